@@ -0,0 +1,387 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * BLDCACHE.C: Keeping the files built by the model conversion tools
+ * in a cache, keyed by a hash of everything they depend on.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bldcache.h"
+
+
+/* Parameters of the 64-bit FNV-1a hash */
+#define FNV_64_PRIME ( ( (Uint64 )0x00000100UL << 32) | 0x000001B3UL)
+#define FNV_64_BASIS ( ( (Uint64 )0xCBF29CE4UL << 32) | 0x84222325UL)
+
+/* The second hash starts from some other value, so that a collision
+ * in one of the hashes is unlikely to be one in the other as well.
+ */
+#define FNV_64_BASIS2 ( ( (Uint64 )0xAF63BD4CUL << 32) | 0x8601B7DFUL)
+
+/* Size of the buffer used for reading and copying files */
+#define BLDCACHE_BUF_SIZE 8192U
+
+/* Longest name of a file in the cache, including its folder */
+#define BLDCACHE_MAX_PATH 1024U
+
+
+/* Local function prototypes */
+
+static void AddBytesToBuildKey(
+    BuildKey *aKey, const Uint8 *someBytes, size_t numBytes
+);
+static GLboolean GetCachePath(
+    const char *cacheDir, const BuildKey *aKey, const char *aSuffix,
+    char *cachePath
+);
+static GLboolean CopyFileBytes(
+    FILE *inFile, FILE *outFile, Uint32 numBytes
+);
+
+
+void InitBuildKey( BuildKey *aKey, const char *toolVersion)
+{
+    aKey->hashes[0] = FNV_64_BASIS;
+    aKey->hashes[1] = FNV_64_BASIS2;
+
+    AddStringToBuildKey( aKey, toolVersion);
+
+} /* End function InitBuildKey */
+
+
+void AddStringToBuildKey( BuildKey *aKey, const char *aString)
+{
+    /* The terminating NUL keeps "ab" + "c" apart from "a" + "bc" */
+    AddBytesToBuildKey(
+	aKey, (const Uint8 *)aString, ( strlen( aString) + 1U)
+    );
+
+} /* End function AddStringToBuildKey */
+
+
+GLboolean AddFileToBuildKey( BuildKey *aKey, const char *fileName)
+{
+    Uint8 readBuf[BLDCACHE_BUF_SIZE];
+    Uint32 fileSize = 0U;
+    size_t numRead;
+    FILE *inFile;
+
+    inFile = fopen( fileName, "rb");
+    if( inFile == NULL)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    while( ( numRead = fread( readBuf, 1U, sizeof( readBuf), inFile)) > 0U)
+    {
+	AddBytesToBuildKey( aKey, readBuf, numRead);
+	fileSize += (Uint32 )numRead;
+
+    } /* End while */
+
+    fclose( inFile);
+
+    /* Also add the size, so that files run together in the key stay
+     * apart.
+     */
+    AddBytesToBuildKey( aKey, (const Uint8 *)&fileSize, sizeof( fileSize));
+
+    return GL_TRUE;
+
+} /* End function AddFileToBuildKey */
+
+
+GLboolean FetchCachedBuild(
+    const char *cacheDir, const BuildKey *aKey, const char *outFileName
+)
+{
+    char cachePath[BLDCACHE_MAX_PATH];
+    char tmpPath[BLDCACHE_MAX_PATH];
+    char fileMagic[sizeof( BLDCACHE_FILE_MAGIC)];
+    Uint64 fileHashes[2];
+    Uint32 numBytes;
+    FILE *inFile, *outFile;
+    GLboolean retVal;
+
+    if( ( GetCachePath( cacheDir, aKey, "", cachePath) == GL_FALSE) ||
+	( ( strlen( outFileName) + sizeof( ".tmp")) > BLDCACHE_MAX_PATH)
+    )
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    strcpy( tmpPath, outFileName);
+    strcat( tmpPath, ".tmp");
+
+    inFile = fopen( cachePath, "rb");
+    if( inFile == NULL)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    /* Check that it is what it claims to be */
+    if( ( fread( fileMagic, 1U, strlen( BLDCACHE_FILE_MAGIC), inFile) !=
+	    strlen( BLDCACHE_FILE_MAGIC)) ||
+	( memcmp(
+	    fileMagic, BLDCACHE_FILE_MAGIC, strlen( BLDCACHE_FILE_MAGIC)) != 0
+	) ||
+	( fread( fileHashes, sizeof( Uint64), 2U, inFile) != 2U) ||
+	( fileHashes[0] != aKey->hashes[0]) ||
+	( fileHashes[1] != aKey->hashes[1]) ||
+	( fread( &numBytes, sizeof( numBytes), 1U, inFile) != 1U)
+    )
+    {
+	fprintf( stderr,
+	    "\nWARNING: Ignoring damaged file \"%s\" in the build cache!\n",
+	    cachePath
+	);
+	fclose( inFile);
+	return GL_FALSE;
+
+    } /* End if */
+
+    /* The file is replaced rather than written over, since a running
+     * demo watching it might have the old one mapped into memory (see
+     * LoadCXMesh( ) in "cxmesh.h").
+     */
+    outFile = fopen( tmpPath, "wb");
+    if( outFile == NULL)
+    {
+	fclose( inFile);
+	return GL_FALSE;
+
+    } /* End if */
+
+    retVal = CopyFileBytes( inFile, outFile, numBytes);
+
+    fclose( inFile);
+    if( fclose( outFile) != 0)
+    {
+	retVal = GL_FALSE;
+
+    } /* End if */
+
+    if( retVal == GL_FALSE)
+    {
+	/* Do not leave a truncated file behind */
+	fprintf( stderr,
+	    "\nWARNING: Ignoring truncated file \"%s\" in the build cache!\n",
+	    cachePath
+	);
+	remove( tmpPath);
+
+    } /* End if */
+    else
+    {
+	/* Some systems do not rename over an existing file */
+	remove( outFileName);
+
+	if( rename( tmpPath, outFileName) != 0)
+	{
+	    remove( tmpPath);
+	    retVal = GL_FALSE;
+
+	} /* End if */
+
+    } /* End else */
+
+    return retVal;
+
+} /* End function FetchCachedBuild */
+
+
+GLboolean StoreCachedBuild(
+    const char *cacheDir, const BuildKey *aKey, const char *builtFileName
+)
+{
+    char cachePath[BLDCACHE_MAX_PATH];
+    char tmpPath[BLDCACHE_MAX_PATH];
+    Uint32 numBytes;
+    long fileSize;
+    FILE *inFile, *outFile;
+    GLboolean retVal;
+
+    if( ( GetCachePath( cacheDir, aKey, "", cachePath) == GL_FALSE) ||
+	( GetCachePath( cacheDir, aKey, ".tmp", tmpPath) == GL_FALSE)
+    )
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    inFile = fopen( builtFileName, "rb");
+    if( inFile == NULL)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    fseek( inFile, 0L, SEEK_END);
+    fileSize = ftell( inFile);
+    fseek( inFile, 0L, SEEK_SET);
+
+    if( fileSize < 0L)
+    {
+	fclose( inFile);
+	return GL_FALSE;
+
+    } /* End if */
+
+    numBytes = (Uint32 )fileSize;
+
+    /* Write it under a temporary name and only then rename it, so that
+     * an interrupted run never leaves a partial file under the real
+     * name.
+     */
+    outFile = fopen( tmpPath, "wb");
+    if( outFile == NULL)
+    {
+	fclose( inFile);
+	return GL_FALSE;
+
+    } /* End if */
+
+    fwrite(
+	BLDCACHE_FILE_MAGIC,
+	sizeof( char), strlen( BLDCACHE_FILE_MAGIC),
+	outFile
+    );
+    fwrite( aKey->hashes, sizeof( Uint64), 2U, outFile);
+    fwrite( &numBytes, sizeof( numBytes), 1U, outFile);
+
+    retVal = CopyFileBytes( inFile, outFile, numBytes);
+
+    fclose( inFile);
+    if( fclose( outFile) != 0)
+    {
+	retVal = GL_FALSE;
+
+    } /* End if */
+
+    if( retVal == GL_TRUE)
+    {
+	/* Some systems do not rename over an existing file */
+	remove( cachePath);
+
+	if( rename( tmpPath, cachePath) != 0)
+	{
+	    retVal = GL_FALSE;
+
+	} /* End if */
+
+    } /* End if */
+
+    if( retVal == GL_FALSE)
+    {
+	remove( tmpPath);
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function StoreCachedBuild */
+
+
+/**
+ * Adds the given bytes to both the hashes of the given key.
+ */
+void AddBytesToBuildKey(
+    BuildKey *aKey, const Uint8 *someBytes, size_t numBytes
+)
+{
+    Uint64 hash0 = aKey->hashes[0];
+    Uint64 hash1 = aKey->hashes[1];
+    size_t i;
+
+    for( i = 0U; i < numBytes; i++)
+    {
+	hash0 = ( hash0 ^ someBytes[i]) * FNV_64_PRIME;
+	hash1 = ( hash1 ^ someBytes[i]) * FNV_64_PRIME;
+
+    } /* End for */
+
+    aKey->hashes[0] = hash0;
+    aKey->hashes[1] = hash1;
+
+} /* End function AddBytesToBuildKey */
+
+
+/**
+ * Puts the name of the file in the cache for the given key, with the
+ * given suffix, in the given buffer of BLDCACHE_MAX_PATH characters.
+ * Returns GL_FALSE if the name does not fit.
+ */
+GLboolean GetCachePath(
+    const char *cacheDir, const BuildKey *aKey, const char *aSuffix,
+    char *cachePath
+)
+{
+    int m;
+
+    /* The folder, "/", 32 hexadecimal digits, the suffix and a NUL */
+    if( ( strlen( cacheDir) + strlen( aSuffix) + 34U) > BLDCACHE_MAX_PATH)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    strcpy( cachePath, cacheDir);
+    strcat( cachePath, "/");
+
+    for( m = 0; m < 2; m++)
+    {
+	/* (C89 has no format for 64-bit words) */
+	sprintf(
+	    ( cachePath + strlen( cachePath)), "%08lx%08lx",
+	    (unsigned long )( ( aKey->hashes[m] >> 32) & 0xFFFFFFFFUL),
+	    (unsigned long )( aKey->hashes[m] & 0xFFFFFFFFUL)
+	);
+
+    } /* End for */
+
+    strcat( cachePath, aSuffix);
+
+    return GL_TRUE;
+
+} /* End function GetCachePath */
+
+
+/**
+ * Copies the given number of bytes from one file to the other.
+ * Returns GL_FALSE if there were not as many bytes to copy, or they
+ * could not all be written.
+ */
+GLboolean CopyFileBytes( FILE *inFile, FILE *outFile, Uint32 numBytes)
+{
+    Uint8 copyBuf[BLDCACHE_BUF_SIZE];
+
+    while( numBytes > 0U)
+    {
+	size_t toCopy =
+	    ( numBytes < sizeof( copyBuf)) ? numBytes : sizeof( copyBuf);
+
+	if( ( fread( copyBuf, 1U, toCopy, inFile) != toCopy) ||
+	    ( fwrite( copyBuf, 1U, toCopy, outFile) != toCopy)
+	)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+	numBytes -= (Uint32 )toCopy;
+
+    } /* End while */
+
+    return GL_TRUE;
+
+} /* End function CopyFileBytes */
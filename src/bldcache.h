@@ -0,0 +1,96 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * BLDCACHE.H: Declarations for the cache of files built by the
+ * model conversion tools.
+ */
+
+/**
+ * The files built by "obj2gld" and "gld2bsp" depend only on the bytes
+ * of their input files, the options they are run with and the version
+ * of the tool. A "build key" is a hash of all of these. The output of
+ * a run is kept in the cache folder under a name made from its key,
+ * so that a later run with the same key (even after the input files
+ * have merely been touched, or rebuilt to the same bytes) just copies
+ * it out of the cache instead of building it all over again.
+ *
+ * Each file in the cache starts with a header:
+ *
+ *   - BLDCACHE_FILE_MAGIC (8 bytes);
+ *   - the two hashes of the build key (64-bit words);
+ *   - the number of bytes of the file built (a 32-bit word);
+ *
+ * followed by the bytes of the file built. (Like the GLData and BSP
+ * Tree files, the words are in the byte order of the machine.)
+ */
+
+#ifndef _BLDCACHE_H
+#define _BLDCACHE_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+
+/* The "signature" of a file in the cache */
+#define BLDCACHE_FILE_MAGIC "VTAJBLD1"
+
+
+/* Data type definitions */
+
+/* The hashes (two 64-bit FNV-1a hashes with different starting
+ * values) of everything a file built depends on
+ */
+typedef struct _build_key
+{
+    Uint64 hashes[2];
+
+} BuildKey;
+
+
+/* Function Prototypes */
+
+/**
+ * Starts a build key for a file built by the given version of a tool.
+ */
+extern void InitBuildKey( BuildKey *aKey, const char *toolVersion);
+
+
+/**
+ * Adds the given string (for example, an option) to the given key.
+ */
+extern void AddStringToBuildKey( BuildKey *aKey, const char *aString);
+
+
+/**
+ * Adds the contents of the given file to the given key. Returns
+ * GL_FALSE if the file could not be read.
+ */
+extern GLboolean AddFileToBuildKey( BuildKey *aKey, const char *fileName);
+
+
+/**
+ * Copies the file built for the given key from the cache in the given
+ * folder to the given file. Returns GL_FALSE if the cache has no such
+ * file.
+ */
+extern GLboolean FetchCachedBuild(
+    const char *cacheDir, const BuildKey *aKey, const char *outFileName
+);
+
+
+/**
+ * Keeps a copy of the given file, built for the given key, in the
+ * cache in the given folder (which must exist). Returns GL_FALSE if it
+ * could not be stored.
+ */
+extern GLboolean StoreCachedBuild(
+    const char *cacheDir, const BuildKey *aKey, const char *builtFileName
+);
+
+#endif    /* _BLDCACHE_H */
@@ -9,7 +9,14 @@
 
 /**
  * This version of the BSP tree compiler can handle only
- * up to 65535 texture maps and 65535 vertex definitions.
+ * up to 65535 texture maps, 65535 vertex definitions and 65535 tree
+ * nodes (and therefore partition planes).
+ *
+ * The partition planes are kept in a table shared by all the nodes of
+ * the tree - a plane is kept only once, however many nodes (split
+ * fragments of the same wall, the same floor, etc.) use it - and each
+ * node refers to its plane by its index into this table. The table is
+ * not stored: it is built up again as the nodes are loaded.
  * 
  * Stream format for a stored BSP tree:
  *
@@ -85,6 +92,13 @@
 #define BSP_TEX_ORD_EPSILON 0.00390625F
 
 
+/* Default costs of the "SAH" cost model (see BSPCostModel) */
+#define BSP_SAH_NODE_COST 1.0F
+#define BSP_SAH_SPLIT_COST 1.0F
+#define BSP_SAH_AXIS_BIAS 0.1F
+#define BSP_SAH_FACADE_BIAS 0.5F
+
+
 /* Data type definitions */
 
 /* Type of a point with respect to a partition plane */
@@ -115,10 +129,9 @@ typedef struct _bsp_tri_face
 typedef struct _bsp_tree
 {
     Uint16 numTri;
+    Uint16 planeIndex;      /* Into the 'partPlanes' of the tree */
     BSPTriFace *triDefs;
 
-    BSPPlane partPlane;
-
     struct _bsp_tree *back;
     struct _bsp_tree *front;
 
@@ -146,11 +159,48 @@ typedef struct _bsp_tree_data
     Uint16 numNodes;
     Uint32 numTri;
 
+    Uint16 numPlanes;
+    BSPPlane *partPlanes;
+
     BSPTree *bspTree;
 
 } BSPTreeData;
 
 
+/* Ways of choosing the partition plane of each node of a BSP tree */
+typedef enum { BSP_COST_BALANCE = 0, BSP_COST_SAH} BSPCostKind;
+
+
+/* How the BSP tree compiler chooses the partition plane of each node,
+ * from the planes of the triangles in the subspace of the node.
+ *
+ * BSP_COST_BALANCE chooses the plane causing the fewest splits while
+ * keeping the tree balanced.
+ *
+ * BSP_COST_SAH instead chooses the plane that would cost the renderer
+ * the least each frame, estimated like the "Surface Area Heuristic" of
+ * ray tracers: the cost of visiting the node and of drawing the
+ * triangles in the plane (which are culled together when the plane
+ * faces away), plus that of drawing the triangles on either side of it
+ * weighted by the chance of that side being seen - the surface area of
+ * its bounding box over that of the whole subspace. Costs are in units
+ * of the cost of drawing a triangle. Axis-aligned planes and planes
+ * with much of the area of the subspace in them (the facades of a
+ * building, its floors, etc.) can be favoured as well.
+ */
+typedef struct _bsp_cost_model
+{
+    BSPCostKind costKind;
+
+    GLfloat nodeCost;     /* Of visiting a node */
+    GLfloat splitCost;    /* Of the vertices added by a split */
+
+    GLfloat axisBias;     /* Part of the cost taken off axis-aligned planes */
+    GLfloat facadeBias;   /* Part taken off a plane with all the area */
+
+} BSPCostModel;
+
+
 /* Function Prototypes */
 
 /**
@@ -161,16 +211,36 @@ typedef struct _bsp_tree_data
  * coordinates at each of the vertices of the triangles in 
  * anticlockwise order, overall number of texture maps, 
  * null-terminated names of the texture maps, respectively (phew!).
+ * The partition planes are chosen using the given cost model (or
+ * BSP_COST_BALANCE, if it is NULL).
  */
 extern BSPTreeData *GenBSPTreeData( 
     Uint32 nTri, 
     GLfloat *triVerts,
     Uint16 *texIndices,
     GLfloat *triTexCoords,
-    Uint16 nMaps, char **mapNames
+    Uint16 nMaps, char **mapNames,
+    const BSPCostModel *costModel
 );
 
 
+/**
+ * Checks that the exact orientations used by GenBSPTreeData( ) come
+ * out right with this compiler and FPU, with a few orientations so
+ * close to zero that plain doubles get their signs wrong.
+ *
+ * Returns GL_TRUE if they do.
+ */
+extern GLboolean CheckBSPPredicates( void);
+
+
+/**
+ * Sets up the given cost model of the given kind with the default
+ * costs.
+ */
+extern void InitBSPCostModel( BSPCostModel *costModel, BSPCostKind costKind);
+
+
 /**
  * Saves the given BSP Tree and associated texture map information
  * into the given file. The file must be opened for writing binary
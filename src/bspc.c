@@ -44,6 +44,63 @@
 /* The assumed thickness of a plane for coplanarity comparisons */
 #define PLANE_THICKNESS 0.0005
 
+/* Partition planes with the components of their unit normals differing
+ * only upto this value, and their distances from the origin only upto
+ * PLANE_THICKNESS, are considered the same plane.
+ */
+#define PLANE_NORMAL_TOLERANCE 0.00001
+
+/* The number of partition planes per block of the plane table */
+#define PLANES_BLK_SIZE 256
+
+/* The planes in a plane table are looked up by their distance from
+ * the origin, in buckets each covering PLANE_BUCKET_WIDTH of it
+ * (folded into PLANE_NUM_BUCKETS buckets).
+ */
+#define PLANE_BUCKET_WIDTH 1.0
+#define PLANE_NUM_BUCKETS 4096
+#define NO_PLANE 0xFFFFU
+
+/* Splits a double into two halves, each of which can be multiplied
+ * exactly with another such half (2^27 + 1, see GetExactOrient( )).
+ */
+#define EXACT_SPLITTER 134217729.0
+
+/* The most components in the exact value of an orientation */
+#define MAX_ORIENT_TERMS 48
+
+/* The exact orientations need every operation on a double rounded to
+ * a double. The x87 FPU (used for doubles even with "-mfpmath=sse"
+ * unless SSE2 is available) rounds to 64 bits of mantissa by default,
+ * so it is switched to 53 bits while a BSP Tree is compiled.
+ */
+#if defined( __GNUC__) && ( defined( __i386__) || defined( __x86_64__))
+    #define FPU_PRECISION_MASK 0x0300U
+    #define FPU_DOUBLE_PRECISION 0x0200U
+#elif defined( _MSC_VER) && defined( _M_IX86)
+    #define FPU_PRECISION_MASK _MCW_PC
+    #define FPU_DOUBLE_PRECISION _PC_53
+#endif
+
+/* The number of near-degenerate orientations in 'orientChecks' */
+#define NUM_ORIENT_CHECKS 2
+
+/* The scale (2^-15) of the points in 'orientChecks' and that (2^-45)
+ * of their orientations
+ */
+#define ORIENT_CHECK_SCALE 32768.0F
+#define ORIENT_CHECK_VOL_SCALE 35184372088832.0
+
+/* The triangles in a partition plane are culled together whenever the
+ * plane faces away from the viewer - about half the time.
+ */
+#define COINCIDENT_DRAW_FRACTION 0.5
+
+/* A plane whose normal is at least this close to an axis is taken as
+ * being aligned with it
+ */
+#define AXIS_ALIGN_COS 0.99999
+
 /* Data types used locally */
 
 typedef struct _bsp_tri_node
@@ -52,10 +109,25 @@ typedef struct _bsp_tri_node
     GLfloat V[3][3];
 
     /* Plane containing the triangle - MUST be separately computed
-     * using the GetPlaneForTri( ) function.
+     * using the SetTriPlane( ) function. A triangle split off from
+     * another one keeps the plane of that one (see SetTriPart( )).
      */
     BSPPlane plane;
 
+    /* The input triangle whose plane this is, with the vertices that
+     * define the plane exactly, the magnitude of the normal of these
+     * vertices and a bound on the error of the distance of a point
+     * from 'plane'.
+     */
+    Uint32 srcIndex;
+    GLfloat S[3][3];
+    GLdouble normMag;
+    GLdouble distErr;
+
+    /* Bounding box and area of the triangle */
+    GLfloat bbMin[3], bbMax[3];
+    GLdouble area;
+
     /* Texture map index and mappings at the three vertices */
     Uint16 tIndex;
     GLfloat T[3][2];
@@ -93,6 +165,72 @@ typedef struct _vert_defs
 } VertDefs;
 
 
+/* A growing table of distinct partition planes */
+typedef struct _plane_table
+{
+    Uint16 numPlanes;
+    BSPPlane *planes;
+
+    /* Chains of the planes in each bucket */
+    Uint16 bucketHeads[PLANE_NUM_BUCKETS];
+    Uint16 *nextPlanes;
+
+} PlaneTable;
+
+
+/* The state of a BSP tree being compiled. Each call to GenBSPTreeData( )
+ * has its own, so that several BSP trees can be compiled at once.
+ */
+typedef struct _bsp_compiler
+{
+    /* Refactored vertex definitions */
+    Uint16 numVertDefs;
+    VertDefs *vertDefsPtr;
+
+    /* Number of triangles mapped to each texture */
+    Uint32 *texCtrs;
+
+    /* Distinct partition planes of the nodes */
+    PlaneTable planeTable;
+
+    /* How the partition planes are chosen */
+    BSPCostModel costModel;
+
+    /* When the plane of each input triangle was last tried as the
+     * partition plane of a node (by the number of that node)
+     */
+    Uint32 *triedAt;
+
+    /* Bounds of the model */
+    GLfloat minX, maxX, minY, maxY, minZ, maxZ;
+
+    Uint32 nodesCreated;
+    Uint32 trianglesCreated;
+    Uint16 maxDepthSoFar;
+    Uint16 currDepth;
+
+#ifdef BSPC_DEBUG
+    Uint32 numInputFaces;
+    Uint32 trianglesSplit;
+
+    Uint32 trianglesConverted;
+    Uint32 nodesConverted;
+#endif
+
+} BSPCompiler;
+
+
+/* The number of nodes, triangles and partition planes of a BSP tree
+ * saved or loaded
+ */
+typedef struct _bsp_io_counts
+{
+    Uint32 numNodes;
+    Uint32 numTri;
+
+} BSPIOCounts;
+
+
 /* A nifty macro to print out a triangle */
 
 #ifdef BSPC_DEBUG
@@ -112,26 +250,64 @@ typedef enum { IN_BACK = 0, SPANNING, COINCIDENT, IN_FRONT} TriType;
 
 /* Internal function prototypes */
 
-static void BuildBSPTree( IntBSPTreeNode *treeNode, BSPTriNode *triList);
+static void BuildBSPTree( 
+    BSPCompiler *bspc, IntBSPTreeNode *treeNode, BSPTriNode *triList
+);
 
-static BSPTriNode *SelectNextRoot( BSPTriNode *triList, BSPTriNode **rootPtr);
+static BSPTriNode *SelectNextRoot( 
+    BSPCompiler *bspc, BSPTriNode *triList, BSPTriNode **rootPtr
+);
+static BSPTriNode *GetCheapestRoot( BSPCompiler *bspc, BSPTriNode *triList);
+static GLdouble GetSplitCost( 
+    BSPCompiler *bspc, BSPTriNode *triList, BSPTriNode *planeTri, 
+    GLdouble listArea, GLdouble boxArea
+);
+static GLdouble GetBoxArea( GLfloat bbMin[], GLfloat bbMax[]);
+static void AddToBox( GLfloat bbMin[], GLfloat bbMax[], BSPTriNode *aTri);
 static void SplitTri( 
-    BSPTriNode *aTri, BSPPlane *p, BSPTriNode **fList, BSPTriNode **bList
+    BSPTriNode *aTri, BSPTriNode *planeTri, 
+    BSPTriNode **fList, BSPTriNode **bList
 );
-static TriType ClassifyTri( BSPTriNode *aTri, BSPPlane *partPlane);
-static GLdouble IntersectPlaneLineSeg( 
-    BSPPlane *p, GLfloat v0[], GLfloat v1[], GLfloat res[]
+static TriType ClassifyTri( BSPTriNode *aTri, BSPTriNode *planeTri);
+static void ClassifyTriVerts( 
+    BSPTriNode *aTri, BSPTriNode *planeTri, 
+    PointType vertTypes[], GLdouble vertDists[]
 );
+static GLdouble GetVertDist( GLfloat aPt[], BSPTriNode *planeTri);
+static GLdouble GetExactOrient( 
+    GLfloat a[], GLfloat b[], GLfloat c[], GLfloat d[]
+);
+static void TwoProduct( GLdouble a, GLdouble b, GLdouble *x, GLdouble *y);
+static int GrowExpansion( int eLen, GLdouble e[], GLdouble b);
+static unsigned int SetDoubleRounding( void);
+static void RestoreRounding( unsigned int oldControl);
 static int GetPlaneForTri( GLfloat V[][3], BSPPlane *planePtr);
+static int SetTriPlane( 
+    BSPTriNode *aTri, Uint32 srcIndex, GLdouble maxPtSize
+);
+static int SetTriPart( BSPTriNode *aPart, BSPTriNode *aTri);
+static void SetTriExtent( BSPTriNode *aTri);
+
+static void WriteBSPTree( 
+    BSPTree *root, BSPTreeData *bspData, FILE *outFile, 
+    BSPIOCounts *ioCounts
+);
+static BSPTree *ReadBSPTree( 
+    FILE *inFile, BSPTreeData *bspData, PlaneTable *planeTable, 
+    BSPIOCounts *ioCounts
+);
 
-static void WriteBSPTree( BSPTree *root, FILE *outFile);
-static BSPTree *ReadBSPTree( FILE *inFile, BSPTreeData *bspData);
+static void InitPlaneTable( PlaneTable *planeTable);
+static Uint16 GetPlaneIndex( PlaneTable *planeTable, BSPPlane *aPlane);
+static int GetPlaneBucket( GLdouble planeDist);
 
-static BSPTree *ConvIntBSPTree( IntBSPTreeNode *intTree);
+static BSPTree *ConvIntBSPTree( BSPCompiler *bspc, IntBSPTreeNode *intTree);
 
 static void FreeBSPTree( BSPTree *root);
 
-static Uint16 GetVertDefIndex( GLfloat v[], GLfloat t[], GLfloat resV[]);
+static Uint16 GetVertDefIndex( 
+    BSPCompiler *bspc, GLfloat v[], GLfloat t[], GLfloat resV[]
+);
 
 static BSPTriNode *AddTriToList( BSPTriNode *list, BSPTriNode *node);
 static BSPTriNode *RemoveTriFromList( BSPTriNode *listHead, BSPTriNode *node);
@@ -139,32 +315,76 @@ static BSPTriNode *RemoveTriFromList( BSPTriNode *listHead, BSPTriNode *node);
 
 /* Global data */
 
-#ifdef BSPC_DEBUG
-    static Uint32 numInputFaces = 0U;
-
-    static Uint32 trianglesConverted = 0U;
-    static Uint32 nodesConverted = 0U;
-
-    static Uint32 nodesSaved = 0U;
-    static Uint32 trianglesSaved = 0U;
-
-    static Uint32 nodesLoaded = 0U;
-    static Uint32 trianglesLoaded = 0U;
-#endif
-
 static const char *vertCodes = "BCF";
 
-static Uint16 numVertDefs;
-static VertDefs *vertDefsPtr;
-
-static Uint32 *texCtrs;
-
-static GLfloat minX, maxX, minY, maxY, minZ, maxZ;
-
-static Uint16 nodesCreated = 0U;
-static Uint32 trianglesCreated = 0U;
-static Uint16 maxDepthSoFar;
-static Uint16 currDepth;
+/* The terms of the orientation of the point 'd' with respect to the
+ * triangle 'abc' - the determinant of the matrix with the rows
+ * (a 1), (b 1), (c 1) and (d 1), negated. Each term is the product of
+ * the X ordinate of one point, the Y ordinate of another and the Z
+ * ordinate of a third (0 = 'a', ..., 3 = 'd'), with a sign.
+ */
+static const int orientTerms[24][4] =
+{
+    { 1, 2, 3,  1}, { 1, 3, 2, -1}, { 2, 1, 3, -1},
+    { 2, 3, 1,  1}, { 3, 1, 2,  1}, { 3, 2, 1, -1},
+    { 0, 2, 3, -1}, { 0, 3, 2,  1}, { 2, 0, 3,  1},
+    { 2, 3, 0, -1}, { 3, 0, 2, -1}, { 3, 2, 0,  1},
+    { 0, 1, 3,  1}, { 0, 3, 1, -1}, { 1, 0, 3, -1},
+    { 1, 3, 0,  1}, { 3, 0, 1,  1}, { 3, 1, 0, -1},
+    { 0, 1, 2, -1}, { 0, 2, 1,  1}, { 1, 0, 2,  1},
+    { 1, 2, 0, -1}, { 2, 0, 1, -1}, { 2, 1, 0,  1},
+};
+
+/* Points 'a', 'b', 'c' and 'd' whose orientations are so close to zero
+ * that working them out with plain doubles gets the sign wrong (0 and
+ * -88, respectively, instead of -210 and 672, scaled by
+ * ORIENT_CHECK_VOL_SCALE). The ordinates are all exact as floats.
+ */
+static const GLfloat orientChecks[NUM_ORIENT_CHECKS][4][3] =
+{
+    {
+	{ 0.0F, 0.0F, 0.0F},
+	{ 
+	    6931451.0F / ORIENT_CHECK_SCALE, 
+	    7889746.0F / ORIENT_CHECK_SCALE, 
+	    5832778.0F / ORIENT_CHECK_SCALE
+	},
+	{ 
+	    6154265.0F / ORIENT_CHECK_SCALE, 
+	    6661826.0F / ORIENT_CHECK_SCALE, 
+	    8386705.0F / ORIENT_CHECK_SCALE
+	},
+	{ 
+	    130377.0F / ORIENT_CHECK_SCALE, 
+	    179428.0F / ORIENT_CHECK_SCALE, 
+	    -180219.0F / ORIENT_CHECK_SCALE
+	},
+    },
+    {
+	{ 0.0F, 0.0F, 0.0F},
+	{ 
+	    4232839.0F / ORIENT_CHECK_SCALE, 
+	    4907241.0F / ORIENT_CHECK_SCALE, 
+	    8030665.0F / ORIENT_CHECK_SCALE
+	},
+	{ 
+	    6527703.0F / ORIENT_CHECK_SCALE, 
+	    7606611.0F / ORIENT_CHECK_SCALE, 
+	    4892265.0F / ORIENT_CHECK_SCALE
+	},
+	{ 
+	    218145.0F / ORIENT_CHECK_SCALE, 
+	    256475.0F / ORIENT_CHECK_SCALE, 
+	    -274913.0F / ORIENT_CHECK_SCALE
+	},
+    },
+};
+
+/* The exact orientations of the points in 'orientChecks', unscaled */
+static const GLdouble orientCheckVols[NUM_ORIENT_CHECKS] = 
+{ 
+    -210.0, 672.0,
+};
 
 
 /**
@@ -176,15 +396,22 @@ BSPTreeData *GenBSPTreeData(
     GLfloat *triVerts,
     Uint16 *texIndices,
     GLfloat *triTexCoords,
-    Uint16 nMaps, char **texMapNames
+    Uint16 nMaps, char **texMapNames,
+    const BSPCostModel *costModel
 )
 {
     BSPTreeData *retVal = NULL;
     IntBSPTreeNode *genBSPTree = NULL;
     BSPTriNode *triList = NULL;
+    BSPCompiler compState;
+    BSPCompiler *bspc = &compState;
+    GLdouble maxPtSize;
     unsigned int i, j;
+    unsigned int oldFPUControl;
 
     
+    oldFPUControl = SetDoubleRounding( );
+
     retVal = (BSPTreeData *)( malloc( sizeof( BSPTreeData )));
     if( retVal == NULL)
     {
@@ -204,8 +431,8 @@ BSPTreeData *GenBSPTreeData(
 
     } /* End if */
 
-    texCtrs = (Uint32 *)( malloc( nMaps * sizeof( Uint32)));
-    if( texCtrs == NULL)
+    bspc->texCtrs = (Uint32 *)( malloc( nMaps * sizeof( Uint32)));
+    if( bspc->texCtrs == NULL)
     {
         fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
 	exit( EXIT_FAILURE);
@@ -227,15 +454,46 @@ BSPTreeData *GenBSPTreeData(
 
 	strcpy( retVal->mapNames[i], texMapNames[i]);
 
-	texCtrs[i] = 0U;
+	bspc->texCtrs[i] = 0U;
 
     } /* End for */
 
 
 #ifdef BSPC_DEBUG
-    numInputFaces = 0U;
+    bspc->numInputFaces = 0U;
 #endif
 
+    if( costModel != NULL)
+    {
+	bspc->costModel = *costModel;
+
+    } /* End if */
+    else
+    {
+	InitBSPCostModel( &( bspc->costModel), BSP_COST_BALANCE);
+
+    } /* End else */
+
+    /* Every point the compiler deals with lies within the input
+     * triangles, so its size is at most the largest size (the sum of
+     * the magnitudes of the ordinates) of an input vertex.
+     */
+    maxPtSize = 0.0;
+    for( i = 0U; i < ( 3U * nTri); i++)
+    {
+	GLdouble ptSize = 
+	    fabs( triVerts[3*i + 0]) + 
+	    fabs( triVerts[3*i + 1]) + 
+	    fabs( triVerts[3*i + 2]);
+
+	if( ptSize > maxPtSize)
+	{
+	    maxPtSize = ptSize;
+
+	} /* End if */
+
+    } /* End for */
+
     /* Convert the input triangles into a list of BSPTriNode-s */
     for( i = 0U; i < nTri; i++)
     {
@@ -264,7 +522,7 @@ BSPTreeData *GenBSPTreeData(
 	} /* End for */
 
 	/* Check if this is a "proper" triangle */
-	if( GetPlaneForTri( tmpTri->V, &( tmpTri->plane)) != 0)
+	if( SetTriPlane( tmpTri, i, maxPtSize) != 0)
 	{
 #ifdef BSPC_DEBUG
             fprintf( stderr, 
@@ -284,7 +542,7 @@ BSPTreeData *GenBSPTreeData(
 	    triList = AddTriToList( triList, tmpTri);
 
 #ifdef BSPC_DEBUG
-            numInputFaces++;
+	    bspc->numInputFaces++;
 #endif
 
 	} /* End else */
@@ -308,73 +566,113 @@ BSPTreeData *GenBSPTreeData(
 #ifdef BSPC_DEBUG
     printf( 
         "BSPC: Compiling BSP tree from %u input triangles...\n",
-	numInputFaces
+	bspc->numInputFaces
     );
     printf( "BSPC: Nodes created so far: 0       ");
     fflush( stdout);
+
+    bspc->trianglesSplit = 0U;
 #endif
 
 
     /* Build the BSP tree */
-    currDepth = 0U;
-    maxDepthSoFar = 0U;
-    nodesCreated = 0U;
-    trianglesCreated = 0U;
-    BuildBSPTree( genBSPTree, triList);
+    bspc->currDepth = 0U;
+    bspc->maxDepthSoFar = 0U;
+    bspc->nodesCreated = 0U;
+    bspc->trianglesCreated = 0U;
+
+    bspc->triedAt = (Uint32 *)( calloc( ( nTri + 1U), sizeof( Uint32)));
+    if( bspc->triedAt == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    BuildBSPTree( bspc, genBSPTree, triList);
+
+    free( bspc->triedAt);
+    bspc->triedAt = NULL;
 
 
 #ifdef BSPC_DEBUG
-    printf( "\b\b\b\b\b\b\b\b%-8d\n", nodesCreated);
-    printf( "BSPC: BSP tree successfully generated!\n");
-    nodesConverted = 0U;
-    trianglesConverted = 0U;
+    printf( "\b\b\b\b\b\b\b\b%-8lu\n", (unsigned long )bspc->nodesCreated);
+    printf( 
+	"BSPC: BSP tree successfully generated (%u triangles split)!\n",
+	bspc->trianglesSplit
+    );
+    bspc->nodesConverted = 0U;
+    bspc->trianglesConverted = 0U;
     printf( 
         "BSPC: Refactoring generated BSP tree: %3u%%", 
-	( ( nodesConverted * 100U) / nodesCreated)
+	( ( bspc->nodesConverted * 100U) / bspc->nodesCreated)
     );
     fflush( stdout);
 #endif
 
 
-    retVal->numNodes = nodesCreated;
-    retVal->maxDepth = maxDepthSoFar;
+    /* (Counted in 32 bits, so that the stamps in 'triedAt' never wrap
+     * around, but saved in 16.)
+     */
+    if( bspc->nodesCreated > USHRT_MAX)
+    {
+        fprintf(
+	    stderr, "\nFATAL ERROR: Too many BSP tree nodes (%lu)!\n",
+	    (unsigned long )bspc->nodesCreated
+	);
+	exit( EXIT_FAILURE);
 
-    minX = minY = minZ = FLT_MAX;
-    maxX = maxY = maxZ = FLT_MIN;
+    } /* End if */
 
-    numVertDefs = 0U;
-    vertDefsPtr = NULL;
+    retVal->numNodes = (Uint16 )bspc->nodesCreated;
+    retVal->maxDepth = bspc->maxDepthSoFar;
+
+    bspc->minX = bspc->minY = bspc->minZ = FLT_MAX;
+    bspc->maxX = bspc->maxY = bspc->maxZ = FLT_MIN;
+
+    bspc->numVertDefs = 0U;
+    bspc->vertDefsPtr = NULL;
+
+    InitPlaneTable( &( bspc->planeTable));
 
 
     /* Convert the internal BSP tree representation */
-    retVal->bspTree = ConvIntBSPTree( genBSPTree);
+    retVal->bspTree = ConvIntBSPTree( bspc, genBSPTree);
 
 
     /* By now we should know the bounds of the model... */
-    retVal->minX = minX;
-    retVal->maxX = maxX;
+    retVal->minX = bspc->minX;
+    retVal->maxX = bspc->maxX;
 
-    retVal->minY = minY;
-    retVal->maxY = maxY;
+    retVal->minY = bspc->minY;
+    retVal->maxY = bspc->maxY;
 
-    retVal->minZ = minZ;
-    retVal->maxZ = maxZ;
+    retVal->minZ = bspc->minZ;
+    retVal->maxZ = bspc->maxZ;
 
     /* ...as well as how many triangles are mapped to each texture. */
-    retVal->mapTriNums = texCtrs;
-    texCtrs = NULL;
+    retVal->mapTriNums = bspc->texCtrs;
+    bspc->texCtrs = NULL;
 
     /* ...and how many triangles we finally created */
-    retVal->numTri = trianglesCreated;
+    retVal->numTri = bspc->trianglesCreated;
+
+    /* ...and the partition planes the nodes share */
+    retVal->numPlanes = bspc->planeTable.numPlanes;
+    retVal->partPlanes = bspc->planeTable.planes;
+    bspc->planeTable.planes = NULL;
+
+    free( bspc->planeTable.nextPlanes);
+    bspc->planeTable.nextPlanes = NULL;
 
 
     /* Get the vertex definitions */
 
-    retVal->nVertices = numVertDefs;
+    retVal->nVertices = bspc->numVertDefs;
     retVal->vertCoords = 
-        (GLfloat *)( malloc( numVertDefs * 3 * sizeof( GLfloat)));
+	(GLfloat *)( malloc( bspc->numVertDefs * 3 * sizeof( GLfloat)));
     retVal->texCoords = 
-        (GLfloat *)( malloc( numVertDefs * 2 * sizeof( GLfloat)));
+	(GLfloat *)( malloc( bspc->numVertDefs * 2 * sizeof( GLfloat)));
 
     if( ( retVal->vertCoords == NULL) || ( retVal->texCoords == NULL))
     {
@@ -386,7 +684,7 @@ BSPTreeData *GenBSPTreeData(
     {
 	VertDefs *cvPtr, *pvPtr;
 
-	cvPtr = vertDefsPtr;
+	cvPtr = bspc->vertDefsPtr;
 	i = 0U;
 	while( cvPtr != NULL)
 	{
@@ -411,7 +709,7 @@ BSPTreeData *GenBSPTreeData(
 
 #ifdef BSPC_DEBUG
         /* Sanity check */
-        if( i != numVertDefs)
+	if( i != bspc->numVertDefs)
 	{
 	    fprintf( 
 	        stderr,
@@ -426,24 +724,103 @@ BSPTreeData *GenBSPTreeData(
 
 
 #ifdef BSPC_DEBUG 
-    printf( "\b\b\b\b%3u%%\n", ( nodesConverted * 100U) / nodesCreated);
     printf( 
-        "(Final: %u triangles, %u vertex definitions)\n",
-        trianglesConverted, numVertDefs
+	"\b\b\b\b%3u%%\n", 
+	( bspc->nodesConverted * 100U) / bspc->nodesCreated
+    );
+    printf( 
+	"(Final: %u triangles, %u vertex definitions, %u planes)\n",
+	bspc->trianglesConverted, bspc->numVertDefs, retVal->numPlanes
     );
     fflush( stdout);
 #endif
 
+    RestoreRounding( oldFPUControl);
+
     return retVal;
 
 } /* End function GenBSPTreeData */
 
 
+/**
+ * Works out the orientations in 'orientChecks' (and those with 'b' and
+ * 'c' swapped) exactly, the way GetVertDist( ) does, and compares them
+ * with 'orientCheckVols'.
+ */
+GLboolean CheckBSPPredicates( void)
+{
+    GLboolean retVal = GL_TRUE;
+    GLfloat thePts[4][3];
+    GLdouble orientVol, flipVol;
+    unsigned int oldFPUControl;
+    int i, j;
+
+    oldFPUControl = SetDoubleRounding( );
+
+    for( i = 0; i < NUM_ORIENT_CHECKS; i++)
+    {
+	for( j = 0; j < 4; j++)
+	{
+	    thePts[j][0] = orientChecks[i][j][0];
+	    thePts[j][1] = orientChecks[i][j][1];
+	    thePts[j][2] = orientChecks[i][j][2];
+
+	} /* End for */
+
+	/* Swapping 'b' and 'c' must flip the orientation exactly */
+	orientVol = GetExactOrient( 
+	    thePts[0], thePts[1], thePts[2], thePts[3]
+	);
+	flipVol = GetExactOrient( 
+	    thePts[0], thePts[2], thePts[1], thePts[3]
+	);
+
+	if( ( orientVol != orientCheckVols[i] / ORIENT_CHECK_VOL_SCALE) ||
+	    ( flipVol != -orientVol)
+	)
+	{
+	    fprintf( 
+		stderr, 
+		"ERROR: Orientation %d is %g (flipped %g) instead of %g!\n",
+		i, orientVol * ORIENT_CHECK_VOL_SCALE,
+		flipVol * ORIENT_CHECK_VOL_SCALE, orientCheckVols[i]
+	    );
+	    retVal = GL_FALSE;
+
+	} /* End if */
+
+    } /* End for */
+
+    RestoreRounding( oldFPUControl);
+
+    return retVal;
+
+} /* End function CheckBSPPredicates */
+
+
+/**
+ * Sets up the given cost model with the default costs from "bsp.h",
+ * which only BSP_COST_SAH uses.
+ */
+void InitBSPCostModel( BSPCostModel *costModel, BSPCostKind costKind)
+{
+    costModel->costKind = costKind;
+
+    costModel->nodeCost = BSP_SAH_NODE_COST;
+    costModel->splitCost = BSP_SAH_SPLIT_COST;
+    costModel->axisBias = BSP_SAH_AXIS_BIAS;
+    costModel->facadeBias = BSP_SAH_FACADE_BIAS;
+
+} /* End function InitBSPCostModel */
+
+
 /**
  * Builds a BSP tree starting at the given node, using the
  * given list of triangular faces.
  */
-void BuildBSPTree( IntBSPTreeNode *treeNode, BSPTriNode *triList)
+void BuildBSPTree( 
+    BSPCompiler *bspc, IntBSPTreeNode *treeNode, BSPTriNode *triList
+)
 {
     BSPTriNode *rootTri;
     BSPTriNode *restOfList;
@@ -451,23 +828,23 @@ void BuildBSPTree( IntBSPTreeNode *treeNode, BSPTriNode *triList)
     BSPTriNode *backList = NULL;
 
 
-    nodesCreated++;
+    bspc->nodesCreated++;
 
-    currDepth++;
-    if( currDepth > maxDepthSoFar)
+    bspc->currDepth++;
+    if( bspc->currDepth > bspc->maxDepthSoFar)
     {
-        maxDepthSoFar = currDepth;
+	bspc->maxDepthSoFar = bspc->currDepth;
 
     } /* End if */
 
 
 #ifdef BSPC_DEBUG
-    printf( "\b\b\b\b\b\b\b\b%-8d", nodesCreated);
+    printf( "\b\b\b\b\b\b\b\b%-8lu", (unsigned long )bspc->nodesCreated);
     fflush( stdout);
 #endif
 
     /* Pick up the root triangle for partitioning this subspace */
-    restOfList = SelectNextRoot( triList, &rootTri);
+    restOfList = SelectNextRoot( bspc, triList, &rootTri);
 
     treeNode->partition.A = rootTri->plane.A;
     treeNode->partition.B = rootTri->plane.B;
@@ -489,7 +866,7 @@ void BuildBSPTree( IntBSPTreeNode *treeNode, BSPTriNode *triList)
         aTri = restOfList;
 	restOfList = RemoveTriFromList( restOfList, aTri);
 
-	triKind = ClassifyTri( aTri, &( treeNode->partition));
+	triKind = ClassifyTri( aTri, rootTri);
 	switch( triKind)
 	{
 	case COINCIDENT:
@@ -507,9 +884,11 @@ void BuildBSPTree( IntBSPTreeNode *treeNode, BSPTriNode *triList)
 
 	case SPANNING:
 	    fSplitList = bSplitList = NULL;
-	    SplitTri( 
-	        aTri, &( treeNode->partition), &fSplitList, &bSplitList
-	    );
+	    SplitTri( aTri, rootTri, &fSplitList, &bSplitList);
+
+#ifdef BSPC_DEBUG
+	    bspc->trianglesSplit++;
+#endif
 
 	    /* The triangle might have been split into two or three other
 	     * triangles - however, on each side (front/back), only up to
@@ -578,7 +957,7 @@ void BuildBSPTree( IntBSPTreeNode *treeNode, BSPTriNode *triList)
 	treeNode->front->front = NULL;
 	treeNode->front->back = NULL;
 
-	BuildBSPTree( treeNode->front, frontList);
+	BuildBSPTree( bspc, treeNode->front, frontList);
 
     } /* End if */
 
@@ -599,12 +978,12 @@ void BuildBSPTree( IntBSPTreeNode *treeNode, BSPTriNode *triList)
 	treeNode->back->front = NULL;
 	treeNode->back->back = NULL;
 
-	BuildBSPTree( treeNode->back, backList);
+	BuildBSPTree( bspc, treeNode->back, backList);
 
     } /* End if */
 
 
-    currDepth--;
+    bspc->currDepth--;
 
 } /* End function BuildBSPTree */
 
@@ -612,13 +991,16 @@ void BuildBSPTree( IntBSPTreeNode *treeNode, BSPTriNode *triList)
 /**
  * Selects the next root node from the given list.
  * This is a node that causes as few splits as possible
- * while keeping the tree balanced. This is an O(N^2)
+ * while keeping the tree balanced (or the cheapest one,
+ * with the BSP_COST_SAH cost model). This is an O(N^2)
  * method and is VERY expensive.
  *
  * Removes the selected node and returns the rest of 
  * the list.
  */
-BSPTriNode *SelectNextRoot( BSPTriNode *triList, BSPTriNode **rootPtr)
+BSPTriNode *SelectNextRoot( 
+    BSPCompiler *bspc, BSPTriNode *triList, BSPTriNode **rootPtr
+)
 {
     unsigned int minScore;
     BSPTriNode *bestNode;
@@ -630,7 +1012,19 @@ BSPTriNode *SelectNextRoot( BSPTriNode *triList, BSPTriNode **rootPtr)
     minScore = UINT_MAX;
     bestNode = NULL;
 
-    currNode = triList;
+    if( bspc->costModel.costKind == BSP_COST_SAH)
+    {
+	/* Skip the search for the best balanced node below */
+	bestNode = GetCheapestRoot( bspc, triList);
+	currNode = NULL;
+
+    } /* End if */
+    else
+    {
+	currNode = triList;
+
+    } /* End else */
+
     while( currNode != NULL)
     {
         BSPTriNode *testNode;
@@ -643,7 +1037,7 @@ BSPTriNode *SelectNextRoot( BSPTriNode *triList, BSPTriNode **rootPtr)
 
 	while( testNode != NULL)
 	{
-	    TriType triType = ClassifyTri( testNode, &( currNode->plane));
+	    TriType triType = ClassifyTri( testNode, currNode);
 
 	    if( testNode != currNode)
 	    {
@@ -668,55 +1062,6 @@ BSPTriNode *SelectNextRoot( BSPTriNode *triList, BSPTriNode **rootPtr)
 		} /* End switch */
 
 	    } /* End if */
-#ifdef BSPC_DEBUG 
-	    else if( triType != COINCIDENT)
-	    {
-	        GLfloat res1, res2, res3;
-	        PointType vt[3];
-		char triType[4];
-
-		vt[0] = ClassifyPoint( testNode->V[0], &( currNode->plane));
-		vt[1] = ClassifyPoint( testNode->V[1], &( currNode->plane));
-		vt[2] = ClassifyPoint( testNode->V[2], &( currNode->plane));
-
-		triType[0] = vertCodes[vt[0]];
-		triType[1] = vertCodes[vt[1]];
-		triType[2] = vertCodes[vt[2]];
-		triType[3] = '\0';
-
-                res1 = currNode->plane.D +
-		    (currNode->plane.A * testNode->V[0][0]) + 
-		    (currNode->plane.B * testNode->V[0][1]) + 
-		    (currNode->plane.C * testNode->V[0][2]);
-
-                res2 = currNode->plane.D +
-		    (currNode->plane.A * testNode->V[1][0]) + 
-		    (currNode->plane.B * testNode->V[1][1]) + 
-		    (currNode->plane.C * testNode->V[1][2]);
-
-                res3 = currNode->plane.D +
-		    (currNode->plane.A * testNode->V[2][0]) + 
-		    (currNode->plane.B * testNode->V[2][1]) + 
-		    (currNode->plane.C * testNode->V[2][2]);
-
-	        /* We are testing the candidate triangle against itself */
-		fprintf( stderr,
-		    "\nERROR: Triangle MUST be coplanar with its own plane!\n"
-		);
-		fprintf( stderr,
-		    "(Triangle type: \"%s\", Plane Eqn Results: %f,%f,%f)\n", 
-		    triType, res1, res2, res3
-		);
-		fprintf( stderr,
-		    "(Plane: %.3fx + %.3fy + %.3fz + %.3f = 0)\n",
-		    currNode->plane.A, currNode->plane.B, 
-		    currNode->plane.C, currNode->plane.D
-		);
-
-		exit( EXIT_FAILURE);
-
-	    } /* End else-if */
-#endif
 
 	    testNode = testNode->next;
 
@@ -766,6 +1111,230 @@ BSPTriNode *SelectNextRoot( BSPTriNode *triList, BSPTriNode **rootPtr)
 } /* End function SelectNextRoot */
 
 
+/**
+ * Returns the node from the given list whose plane is the cheapest
+ * to partition the subspace of the list with, as estimated by the
+ * BSP_COST_SAH cost model.
+ */
+BSPTriNode *GetCheapestRoot( BSPCompiler *bspc, BSPTriNode *triList)
+{
+    GLfloat bbMin[3], bbMax[3];
+    GLdouble listArea, boxArea, minCost;
+    BSPTriNode *currNode;
+    BSPTriNode *retVal;
+    unsigned int i;
+
+    /* The bounds of the subspace and the area of its triangles */
+    for( i = 0U; i < 3U; i++)
+    {
+	bbMin[i] = FLT_MAX;
+	bbMax[i] = -FLT_MAX;
+
+    } /* End for */
+
+    listArea = 0.0;
+
+    currNode = triList;
+    while( currNode != NULL)
+    {
+	AddToBox( bbMin, bbMax, currNode);
+	listArea += currNode->area;
+
+	currNode = currNode->next;
+
+    } /* End while */
+
+    boxArea = GetBoxArea( bbMin, bbMax);
+
+    minCost = DBL_MAX;
+    retVal = NULL;
+
+    currNode = triList;
+    while( currNode != NULL)
+    {
+	/* The parts of an input triangle all have its plane, so only the
+	 * first of them need be tried.
+	 */
+	if( bspc->triedAt[currNode->srcIndex] != bspc->nodesCreated)
+	{
+	    GLdouble cost = 
+		GetSplitCost( bspc, triList, currNode, listArea, boxArea);
+
+	    if( cost < minCost)
+	    {
+		minCost = cost;
+		retVal = currNode;
+
+	    } /* End if */
+
+	    bspc->triedAt[currNode->srcIndex] = bspc->nodesCreated;
+
+	} /* End if */
+
+	currNode = currNode->next;
+
+    } /* End while */
+
+    return retVal;
+
+} /* End function GetCheapestRoot */
+
+
+/**
+ * Estimates what partitioning the subspace of the given list of
+ * triangles with the plane of the given triangle would cost the
+ * renderer, given the total area of the triangles and the surface
+ * area of their bounding box (see BSPCostModel).
+ */
+GLdouble GetSplitCost( 
+    BSPCompiler *bspc, BSPTriNode *triList, BSPTriNode *planeTri, 
+    GLdouble listArea, GLdouble boxArea
+)
+{
+    BSPCostModel *costModel = &( bspc->costModel);
+    GLfloat fMin[3], fMax[3], bMin[3], bMax[3];
+    unsigned int splits, inFront, inBack, onPlane;
+    GLdouble planeArea, fWeight, bWeight;
+    GLdouble retVal;
+    BSPTriNode *testNode;
+    unsigned int i;
+
+    for( i = 0U; i < 3U; i++)
+    {
+	fMin[i] = bMin[i] = FLT_MAX;
+	fMax[i] = bMax[i] = -FLT_MAX;
+
+    } /* End for */
+
+    splits = 0U;
+    inFront = inBack = onPlane = 0U;
+    planeArea = 0.0;
+
+    testNode = triList;
+    while( testNode != NULL)
+    {
+	switch( ClassifyTri( testNode, planeTri))
+	{
+	case SPANNING:
+	    /* Its parts are somewhere within its bounds on either side */
+	    splits++;
+	    AddToBox( fMin, fMax, testNode);
+	    AddToBox( bMin, bMax, testNode);
+	    break;
+
+	case IN_FRONT:
+	    inFront++;
+	    AddToBox( fMin, fMax, testNode);
+	    break;
+
+	case IN_BACK:
+	    inBack++;
+	    AddToBox( bMin, bMax, testNode);
+	    break;
+
+	case COINCIDENT:
+	    onPlane++;
+	    planeArea += testNode->area;
+	    break;
+
+	} /* End switch */
+
+	testNode = testNode->next;
+
+    } /* End while */
+
+    /* The chances of either side being seen */
+    if( boxArea > 0.0)
+    {
+	fWeight = GetBoxArea( fMin, fMax) / boxArea;
+	bWeight = GetBoxArea( bMin, bMax) / boxArea;
+
+    } /* End if */
+    else
+    {
+	fWeight = bWeight = 1.0;
+
+    } /* End else */
+
+    retVal = 
+	costModel->nodeCost + 
+	( COINCIDENT_DRAW_FRACTION * (GLdouble )onPlane) +
+	( fWeight * (GLdouble )( inFront + splits)) +
+	( bWeight * (GLdouble )( inBack + splits)) +
+	( costModel->splitCost * (GLdouble )splits);
+
+    if( ( fabs( planeTri->plane.A) >= AXIS_ALIGN_COS) || 
+	( fabs( planeTri->plane.B) >= AXIS_ALIGN_COS) || 
+	( fabs( planeTri->plane.C) >= AXIS_ALIGN_COS)
+    )
+    {
+	retVal *= ( 1.0 - costModel->axisBias);
+
+    } /* End if */
+
+    if( listArea > 0.0)
+    {
+	retVal *= ( 1.0 - ( costModel->facadeBias * planeArea / listArea));
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function GetSplitCost */
+
+
+/**
+ * Returns the surface area of the given bounding box (or zero, if it
+ * is empty).
+ */
+GLdouble GetBoxArea( GLfloat bbMin[], GLfloat bbMax[])
+{
+    GLdouble dX, dY, dZ;
+
+    if( ( bbMin[0] > bbMax[0]) || 
+	( bbMin[1] > bbMax[1]) || 
+	( bbMin[2] > bbMax[2])
+    )
+    {
+	return 0.0;
+
+    } /* End if */
+
+    dX = (GLdouble )( bbMax[0]) - (GLdouble )( bbMin[0]);
+    dY = (GLdouble )( bbMax[1]) - (GLdouble )( bbMin[1]);
+    dZ = (GLdouble )( bbMax[2]) - (GLdouble )( bbMin[2]);
+
+    return ( 2.0 * ( ( dX * dY) + ( dY * dZ) + ( dZ * dX)));
+
+} /* End function GetBoxArea */
+
+
+/**
+ * Grows the given bounding box to take in the given triangle.
+ */
+void AddToBox( GLfloat bbMin[], GLfloat bbMax[], BSPTriNode *aTri)
+{
+    unsigned int i;
+
+    for( i = 0U; i < 3U; i++)
+    {
+	if( aTri->bbMin[i] < bbMin[i])
+	{
+	    bbMin[i] = aTri->bbMin[i];
+
+	} /* End if */
+
+	if( aTri->bbMax[i] > bbMax[i])
+	{
+	    bbMax[i] = aTri->bbMax[i];
+
+	} /* End if */
+
+    } /* End for */
+
+} /* End function AddToBox */
+
+
 /**
  * Splits a spanning triangle with respect to the given
  * plane into front and back triangles. Assumes that the
@@ -781,13 +1350,16 @@ BSPTriNode *SelectNextRoot( BSPTriNode *triList, BSPTriNode **rootPtr)
  * The lists are then used to create the respective new triangles.
  * Note that only a maximum of two edges of a triangle can
  * be intersected by a non-coincident plane.
+ *
+ * The plane is that of the given triangle 'planeTri'.
  */
 void SplitTri( 
-    BSPTriNode *aTri, BSPPlane *partnPlane, 
+    BSPTriNode *aTri, BSPTriNode *planeTri, 
     BSPTriNode **fList, BSPTriNode **bList
 )
 {
     PointType vertTypes[3];
+    GLdouble vertDists[3];
     unsigned int numFrontVerts, numBackVerts;
 
     GLfloat frontVerts[4][3];
@@ -802,9 +1374,7 @@ void SplitTri(
 
     numFrontVerts = numBackVerts = 0U;
 
-    vertTypes[0] = ClassifyPoint( aTri->V[0], partnPlane);
-    vertTypes[1] = ClassifyPoint( aTri->V[1], partnPlane);
-    vertTypes[2] = ClassifyPoint( aTri->V[2], partnPlane);
+    ClassifyTriVerts( aTri, planeTri, vertTypes, vertDists);
 
     /* Construct "split code" for triangle - "BCF", "FFC", etc. */
     triSplitCode[0] = vertCodes[ vertTypes[0]];
@@ -876,16 +1446,24 @@ void SplitTri(
         )
 	{
 	    GLdouble tcDiff[2];
+	    GLdouble t;
+	    unsigned int k;
 
-	    /* Find the intersection point of the plane and this edge */
-
-	    /* This intersection point is trivially coincident with
-	     * the plane.
+	    /* Find the intersection point of the plane and this edge,
+	     * from the same distances of its end points from the plane
+	     * that put them on either side of it.
 	     */
-	    GLdouble t = IntersectPlaneLineSeg( 
-	        partnPlane, aTri->V[i], aTri->V[ next1], 
-		backVerts[ numBackVerts]
-            );
+	    t = vertDists[i] / ( vertDists[i] - vertDists[next1]);
+
+	    for( k = 0U; k < 3U; k++)
+	    {
+		backVerts[ numBackVerts][k] = (GLfloat )( 
+		    (GLdouble )( aTri->V[i][k]) + 
+		    t * ( (GLdouble )( aTri->V[next1][k]) - 
+			(GLdouble )( aTri->V[i][k]))
+		);
+
+	    } /* End for */
 
 	    /* Suitably interpolate texture coordinates */
 
@@ -973,7 +1551,7 @@ void SplitTri(
 
     } /* End for */
 
-    if( GetPlaneForTri( (*fList)->V, &( (*fList)->plane)) != 0)
+    if( SetTriPart( *fList, aTri) != 0)
     {
         /* We have created a degenerate triangle - discard it */
 	free( *fList);
@@ -1006,7 +1584,7 @@ void SplitTri(
 
 	} /* End for */
 
-	if( GetPlaneForTri( tmpTri->V, &( tmpTri->plane)) != 0)
+	if( SetTriPart( tmpTri, aTri) != 0)
 	{
 	    /* We have created a degenerate triangle - discard it */
 	    free( tmpTri);
@@ -1046,7 +1624,7 @@ void SplitTri(
 
     } /* End for */
 
-    if( GetPlaneForTri( (*bList)->V, &( (*bList)->plane)) != 0)
+    if( SetTriPart( *bList, aTri) != 0)
     {
         /* We have created a degenerate triangle - discard it */
 	free( *bList);
@@ -1079,7 +1657,7 @@ void SplitTri(
 
 	} /* End for */
 
-	if( GetPlaneForTri( tmpTri->V, &( tmpTri->plane)) != 0)
+	if( SetTriPart( tmpTri, aTri) != 0)
 	{
 	    /* We have created a degenerate triangle - discard it */
 	    free( tmpTri);
@@ -1191,26 +1769,192 @@ int GetPlaneForTri( GLfloat V[][3], BSPPlane *planePtr)
 
     return retVal;
 
-} /* End function GetPlaneForTri */
+} /* End function GetPlaneForTri */
+
+
+/**
+ * Sets the plane of the given input triangle (the 'srcIndex'-th) from
+ * its vertices, along with what is needed to classify points exactly
+ * with respect to it, given the largest size of such a point. Returns
+ * -1 if the triangle is degenerate.
+ */
+int SetTriPlane( BSPTriNode *aTri, Uint32 srcIndex, GLdouble maxPtSize)
+{
+    GLdouble AB[3], AC[3], Normal[3];
+    GLdouble abMag, acMag;
+    unsigned int i, j;
+
+    if( GetPlaneForTri( aTri->V, &( aTri->plane)) != 0)
+    {
+	return -1;
+
+    } /* End if */
+
+    for( i = 0U; i < 3U; i++)
+    {
+	for( j = 0U; j < 3U; j++)
+	{
+	    aTri->S[i][j] = aTri->V[i][j];
+
+	} /* End for */
+
+	AB[i] = (GLdouble )( aTri->V[1][i]) - (GLdouble )( aTri->V[0][i]);
+	AC[i] = (GLdouble )( aTri->V[2][i]) - (GLdouble )( aTri->V[0][i]);
+
+    } /* End for */
+
+    Normal[0] = AB[1]*AC[2] - AB[2]*AC[1];
+    Normal[1] = AB[2]*AC[0] - AB[0]*AC[2];
+    Normal[2] = AB[0]*AC[1] - AB[1]*AC[0];
+
+    aTri->normMag = sqrt( 
+	( Normal[0] * Normal[0]) + 
+	( Normal[1] * Normal[1]) + 
+	( Normal[2] * Normal[2])
+    );
+
+    abMag = sqrt( ( AB[0] * AB[0]) + ( AB[1] * AB[1]) + ( AB[2] * AB[2]));
+    acMag = sqrt( ( AC[0] * AC[0]) + ( AC[1] * AC[1]) + ( AC[2] * AC[2]));
+
+    /* A generous bound on the error of the plane equation, which grows
+     * with the sizes of the point and of the first vertex and as the
+     * triangle gets more needle-like.
+     */
+    aTri->distErr = 
+	8.0 * DBL_EPSILON * ( 1.0 + ( ( abMag * acMag) / aTri->normMag)) *
+	( maxPtSize + 
+	  fabs( aTri->S[0][0]) + fabs( aTri->S[0][1]) + fabs( aTri->S[0][2]));
+
+    aTri->srcIndex = srcIndex;
+
+    SetTriExtent( aTri);
+
+    return 0;
+
+} /* End function SetTriPlane */
+
+
+/**
+ * Sets the plane of the given part of the given triangle to that of
+ * the triangle. Returns -1 if the part is degenerate.
+ */
+int SetTriPart( BSPTriNode *aPart, BSPTriNode *aTri)
+{
+    BSPPlane partPlane;
+    unsigned int i, j;
+
+    if( GetPlaneForTri( aPart->V, &partPlane) != 0)
+    {
+	return -1;
+
+    } /* End if */
+
+    aPart->plane = aTri->plane;
+
+    for( i = 0U; i < 3U; i++)
+    {
+	for( j = 0U; j < 3U; j++)
+	{
+	    aPart->S[i][j] = aTri->S[i][j];
+
+	} /* End for */
+
+    } /* End for */
+
+    aPart->normMag = aTri->normMag;
+    aPart->distErr = aTri->distErr;
+    aPart->srcIndex = aTri->srcIndex;
+
+    SetTriExtent( aPart);
+
+    return 0;
+
+} /* End function SetTriPart */
+
+
+/**
+ * Sets the bounding box and the area of the given triangle.
+ */
+void SetTriExtent( BSPTriNode *aTri)
+{
+    GLdouble AB[3], AC[3], Normal[3];
+    unsigned int i;
+
+    for( i = 0U; i < 3U; i++)
+    {
+	aTri->bbMin[i] = aTri->bbMax[i] = aTri->V[0][i];
+
+	if( aTri->V[1][i] < aTri->bbMin[i])
+	{
+	    aTri->bbMin[i] = aTri->V[1][i];
+
+	} /* End if */
+	else if( aTri->V[1][i] > aTri->bbMax[i])
+	{
+	    aTri->bbMax[i] = aTri->V[1][i];
+
+	} /* End else-if */
+
+	if( aTri->V[2][i] < aTri->bbMin[i])
+	{
+	    aTri->bbMin[i] = aTri->V[2][i];
+
+	} /* End if */
+	else if( aTri->V[2][i] > aTri->bbMax[i])
+	{
+	    aTri->bbMax[i] = aTri->V[2][i];
+
+	} /* End else-if */
+
+	AB[i] = (GLdouble )( aTri->V[1][i]) - (GLdouble )( aTri->V[0][i]);
+	AC[i] = (GLdouble )( aTri->V[2][i]) - (GLdouble )( aTri->V[0][i]);
+
+    } /* End for */
+
+    Normal[0] = AB[1]*AC[2] - AB[2]*AC[1];
+    Normal[1] = AB[2]*AC[0] - AB[0]*AC[2];
+    Normal[2] = AB[0]*AC[1] - AB[1]*AC[0];
+
+    aTri->area = 0.5 * sqrt( 
+	( Normal[0] * Normal[0]) + 
+	( Normal[1] * Normal[1]) + 
+	( Normal[2] * Normal[2])
+    );
+
+} /* End function SetTriExtent */
 
 
 /**
- * Classifies a triangle with respect to the given partition
- * plane.
+ * Classifies a triangle with respect to the plane of the given
+ * triangle.
  */
-TriType ClassifyTri( BSPTriNode *aTri, BSPPlane *partPlane)
+TriType ClassifyTri( BSPTriNode *aTri, BSPTriNode *planeTri)
 {
+    PointType vertTypes[3];
+    GLdouble vertDists[3];
     unsigned int i;
     unsigned int vOnPlane, vAbove, vBelow;
     TriType retVal;
 
+    /* The parts of an input triangle are always in its plane, however
+     * far the rounding of the points where it was split has moved them
+     * off it. (This also ensures that each input triangle provides the
+     * partition plane of at most one node along any path down the
+     * tree, so that the tree can not go on growing forever.)
+     */
+    if( aTri->srcIndex == planeTri->srcIndex)
+    {
+	return COINCIDENT;
+
+    } /* End if */
+
+    ClassifyTriVerts( aTri, planeTri, vertTypes, vertDists);
+
     vOnPlane = vAbove = vBelow = 0U;
 
     for( i = 0U; i < 3U; i++)
     {
-        PointType vType = ClassifyPoint( aTri->V[i], partPlane);
-        
-	switch( vType)
+	switch( vertTypes[i])
 	{
 	case ON_PLANE:
 	    vOnPlane++;
@@ -1255,6 +1999,264 @@ TriType ClassifyTri( BSPTriNode *aTri, BSPPlane *partPlane)
 } /* End function ClassifyTri */
 
 
+/**
+ * Classifies the vertices of a triangle with respect to the plane of
+ * the given triangle, also giving their distances from the plane.
+ *
+ * A vertex is on the plane only if it is within PLANE_THICKNESS of it:
+ * an edge crossing the plane is always split, however close to one of
+ * its end points, so that no part of a triangle put in front of the
+ * plane is more than PLANE_THICKNESS below it (and likewise behind it).
+ */
+void ClassifyTriVerts( 
+    BSPTriNode *aTri, BSPTriNode *planeTri, 
+    PointType vertTypes[], GLdouble vertDists[]
+)
+{
+    unsigned int i;
+
+    for( i = 0U; i < 3U; i++)
+    {
+	vertDists[i] = GetVertDist( aTri->V[i], planeTri);
+
+	if( fabs( vertDists[i]) <= PLANE_THICKNESS)
+	{
+	    vertTypes[i] = ON_PLANE;
+
+	} /* End if */
+	else if( vertDists[i] > PLANE_THICKNESS)
+	{
+	    vertTypes[i] = ABOVE_PLANE;
+
+	} /* End else-if */
+	else
+	{
+	    vertTypes[i] = BELOW_PLANE;
+
+	} /* End else */
+
+    } /* End for */
+
+} /* End function ClassifyTriVerts */
+
+
+/**
+ * Returns the distance of the given point from the plane of the given
+ * triangle, along the normal of the plane.
+ *
+ * This is first worked out from the plane equation. Only if the error
+ * this could have is large enough to put the point on the other side
+ * of either surface of the (thick) plane, is it worked out from the
+ * exact orientation of the point with respect to the vertices that
+ * define the plane. (This is the "filtered" approach of Jonathan
+ * Shewchuk's "Adaptive Precision Floating-Point Arithmetic and Fast
+ * Robust Geometric Predicates".) A point is thus always put on the
+ * same side of a plane, whichever way it is tested.
+ */
+GLdouble GetVertDist( GLfloat aPt[], BSPTriNode *planeTri)
+{
+    BSPPlane *aPlane = &( planeTri->plane);
+    GLdouble vDist;
+
+    vDist = 
+	( aPlane->A * (GLdouble )( aPt[0])) +
+	( aPlane->B * (GLdouble )( aPt[1])) +
+	( aPlane->C * (GLdouble )( aPt[2])) +
+	aPlane->D;
+
+    if( fabs( fabs( vDist) - PLANE_THICKNESS) <= planeTri->distErr)
+    {
+	vDist = GetExactOrient( 
+	    planeTri->S[0], planeTri->S[1], planeTri->S[2], aPt
+	) / planeTri->normMag;
+
+    } /* End if */
+
+    return vDist;
+
+} /* End function GetVertDist */
+
+
+/**
+ * Returns the orientation of the point 'd' with respect to the
+ * triangle 'abc' - the dot product of the normal (b-a)x(c-a) of the
+ * triangle with (d-a), which is positive if 'd' is above the plane
+ * of the triangle. This is worked out exactly, as the sum of the
+ * exact products in 'orientTerms', and then rounded.
+ */
+GLdouble GetExactOrient( GLfloat a[], GLfloat b[], GLfloat c[], GLfloat d[])
+{
+    GLdouble orientSum[MAX_ORIENT_TERMS];
+    GLfloat *thePts[4];
+    GLdouble retVal;
+    int sumLen, i;
+
+    thePts[0] = a;
+    thePts[1] = b;
+    thePts[2] = c;
+    thePts[3] = d;
+
+    sumLen = 0;
+
+    for( i = 0; i < 24; i++)
+    {
+	GLdouble xyProd, prodHi, prodLo;
+
+	/* The product of two floats is exact as a double... */
+	xyProd = 
+	    (GLdouble )( thePts[orientTerms[i][0]][0]) * 
+	    (GLdouble )( thePts[orientTerms[i][1]][1]) * 
+	    (GLdouble )( orientTerms[i][3]);
+
+	/* ...while that of three needs two of them */
+	TwoProduct( 
+	    xyProd, (GLdouble )( thePts[orientTerms[i][2]][2]), 
+	    &prodHi, &prodLo
+	);
+
+	sumLen = GrowExpansion( sumLen, orientSum, prodLo);
+	sumLen = GrowExpansion( sumLen, orientSum, prodHi);
+
+    } /* End for */
+
+    /* The components are in increasing order of magnitude and do not
+     * overlap, so adding them up in that order rounds the sum well.
+     */
+    retVal = 0.0;
+    for( i = 0; i < sumLen; i++)
+    {
+	retVal += orientSum[i];
+
+    } /* End for */
+
+    return retVal;
+
+} /* End function GetExactOrient */
+
+
+/**
+ * Computes the product of 'a' and 'b' exactly as 'x' + 'y', where 'x'
+ * is the rounded product.
+ */
+void TwoProduct( GLdouble a, GLdouble b, GLdouble *x, GLdouble *y)
+{
+    GLdouble aHi, aLo, bHi, bLo, cBig, errSum;
+
+    *x = a * b;
+
+    cBig = EXACT_SPLITTER * a;
+    aHi = cBig - ( cBig - a);
+    aLo = a - aHi;
+
+    cBig = EXACT_SPLITTER * b;
+    bHi = cBig - ( cBig - b);
+    bLo = b - bHi;
+
+    errSum = *x - ( aHi * bHi);
+    errSum -= ( aLo * bHi);
+    errSum -= ( aHi * bLo);
+
+    *y = ( aLo * bLo) - errSum;
+
+} /* End function TwoProduct */
+
+
+/**
+ * Adds 'b' exactly to the sum of the 'eLen' components of 'e' (in
+ * increasing order of magnitude and not overlapping), leaving out
+ * components that become zero. Returns the number of components now
+ * in 'e'.
+ */
+int GrowExpansion( int eLen, GLdouble e[], GLdouble b)
+{
+    GLdouble sumHi, sumLo, bVirt, aVirt, newSum;
+    int i, hLen;
+
+    sumHi = b;
+    hLen = 0;
+
+    for( i = 0; i < eLen; i++)
+    {
+	/* Add 'e[i]' to 'sumHi' exactly as 'newSum' + 'sumLo' */
+	newSum = sumHi + e[i];
+	bVirt = newSum - sumHi;
+	aVirt = newSum - bVirt;
+	sumLo = ( sumHi - aVirt) + ( e[i] - bVirt);
+
+	sumHi = newSum;
+
+	if( sumLo != 0.0)
+	{
+	    e[hLen++] = sumLo;
+
+	} /* End if */
+
+    } /* End for */
+
+    if( ( sumHi != 0.0) || ( hLen == 0))
+    {
+	e[hLen++] = sumHi;
+
+    } /* End if */
+
+    return hLen;
+
+} /* End function GrowExpansion */
+
+
+/**
+ * Makes the FPU round every operation on doubles to a double, as
+ * GetExactOrient( ) needs, returning the old state of its control
+ * word (to be restored with RestoreRounding( )). The x87 FPU
+ * otherwise keeps 64 bits of mantissa in its registers, which breaks
+ * the splitting in TwoProduct( ) and the error terms in
+ * GrowExpansion( ).
+ */
+unsigned int SetDoubleRounding( void)
+{
+#if defined( __GNUC__) && defined( FPU_PRECISION_MASK)
+    unsigned short oldControl, newControl;
+
+    __asm__ __volatile__( "fnstcw %0" : "=m" ( oldControl));
+    newControl = (unsigned short )( 
+	( oldControl & ~FPU_PRECISION_MASK) | FPU_DOUBLE_PRECISION
+    );
+    __asm__ __volatile__( "fldcw %0" : : "m" ( newControl));
+
+    return oldControl;
+#elif defined( _MSC_VER) && defined( FPU_PRECISION_MASK)
+    unsigned int oldControl = _controlfp( 0U, 0U);
+
+    _controlfp( FPU_DOUBLE_PRECISION, FPU_PRECISION_MASK);
+
+    return oldControl;
+#else
+    /* Doubles are rounded to doubles already (e.g. with SSE2) */
+    return 0U;
+#endif
+
+} /* End function SetDoubleRounding */
+
+
+/**
+ * Restores the state of the control word of the FPU saved by 
+ * SetDoubleRounding( ).
+ */
+void RestoreRounding( unsigned int oldControl)
+{
+#if defined( __GNUC__) && defined( FPU_PRECISION_MASK)
+    unsigned short theControl = (unsigned short )( oldControl);
+
+    __asm__ __volatile__( "fldcw %0" : : "m" ( theControl));
+#elif defined( _MSC_VER) && defined( FPU_PRECISION_MASK)
+    _controlfp( oldControl, FPU_PRECISION_MASK);
+#else
+    (void )oldControl;
+#endif
+
+} /* End function RestoreRounding */
+
+
 /**
  * Finds out if a given point is below, on, or above,
  * the given plane.
@@ -1306,87 +2308,6 @@ PointType ClassifyPoint( GLfloat aPt[], BSPPlane *partPlane)
 } /* End function ClassifyPoint */
 
 
-/**
- * Intersects the given plane with the given line segment and stores
- * the result in the given array. Returns 't' such that the point
- * of intersection 'P' = V0 + t*(V1-V0)
- *
- * WARNING: The result is undefined if the line DOES NOT intersect
- * the plane.
- */
-GLdouble IntersectPlaneLineSeg( 
-    BSPPlane *plane, GLfloat v0[], GLfloat v1[], GLfloat res[]
-)
-{
-    GLdouble t = DBL_MAX;
-    GLdouble lSeg[3];
-    GLdouble epsilon;
-    GLdouble numer, denom;
-
-
-    /* Compute the differences between the coordinates of the vertices */
-    lSeg[0] = (GLdouble )( v1[0]) - (GLdouble )( v0[0]);
-    lSeg[1] = (GLdouble )( v1[1]) - (GLdouble )( v0[1]);
-    lSeg[2] = (GLdouble )( v1[2]) - (GLdouble )( v0[2]);
-
-
-    /* Use the parametric form for a line from V0 to V1:
-     *
-     *     V = V0 + t*(V1-V0) 
-     *
-     * Plug this into the plane equation "Ax + By + Cz + D = 0"
-     * to find the value of 't':
-     *
-     *         - ( A*x0 + B*y0 + C*z0 + D)
-     * t = --------------------------------------
-     *      ( A*(x1-x0) + B*(y1-y0) + C*(z1-z0))
-     *
-     * The line intersects the plane if the denominator is greater 
-     * than zero, otherwise is parallel to, or on, the plane.
-     */
-
-    denom = 
-        ( plane->A * lSeg[0]) + 
-	( plane->B * lSeg[1]) + 
-	( plane->C * lSeg[2]);
-
-
-    /* Scale floating-point epsilon for comparison */
-    epsilon = 
-        fabs( ( ( plane->A + (GLdouble )( v1[2])) * DBL_EPSILON) / 2.0);
-
-    if( fabs( denom) > epsilon)
-    {
-	numer = ( plane->A * (GLdouble )( v0[0])) + 
-	        ( plane->B * (GLdouble )( v0[1])) + 
-	        ( plane->C * (GLdouble )( v0[2])) + 
-		plane->D;
-
-        numer *= -1.0;
-
-	t = numer / denom;
-
-	res[0] = (GLfloat )( (GLdouble )( v0[0]) + t * lSeg[0]);
-	res[1] = (GLfloat )( (GLdouble )( v0[1]) + t * lSeg[1]);
-	res[2] = (GLfloat )( (GLdouble )( v0[2]) + t * lSeg[2]);
-
-    } /* End if */
-#ifdef BSPC_DEBUG
-    else
-    {
-        fprintf(
-	    stderr,
-	    "\nERROR: No intersection for parallel line/plane!\n"
-	);
-	exit( EXIT_FAILURE);
-    } /* End else */
-#endif
-
-    return t;
-
-} /* End function IntersectPlaneLineSeg */
-
-
 /**
  * Adds the given node to the given list (can be empty).
  * Returns the new list starting from the given node.
@@ -1485,6 +2406,7 @@ void SaveBSPTreeData( BSPTreeData *bspData, FILE *outFile)
     {
         unsigned int i;
 	Uint8 bspDataVer = BSP_DATA_VER;
+	BSPIOCounts ioCounts;
 
         /* Write out a small signature */
 	fwrite( 
@@ -1562,7 +2484,8 @@ void SaveBSPTreeData( BSPTreeData *bspData, FILE *outFile)
 
 
 	/* Finally, write out the actual BSP tree itself */
-	WriteBSPTree( bspData->bspTree, outFile);
+	ioCounts.numNodes = ioCounts.numTri = 0U;
+	WriteBSPTree( bspData->bspTree, bspData, outFile, &ioCounts);
 
 	/* Just to be sure */
 	fflush( outFile);
@@ -1570,7 +2493,7 @@ void SaveBSPTreeData( BSPTreeData *bspData, FILE *outFile)
 #ifdef BSPC_DEBUG
 	printf( 
 	    "BSPC: Saved %u triangles spread over %u nodes (%hu levels).\n",
-	    trianglesSaved, nodesSaved, bspData->maxDepth
+	    ioCounts.numTri, ioCounts.numNodes, bspData->maxDepth
 	);
 	fflush( stdout);
 #endif
@@ -1581,9 +2504,13 @@ void SaveBSPTreeData( BSPTreeData *bspData, FILE *outFile)
 
 
 /**
- * Writes out the given BSP tree to the given file in preorder.
+ * Writes out the given BSP tree, of the given BSP tree data, to the
+ * given file in preorder.
  */
-void WriteBSPTree( BSPTree *root, FILE *outFile)
+void WriteBSPTree( 
+    BSPTree *root, BSPTreeData *bspData, FILE *outFile, 
+    BSPIOCounts *ioCounts
+)
 {
     if( root != NULL)
     {
@@ -1609,14 +2536,26 @@ void WriteBSPTree( BSPTree *root, FILE *outFile)
 
 	} /* End for */
 
-        /* Need to write the partition plane only if there are no
-	 * triangles left in this node.
+#ifdef BSPC_DEBUG
+	/* Sanity check */
+	if( root->planeIndex >= bspData->numPlanes)
+	{
+	    fprintf( stderr, "\nERROR: WriteBSPTree( ) has gone bonkers!\n");
+	    fprintf( stderr, "(planeIndex = %hu)\n", root->planeIndex);
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+#endif
+
+	/* Need to write out the partition plane equation only if there
+	 * are no triangles in this node (it is computed from the first
+	 * triangle otherwise, when the tree is loaded).
 	 */
-        if( root->numTri == 0U)
+	if( root->numTri == 0U)
 	{
 	    fwrite( 
-	        &( root->partPlane), 
-		sizeof( root->partPlane), 1, 
+		( bspData->partPlanes + root->planeIndex), 
+		sizeof( BSPPlane), 1, 
 		outFile
 	    );
 
@@ -1660,21 +2599,19 @@ void WriteBSPTree( BSPTree *root, FILE *outFile)
 
 	if( root->back != NULL)
 	{
-	    WriteBSPTree( root->back, outFile);
+	    WriteBSPTree( root->back, bspData, outFile, ioCounts);
 
 	} /* End if */
 
 	if( root->front != NULL)
 	{
-	    WriteBSPTree( root->front, outFile);
+	    WriteBSPTree( root->front, bspData, outFile, ioCounts);
 
 	} /* End if */
 
 
-#ifdef BSPC_DEBUG
-        nodesSaved++;
-	trianglesSaved += root->numTri;
-#endif
+	ioCounts->numNodes++;
+	ioCounts->numTri += root->numTri;
 
     } /* End if */
 
@@ -1696,11 +2633,9 @@ BSPTreeData *LoadBSPTreeData( FILE *inFile)
 	Uint8 bspDataVer = 0U;
         char *savedSig = NULL;
 	unsigned int i;
+	BSPIOCounts ioCounts;
 
-#ifdef BSPC_DEBUG
-        nodesLoaded = 0U;
-        trianglesLoaded = 0U;
-#endif
+	ioCounts.numNodes = ioCounts.numTri = 0U;
 
 	sigSize = strlen( BSP_FILE_MAGIC) + 1U;
 	savedSig = (char *)( malloc( sizeof( char) * sigSize));
@@ -1850,17 +2785,35 @@ BSPTreeData *LoadBSPTreeData( FILE *inFile)
 	    fread( &( retVal->numTri), sizeof( retVal->numTri), 1, inFile);
 
 
-	    /* Finally, read in the actual BSP tree */
-	    retVal->bspTree = ReadBSPTree( inFile, retVal);
+	    /* Finally, read in the actual BSP tree, gathering the
+	     * partition planes of its nodes into a table as they are
+	     * found
+	     */
+	    {
+		PlaneTable planeTable;
+
+		InitPlaneTable( &planeTable);
+
+		retVal->bspTree = ReadBSPTree( 
+		    inFile, retVal, &planeTable, &ioCounts
+		);
+
+		retVal->numPlanes = planeTable.numPlanes;
+		retVal->partPlanes = planeTable.planes;
+		free( planeTable.nextPlanes);
+	    }
 
 
 #ifdef BSPC_DEBUG
             printf( 
 	        "BSPC: Loaded %u triangles spread over %u nodes "
 		"(%hu levels).\n",
-		trianglesLoaded, nodesLoaded, retVal->maxDepth
+		ioCounts.numTri, ioCounts.numNodes, retVal->maxDepth
+	    );
+	    printf( 
+		"\t(%u mapped vertex definitions, %u planes)\n", 
+		retVal->nVertices, retVal->numPlanes
 	    );
-	    printf( "\t(%u mapped vertex definitions)\n", retVal->nVertices);
 	    fflush( stdout);
 #endif
 
@@ -1892,14 +2845,19 @@ BSPTreeData *LoadBSPTreeData( FILE *inFile)
 
 
 /**
- * Reads a BSP Tree in preorder from the given file.
+ * Reads a BSP Tree in preorder from the given file, gathering the
+ * partition planes of its nodes into the given plane table.
  */
-BSPTree *ReadBSPTree( FILE *inFile, BSPTreeData *bspData)
+BSPTree *ReadBSPTree( 
+    FILE *inFile, BSPTreeData *bspData, PlaneTable *planeTable, 
+    BSPIOCounts *ioCounts
+)
 {
     BSPTree *retVal = NULL;
     unsigned int i;
     Uint8 cFlag;
     GLboolean hasFrontTree, hasBackTree;
+    BSPPlane nodePlane;
 
 
     retVal = (BSPTree *)( malloc( sizeof( BSPTree)));
@@ -1910,9 +2868,7 @@ BSPTree *ReadBSPTree( FILE *inFile, BSPTreeData *bspData)
 
     } /* End if */
 
-#ifdef BSPC_DEBUG
-    nodesLoaded++;
-#endif
+    ioCounts->numNodes++;
 
     fread( &( retVal->numTri), sizeof( retVal->numTri), 1, inFile);
     
@@ -1953,29 +2909,23 @@ BSPTree *ReadBSPTree( FILE *inFile, BSPTreeData *bspData)
     } /* End else */
 
 
-#ifdef BSPC_DEBUG
-    trianglesLoaded+= retVal->numTri;
-#endif
+    ioCounts->numTri += retVal->numTri;
 
-    /* Need to read in the partition plane equation only if
-     * there were no triangles in this node, otherwise recalculate
-     * it.
+    /* Need to read in the partition plane equation only if there were
+     * no triangles in this node, otherwise recalculate it. It is then
+     * merged with any other plane that is the same.
      */
     if( retVal->numTri == 0U)
     {
-	fread( 
-	    &( retVal->partPlane), 
-	    sizeof( retVal->partPlane), 1, 
-	    inFile
-	);
+	fread( &nodePlane, sizeof( nodePlane), 1, inFile);
 
     } /* End if */
     else
     {
-        GLfloat triVerts[3][3];
+	GLfloat triVerts[3][3];
 	unsigned int k;
 
-        for( k = 0U; k < 3U; k++)
+	for( k = 0U; k < 3U; k++)
 	{
 	    unsigned int vIndex = 3*( retVal->triDefs[0].vIndices[k]);
 
@@ -1985,15 +2935,19 @@ BSPTree *ReadBSPTree( FILE *inFile, BSPTreeData *bspData)
 
 	} /* End for */
 
-	if( GetPlaneForTri( triVerts, &( retVal->partPlane)) != 0)
+	if( GetPlaneForTri( triVerts, &nodePlane) != 0)
 	{
-	    fprintf( stderr, "ERROR: Degenerate triangle in saved file!\n");
+	    fprintf( 
+		stderr, "ERROR: Degenerate triangle in saved file!\n"
+	    );
 	    exit( EXIT_FAILURE);
 
-	} /* End else */
+	} /* End if */
 
     } /* End else */
 
+    retVal->planeIndex = GetPlaneIndex( planeTable, &nodePlane);
+
     fread( &cFlag, sizeof( Uint8), 1, inFile);
 
     hasFrontTree = hasBackTree = GL_FALSE;
@@ -2024,7 +2978,7 @@ BSPTree *ReadBSPTree( FILE *inFile, BSPTreeData *bspData)
 
     if( hasBackTree == GL_TRUE)
     {
-	retVal->back = ReadBSPTree( inFile, bspData);
+	retVal->back = ReadBSPTree( inFile, bspData, planeTable, ioCounts);
 
     } /* End if */
     else
@@ -2035,7 +2989,7 @@ BSPTree *ReadBSPTree( FILE *inFile, BSPTreeData *bspData)
 
     if( hasFrontTree == GL_TRUE)
     {
-	retVal->front = ReadBSPTree( inFile, bspData);
+	retVal->front = ReadBSPTree( inFile, bspData, planeTable, ioCounts);
 
     } /* End if */
     else
@@ -2049,10 +3003,11 @@ BSPTree *ReadBSPTree( FILE *inFile, BSPTreeData *bspData)
 } /* End function ReadBSPTree */
 
 
-BSPTree *ConvIntBSPTree( IntBSPTreeNode *intTree)
+BSPTree *ConvIntBSPTree( BSPCompiler *bspc, IntBSPTreeNode *intTree)
 {
     BSPTree *retVal = NULL;
     BSPTriNode *tmpTri;
+    BSPPlane nodePlane;
     unsigned int i;
 
     retVal = (BSPTree *)( malloc( sizeof( BSPTree)));
@@ -2063,10 +3018,10 @@ BSPTree *ConvIntBSPTree( IntBSPTreeNode *intTree)
 
     } /* End if */
 
-    retVal->partPlane.A = intTree->partition.A;
-    retVal->partPlane.B = intTree->partition.B;
-    retVal->partPlane.C = intTree->partition.C;
-    retVal->partPlane.D = intTree->partition.D;
+    nodePlane.A = intTree->partition.A;
+    nodePlane.B = intTree->partition.B;
+    nodePlane.C = intTree->partition.C;
+    nodePlane.D = intTree->partition.D;
 
     retVal->numTri = intTree->numTri;
 
@@ -2091,9 +3046,15 @@ BSPTree *ConvIntBSPTree( IntBSPTreeNode *intTree)
 	BSPTriNode *prevPtr;
 	BSPPlane tmpPlane;
 
-	vInd[0] = GetVertDefIndex( tmpTri->V[0], tmpTri->T[0], resV[0]);
-	vInd[1] = GetVertDefIndex( tmpTri->V[1], tmpTri->T[1], resV[1]);
-	vInd[2] = GetVertDefIndex( tmpTri->V[2], tmpTri->T[2], resV[2]);
+	vInd[0] = GetVertDefIndex( 
+	    bspc, tmpTri->V[0], tmpTri->T[0], resV[0]
+	);
+	vInd[1] = GetVertDefIndex( 
+	    bspc, tmpTri->V[1], tmpTri->T[1], resV[1]
+	);
+	vInd[2] = GetVertDefIndex( 
+	    bspc, tmpTri->V[2], tmpTri->T[2], resV[2]
+	);
 
         /* Have we created a degenerate triangle? */
         if( ( vInd[0] == vInd[1]) || 
@@ -2116,10 +3077,10 @@ BSPTree *ConvIntBSPTree( IntBSPTreeNode *intTree)
 	        /* Recalculate plane equation to adjust for loss
 		 * of precision during refactoring of vertices.
 		 */
-	        retVal->partPlane.A = tmpPlane.A;
-	        retVal->partPlane.B = tmpPlane.B;
-	        retVal->partPlane.C = tmpPlane.C;
-	        retVal->partPlane.D = tmpPlane.D;
+		nodePlane.A = tmpPlane.A;
+		nodePlane.B = tmpPlane.B;
+		nodePlane.C = tmpPlane.C;
+		nodePlane.D = tmpPlane.D;
 
 	    } /* End if */
 
@@ -2129,7 +3090,7 @@ BSPTree *ConvIntBSPTree( IntBSPTreeNode *intTree)
 
 	    retVal->triDefs[i].texIndex = tmpTri->tIndex;
 
-	    texCtrs[ tmpTri->tIndex]++;
+	    bspc->texCtrs[ tmpTri->tIndex]++;
 
 	    i++;
 
@@ -2141,6 +3102,9 @@ BSPTree *ConvIntBSPTree( IntBSPTreeNode *intTree)
 
     } /* End while */
 
+    /* Share the plane with any other node in the same plane */
+    retVal->planeIndex = GetPlaneIndex( &( bspc->planeTable), &nodePlane);
+
     /* Adjust memory usage if we have discarded some or all triangles */
     if( retVal->numTri == 0U)
     {
@@ -2170,20 +3134,22 @@ BSPTree *ConvIntBSPTree( IntBSPTreeNode *intTree)
     } /* End if */
 
 
-    trianglesCreated += retVal->numTri;
+    bspc->trianglesCreated += retVal->numTri;
 
 
 #ifdef BSPC_DEBUG 
-    nodesConverted++;
-    trianglesConverted += retVal->numTri;
-    printf( "\b\b\b\b%3u%%", ( nodesConverted * 100U) / nodesCreated);
+    bspc->nodesConverted++;
+    bspc->trianglesConverted += retVal->numTri;
+    printf( 
+	"\b\b\b\b%3u%%", ( bspc->nodesConverted * 100U) / bspc->nodesCreated
+    );
     fflush( stdout);
 #endif
 
 
     if( intTree->back != NULL)
     {
-        retVal->back = ConvIntBSPTree( intTree->back);
+	retVal->back = ConvIntBSPTree( bspc, intTree->back);
 
     } /* End if */
     else
@@ -2194,7 +3160,7 @@ BSPTree *ConvIntBSPTree( IntBSPTreeNode *intTree)
 
     if( intTree->front != NULL)
     {
-        retVal->front = ConvIntBSPTree( intTree->front);
+	retVal->front = ConvIntBSPTree( bspc, intTree->front);
 
     } /* End if */
     else
@@ -2213,7 +3179,127 @@ BSPTree *ConvIntBSPTree( IntBSPTreeNode *intTree)
 } /* End function ConvIntBSPTree */
 
 
-Uint16 GetVertDefIndex( GLfloat v[], GLfloat t[], GLfloat resV[])
+/**
+ * Initialises the given plane table to have no planes.
+ */
+void InitPlaneTable( PlaneTable *planeTable)
+{
+    int i;
+
+    planeTable->numPlanes = 0U;
+    planeTable->planes = NULL;
+    planeTable->nextPlanes = NULL;
+
+    for( i = 0; i < PLANE_NUM_BUCKETS; i++)
+    {
+	planeTable->bucketHeads[i] = NO_PLANE;
+
+    } /* End for */
+
+} /* End function InitPlaneTable */
+
+
+/**
+ * Returns the index of the given plane in the given plane table,
+ * adding it to the table if it has no plane that is the same. The
+ * table grows in blocks of PLANES_BLK_SIZE planes.
+ */
+Uint16 GetPlaneIndex( PlaneTable *planeTable, BSPPlane *aPlane)
+{
+    BSPPlane *thePlanes = planeTable->planes;
+    Uint16 i;
+    int b, lastBucket;
+
+    /* A plane that is the same can only be in the buckets covering
+     * the distances within PLANE_THICKNESS of this one's.
+     */
+    b = GetPlaneBucket( aPlane->D - PLANE_THICKNESS);
+    lastBucket = GetPlaneBucket( aPlane->D + PLANE_THICKNESS);
+
+    for( ; ; b = ( ( b + 1) % PLANE_NUM_BUCKETS))
+    {
+	for( i = planeTable->bucketHeads[b]; 
+	     i != NO_PLANE; 
+	     i = planeTable->nextPlanes[i]
+	)
+	{
+	    if( ( fabs( thePlanes[i].A - aPlane->A) <= 
+		    PLANE_NORMAL_TOLERANCE) &&
+		( fabs( thePlanes[i].B - aPlane->B) <= 
+		    PLANE_NORMAL_TOLERANCE) &&
+		( fabs( thePlanes[i].C - aPlane->C) <= 
+		    PLANE_NORMAL_TOLERANCE) &&
+		( fabs( thePlanes[i].D - aPlane->D) <= PLANE_THICKNESS)
+	    )
+	    {
+		return i;
+
+	    } /* End if */
+
+	} /* End for */
+
+	if( b == lastBucket)
+	{
+	    break;
+
+	} /* End if */
+
+    } /* End for */
+
+    i = planeTable->numPlanes;
+
+    if( ( i % PLANES_BLK_SIZE) == 0U)
+    {
+	thePlanes = (BSPPlane *)( realloc( 
+	    thePlanes, ( ( i + PLANES_BLK_SIZE) * sizeof( BSPPlane))
+	));
+	planeTable->nextPlanes = (Uint16 *)( realloc( 
+	    planeTable->nextPlanes, 
+	    ( ( i + PLANES_BLK_SIZE) * sizeof( Uint16))
+	));
+
+	if( ( thePlanes == NULL) || ( planeTable->nextPlanes == NULL))
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	planeTable->planes = thePlanes;
+
+    } /* End if */
+
+    thePlanes[i] = *aPlane;
+
+    b = GetPlaneBucket( aPlane->D);
+    planeTable->nextPlanes[i] = planeTable->bucketHeads[b];
+    planeTable->bucketHeads[b] = i;
+
+    planeTable->numPlanes++;
+
+    return i;
+
+} /* End function GetPlaneIndex */
+
+
+/**
+ * Returns the bucket of a plane table for planes at the given
+ * distance from the origin.
+ */
+int GetPlaneBucket( GLdouble planeDist)
+{
+    long cellNum = (long )floor( planeDist / PLANE_BUCKET_WIDTH);
+
+    /* (The remainder of a negative number may be negative) */
+    return (int )( ( ( cellNum % PLANE_NUM_BUCKETS) + PLANE_NUM_BUCKETS) %
+	PLANE_NUM_BUCKETS);
+
+} /* End function GetPlaneBucket */
+
+
+Uint16 GetVertDefIndex( 
+    BSPCompiler *bspc, GLfloat v[], GLfloat t[], GLfloat resV[]
+)
 {
     Uint16 retVal;
     VertDefs *currPtr, *prevPtr;
@@ -2222,7 +3308,7 @@ Uint16 GetVertDefIndex( GLfloat v[], GLfloat t[], GLfloat resV[])
     resV[1] = v[1];
     resV[2] = v[2];
 
-    prevPtr = currPtr = vertDefsPtr;
+    prevPtr = currPtr = bspc->vertDefsPtr;
     retVal = 0U;
     
     while( currPtr != NULL)
@@ -2271,19 +3357,19 @@ Uint16 GetVertDefIndex( GLfloat v[], GLfloat t[], GLfloat resV[])
 
 	    currPtr->nDefs++;
 
-	    numVertDefs++;
+	    bspc->numVertDefs++;
 
 
             /* Is this vertex at the edge of the known universe? */
 
-	    minX = ( v[0] < minX) ? ( v[0]) : minX;
-	    maxX = ( v[0] > maxX) ? ( v[0]) : maxX;
+	    bspc->minX = ( v[0] < bspc->minX) ? ( v[0]) : bspc->minX;
+	    bspc->maxX = ( v[0] > bspc->maxX) ? ( v[0]) : bspc->maxX;
 
-	    minY = ( v[1] < minY) ? ( v[1]) : minY;
-	    maxY = ( v[1] > maxY) ? ( v[1]) : maxY;
+	    bspc->minY = ( v[1] < bspc->minY) ? ( v[1]) : bspc->minY;
+	    bspc->maxY = ( v[1] > bspc->maxY) ? ( v[1]) : bspc->maxY;
 
-	    minZ = ( v[2] < minZ) ? ( v[2]) : minZ;
-	    maxZ = ( v[2] > maxZ) ? ( v[2]) : maxZ;
+	    bspc->minZ = ( v[2] < bspc->minZ) ? ( v[2]) : bspc->minZ;
+	    bspc->maxZ = ( v[2] > bspc->maxZ) ? ( v[2]) : bspc->maxZ;
 
 	    /* 'retVal' has the correct value */
 	    break;
@@ -2319,19 +3405,19 @@ Uint16 GetVertDefIndex( GLfloat v[], GLfloat t[], GLfloat resV[])
 	currPtr->T[0][1] = t[1];
 
 	currPtr->nDefs = 1U;
-	numVertDefs++;
+	bspc->numVertDefs++;
 
 
 	/* Is this vertex at the edge of the known universe? */
 
-	minX = ( v[0] < minX) ? ( v[0]) : minX;
-	maxX = ( v[0] > maxX) ? ( v[0]) : maxX;
+	bspc->minX = ( v[0] < bspc->minX) ? ( v[0]) : bspc->minX;
+	bspc->maxX = ( v[0] > bspc->maxX) ? ( v[0]) : bspc->maxX;
 
-	minY = ( v[1] < minY) ? ( v[1]) : minY;
-	maxY = ( v[1] > maxY) ? ( v[1]) : maxY;
+	bspc->minY = ( v[1] < bspc->minY) ? ( v[1]) : bspc->minY;
+	bspc->maxY = ( v[1] > bspc->maxY) ? ( v[1]) : bspc->maxY;
 
-	minZ = ( v[2] < minZ) ? ( v[2]) : minZ;
-	maxZ = ( v[2] > maxZ) ? ( v[2]) : maxZ;
+	bspc->minZ = ( v[2] < bspc->minZ) ? ( v[2]) : bspc->minZ;
+	bspc->maxZ = ( v[2] > bspc->maxZ) ? ( v[2]) : bspc->maxZ;
 
 
 	currPtr->next = NULL;
@@ -2343,7 +3429,7 @@ Uint16 GetVertDefIndex( GLfloat v[], GLfloat t[], GLfloat resV[])
 	} /* End if */
 	else
 	{
-	    vertDefsPtr = currPtr;
+	    bspc->vertDefsPtr = currPtr;
 
 	} /* End else */
 
@@ -2380,6 +3466,10 @@ void FreeBSPTreeData( BSPTreeData *bspData)
 	free( bspData->texCoords);
 	bspData->nVertices = 0U;
 
+	free( bspData->partPlanes);
+	bspData->partPlanes = NULL;
+	bspData->numPlanes = 0U;
+
         FreeBSPTree( bspData->bspTree);
 
         bspData->bspTree = NULL;
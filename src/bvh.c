@@ -0,0 +1,784 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * BVH.C: Bounding Volume Hierarchy construction and ray casting.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <float.h>
+
+#include "bvh.h"
+
+
+/* Data types used locally */
+
+/* Scratch data used while building a BVH */
+typedef struct _bvh_build
+{
+    BVHNode *nodes;
+    Uint32 numNodes;
+
+    const GLfloat *triBounds;   /* Per triangle, minimum and maximum */
+    const GLfloat *centroids;   /* Per triangle, centroid (x,y,z) */
+    Uint32 *triOrder;           /* Triangles in the order of the leaves */
+
+} BVHBuild;
+
+
+/* A node yet to be visited while casting a ray */
+typedef struct _bvh_stack_entry
+{
+    Uint32 nodeIndex;
+    GLfloat tEntry;
+
+} BVHStackEntry;
+
+
+/* Local function prototypes */
+
+static void BuildNode(
+    BVHBuild *bldData, Uint32 nodeIndex, Uint32 start, Uint32 count,
+    int depth
+);
+static GLfloat HalfArea( const GLfloat bbMin[3], const GLfloat bbMax[3]);
+static GLboolean IntersectBox(
+    const BVHNode *aNode, const GLfloat orig[3], const GLfloat invDir[3],
+    GLfloat tMin, GLfloat tMax, GLfloat *tEntry
+);
+
+
+BVHData *GenBVHData( GLData *glData)
+{
+    BVHData *retVal;
+    BVHTri *sortedTris;
+    GLfloat *triBounds, *centroids;
+    Uint32 *triOrder;
+    Uint32 numTri = glData->numTri;
+    Uint32 triNum, i, j;
+    int k, m;
+
+    retVal = (BVHData *)( malloc( sizeof( BVHData)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->glData = glData;
+    retVal->numTri = numTri;
+    retVal->numNodes = 0U;
+
+    retVal->tris = (BVHTri *)( malloc( ( numTri + 1U) * sizeof( BVHTri)));
+    sortedTris = (BVHTri *)( malloc( ( numTri + 1U) * sizeof( BVHTri)));
+
+    triBounds = (GLfloat *)( malloc( 6U * ( numTri + 1U) * sizeof( GLfloat)));
+    centroids = (GLfloat *)( malloc( 3U * ( numTri + 1U) * sizeof( GLfloat)));
+    triOrder = (Uint32 *)( malloc( ( numTri + 1U) * sizeof( Uint32)));
+
+    if( ( retVal->tris == NULL) || ( sortedTris == NULL) ||
+	( triBounds == NULL) || ( centroids == NULL) || ( triOrder == NULL)
+    )
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+
+    /* Gather the triangles of the model */
+    triNum = 0U;
+    for( i = 0U; ( i < glData->nMaps) && ( triNum < numTri); i++)
+    {
+	for( j = 0U; ( j < glData->mapTriNums[i]) && ( triNum < numTri); j++)
+	{
+	    BVHTri *aTri = retVal->tris + triNum;
+	    GLfloat *bbMin = triBounds + 6U*triNum;
+	    GLfloat *bbMax = bbMin + 3;
+	    const GLfloat *vCoords[3];
+
+	    for( k = 0; k < 3; k++)
+	    {
+		aTri->vIndices[k] = glData->triFaces[i][3U*j + k];
+		vCoords[k] = GLD_VERT_COORDS( glData, aTri->vIndices[k]);
+
+	    } /* End for */
+
+	    for( m = 0; m < 3; m++)
+	    {
+		aTri->v0[m] = vCoords[0][m];
+		aTri->e1[m] = vCoords[1][m] - vCoords[0][m];
+		aTri->e2[m] = vCoords[2][m] - vCoords[0][m];
+
+		bbMin[m] = bbMax[m] = vCoords[0][m];
+		for( k = 1; k < 3; k++)
+		{
+		    if( vCoords[k][m] < bbMin[m])
+		    {
+			bbMin[m] = vCoords[k][m];
+
+		    } /* End if */
+
+		    if( vCoords[k][m] > bbMax[m])
+		    {
+			bbMax[m] = vCoords[k][m];
+
+		    } /* End if */
+
+		} /* End for */
+
+		centroids[3U*triNum + m] =
+		    ( vCoords[0][m] + vCoords[1][m] + vCoords[2][m]) / 3.0F;
+
+	    } /* End for */
+
+	    aTri->triNum = triNum;
+	    aTri->texIndex = (Uint16 )i;
+
+	    triNum++;
+
+	} /* End for */
+
+    } /* End for */
+
+    retVal->numTri = numTri = triNum;
+
+
+    /* Build the hierarchy */
+    retVal->nodes = GenBVHNodes(
+	numTri, triBounds, centroids, triOrder, &( retVal->numNodes)
+    );
+
+
+    /* Store the triangles in the order of the leaves */
+    for( i = 0U; i < numTri; i++)
+    {
+	sortedTris[i] = retVal->tris[triOrder[i]];
+
+    } /* End for */
+
+    free( retVal->tris);
+    retVal->tris = sortedTris;
+
+    free( triBounds);
+    free( centroids);
+    free( triOrder);
+
+#ifdef VTAJ_DEBUG
+    printf(
+	"BVH: %u triangles, %u nodes\n", retVal->numTri, retVal->numNodes
+    );
+    fflush( stdout);
+#endif
+
+    return retVal;
+
+} /* End function GenBVHData */
+
+
+BVHNode *GenBVHNodes(
+    Uint32 numTri, GLfloat *triBounds, GLfloat *centroids,
+    Uint32 *triOrder, Uint32 *numNodes
+)
+{
+    BVHBuild bldData;
+    Uint32 i;
+
+    /* A split always leaves triangles on both sides, so there are
+     * at most ( 2*numTri - 1) nodes.
+     */
+    bldData.nodes = (BVHNode *)(
+	malloc( ( 2U * numTri + 1U) * sizeof( BVHNode))
+    );
+    if( bldData.nodes == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    bldData.triBounds = triBounds;
+    bldData.centroids = centroids;
+    bldData.triOrder = triOrder;
+
+    for( i = 0U; i < numTri; i++)
+    {
+	triOrder[i] = i;
+
+    } /* End for */
+
+    bldData.numNodes = 1U;
+    BuildNode( &bldData, 0U, 0U, numTri, 0);
+
+    *numNodes = bldData.numNodes;
+
+    return (BVHNode *)(
+	realloc( bldData.nodes, bldData.numNodes * sizeof( BVHNode))
+    );
+
+} /* End function GenBVHNodes */
+
+
+GLboolean IntersectBVH(
+    const BVHData *bvhData,
+    const GLfloat orig[3], const GLfloat dir[3],
+    GLfloat tMin, GLfloat tMax,
+    GLboolean cullBack,
+    BVHHitFilter hitFilter, void *filterData,
+    BVHHit *aHit
+)
+{
+    BVHStackEntry nodeStack[BVH_MAX_DEPTH];
+    int stackSize = 0;
+    GLfloat invDir[3];
+    GLfloat tBest = tMax;
+    GLfloat tEntry;
+    GLboolean found = GL_FALSE;
+    Uint32 nodeIndex = 0U;
+    int m;
+
+    if( bvhData->numTri == 0U)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    /* Division by zero gives infinities, which the box tests handle */
+    for( m = 0; m < 3; m++)
+    {
+	invDir[m] = 1.0F / dir[m];
+
+    } /* End for */
+
+    if( IntersectBox(
+	    bvhData->nodes, orig, invDir, tMin, tBest, &tEntry
+	) == GL_FALSE
+    )
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    for( ; ; )
+    {
+	const BVHNode *aNode = bvhData->nodes + nodeIndex;
+	GLboolean popNode = GL_TRUE;
+
+	if( aNode->numTri > 0U)
+	{
+	    /* A leaf - test its triangles (Moller-Trumbore) */
+	    const BVHTri *aTri = bvhData->tris + aNode->first;
+	    const BVHTri *endTri = aTri + aNode->numTri;
+
+	    for( ; aTri < endTri; aTri++)
+	    {
+		GLfloat pVec[3], sVec[3], qVec[3];
+		GLfloat det, invDet;
+		BVHHit candHit;
+
+		pVec[0] = dir[1]*aTri->e2[2] - dir[2]*aTri->e2[1];
+		pVec[1] = dir[2]*aTri->e2[0] - dir[0]*aTri->e2[2];
+		pVec[2] = dir[0]*aTri->e2[1] - dir[1]*aTri->e2[0];
+
+		det = aTri->e1[0]*pVec[0] + aTri->e1[1]*pVec[1] +
+		    aTri->e1[2]*pVec[2];
+
+		/* A positive determinant means the ray sees the
+		 * vertices in anticlockwise order.
+		 */
+		if( cullBack == GL_TRUE)
+		{
+		    if( det <= BVH_DET_EPSILON)
+		    {
+			continue;
+
+		    } /* End if */
+
+		} /* End if */
+		else if( ( det <= BVH_DET_EPSILON) &&
+		    ( det >= -BVH_DET_EPSILON)
+		)
+		{
+		    continue;
+
+		} /* End else-if */
+
+		invDet = 1.0F / det;
+
+		sVec[0] = orig[0] - aTri->v0[0];
+		sVec[1] = orig[1] - aTri->v0[1];
+		sVec[2] = orig[2] - aTri->v0[2];
+
+		candHit.u = ( sVec[0]*pVec[0] + sVec[1]*pVec[1] +
+		    sVec[2]*pVec[2]) * invDet;
+		if( ( candHit.u < 0.0F) || ( candHit.u > 1.0F))
+		{
+		    continue;
+
+		} /* End if */
+
+		qVec[0] = sVec[1]*aTri->e1[2] - sVec[2]*aTri->e1[1];
+		qVec[1] = sVec[2]*aTri->e1[0] - sVec[0]*aTri->e1[2];
+		qVec[2] = sVec[0]*aTri->e1[1] - sVec[1]*aTri->e1[0];
+
+		candHit.v = ( dir[0]*qVec[0] + dir[1]*qVec[1] +
+		    dir[2]*qVec[2]) * invDet;
+		if( ( candHit.v < 0.0F) || ( ( candHit.u + candHit.v) > 1.0F))
+		{
+		    continue;
+
+		} /* End if */
+
+		candHit.t = ( aTri->e2[0]*qVec[0] + aTri->e2[1]*qVec[1] +
+		    aTri->e2[2]*qVec[2]) * invDet;
+		if( ( candHit.t <= tMin) || ( candHit.t >= tBest))
+		{
+		    continue;
+
+		} /* End if */
+
+		candHit.aTri = aTri;
+
+		if( ( hitFilter == NULL) ||
+		    ( (*hitFilter)( &candHit, filterData) == GL_TRUE)
+		)
+		{
+		    *aHit = candHit;
+		    tBest = candHit.t;
+		    found = GL_TRUE;
+
+		} /* End if */
+
+	    } /* End for */
+
+	} /* End if */
+	else
+	{
+	    /* An inner node - visit the nearer child first */
+	    GLfloat tLeft, tRight;
+	    GLboolean hitLeft, hitRight;
+
+	    hitLeft = IntersectBox(
+		bvhData->nodes + aNode->first, orig, invDir, tMin, tBest,
+		&tLeft
+	    );
+	    hitRight = IntersectBox(
+		bvhData->nodes + aNode->first + 1U, orig, invDir, tMin, tBest,
+		&tRight
+	    );
+
+	    if( ( hitLeft == GL_TRUE) && ( hitRight == GL_TRUE))
+	    {
+		if( tLeft <= tRight)
+		{
+		    nodeStack[stackSize].nodeIndex = aNode->first + 1U;
+		    nodeStack[stackSize].tEntry = tRight;
+		    nodeIndex = aNode->first;
+
+		} /* End if */
+		else
+		{
+		    nodeStack[stackSize].nodeIndex = aNode->first;
+		    nodeStack[stackSize].tEntry = tLeft;
+		    nodeIndex = aNode->first + 1U;
+
+		} /* End else */
+
+		stackSize++;
+		popNode = GL_FALSE;
+
+	    } /* End if */
+	    else if( hitLeft == GL_TRUE)
+	    {
+		nodeIndex = aNode->first;
+		popNode = GL_FALSE;
+
+	    } /* End else-if */
+	    else if( hitRight == GL_TRUE)
+	    {
+		nodeIndex = aNode->first + 1U;
+		popNode = GL_FALSE;
+
+	    } /* End else-if */
+
+	} /* End else */
+
+	if( popNode == GL_TRUE)
+	{
+	    /* Skip nodes that start beyond the nearest hit so far */
+	    while( ( stackSize > 0) &&
+		( nodeStack[stackSize - 1].tEntry >= tBest)
+	    )
+	    {
+		stackSize--;
+
+	    } /* End while */
+
+	    if( stackSize == 0)
+	    {
+		break;
+
+	    } /* End if */
+
+	    nodeIndex = nodeStack[--stackSize].nodeIndex;
+
+	} /* End if */
+
+    } /* End for */
+
+    return found;
+
+} /* End function IntersectBVH */
+
+
+void FreeBVHData( BVHData *bvhData)
+{
+    if( bvhData != NULL)
+    {
+	free( bvhData->nodes);
+	free( bvhData->tris);
+	free( bvhData);
+
+    } /* End if */
+
+} /* End function FreeBVHData */
+
+
+/**
+ * Recursively builds the node of the hierarchy for the given range
+ * of the triangle order, splitting it where the SAH predicts the
+ * cheapest ray casts.
+ */
+void BuildNode(
+    BVHBuild *bldData, Uint32 nodeIndex, Uint32 start, Uint32 count,
+    int depth
+)
+{
+    BVHNode *aNode = bldData->nodes + nodeIndex;
+    Uint32 *triOrder = bldData->triOrder;
+    GLfloat cMin[3], cMax[3];
+    GLfloat bestCost = FLT_MAX;
+    int bestAxis = -1, bestBin = 0;
+    Uint32 i, mid;
+    int m;
+
+    /* Find the bounds of the triangles and of their centroids */
+    for( m = 0; m < 3; m++)
+    {
+	aNode->bbMin[m] = cMin[m] = +FLT_MAX;
+	aNode->bbMax[m] = cMax[m] = -FLT_MAX;
+
+    } /* End for */
+
+    for( i = start; i < ( start + count); i++)
+    {
+	const GLfloat *triMin = bldData->triBounds + 6U*triOrder[i];
+	const GLfloat *triMax = triMin + 3;
+	const GLfloat *aCentroid = bldData->centroids + 3U*triOrder[i];
+
+	for( m = 0; m < 3; m++)
+	{
+	    aNode->bbMin[m] = 
+		( triMin[m] < aNode->bbMin[m]) ? triMin[m] : aNode->bbMin[m];
+	    aNode->bbMax[m] = 
+		( triMax[m] > aNode->bbMax[m]) ? triMax[m] : aNode->bbMax[m];
+
+	    cMin[m] = ( aCentroid[m] < cMin[m]) ? aCentroid[m] : cMin[m];
+	    cMax[m] = ( aCentroid[m] > cMax[m]) ? aCentroid[m] : cMax[m];
+
+	} /* End for */
+
+    } /* End for */
+
+    /* Assume a leaf to begin with */
+    aNode->first = start;
+    aNode->numTri = count;
+
+    if( ( count <= 1U) || ( depth >= ( BVH_MAX_DEPTH - 1)))
+    {
+	return;
+
+    } /* End if */
+
+
+    /* Evaluate the SAH at the bin boundaries along each axis */
+    for( m = 0; m < 3; m++)
+    {
+	Uint32 binCounts[BVH_NUM_BINS];
+	GLfloat binMin[BVH_NUM_BINS][3], binMax[BVH_NUM_BINS][3];
+	GLfloat leftCosts[BVH_NUM_BINS];
+	GLfloat accMin[3], accMax[3];
+	Uint32 accCount;
+	GLfloat binScale;
+	int b, n;
+
+	if( cMax[m] <= cMin[m])
+	{
+	    /* All centroids coincide along this axis */
+	    continue;
+
+	} /* End if */
+
+	binScale = (GLfloat )BVH_NUM_BINS / ( cMax[m] - cMin[m]);
+
+	for( b = 0; b < BVH_NUM_BINS; b++)
+	{
+	    binCounts[b] = 0U;
+	    for( n = 0; n < 3; n++)
+	    {
+		binMin[b][n] = +FLT_MAX;
+		binMax[b][n] = -FLT_MAX;
+
+	    } /* End for */
+
+	} /* End for */
+
+	for( i = start; i < ( start + count); i++)
+	{
+	    const GLfloat *triMin = bldData->triBounds + 6U*triOrder[i];
+	    const GLfloat *triMax = triMin + 3;
+
+	    b = (int )(
+		( bldData->centroids[3U*triOrder[i] + m] - cMin[m]) * binScale
+	    );
+	    if( b >= BVH_NUM_BINS)
+	    {
+		b = BVH_NUM_BINS - 1;
+
+	    } /* End if */
+
+	    binCounts[b]++;
+	    for( n = 0; n < 3; n++)
+	    {
+		binMin[b][n] = 
+		    ( triMin[n] < binMin[b][n]) ? triMin[n] : binMin[b][n];
+		binMax[b][n] = 
+		    ( triMax[n] > binMax[b][n]) ? triMax[n] : binMax[b][n];
+
+	    } /* End for */
+
+	} /* End for */
+
+	/* Sweep from the left, then from the right */
+	accCount = 0U;
+	for( n = 0; n < 3; n++)
+	{
+	    accMin[n] = +FLT_MAX;
+	    accMax[n] = -FLT_MAX;
+
+	} /* End for */
+
+	for( b = 0; b < ( BVH_NUM_BINS - 1); b++)
+	{
+	    accCount += binCounts[b];
+	    for( n = 0; n < 3; n++)
+	    {
+		accMin[n] = 
+		    ( binMin[b][n] < accMin[n]) ? binMin[b][n] : accMin[n];
+		accMax[n] = 
+		    ( binMax[b][n] > accMax[n]) ? binMax[b][n] : accMax[n];
+
+	    } /* End for */
+
+	    leftCosts[b] = ( accCount > 0U) ?
+		( HalfArea( accMin, accMax) * accCount) : 0.0F;
+
+	} /* End for */
+
+	accCount = 0U;
+	for( n = 0; n < 3; n++)
+	{
+	    accMin[n] = +FLT_MAX;
+	    accMax[n] = -FLT_MAX;
+
+	} /* End for */
+
+	for( b = ( BVH_NUM_BINS - 1); b > 0; b--)
+	{
+	    GLfloat splitCost;
+
+	    accCount += binCounts[b];
+	    for( n = 0; n < 3; n++)
+	    {
+		accMin[n] = 
+		    ( binMin[b][n] < accMin[n]) ? binMin[b][n] : accMin[n];
+		accMax[n] = 
+		    ( binMax[b][n] > accMax[n]) ? binMax[b][n] : accMax[n];
+
+	    } /* End for */
+
+	    /* Splitting after bin 'b - 1' must leave triangles on
+	     * both sides.
+	     */
+	    if( ( accCount == 0U) || ( accCount == count))
+	    {
+		continue;
+
+	    } /* End if */
+
+	    splitCost = leftCosts[b - 1] + HalfArea( accMin, accMax) * accCount;
+	    if( splitCost < bestCost)
+	    {
+		bestCost = splitCost;
+		bestAxis = m;
+		bestBin = b - 1;
+
+	    } /* End if */
+
+	} /* End for */
+
+    } /* End for */
+
+
+    if( bestAxis >= 0)
+    {
+	GLfloat nodeArea = HalfArea( aNode->bbMin, aNode->bbMax);
+	GLfloat binScale =
+	    (GLfloat )BVH_NUM_BINS / ( cMax[bestAxis] - cMin[bestAxis]);
+	Uint32 j;
+
+	/* Small nodes stay leaves unless splitting is cheaper */
+	if( ( count <= BVH_MAX_LEAF_TRI) && ( nodeArea > 0.0F) &&
+	    ( ( BVH_TRAVERSAL_COST + ( bestCost / nodeArea)) >= (GLfloat )count)
+	)
+	{
+	    return;
+
+	} /* End if */
+
+	/* Partition the triangles about the chosen split */
+	i = start;
+	j = start + count;
+	while( i < j)
+	{
+	    int b = (int )(
+		( bldData->centroids[3U*triOrder[i] + bestAxis] -
+		    cMin[bestAxis]) * binScale
+	    );
+
+	    if( b > bestBin)
+	    {
+		Uint32 tmpTri = triOrder[i];
+
+		triOrder[i] = triOrder[--j];
+		triOrder[j] = tmpTri;
+
+	    } /* End if */
+	    else
+	    {
+		i++;
+
+	    } /* End else */
+
+	} /* End while */
+
+	mid = i;
+
+    } /* End if */
+    else if( count <= BVH_MAX_LEAF_TRI)
+    {
+	return;
+
+    } /* End else-if */
+    else
+    {
+	/* Can not tell the triangles apart - just halve them */
+	mid = start + count / 2U;
+
+    } /* End else */
+
+    if( ( mid == start) || ( mid == ( start + count)))
+    {
+	mid = start + count / 2U;
+
+    } /* End if */
+
+
+    /* Make this an inner node and build its children */
+    aNode->first = bldData->numNodes;
+    aNode->numTri = 0U;
+    bldData->numNodes += 2U;
+
+    BuildNode( bldData, aNode->first, start, ( mid - start), depth + 1);
+    BuildNode(
+	bldData, aNode->first + 1U, mid, ( start + count - mid), depth + 1
+    );
+
+} /* End function BuildNode */
+
+
+/**
+ * Returns half the surface area of the given box.
+ */
+GLfloat HalfArea( const GLfloat bbMin[3], const GLfloat bbMax[3])
+{
+    GLfloat dX = bbMax[0] - bbMin[0];
+    GLfloat dY = bbMax[1] - bbMin[1];
+    GLfloat dZ = bbMax[2] - bbMin[2];
+
+    return ( dX*dY + dY*dZ + dZ*dX);
+
+} /* End function HalfArea */
+
+
+/**
+ * Clips the ray parameter range [tMin, tMax] to the box of the given
+ * node. Returns GL_TRUE and the parameter at which the ray enters the
+ * box if the range is not empty, GL_FALSE otherwise.
+ */
+GLboolean IntersectBox(
+    const BVHNode *aNode, const GLfloat orig[3], const GLfloat invDir[3],
+    GLfloat tMin, GLfloat tMax, GLfloat *tEntry
+)
+{
+    int m;
+
+    for( m = 0; m < 3; m++)
+    {
+	GLfloat t0 = ( aNode->bbMin[m] - orig[m]) * invDir[m];
+	GLfloat t1 = ( aNode->bbMax[m] - orig[m]) * invDir[m];
+
+	if( t0 > t1)
+	{
+	    GLfloat tmpT = t0;
+
+	    t0 = t1;
+	    t1 = tmpT;
+
+	} /* End if */
+
+	/* (Comparisons with NaNs, from rays in the plane of a face
+	 * of the box, are false and leave the range unchanged.)
+	 */
+	if( t0 > tMin)
+	{
+	    tMin = t0;
+
+	} /* End if */
+
+	if( t1 < tMax)
+	{
+	    tMax = t1;
+
+	} /* End if */
+
+	if( tMin > tMax)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+    } /* End for */
+
+    *tEntry = tMin;
+
+    return GL_TRUE;
+
+} /* End function IntersectBox */
+
+
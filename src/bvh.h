@@ -0,0 +1,174 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * BVH.H: Declarations for the Bounding Volume Hierarchy (BVH) functions.
+ */
+
+/**
+ * A BVH over the triangles of a GLData model lets us cast rays against
+ * the model in roughly logarithmic, rather than linear, time. Each node
+ * of the hierarchy has an axis-aligned bounding box enclosing all the
+ * triangles below it; leaves hold a handful of triangles.
+ *
+ * The hierarchy is built top-down, splitting the triangles of a node
+ * where the Surface Area Heuristic (SAH) predicts the cheapest ray
+ * casts. The heuristic is evaluated for BVH_NUM_BINS candidate splits
+ * along each axis, rather than for every triangle, which keeps the
+ * build fast.
+ *
+ * Triangles are identified by their position in the model - the
+ * triangles of the maps are numbered consecutively, in the order of
+ * the maps, so the j-th triangle of map i has the number
+ * ( mapTriNums[0] + ... + mapTriNums[i - 1] + j).
+ */
+
+#ifndef _BVH_H
+#define _BVH_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+#include "gld.h"
+
+
+/* Number of candidate split positions evaluated along each axis */
+#define BVH_NUM_BINS 16
+
+/* Nodes with at most this many triangles can become leaves */
+#define BVH_MAX_LEAF_TRI 4
+
+/* Relative cost of visiting a node, compared to intersecting a
+ * triangle, used by the SAH.
+ */
+#define BVH_TRAVERSAL_COST 1.0F
+
+/* Maximum depth of the hierarchy (and of the traversal stack) */
+#define BVH_MAX_DEPTH 64
+
+/* Rays nearly parallel to a triangle's plane miss it */
+#define BVH_DET_EPSILON 1.0e-9F
+
+
+/* Data type definitions */
+
+/* A node of the hierarchy */
+typedef struct _bvh_node
+{
+    GLfloat bbMin[3];
+    GLfloat bbMax[3];
+
+    /* For a leaf, the first of its 'numTri' triangles. For an inner
+     * node ('numTri' is zero), its first child - the second child
+     * immediately follows the first.
+     */
+    Uint32 first;
+    Uint32 numTri;
+
+} BVHNode;
+
+
+/* A triangle of the model, in the form best suited for ray casts */
+typedef struct _bvh_tri
+{
+    GLfloat v0[3];          /* First vertex */
+    GLfloat e1[3];          /* Second vertex minus the first */
+    GLfloat e2[3];          /* Third vertex minus the first */
+
+    Uint32 triNum;          /* Number of the triangle in the model */
+    Uint16 texIndex;        /* Texture map of the triangle */
+    Uint16 vIndices[3];     /* Vertex definitions of the triangle */
+
+} BVHTri;
+
+
+/* Run-time representation of a BVH */
+typedef struct _bvhdata
+{
+    GLData *glData;         /* The model (not owned by the BVH) */
+
+    Uint32 numNodes;
+    BVHNode *nodes;         /* The root is the first node */
+
+    Uint32 numTri;
+    BVHTri *tris;           /* Ordered so that leaves are contiguous */
+
+} BVHData;
+
+
+/* The nearest intersection of a ray with a model */
+typedef struct _bvh_hit
+{
+    GLfloat t;              /* Ray parameter of the hit point */
+    GLfloat u, v;           /* Barycentric weights of vertices 2 and 3 */
+    const BVHTri *aTri;     /* The triangle hit */
+
+} BVHHit;
+
+
+/* A function that can reject a candidate hit (for example, a
+ * transparent texel), letting the ray continue beyond it. Returns
+ * GL_TRUE to accept the hit. Accepted hits are always nearer than
+ * the ones accepted before them, so the last hit accepted is the
+ * one finally returned.
+ */
+typedef GLboolean (*BVHHitFilter)( const BVHHit *aHit, void *filterData);
+
+
+/* Function Prototypes */
+
+/**
+ * Builds a BVH over the triangles of the given model. The model must
+ * not be changed or freed while the BVH is in use.
+ */
+extern BVHData *GenBVHData( GLData *glData);
+
+
+/**
+ * Builds just the nodes of a BVH over 'numTri' triangles, given the
+ * bounds of each (its minimum, then its maximum, x, y and z) and its
+ * centroid, for other kinds of triangles than BVHTri. The triangles of
+ * the leaves are numbered by the order of 'numTri' triangle numbers
+ * filled into 'triOrder', rather than by their own numbers.
+ *
+ * Returns the nodes, and their number in 'numNodes'.
+ */
+extern BVHNode *GenBVHNodes(
+    Uint32 numTri, GLfloat *triBounds, GLfloat *centroids,
+    Uint32 *triOrder, Uint32 *numNodes
+);
+
+
+/**
+ * Casts the ray ( orig + t*dir), for tMin < t < tMax, against the model
+ * of the given BVH. Triangles facing away from the ray are ignored if
+ * 'cullBack' is GL_TRUE (triangles are front facing when their vertices
+ * are in anticlockwise order). If 'hitFilter' is not NULL, it is
+ * consulted for every candidate hit.
+ *
+ * Returns GL_TRUE and fills in 'aHit' with the nearest accepted hit,
+ * or returns GL_FALSE if the ray hits nothing.
+ */
+extern GLboolean IntersectBVH(
+    const BVHData *bvhData,
+    const GLfloat orig[3], const GLfloat dir[3],
+    GLfloat tMin, GLfloat tMax,
+    GLboolean cullBack,
+    BVHHitFilter hitFilter, void *filterData,
+    BVHHit *aHit
+);
+
+
+/**
+ * Frees a BVH (but not its model).
+ */
+extern void FreeBVHData( BVHData *bvhData);
+
+#endif    /* _BVH_H */
+
+
@@ -0,0 +1,646 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * CAPTURE.C: Asynchronous capture of rendered frames to disc.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "SDL_thread.h"
+
+#include "glutil.h"
+#include "capture.h"
+
+
+/* Data types used locally */
+
+/* A frame waiting for the writer thread */
+typedef struct _cap_slot
+{
+    Uint32 frameNum;
+    Uint8 *pixels;
+
+} CapSlot;
+
+
+/* Global data */
+
+static GLboolean capturing = GL_FALSE;
+static GLboolean usePBOs = GL_FALSE;
+
+static int capWidth, capHeight;
+static GLenum capFormat;
+static unsigned int redOffset, blueOffset;
+
+static char *capOutName = NULL;
+static FILE *y4mFile = NULL;
+
+/* Frame numbers continue across capture sessions, so that a later
+ * session does not overwrite the images saved by an earlier one.
+ */
+static Uint32 nextFrameNum = 0U;
+
+/* The ring of pixel buffer objects and the frames read into them */
+static GLuint capPBOs[CAPTURE_PBO_LAG];
+static Uint32 pboFrameNums[CAPTURE_PBO_LAG];
+static Uint32 readsIssued, readsCollected;
+
+/* Queue of frames waiting for the writer thread. Only the thread
+ * owning a slot touches its pixels - the writer owns the 'qCount'
+ * slots from 'qHead' onwards, the renderer owns the rest.
+ */
+static CapSlot capQueue[CAPTURE_QUEUE_LEN];
+static unsigned int qHead, qCount;
+static SDL_mutex *qLock = NULL;
+static SDL_cond *qChanged = NULL;
+static SDL_Thread *writerThread = NULL;
+static GLboolean stopWriter;
+
+static Uint32 framesDropped, framesSaved;
+
+/* Scratch buffers used only by the writer thread */
+static Uint8 *rowBuf = NULL;
+static Uint8 *yuvBuf = NULL;
+
+
+/* Local function prototypes */
+
+static CapSlot *GetFreeSlot( GLboolean mayWait);
+static void QueueSlot( void);
+static void CollectFrame( unsigned int pboIndex, GLboolean mayWait);
+static int WriterMain( void *unused);
+static void SavePPMFrame( CapSlot *aSlot);
+static void SaveY4MFrame( CapSlot *aSlot);
+
+
+int StartFrameCapture( int width, int height, const char *outName)
+{
+    size_t nameLen;
+    unsigned int i;
+
+    if( ( capturing == GL_TRUE) || ( width <= 0) || ( height <= 0) ||
+	( outName == NULL)
+    )
+    {
+	return -1;
+
+    } /* End if */
+
+    capWidth = width;
+    capHeight = height;
+
+    capOutName = (char *)( malloc( ( strlen( outName) + 1) * sizeof( char)));
+    if( capOutName == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    strcpy( capOutName, outName);
+
+    nameLen = strlen( capOutName);
+    if( ( nameLen > 4U) && ( strcmp( capOutName + nameLen - 4U, ".y4m") == 0))
+    {
+	/* Chroma is subsampled 2x2, so the frame size must be even */
+	if( ( ( width % 2) != 0) || ( ( height % 2) != 0))
+	{
+	    fprintf( stderr,
+		"\nERROR: Y4M capture needs an even frame size (%dx%d)!\n",
+		width, height
+	    );
+	    free( capOutName);
+	    capOutName = NULL;
+	    return -1;
+
+	} /* End if */
+
+	y4mFile = fopen( capOutName, "wb");
+	if( y4mFile == NULL)
+	{
+	    fprintf( stderr,
+		"\nERROR: Unable to open file \"%s\" for writing!\n",
+		capOutName
+	    );
+	    free( capOutName);
+	    capOutName = NULL;
+	    return -1;
+
+	} /* End if */
+
+	fprintf( y4mFile,
+	    "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n",
+	    width, height, CAPTURE_Y4M_FPS
+	);
+
+    } /* End if */
+
+
+    /* Read back in BGRA order if we can - it is what most hardware
+     * uses internally and avoids a swizzle in the driver.
+     */
+    if( hasBGRAPixels == GL_TRUE)
+    {
+	capFormat = GL_BGRA;
+	redOffset = 2U;
+	blueOffset = 0U;
+
+    } /* End if */
+    else
+    {
+	capFormat = GL_RGBA;
+	redOffset = 0U;
+	blueOffset = 2U;
+
+    } /* End else */
+
+    glPixelStorei( GL_PACK_ALIGNMENT, 4);
+    CHECK_GL_ERROR;
+
+
+    /* Set up the ring of pixel buffer objects */
+    usePBOs = hasPixelBufferObjects;
+    readsIssued = readsCollected = 0U;
+
+    if( usePBOs == GL_TRUE)
+    {
+	pglGenBuffers( CAPTURE_PBO_LAG, capPBOs);
+
+	for( i = 0U; i < CAPTURE_PBO_LAG; i++)
+	{
+	    pglBindBuffer( GL_PIXEL_PACK_BUFFER, capPBOs[i]);
+	    pglBufferData(
+		GL_PIXEL_PACK_BUFFER, (ptrdiff_t )( 4 * width * height),
+		NULL, GL_STREAM_READ
+	    );
+
+	} /* End for */
+
+	pglBindBuffer( GL_PIXEL_PACK_BUFFER, 0U);
+	CHECK_GL_ERROR;
+
+    } /* End if */
+
+
+    /* Set up the queue of frames and the writer thread */
+    for( i = 0U; i < CAPTURE_QUEUE_LEN; i++)
+    {
+	capQueue[i].pixels = (Uint8 *)( malloc( 4 * width * height));
+	if( capQueue[i].pixels == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+    } /* End for */
+
+    rowBuf = (Uint8 *)( malloc( 3 * width));
+    yuvBuf = (Uint8 *)( malloc( ( 3 * width * height) / 2));
+    if( ( rowBuf == NULL) || ( yuvBuf == NULL))
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    qHead = qCount = 0U;
+    stopWriter = GL_FALSE;
+    framesDropped = framesSaved = 0U;
+
+    qLock = SDL_CreateMutex( );
+    qChanged = SDL_CreateCond( );
+    if( ( qLock == NULL) || ( qChanged == NULL))
+    {
+	fprintf( stderr, "\nERROR: Could not create capture queue! (%s)\n",
+	    SDL_GetError( )
+	);
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    writerThread = SDL_CreateThread( WriterMain, NULL);
+    if( writerThread == NULL)
+    {
+	fprintf( stderr, "\nERROR: Could not create writer thread! (%s)\n",
+	    SDL_GetError( )
+	);
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    capturing = GL_TRUE;
+
+    printf(
+	"CAPTURE: Recording %dx%d frames to \"%s\"%s\n",
+	width, height, capOutName,
+	( ( usePBOs == GL_TRUE) ? "" : " (synchronous read back)")
+    );
+    fflush( stdout);
+
+    return 0;
+
+} /* End function StartFrameCapture */
+
+
+void CaptureFrame( void)
+{
+    if( capturing == GL_FALSE)
+    {
+	return;
+
+    } /* End if */
+
+    if( usePBOs == GL_TRUE)
+    {
+	unsigned int pboIndex = ( readsIssued % CAPTURE_PBO_LAG);
+
+	/* If the ring is full, the oldest read occupies the buffer we
+	 * need - by now it must have long completed, so mapping the
+	 * buffer will not stall.
+	 */
+	if( ( readsIssued - readsCollected) == CAPTURE_PBO_LAG)
+	{
+	    CollectFrame( pboIndex, GL_FALSE);
+
+	} /* End if */
+
+	/* Start an asynchronous read into the buffer */
+	pglBindBuffer( GL_PIXEL_PACK_BUFFER, capPBOs[pboIndex]);
+	glReadPixels(
+	    0, 0, capWidth, capHeight, capFormat, GL_UNSIGNED_BYTE,
+	    (GLvoid *)( 0)
+	);
+	pglBindBuffer( GL_PIXEL_PACK_BUFFER, 0U);
+
+	pboFrameNums[pboIndex] = nextFrameNum++;
+	readsIssued++;
+
+    } /* End if */
+    else
+    {
+	CapSlot *aSlot = GetFreeSlot( GL_FALSE);
+
+	if( aSlot != NULL)
+	{
+	    glReadPixels(
+		0, 0, capWidth, capHeight, capFormat, GL_UNSIGNED_BYTE,
+		aSlot->pixels
+	    );
+	    aSlot->frameNum = nextFrameNum++;
+	    QueueSlot( );
+
+	} /* End if */
+
+    } /* End else */
+
+} /* End function CaptureFrame */
+
+
+void StopFrameCapture( void)
+{
+    unsigned int i;
+
+    if( capturing == GL_FALSE)
+    {
+	return;
+
+    } /* End if */
+
+    /* Collect the frames still in flight, oldest first */
+    while( readsCollected < readsIssued)
+    {
+	CollectFrame( ( readsCollected % CAPTURE_PBO_LAG), GL_TRUE);
+
+    } /* End while */
+
+    /* Let the writer thread drain the queue and quit */
+    SDL_LockMutex( qLock);
+    stopWriter = GL_TRUE;
+    SDL_CondBroadcast( qChanged);
+    SDL_UnlockMutex( qLock);
+
+    SDL_WaitThread( writerThread, NULL);
+    writerThread = NULL;
+
+    SDL_DestroyCond( qChanged);
+    qChanged = NULL;
+    SDL_DestroyMutex( qLock);
+    qLock = NULL;
+
+    if( usePBOs == GL_TRUE)
+    {
+	pglDeleteBuffers( CAPTURE_PBO_LAG, capPBOs);
+	CHECK_GL_ERROR;
+
+    } /* End if */
+
+    for( i = 0U; i < CAPTURE_QUEUE_LEN; i++)
+    {
+	free( capQueue[i].pixels);
+	capQueue[i].pixels = NULL;
+
+    } /* End for */
+
+    free( rowBuf);
+    rowBuf = NULL;
+    free( yuvBuf);
+    yuvBuf = NULL;
+
+    if( y4mFile != NULL)
+    {
+	fclose( y4mFile);
+	y4mFile = NULL;
+
+    } /* End if */
+
+    printf(
+	"CAPTURE: Saved %u frames to \"%s\" (%u dropped)\n",
+	framesSaved, capOutName, framesDropped
+    );
+    fflush( stdout);
+
+    free( capOutName);
+    capOutName = NULL;
+
+    capturing = GL_FALSE;
+
+} /* End function StopFrameCapture */
+
+
+GLboolean IsCapturingFrames( void)
+{
+    return capturing;
+
+} /* End function IsCapturingFrames */
+
+
+/**
+ * Returns the next free slot in the writer's queue, or NULL if the
+ * queue is full and we may not wait for the writer (in which case
+ * the frame is counted as dropped).
+ */
+CapSlot *GetFreeSlot( GLboolean mayWait)
+{
+    CapSlot *retVal = NULL;
+
+    SDL_LockMutex( qLock);
+
+    while( ( qCount == CAPTURE_QUEUE_LEN) && ( mayWait == GL_TRUE))
+    {
+	SDL_CondWait( qChanged, qLock);
+
+    } /* End while */
+
+    if( qCount < CAPTURE_QUEUE_LEN)
+    {
+	retVal = &( capQueue[ ( qHead + qCount) % CAPTURE_QUEUE_LEN]);
+
+    } /* End if */
+    else
+    {
+	framesDropped++;
+
+    } /* End else */
+
+    SDL_UnlockMutex( qLock);
+
+    return retVal;
+
+} /* End function GetFreeSlot */
+
+
+/**
+ * Hands over the slot last returned by GetFreeSlot( ) to the writer.
+ */
+void QueueSlot( void)
+{
+    SDL_LockMutex( qLock);
+    qCount++;
+    SDL_CondBroadcast( qChanged);
+    SDL_UnlockMutex( qLock);
+
+} /* End function QueueSlot */
+
+
+/**
+ * Copies the frame read into the given pixel buffer object into the
+ * writer's queue.
+ */
+void CollectFrame( unsigned int pboIndex, GLboolean mayWait)
+{
+    CapSlot *aSlot = GetFreeSlot( mayWait);
+
+    if( aSlot != NULL)
+    {
+	GLvoid *pboPixels;
+
+	pglBindBuffer( GL_PIXEL_PACK_BUFFER, capPBOs[pboIndex]);
+	pboPixels = pglMapBuffer( GL_PIXEL_PACK_BUFFER, GL_READ_ONLY);
+
+	if( pboPixels != NULL)
+	{
+	    memcpy( aSlot->pixels, pboPixels, ( 4 * capWidth * capHeight));
+	    pglUnmapBuffer( GL_PIXEL_PACK_BUFFER);
+
+	    aSlot->frameNum = pboFrameNums[pboIndex];
+	    QueueSlot( );
+
+	} /* End if */
+	else
+	{
+	    framesDropped++;
+
+	} /* End else */
+
+	pglBindBuffer( GL_PIXEL_PACK_BUFFER, 0U);
+
+    } /* End if */
+
+    readsCollected++;
+
+} /* End function CollectFrame */
+
+
+/**
+ * The writer thread - saves queued frames until asked to stop and
+ * the queue is empty.
+ */
+int WriterMain( void *unused)
+{
+    (void )unused;
+
+    for( ; ; )
+    {
+	CapSlot *aSlot;
+
+	SDL_LockMutex( qLock);
+
+	while( ( qCount == 0U) && ( stopWriter == GL_FALSE))
+	{
+	    SDL_CondWait( qChanged, qLock);
+
+	} /* End while */
+
+	if( qCount == 0U)
+	{
+	    /* Asked to stop and nothing left to save */
+	    SDL_UnlockMutex( qLock);
+	    break;
+
+	} /* End if */
+
+	aSlot = &( capQueue[qHead]);
+
+	SDL_UnlockMutex( qLock);
+
+
+	/* Save the frame without holding the lock */
+	if( y4mFile != NULL)
+	{
+	    SaveY4MFrame( aSlot);
+
+	} /* End if */
+	else
+	{
+	    SavePPMFrame( aSlot);
+
+	} /* End else */
+
+
+	SDL_LockMutex( qLock);
+	qHead = ( qHead + 1U) % CAPTURE_QUEUE_LEN;
+	qCount--;
+	framesSaved++;
+	SDL_CondBroadcast( qChanged);
+	SDL_UnlockMutex( qLock);
+
+    } /* End for */
+
+    return 0;
+
+} /* End function WriterMain */
+
+
+/**
+ * Saves a frame as a binary PPM image. OpenGL returns the rows
+ * bottom-up, while PPM wants them top-down.
+ */
+void SavePPMFrame( CapSlot *aSlot)
+{
+    char fileName[FILENAME_MAX];
+    FILE *outFile;
+    int x, y;
+
+    sprintf( fileName, "%.*s%05u.ppm",
+	( FILENAME_MAX - 16), capOutName, aSlot->frameNum
+    );
+
+    outFile = fopen( fileName, "wb");
+    if( outFile == NULL)
+    {
+	fprintf( stderr,
+	    "\nERROR: Unable to open file \"%s\" for writing!\n", fileName
+	);
+	return;
+
+    } /* End if */
+
+    fprintf( outFile, "P6\n%d %d\n255\n", capWidth, capHeight);
+
+    for( y = ( capHeight - 1); y >= 0; y--)
+    {
+	const Uint8 *srcRow = aSlot->pixels + ( 4 * capWidth * y);
+
+	for( x = 0; x < capWidth; x++)
+	{
+	    rowBuf[3*x + 0] = srcRow[4*x + redOffset];
+	    rowBuf[3*x + 1] = srcRow[4*x + 1];
+	    rowBuf[3*x + 2] = srcRow[4*x + blueOffset];
+
+	} /* End for */
+
+	fwrite( rowBuf, sizeof( Uint8), ( 3 * capWidth), outFile);
+
+    } /* End for */
+
+    fclose( outFile);
+
+} /* End function SavePPMFrame */
+
+
+/**
+ * Appends a frame to the Y4M stream, converting it to full-range
+ * YCbCr (as in JFIF) with 2x2 subsampled chroma.
+ */
+void SaveY4MFrame( CapSlot *aSlot)
+{
+    Uint8 *yPlane = yuvBuf;
+    Uint8 *cbPlane = yuvBuf + ( capWidth * capHeight);
+    Uint8 *crPlane = cbPlane + ( ( capWidth / 2) * ( capHeight / 2));
+    int x, y;
+
+    for( y = 0; y < capHeight; y++)
+    {
+	/* Flip vertically while converting */
+	const Uint8 *srcRow =
+	    aSlot->pixels + ( 4 * capWidth * ( capHeight - 1 - y));
+
+	for( x = 0; x < capWidth; x++)
+	{
+	    int r = srcRow[4*x + redOffset];
+	    int g = srcRow[4*x + 1];
+	    int b = srcRow[4*x + blueOffset];
+
+	    /* Y = 0.299R + 0.587G + 0.114B, in 16.16 fixed point */
+	    yPlane[capWidth*y + x] =
+		(Uint8 )( ( 19595*r + 38470*g + 7471*b + 32768) >> 16);
+
+	} /* End for */
+
+    } /* End for */
+
+    for( y = 0; y < ( capHeight / 2); y++)
+    {
+	const Uint8 *row0 =
+	    aSlot->pixels + ( 4 * capWidth * ( capHeight - 1 - 2*y));
+	const Uint8 *row1 = row0 - ( 4 * capWidth);
+
+	for( x = 0; x < ( capWidth / 2); x++)
+	{
+	    int r, g, b;
+
+	    r = row0[8*x + redOffset] + row0[8*x + 4 + redOffset] +
+		row1[8*x + redOffset] + row1[8*x + 4 + redOffset];
+	    g = row0[8*x + 1] + row0[8*x + 5] +
+		row1[8*x + 1] + row1[8*x + 5];
+	    b = row0[8*x + blueOffset] + row0[8*x + 4 + blueOffset] +
+		row1[8*x + blueOffset] + row1[8*x + 4 + blueOffset];
+
+	    /* Cb = 128 - 0.168736R - 0.331264G + 0.5B
+	     * Cr = 128 + 0.5R - 0.418688G - 0.081312B
+	     * (The sums are of four pixels, hence the extra shift.)
+	     */
+	    cbPlane[( capWidth / 2)*y + x] = (Uint8 )(
+		( ( 128 << 18) - 11059*r - 21709*g + 32768*b + ( 1 << 17)) >> 18
+	    );
+	    crPlane[( capWidth / 2)*y + x] = (Uint8 )(
+		( ( 128 << 18) + 32768*r - 27439*g - 5329*b + ( 1 << 17)) >> 18
+	    );
+
+	} /* End for */
+
+    } /* End for */
+
+    fputs( "FRAME\n", y4mFile);
+    fwrite( yuvBuf, sizeof( Uint8), ( 3 * capWidth * capHeight) / 2, y4mFile);
+
+} /* End function SaveY4MFrame */
+
+
@@ -0,0 +1,80 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * CAPTURE.H: Declarations for the frame capture functions.
+ */
+
+/**
+ * Rendered frames are read back asynchronously through a ring of
+ * pixel buffer objects, so that the pixels of a frame are collected
+ * a few frames after the read was issued, by which time the GPU has
+ * long finished with them. A separate writer thread then saves the
+ * frames to disc, so the render loop never waits for disc I/O. If
+ * the writer falls behind, frames are dropped rather than stalling
+ * the renderer.
+ *
+ * Frames are saved either as a single YUV4MPEG2 ("Y4M") stream, if
+ * the output name ends with ".y4m", or else as a sequence of binary
+ * PPM images named by appending a five-digit frame number and ".ppm"
+ * to the output name.
+ *
+ * Without pixel buffer objects, frames are read back synchronously
+ * (which stalls the pipeline) but are still written out by the
+ * writer thread.
+ */
+
+#ifndef _CAPTURE_H
+#define _CAPTURE_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+
+/* Number of frames a read back lags behind its read request */
+#define CAPTURE_PBO_LAG 3
+
+/* Number of frames that can wait for the writer thread */
+#define CAPTURE_QUEUE_LEN 8
+
+/* Nominal frame rate recorded in Y4M streams */
+#define CAPTURE_Y4M_FPS 30
+
+
+/* Function Prototypes */
+
+/**
+ * Starts capturing frames of the given size to the given output.
+ * Returns 0 if successful, -1 otherwise.
+ */
+extern int StartFrameCapture( int width, int height, const char *outName);
+
+
+/**
+ * Queues a read back of the frame just rendered into the back buffer,
+ * and hands over to the writer thread the frame read back
+ * CAPTURE_PBO_LAG frames ago. Must be called before swapping buffers.
+ */
+extern void CaptureFrame( void);
+
+
+/**
+ * Collects the frames still in flight, waits for the writer thread
+ * to save them and stops capturing.
+ */
+extern void StopFrameCapture( void);
+
+
+/**
+ * Returns GL_TRUE if frames are being captured.
+ */
+extern GLboolean IsCapturingFrames( void);
+
+#endif    /* _CAPTURE_H */
+
+
@@ -0,0 +1,587 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * CLUSTER.C: Grouping triangles into clusters with normal cones.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "cluster.h"
+
+
+/* Number of bits of each ordinate in the Morton code of a centroid */
+#define CLUSTER_MORTON_BITS 10
+
+/* Triangles with no proper normal (degenerate ones) are put in a
+ * group of their own, after those facing along each of the axes.
+ */
+#define CLUSTER_NO_NORMAL ( 6U * CLUSTER_NORMAL_BINS * CLUSTER_NORMAL_BINS)
+
+
+/* Data types used locally */
+
+/* A triangle being sorted into clusters */
+typedef struct _cluster_tri
+{
+    Uint32 facing;      /* Bin of the normal (see GetNormalBin( )) */
+    Uint32 mortonCode;  /* Of its centroid */
+    Uint32 triNum;      /* Within its map */
+    GLfloat normal[3];
+
+} ClusterTri;
+
+
+/* Local function prototypes */
+
+static Uint32 GetNormalBin( const GLfloat normal[3]);
+static GLboolean InSameCluster( 
+    const ClusterTri *aTri, const ClusterTri *bTri
+);
+static int CompareClusterTris( const void *tri1, const void *tri2);
+static Uint32 SpreadBits( Uint32 aValue);
+static void SetClusterBounds(
+    TriCluster *aCluster, const GLData *glData, const GLushort *indices,
+    const ClusterTri *clusterTris, Uint32 numTri
+);
+
+
+ClusterData *GenClusterData( const GLData *glData)
+{
+    ClusterData *retVal;
+    ClusterTri *clusterTris;
+    GLfloat modelMin[3], modelScale[3];
+    Uint32 maxMapTri = 0U;
+    Uint32 i, j, k;
+    int m;
+
+    retVal = (ClusterData *)( malloc( sizeof( ClusterData)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->nMaps = glData->nMaps;
+    retVal->numClusters = 0U;
+
+    retVal->mapClusterNums =
+	(Uint32 *)( malloc( ( glData->nMaps + 1U) * sizeof( Uint32)));
+    retVal->clusters = (TriCluster **)( 
+	malloc( ( glData->nMaps + 1U) * sizeof( TriCluster *))
+    );
+    retVal->indices =
+	(GLushort **)( malloc( ( glData->nMaps + 1U) * sizeof( GLushort *)));
+
+    if( ( retVal->mapClusterNums == NULL) || ( retVal->clusters == NULL) ||
+	( retVal->indices == NULL)
+    )
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( i = 0U; i < glData->nMaps; i++)
+    {
+	maxMapTri =
+	    ( glData->mapTriNums[i] > maxMapTri) ?
+		glData->mapTriNums[i] : maxMapTri;
+
+    } /* End for */
+
+    clusterTris =
+	(ClusterTri *)( malloc( ( maxMapTri + 1U) * sizeof( ClusterTri)));
+    if( clusterTris == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    /* Centroids are placed on a grid spanning the model */
+    modelMin[0] = glData->minX;
+    modelMin[1] = glData->minY;
+    modelMin[2] = glData->minZ;
+    modelScale[0] = glData->maxX - glData->minX;
+    modelScale[1] = glData->maxY - glData->minY;
+    modelScale[2] = glData->maxZ - glData->minZ;
+    for( m = 0; m < 3; m++)
+    {
+	modelScale[m] = ( modelScale[m] > 0.0F) ?
+	    ( (GLfloat )( ( 1 << CLUSTER_MORTON_BITS) - 1) / modelScale[m]) :
+	    0.0F;
+
+    } /* End for */
+
+
+    for( i = 0U; i < glData->nMaps; i++)
+    {
+	Uint32 numTri = glData->mapTriNums[i];
+	Uint32 numClusters, firstTri;
+
+	/* Work out which way each triangle faces and where it is */
+	for( j = 0U; j < numTri; j++)
+	{
+	    ClusterTri *aTri = ( clusterTris + j);
+	    const Uint16 *vIndices = ( glData->triFaces[i] + 3U*j);
+	    const GLfloat *v0 = GLD_VERT_COORDS( glData, vIndices[0]);
+	    const GLfloat *v1 = GLD_VERT_COORDS( glData, vIndices[1]);
+	    const GLfloat *v2 = GLD_VERT_COORDS( glData, vIndices[2]);
+	    GLfloat edge1[3], edge2[3], normLen;
+	    Uint32 gridPos[3];
+
+	    for( m = 0; m < 3; m++)
+	    {
+		GLfloat centroid = ( v0[m] + v1[m] + v2[m]) / 3.0F;
+
+		edge1[m] = v1[m] - v0[m];
+		edge2[m] = v2[m] - v0[m];
+
+		gridPos[m] = (Uint32 )( 
+		    ( centroid - modelMin[m]) * modelScale[m] + 0.5F
+		);
+		if( gridPos[m] >= ( 1U << CLUSTER_MORTON_BITS))
+		{
+		    gridPos[m] = ( 1U << CLUSTER_MORTON_BITS) - 1U;
+
+		} /* End if */
+
+	    } /* End for */
+
+	    aTri->normal[0] = edge1[1]*edge2[2] - edge1[2]*edge2[1];
+	    aTri->normal[1] = edge1[2]*edge2[0] - edge1[0]*edge2[2];
+	    aTri->normal[2] = edge1[0]*edge2[1] - edge1[1]*edge2[0];
+
+	    normLen = (GLfloat )sqrt(
+		aTri->normal[0]*aTri->normal[0] +
+		aTri->normal[1]*aTri->normal[1] +
+		aTri->normal[2]*aTri->normal[2]
+	    );
+
+	    aTri->facing = CLUSTER_NO_NORMAL;
+	    if( normLen > 0.0F)
+	    {
+		for( m = 0; m < 3; m++)
+		{
+		    aTri->normal[m] /= normLen;
+
+		} /* End for */
+
+		aTri->facing = GetNormalBin( aTri->normal);
+
+	    } /* End if */
+
+	    aTri->mortonCode =
+		( SpreadBits( gridPos[0]) << 2) |
+		( SpreadBits( gridPos[1]) << 1) |
+		SpreadBits( gridPos[2]);
+	    aTri->triNum = j;
+
+	} /* End for */
+
+	qsort( clusterTris, numTri, sizeof( ClusterTri), CompareClusterTris);
+
+
+	/* Count the clusters - a cluster ends when it is full, or when
+	 * the next triangle faces some other way or is elsewhere.
+	 */
+	numClusters = 0U;
+	for( j = 0U; j < numTri; j = k)
+	{
+	    for( k = j + 1U;
+		( k < numTri) && ( ( k - j) < CLUSTER_MAX_TRI) &&
+		( InSameCluster( clusterTris + j, clusterTris + k) == GL_TRUE);
+		k++
+	    )
+	    {
+		/* Nothing to do */
+
+	    } /* End for */
+
+	    numClusters++;
+
+	} /* End for */
+
+	retVal->mapClusterNums[i] = numClusters;
+	retVal->numClusters += numClusters;
+
+	retVal->clusters[i] = (TriCluster *)(
+	    malloc( ( numClusters + 1U) * sizeof( TriCluster))
+	);
+	retVal->indices[i] = (GLushort *)(
+	    malloc( ( 3U * numTri + 1U) * sizeof( GLushort))
+	);
+
+	if( ( retVal->clusters[i] == NULL) || ( retVal->indices[i] == NULL))
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	for( j = 0U; j < numTri; j++)
+	{
+	    const Uint16 *vIndices =
+		( glData->triFaces[i] + 3U*clusterTris[j].triNum);
+
+	    retVal->indices[i][3U*j + 0U] = vIndices[0];
+	    retVal->indices[i][3U*j + 1U] = vIndices[1];
+	    retVal->indices[i][3U*j + 2U] = vIndices[2];
+
+	} /* End for */
+
+	/* Now fill them in */
+	numClusters = 0U;
+	for( firstTri = 0U; firstTri < numTri; firstTri = k)
+	{
+	    TriCluster *aCluster = ( retVal->clusters[i] + numClusters);
+
+	    for( k = firstTri + 1U;
+		( k < numTri) && ( ( k - firstTri) < CLUSTER_MAX_TRI) &&
+		( InSameCluster( 
+		    clusterTris + firstTri, clusterTris + k) == GL_TRUE
+		);
+		k++
+	    )
+	    {
+		/* Nothing to do */
+
+	    } /* End for */
+
+	    aCluster->firstIndex = 3U * firstTri;
+	    aCluster->numIndices = 3U * ( k - firstTri);
+
+	    SetClusterBounds(
+		aCluster, glData,
+		( retVal->indices[i] + aCluster->firstIndex),
+		( clusterTris + firstTri), ( k - firstTri)
+	    );
+
+	    numClusters++;
+
+	} /* End for */
+
+    } /* End for */
+
+    free( clusterTris);
+
+#ifdef VTAJ_DEBUG
+    printf(
+	"CLUSTER: %u triangles, %u clusters\n",
+	glData->numTri, retVal->numClusters
+    );
+#endif
+
+    return retVal;
+
+} /* End function GenClusterData */
+
+
+GLboolean IsClusterBackFacing(
+    const TriCluster *aCluster, const GLfloat eyePos[3]
+)
+{
+    GLfloat toEye[3], axisDist, distSqr, perpDist;
+    int m;
+
+    if( aCluster->coneCos <= 0.0F)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    axisDist = distSqr = 0.0F;
+    for( m = 0; m < 3; m++)
+    {
+	toEye[m] = eyePos[m] - aCluster->center[m];
+	axisDist += toEye[m] * aCluster->coneAxis[m];
+	distSqr += toEye[m] * toEye[m];
+
+    } /* End for */
+
+    /* The largest distance of the eye above the plane of any of the
+     * triangles is at most the largest component along a normal in
+     * the cone of the vector from the centre to the eye, plus the
+     * radius. For a vector at an angle 't' to the axis, this
+     * component is its length times cos( t - coneAngle), provided 't'
+     * is more than the cone angle - otherwise the eye is in front.
+     */
+    perpDist = distSqr - axisDist * axisDist;
+    perpDist = ( perpDist > 0.0F) ? (GLfloat )sqrt( perpDist) : 0.0F;
+
+    if( ( axisDist * aCluster->coneCos + perpDist * aCluster->coneSin) <
+	-aCluster->radius
+    )
+    {
+	return GL_TRUE;
+
+    } /* End if */
+
+    return GL_FALSE;
+
+} /* End function IsClusterBackFacing */
+
+
+void FreeClusterData( ClusterData *clusterData)
+{
+    if( clusterData != NULL)
+    {
+	Uint16 i;
+
+	for( i = 0U; i < clusterData->nMaps; i++)
+	{
+	    free( clusterData->clusters[i]);
+	    free( clusterData->indices[i]);
+
+	} /* End for */
+
+	free( clusterData->clusters);
+	free( clusterData->indices);
+	free( clusterData->mapClusterNums);
+
+	free( clusterData);
+
+    } /* End if */
+
+} /* End function FreeClusterData */
+
+
+/**
+ * Returns the bin of directions the given unit normal is in. The 
+ * directions whose largest component is along the same axis, with the
+ * same sign, are divided into CLUSTER_NORMAL_BINS x CLUSTER_NORMAL_BINS
+ * bins by the ratios of the other two components to the largest (like
+ * the texels of a face of a cube map).
+ */
+Uint32 GetNormalBin( const GLfloat normal[3])
+{
+    GLfloat maxOrd = 0.0F;
+    Uint32 retVal, binU, binV;
+    int axis = 0;
+    int m;
+
+    for( m = 0; m < 3; m++)
+    {
+	if( fabs( normal[m]) > maxOrd)
+	{
+	    maxOrd = (GLfloat )fabs( normal[m]);
+	    axis = m;
+
+	} /* End if */
+
+    } /* End for */
+
+    binU = (Uint32 )( 
+	( normal[( axis + 1) % 3] / maxOrd + 1.0F) * 0.5F * CLUSTER_NORMAL_BINS
+    );
+    binV = (Uint32 )( 
+	( normal[( axis + 2) % 3] / maxOrd + 1.0F) * 0.5F * CLUSTER_NORMAL_BINS
+    );
+    binU = ( binU < CLUSTER_NORMAL_BINS) ? binU : ( CLUSTER_NORMAL_BINS - 1U);
+    binV = ( binV < CLUSTER_NORMAL_BINS) ? binV : ( CLUSTER_NORMAL_BINS - 1U);
+
+    retVal = 2U * (Uint32 )axis + ( ( normal[axis] < 0.0F) ? 1U : 0U);
+    retVal = ( retVal * CLUSTER_NORMAL_BINS + binU) * CLUSTER_NORMAL_BINS;
+
+    return ( retVal + binV);
+
+} /* End function GetNormalBin */
+
+
+/**
+ * Returns GL_TRUE if the second of the given triangles (in sorted 
+ * order) can be in the same cluster as the first - that is, if their
+ * normals are in the same bin and their centroids in the same cell of 
+ * the grid of CLUSTER_CELL_BITS bits along each axis.
+ */
+GLboolean InSameCluster( const ClusterTri *aTri, const ClusterTri *bTri)
+{
+    int cellShift = 3 * ( CLUSTER_MORTON_BITS - CLUSTER_CELL_BITS);
+
+    if( ( aTri->facing == bTri->facing) &&
+	( ( aTri->mortonCode >> cellShift) == ( bTri->mortonCode >> cellShift))
+    )
+    {
+	return GL_TRUE;
+
+    } /* End if */
+
+    return GL_FALSE;
+
+} /* End function InSameCluster */
+
+
+/**
+ * Orders triangles by the way they face, and then by their Morton
+ * codes.
+ */
+int CompareClusterTris( const void *tri1, const void *tri2)
+{
+    const ClusterTri *aTri = (const ClusterTri *)tri1;
+    const ClusterTri *bTri = (const ClusterTri *)tri2;
+
+    if( aTri->facing != bTri->facing)
+    {
+	return ( aTri->facing < bTri->facing) ? -1 : 1;
+
+    } /* End if */
+
+    if( aTri->mortonCode != bTri->mortonCode)
+    {
+	return ( aTri->mortonCode < bTri->mortonCode) ? -1 : 1;
+
+    } /* End if */
+
+    /* Keep the original order otherwise, as qsort( ) need not */
+    return ( aTri->triNum < bTri->triNum) ? -1 : 1;
+
+} /* End function CompareClusterTris */
+
+
+/**
+ * Spreads out the lower CLUSTER_MORTON_BITS bits of the given value
+ * so that there are two 0 bits between any two of them.
+ */
+Uint32 SpreadBits( Uint32 aValue)
+{
+    Uint32 retVal = 0U;
+    int b;
+
+    for( b = 0; b < CLUSTER_MORTON_BITS; b++)
+    {
+	retVal |= ( ( aValue >> b) & 1U) << ( 3 * b);
+
+    } /* End for */
+
+    return retVal;
+
+} /* End function SpreadBits */
+
+
+/**
+ * Works out the bounding sphere and the normal cone of the given
+ * cluster from its triangles.
+ */
+void SetClusterBounds(
+    TriCluster *aCluster, const GLData *glData, const GLushort *indices,
+    const ClusterTri *clusterTris, Uint32 numTri
+)
+{
+    GLfloat minCorner[3], maxCorner[3], axisLen, maxDistSqr;
+    Uint32 j;
+    int m;
+
+    /* The sphere is centred on the centre of the bounding box */
+    for( m = 0; m < 3; m++)
+    {
+	minCorner[m] = maxCorner[m] = GLD_VERT_COORDS( glData, indices[0])[m];
+
+    } /* End for */
+
+    for( j = 1U; j < 3U * numTri; j++)
+    {
+	const GLfloat *aVert = GLD_VERT_COORDS( glData, indices[j]);
+
+	for( m = 0; m < 3; m++)
+	{
+	    minCorner[m] = 
+		( aVert[m] < minCorner[m]) ? aVert[m] : minCorner[m];
+	    maxCorner[m] = 
+		( aVert[m] > maxCorner[m]) ? aVert[m] : maxCorner[m];
+
+	} /* End for */
+
+    } /* End for */
+
+    for( m = 0; m < 3; m++)
+    {
+	aCluster->center[m] = ( minCorner[m] + maxCorner[m]) / 2.0F;
+
+    } /* End for */
+
+    maxDistSqr = 0.0F;
+    for( j = 0U; j < 3U * numTri; j++)
+    {
+	const GLfloat *aVert = GLD_VERT_COORDS( glData, indices[j]);
+	GLfloat distSqr = 0.0F;
+
+	for( m = 0; m < 3; m++)
+	{
+	    distSqr +=
+		( aVert[m] - aCluster->center[m]) *
+		( aVert[m] - aCluster->center[m]);
+
+	} /* End for */
+
+	maxDistSqr = ( distSqr > maxDistSqr) ? distSqr : maxDistSqr;
+
+    } /* End for */
+
+    /* Allow a little for rounding errors */
+    aCluster->radius = (GLfloat )sqrt( maxDistSqr) * 1.001F + 1.0e-4F;
+
+
+    /* The cone is around the average normal */
+    aCluster->coneCos = -1.0F;
+    aCluster->coneSin = 0.0F;
+
+    if( clusterTris[0].facing == CLUSTER_NO_NORMAL)
+    {
+	return;
+
+    } /* End if */
+
+    for( m = 0; m < 3; m++)
+    {
+	aCluster->coneAxis[m] = 0.0F;
+	for( j = 0U; j < numTri; j++)
+	{
+	    aCluster->coneAxis[m] += clusterTris[j].normal[m];
+
+	} /* End for */
+
+    } /* End for */
+
+    axisLen = (GLfloat )sqrt(
+	aCluster->coneAxis[0]*aCluster->coneAxis[0] +
+	aCluster->coneAxis[1]*aCluster->coneAxis[1] +
+	aCluster->coneAxis[2]*aCluster->coneAxis[2]
+    );
+    if( axisLen <= 0.0F)
+    {
+	return;
+
+    } /* End if */
+
+    aCluster->coneCos = 1.0F;
+    for( m = 0; m < 3; m++)
+    {
+	aCluster->coneAxis[m] /= axisLen;
+
+    } /* End for */
+
+    for( j = 0U; j < numTri; j++)
+    {
+	GLfloat dotProd =
+	    clusterTris[j].normal[0] * aCluster->coneAxis[0] +
+	    clusterTris[j].normal[1] * aCluster->coneAxis[1] +
+	    clusterTris[j].normal[2] * aCluster->coneAxis[2];
+
+	aCluster->coneCos =
+	    ( dotProd < aCluster->coneCos) ? dotProd : aCluster->coneCos;
+
+    } /* End for */
+
+    /* Widen the cone a little for rounding errors */
+    aCluster->coneCos -= 1.0e-4F;
+    aCluster->coneSin = ( aCluster->coneCos < 1.0F) ?
+	(GLfloat )sqrt( 1.0F - aCluster->coneCos * aCluster->coneCos) : 0.0F;
+
+} /* End function SetClusterBounds */
@@ -0,0 +1,116 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * CLUSTER.H: Declarations for grouping the triangles of a GLData model
+ * into clusters that can be backface culled as a whole.
+ */
+
+/**
+ * The triangles using each texture map of a model are grouped into
+ * clusters of up to CLUSTER_MAX_TRI triangles, each facing roughly the
+ * same way (their normals are in the same one of a set of bins of
+ * directions) and lying close together (their centroids are in the
+ * same cell of a coarse grid over the model, and the triangles of a
+ * cell are taken in the order of the Morton codes of their centroids).
+ *
+ * Each cluster has a bounding sphere and a "normal cone" - an axis and
+ * an angle such that the normals of all its triangles are within that
+ * angle of the axis. From a viewpoint that sees the back of every
+ * plane through the sphere with a normal in the cone, the whole cluster
+ * is back-facing and need not be drawn at all.
+ */
+
+#ifndef _CLUSTER_H
+#define _CLUSTER_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+#include "gld.h"
+
+
+/* Maximum number of triangles in a cluster */
+#define CLUSTER_MAX_TRI 64U
+
+/* Directions along each axis are divided into this many bins along
+ * each of the other two axes, so that the normal cones are narrow.
+ */
+#define CLUSTER_NORMAL_BINS 3U
+
+/* The grid over the model has ( 1 << CLUSTER_CELL_BITS) cells along
+ * each axis.
+ */
+#define CLUSTER_CELL_BITS 2
+
+
+/* Data type definitions */
+
+/* A cluster of triangles using the same texture map */
+typedef struct _tri_cluster
+{
+    /* The vertex indices of its triangles, in the indices of its map */
+    Uint32 firstIndex;
+    Uint32 numIndices;
+
+    /* Bounding sphere */
+    GLfloat center[3];
+    GLfloat radius;
+
+    /* Normal cone, with the cosine and the sine of its angle. If the
+     * cosine is not positive, the cone is too wide to ever cull the
+     * cluster.
+     */
+    GLfloat coneAxis[3];
+    GLfloat coneCos, coneSin;
+
+} TriCluster;
+
+
+/* The clusters of a GLData model */
+typedef struct _cluster_data
+{
+    Uint16 nMaps;
+
+    /* 'mapClusterNums[i]' clusters for 0 <= i < 'nMaps' */
+    Uint32 *mapClusterNums;
+    TriCluster **clusters;
+
+    /* The vertex indices of the triangles of each map, rearranged so
+     * that those of a cluster are together.
+     */
+    GLushort **indices;
+
+    Uint32 numClusters;
+
+} ClusterData;
+
+
+/* Function Prototypes */
+
+/**
+ * Groups the triangles of the given GLData model into clusters.
+ */
+extern ClusterData *GenClusterData( const GLData *glData);
+
+
+/**
+ * Returns GL_TRUE if every triangle of the given cluster is seen from
+ * behind from the given point (in the coordinates of the model).
+ */
+extern GLboolean IsClusterBackFacing(
+    const TriCluster *aCluster, const GLfloat eyePos[3]
+);
+
+
+/**
+ * Frees the given clusters.
+ */
+extern void FreeClusterData( ClusterData *clusterData);
+
+#endif    /* _CLUSTER_H */
@@ -42,6 +42,9 @@ static GLboolean intersectsFace(
     GLfloat vert0[], GLfloat vert1[], GLfloat vert2[],
     GLfloat *t, GLfloat *u, GLfloat *v
 );
+static GLboolean segmentHitsBox(
+    const BVHNode *aNode, GLfloat orig[], GLfloat invDir[], GLfloat tMax
+);
 
 
 GLboolean hasCollision( 
@@ -106,17 +109,17 @@ GLboolean hasCollision(
 	    vInd[1] = *( model->triFaces[i] + 3*j + 1);
 	    vInd[2] = *( model->triFaces[i] + 3*j + 2);
 
-            v0[0] = *( model->vertCoords + 3*vInd[0] + 0);
-            v0[1] = *( model->vertCoords + 3*vInd[0] + 1);
-            v0[2] = *( model->vertCoords + 3*vInd[0] + 2);
+	    v0[0] = *( GLD_VERT_COORDS( model, vInd[0]) + 0);
+	    v0[1] = *( GLD_VERT_COORDS( model, vInd[0]) + 1);
+	    v0[2] = *( GLD_VERT_COORDS( model, vInd[0]) + 2);
 
-            v1[0] = *( model->vertCoords + 3*vInd[1] + 0);
-            v1[1] = *( model->vertCoords + 3*vInd[1] + 1);
-            v1[2] = *( model->vertCoords + 3*vInd[1] + 2);
+	    v1[0] = *( GLD_VERT_COORDS( model, vInd[1]) + 0);
+	    v1[1] = *( GLD_VERT_COORDS( model, vInd[1]) + 1);
+	    v1[2] = *( GLD_VERT_COORDS( model, vInd[1]) + 2);
 
-            v2[0] = *( model->vertCoords + 3*vInd[2] + 0);
-            v2[1] = *( model->vertCoords + 3*vInd[2] + 1);
-            v2[2] = *( model->vertCoords + 3*vInd[2] + 2);
+	    v2[0] = *( GLD_VERT_COORDS( model, vInd[2]) + 0);
+	    v2[1] = *( GLD_VERT_COORDS( model, vInd[2]) + 1);
+	    v2[2] = *( GLD_VERT_COORDS( model, vInd[2]) + 2);
 
 	    if( intersectsFace( fromPt, dir, v0, v1, v2, &tmpT, &tmpU, &tmpV)
 		== GL_TRUE
@@ -141,6 +144,148 @@ GLboolean hasCollision(
 } /* End function hasCollision */
 
 
+GLboolean hasCXCollision(
+    const CXMesh *cxMesh,
+    GLfloat fromPt[], GLfloat toPt[],
+    GLfloat *dist
+)
+{
+    GLboolean retVal = GL_FALSE;
+
+    Uint32 nodeStack[BVH_MAX_DEPTH];
+    int stackSize = 0;
+    GLfloat dir[3], invDir[3];
+    GLdouble dirMag;
+    GLfloat tMax;
+    int m;
+
+
+    /* Initialise stuff */
+    *dist = FLT_MAX;
+
+
+    /* Prepare the normalised direction of movement vector */
+
+    dir[0] = toPt[0] - fromPt[0];
+    dir[1] = toPt[1] - fromPt[1];
+    dir[2] = toPt[2] - fromPt[2];
+
+    dirMag = sqrt(
+	( (GLdouble )dir[0] * (GLdouble )dir[0]) +
+	( (GLdouble )dir[1] * (GLdouble )dir[1]) +
+	( (GLdouble )dir[2] * (GLdouble )dir[2])
+    );
+
+    if( dirMag > 0.0)
+    {
+	dir[0] = (GLfloat )( (GLdouble )dir[0] / dirMag);
+	dir[1] = (GLfloat )( (GLdouble )dir[1] / dirMag);
+	dir[2] = (GLfloat )( (GLdouble )dir[2] / dirMag);
+
+    } /* End if */
+    else
+    {
+#ifdef VTAJ_DEBUG
+	fprintf( stderr,
+	    "ERROR: dirMag is 0 in function hasCXCollision( )\n"
+	);
+#endif
+	return GL_TRUE;
+
+    } /* End else */
+
+    if( cxMesh->numTri == 0U)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    /* Division by zero gives infinities, which the box tests handle */
+    for( m = 0; m < 3; m++)
+    {
+	invDir[m] = 1.0F / dir[m];
+
+    } /* End for */
+
+    tMax = (GLfloat )dirMag;
+
+
+    /* Walk down the BVH to the triangles near the movement, nearer
+     * than any hit found so far. (The BVH has at most BVH_MAX_DEPTH
+     * levels, so the stack can not overflow.)
+     */
+    nodeStack[stackSize++] = 0U;
+
+    while( stackSize > 0)
+    {
+	const BVHNode *aNode = cxMesh->nodes + nodeStack[--stackSize];
+	Uint32 i;
+
+	if( segmentHitsBox( aNode, fromPt, invDir, tMax) == GL_FALSE)
+	{
+	    continue;
+
+	} /* End if */
+
+	if( aNode->numTri == 0U)
+	{
+	    nodeStack[stackSize++] = aNode->first;
+	    nodeStack[stackSize++] = aNode->first + 1U;
+	    continue;
+
+	} /* End if */
+
+	for( i = aNode->first; i < ( aNode->first + aNode->numTri); i++)
+	{
+	    const GLfloat *aPlane = cxMesh->triPlanes + 4 * i;
+	    const Uint32 *vInd = cxMesh->triVerts + 3 * i;
+	    GLfloat fromDist, toDist;
+	    GLfloat tmpT = FLT_MAX;
+	    GLfloat tmpU = FLT_MAX;
+	    GLfloat tmpV = FLT_MAX;
+
+	    /* A movement that stays on one side of the plane of the
+	     * triangle can not hit it
+	     */
+	    fromDist = DOT( aPlane, fromPt) + aPlane[3];
+	    toDist = DOT( aPlane, toPt) + aPlane[3];
+
+	    if( ( ( fromDist > 0.0F) && ( toDist > 0.0F)) ||
+		( ( fromDist < 0.0F) && ( toDist < 0.0F))
+	    )
+	    {
+		continue;
+
+	    } /* End if */
+
+	    if( intersectsFace(
+		    fromPt, dir,
+		    cxMesh->vertCoords + 3 * vInd[0],
+		    cxMesh->vertCoords + 3 * vInd[1],
+		    cxMesh->vertCoords + 3 * vInd[2],
+		    &tmpT, &tmpU, &tmpV
+		) == GL_TRUE
+	    )
+	    {
+		if( ( tmpT >= 0.0f) && ( tmpT < *dist) && ( tmpT <= tMax))
+		{
+		    *dist = tMax = tmpT;
+
+		    retVal = GL_TRUE;
+
+		} /* End if */
+
+	    } /* End if */
+
+	} /* End for */
+
+    } /* End while */
+
+    return retVal;
+
+} /* End function hasCXCollision */
+
+
 GLboolean intersectsFace( 
     GLfloat orig[], GLfloat dir[], 
     GLfloat vert0[], GLfloat vert1[], GLfloat vert2[],
@@ -203,3 +348,57 @@ GLboolean intersectsFace(
 } /* End function intersectsFace */
 
 
+/**
+ * Returns GL_TRUE if the part ( orig + t*dir), for 0 <= t <= tMax, of
+ * a ray (given with the reciprocals of the components of 'dir') goes
+ * through the bounding box of the given node of a BVH.
+ */
+GLboolean segmentHitsBox(
+    const BVHNode *aNode, GLfloat orig[], GLfloat invDir[], GLfloat tMax
+)
+{
+    GLfloat tMin = 0.0F;
+    int m;
+
+    for( m = 0; m < 3; m++)
+    {
+	GLfloat t0 = ( aNode->bbMin[m] - orig[m]) * invDir[m];
+	GLfloat t1 = ( aNode->bbMax[m] - orig[m]) * invDir[m];
+
+	if( t0 > t1)
+	{
+	    GLfloat tmpT = t0;
+
+	    t0 = t1;
+	    t1 = tmpT;
+
+	} /* End if */
+
+	/* (Comparisons with NaNs, from rays in the plane of a face
+	 * of the box, are false and leave the range unchanged.)
+	 */
+	if( t0 > tMin)
+	{
+	    tMin = t0;
+
+	} /* End if */
+
+	if( t1 < tMax)
+	{
+	    tMax = t1;
+
+	} /* End if */
+
+	if( tMin > tMax)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+    } /* End for */
+
+    return GL_TRUE;
+
+} /* End function segmentHitsBox */
+
+
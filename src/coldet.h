@@ -17,6 +17,7 @@
 #include "SDL_opengl.h"
 
 #include "gld.h"
+#include "cxmesh.h"
 
 
 /* Function prototypes */
@@ -27,6 +28,16 @@ extern GLboolean hasCollision(
     GLfloat *dist
 );
 
+/* Like hasCollision( ), but with a collision mesh - only the triangles
+ * near the movement, as found by the BVH of the mesh, whose planes the
+ * movement crosses are tested.
+ */
+extern GLboolean hasCXCollision( 
+    const CXMesh *cxMesh, 
+    GLfloat fromPt[], GLfloat toPt[],
+    GLfloat *dist
+);
+
 #endif    /* _COLDET_H */
 
 
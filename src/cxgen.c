@@ -0,0 +1,1592 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * CXGEN.C: Simplifying a model into its collision mesh, by clustering
+ * its vertices and voxelizing the parts too thin to be clustered.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "gld.h"
+#include "cxmesh.h"
+#include "cxgen.h"
+
+
+/* The marked voxels are kept in "bricks" of BRICK_DIM x BRICK_DIM x
+ * BRICK_DIM voxels, only for the parts of the grid that have some
+ * voxel marked - a grid over the whole of a large model would not fit
+ * in memory.
+ */
+#define BRICK_SHIFT 3
+#define BRICK_DIM 8
+#define BRICK_ROWS ( BRICK_DIM * BRICK_DIM)
+
+/* Whether voxel (x,y,z) of the given rows of a brick is marked */
+#define VOXEL_MARKED( rows, x, y, z) \
+    ( ( ( rows)[( z) * BRICK_DIM + ( y)] >> ( x)) & 1U)
+
+/* Stands for "no such point" */
+#define CXGEN_NONE 0xFFFFFFFFU
+
+/* A triangle is taken to touch a voxel if it is within this fraction
+ * of the edge of the voxel from it, so that one lying exactly between
+ * two voxels (or rounded off a little) marks both of them.
+ */
+#define CXGEN_BOX_SLACK 1.0E-3
+
+/* No grid may have more voxels along an axis than this */
+#define CXGEN_MAX_GRID_DIM 0x10000000
+
+
+/* Data types used locally */
+
+/* Points of the grid (corners of voxels, or positions of bricks), each
+ * given a number in the order in which they are added
+ */
+typedef struct _grid_index
+{
+    Uint32 numPts;
+    Uint32 maxPts;
+    Sint32 *gridPts;      /* 'numPts' packed triads of (x,y,z) values */
+
+    Uint32 hashSize;      /* A power of two, at least twice 'numPts' */
+    Uint32 *ptSlots;      /* Numbers of the points, or CXGEN_NONE */
+
+} GridIndex;
+
+
+/* The voxels marked by the triangles of a model */
+typedef struct _vox_grid
+{
+    GLdouble origin[3];   /* Corner of voxel (0,0,0) */
+    GLdouble voxelSize;
+
+    /* Brick (x,y,z) has voxels (8x,8y,8z) to (8x+7,8y+7,8z+7). Bit 'x'
+     * of row 'z * BRICK_DIM + y' of a brick is set if its voxel
+     * (x,y,z) is marked.
+     */
+    GridIndex brickIndex;
+    Uint32 maxBricks;
+    Uint8 *brickRows;     /* BRICK_ROWS for each brick */
+
+} VoxGrid;
+
+
+/* A rectangle made of faces of voxels, in the plane at 'plane' along
+ * the 'axis' and spanning 'uMin' to 'uMax' along the next axis and
+ * 'vMin' to 'vMax' along the one after that (in voxels)
+ */
+typedef struct _cx_rect
+{
+    Uint8 axis;           /* 0, 1 or 2 for X, Y or Z */
+    Uint8 facesUp;        /* 1 if it faces along the axis, 0 if against */
+
+    Sint32 plane;
+    Sint32 uMin, uMax;
+    Sint32 vMin, vMax;
+
+} CXRect;
+
+
+typedef struct _cx_rect_list
+{
+    Uint32 numRects;
+    Uint32 maxRects;
+    CXRect *rects;
+
+} CXRectList;
+
+
+/* Local function prototypes */
+
+static Uint32 ClusterVerts(
+    GLData *glData, VoxGrid *voxGrid,
+    Uint32 *vertClusters, GLdouble *clusterPts
+);
+static Uint32 SimplifyTris(
+    GLData *glData, VoxGrid *voxGrid,
+    const Uint32 *vertClusters, const GLdouble *clusterPts, Uint32 *keptTris
+);
+static void InitGridIndex( GridIndex *anIndex);
+static void FreeGridIndex( GridIndex *anIndex);
+static Uint32 FindGridPoint(
+    GridIndex *anIndex, const Sint32 aPt[3], GLboolean canAdd
+);
+static Uint32 HashGridPoint( const Sint32 aPt[3], Uint32 hashSize);
+static Uint8 *GetBrickRows(
+    VoxGrid *voxGrid, const Sint32 brickPos[3], GLboolean canAdd
+);
+static void MarkTriVoxels(
+    VoxGrid *voxGrid, const GLdouble triPts[3][3], GLboolean toMark
+);
+static void MarkBrickVoxels(
+    VoxGrid *voxGrid, const Sint32 brickPos[3],
+    const GLdouble gridPts[3][3],
+    const Sint32 minVox[3], const Sint32 maxVox[3], GLboolean toMark
+);
+static GLboolean TriTouchesBox(
+    const GLdouble triPts[3][3], GLdouble halfSize
+);
+static GLboolean IsSeparatingAxis(
+    const GLdouble anAxis[3], const GLdouble triPts[3][3], GLdouble halfSize
+);
+static void AddBrickFaces(
+    VoxGrid *voxGrid, Uint32 brickNum, CXRectList *rectList
+);
+static void AddFaceRects(
+    CXRectList *rectList, const Sint32 brickPos[3],
+    int axis, int facesUp, int slice, Uint8 faceMask[BRICK_DIM]
+);
+static void AddRect( CXRectList *rectList, const CXRect *aRect);
+static Uint32 MergeRects( CXRectList *rectList, GLboolean alongU);
+static int CompareRectsAlongU( const void *rect1, const void *rect2);
+static int CompareRectsAlongV( const void *rect1, const void *rect2);
+static CXMesh *MakeCXMesh(
+    VoxGrid *voxGrid, const GLdouble *clusterPts, Uint32 numClusters,
+    const Uint32 *keptTris, Uint32 numKept, CXRectList *rectList
+);
+
+
+CXMesh *GenCXMesh( GLData *glData, GLfloat voxelSize)
+{
+    CXMesh *retVal = NULL;
+    VoxGrid voxGrid;
+    CXRectList rectList;
+    GLdouble gridDim;
+
+    Uint32 *vertClusters;
+    GLdouble *clusterPts;
+    Uint32 numClusters;
+
+    Uint32 *keptTris;
+    Uint32 numKept;
+
+    Uint32 i, numMerged;
+
+    /* Keep a voxel free all around the model, so that no point of the
+     * grid that is used is negative
+     */
+    voxGrid.voxelSize = voxelSize;
+    voxGrid.origin[0] = glData->minX - voxelSize;
+    voxGrid.origin[1] = glData->minY - voxelSize;
+    voxGrid.origin[2] = glData->minZ - voxelSize;
+
+    gridDim = glData->maxX - glData->minX;
+    gridDim = ( glData->maxY - glData->minY > gridDim) ?
+	( glData->maxY - glData->minY) : gridDim;
+    gridDim = ( glData->maxZ - glData->minZ > gridDim) ?
+	( glData->maxZ - glData->minZ) : gridDim;
+
+    if( ( voxelSize <= 0.0F) ||
+	( gridDim / voxelSize > (GLdouble )CXGEN_MAX_GRID_DIM)
+    )
+    {
+	return NULL;
+
+    } /* End if */
+
+    InitGridIndex( &( voxGrid.brickIndex));
+    voxGrid.maxBricks = 0U;
+    voxGrid.brickRows = NULL;
+
+    vertClusters = (Uint32 *)( malloc(
+	( glData->nVertices + 1) * sizeof( Uint32)
+    ));
+    clusterPts = (GLdouble *)( malloc(
+	( 3 * glData->nVertices + 1) * sizeof( GLdouble)
+    ));
+    keptTris = (Uint32 *)( malloc(
+	( 3 * glData->numTri + 1) * sizeof( Uint32)
+    ));
+
+    if( ( vertClusters == NULL) || ( clusterPts == NULL) ||
+	( keptTris == NULL)
+    )
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+
+    /* Cluster the vertices, and mark the voxels of the triangles that
+     * have collapsed
+     */
+    numClusters = ClusterVerts( glData, &voxGrid, vertClusters, clusterPts);
+    numKept = SimplifyTris(
+	glData, &voxGrid, vertClusters, clusterPts, keptTris
+    );
+
+#ifdef GLD_DEBUG
+    printf(
+	"CXGEN: %u vertices in %lu clusters, %lu of %lu triangles kept\n",
+	(unsigned int )glData->nVertices, (unsigned long )numClusters,
+	(unsigned long )numKept, (unsigned long )glData->numTri
+    );
+    printf(
+	"CXGEN: Collapsed triangles marked voxels in %lu bricks\n",
+	(unsigned long )voxGrid.brickIndex.numPts
+    );
+    fflush( stdout);
+#endif
+
+
+    /* Take the exposed faces of the marked voxels */
+    rectList.numRects = 0U;
+    rectList.maxRects = 0U;
+    rectList.rects = NULL;
+
+    for( i = 0U; i < voxGrid.brickIndex.numPts; i++)
+    {
+	AddBrickFaces( &voxGrid, i, &rectList);
+
+    } /* End for */
+
+    /* Merge the rectangles across the bricks, until no more can be */
+    do
+    {
+	numMerged = MergeRects( &rectList, GL_TRUE);
+	numMerged += MergeRects( &rectList, GL_FALSE);
+
+    } while( numMerged > 0U);
+
+#ifdef GLD_DEBUG
+    printf(
+	"CXGEN: %lu rectangles of exposed voxel faces\n",
+	(unsigned long )rectList.numRects
+    );
+    fflush( stdout);
+#endif
+
+
+    /* Make the collision mesh from the triangles kept and the
+     * rectangles
+     */
+    retVal = MakeCXMesh(
+	&voxGrid, clusterPts, numClusters, keptTris, numKept, &rectList
+    );
+    IndexCXMesh( retVal);
+
+#ifdef GLD_DEBUG
+    printf(
+	"CXGEN: BVH of %lu nodes over the collision mesh\n",
+	(unsigned long )retVal->numNodes
+    );
+    fflush( stdout);
+#endif
+
+    free( rectList.rects);
+    free( keptTris);
+    free( clusterPts);
+    free( vertClusters);
+    free( voxGrid.brickRows);
+    FreeGridIndex( &( voxGrid.brickIndex));
+
+    return retVal;
+
+} /* End function GenCXMesh */
+
+
+/**
+ * Puts each vertex of the given GLData in the cluster of the vertices
+ * in the same voxel of the given grid, noting the number of its
+ * cluster in 'vertClusters'. Each cluster is placed at the average of
+ * the positions of its vertices, in 'clusterPts'. Returns the number
+ * of clusters.
+ */
+Uint32 ClusterVerts(
+    GLData *glData, VoxGrid *voxGrid,
+    Uint32 *vertClusters, GLdouble *clusterPts
+)
+{
+    GridIndex voxIndex;
+    Uint32 *clusterSizes;
+    Uint32 numClusters;
+    Uint32 i, j;
+
+    clusterSizes = (Uint32 *)( calloc(
+	( glData->nVertices + 1), sizeof( Uint32)
+    ));
+
+    if( clusterSizes == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    InitGridIndex( &voxIndex);
+
+    for( i = 0U; i < glData->nVertices; i++)
+    {
+	const GLfloat *aVert = GLD_VERT_COORDS( glData, i);
+	Sint32 aVox[3];
+	Uint32 clusterNum;
+
+	for( j = 0U; j < 3U; j++)
+	{
+	    aVox[j] = (Sint32 )floor(
+		( aVert[j] - voxGrid->origin[j]) / voxGrid->voxelSize
+	    );
+
+	} /* End for */
+
+	clusterNum = FindGridPoint( &voxIndex, aVox, GL_TRUE);
+	vertClusters[i] = clusterNum;
+
+	if( clusterSizes[clusterNum] == 0U)
+	{
+	    clusterPts[3 * clusterNum + 0] = 0.0;
+	    clusterPts[3 * clusterNum + 1] = 0.0;
+	    clusterPts[3 * clusterNum + 2] = 0.0;
+
+	} /* End if */
+
+	clusterPts[3 * clusterNum + 0] += aVert[0];
+	clusterPts[3 * clusterNum + 1] += aVert[1];
+	clusterPts[3 * clusterNum + 2] += aVert[2];
+	clusterSizes[clusterNum]++;
+
+    } /* End for */
+
+    numClusters = voxIndex.numPts;
+
+    for( i = 0U; i < numClusters; i++)
+    {
+	clusterPts[3 * i + 0] /= clusterSizes[i];
+	clusterPts[3 * i + 1] /= clusterSizes[i];
+	clusterPts[3 * i + 2] /= clusterSizes[i];
+
+    } /* End for */
+
+    FreeGridIndex( &voxIndex);
+    free( clusterSizes);
+
+    return numClusters;
+
+} /* End function ClusterVerts */
+
+
+/**
+ * Puts the triangles of the given GLData that still have three
+ * different clusters of vertices into 'keptTris' (as triads of the
+ * numbers of the clusters), dropping those that repeat another one
+ * kept (with either facing). The voxels of the given grid touched by
+ * each triangle that has collapsed into a line or a point, but not by
+ * any triangle kept (at the given positions of the clusters), are
+ * marked. Returns the number of triangles kept.
+ */
+Uint32 SimplifyTris(
+    GLData *glData, VoxGrid *voxGrid,
+    const Uint32 *vertClusters, const GLdouble *clusterPts, Uint32 *keptTris
+)
+{
+    GridIndex triIndex;
+    Uint32 numKept = 0U;
+    Uint32 i, j, k;
+
+    InitGridIndex( &triIndex);
+
+    for( i = 0U; i < glData->nMaps; i++)
+    {
+	for( j = 0U; j < glData->mapTriNums[i]; j++)
+	{
+	    const Uint16 *vIndices = glData->triFaces[i] + 3 * j;
+	    GLdouble triPts[3][3];
+	    Uint32 triClusters[3];
+	    Sint32 sortedClusters[3];
+	    Uint32 numTriSeen;
+
+	    for( k = 0U; k < 3U; k++)
+	    {
+		const GLfloat *aVert = GLD_VERT_COORDS( glData, vIndices[k]);
+
+		triPts[k][0] = aVert[0];
+		triPts[k][1] = aVert[1];
+		triPts[k][2] = aVert[2];
+		triClusters[k] = vertClusters[vIndices[k]];
+
+	    } /* End for */
+
+	    if( ( triClusters[0] == triClusters[1]) ||
+		( triClusters[1] == triClusters[2]) ||
+		( triClusters[2] == triClusters[0])
+	    )
+	    {
+		MarkTriVoxels( voxGrid, triPts, GL_TRUE);
+		continue;
+
+	    } /* End if */
+
+	    /* Find the triangle in the index of those kept, with its
+	     * clusters in order so that it is found whichever way it
+	     * faces
+	     */
+	    for( k = 0U; k < 3U; k++)
+	    {
+		sortedClusters[k] = (Sint32 )triClusters[k];
+
+	    } /* End for */
+
+	    for( k = 1U; k < 3U; k++)
+	    {
+		Uint32 m = k;
+
+		while( ( m > 0U) &&
+		    ( sortedClusters[m - 1U] > sortedClusters[m])
+		)
+		{
+		    Sint32 tmpCluster = sortedClusters[m];
+
+		    sortedClusters[m] = sortedClusters[m - 1U];
+		    sortedClusters[m - 1U] = tmpCluster;
+		    m--;
+
+		} /* End while */
+
+	    } /* End for */
+
+	    numTriSeen = triIndex.numPts;
+	    FindGridPoint( &triIndex, sortedClusters, GL_TRUE);
+
+	    if( triIndex.numPts > numTriSeen)
+	    {
+		keptTris[3 * numKept + 0] = triClusters[0];
+		keptTris[3 * numKept + 1] = triClusters[1];
+		keptTris[3 * numKept + 2] = triClusters[2];
+		numKept++;
+
+	    } /* End if */
+
+	} /* End for */
+
+    } /* End for */
+
+    FreeGridIndex( &triIndex);
+
+    /* The collapsed triangles are left with the voxels that none of the
+     * triangles kept pass through (those of thin features that have
+     * collapsed as a whole, rather than of detail on a surface that has
+     * been kept)
+     */
+    for( i = 0U; ( i < numKept) && ( voxGrid->brickIndex.numPts > 0U); i++)
+    {
+	GLdouble keptPts[3][3];
+
+	for( k = 0U; k < 3U; k++)
+	{
+	    const GLdouble *clusterPt = clusterPts + 3 * keptTris[3 * i + k];
+
+	    keptPts[k][0] = clusterPt[0];
+	    keptPts[k][1] = clusterPt[1];
+	    keptPts[k][2] = clusterPt[2];
+
+	} /* End for */
+
+	MarkTriVoxels( voxGrid, keptPts, GL_FALSE);
+
+    } /* End for */
+
+    return numKept;
+
+} /* End function SimplifyTris */
+
+
+/**
+ * Sets up an empty index of grid points.
+ */
+void InitGridIndex( GridIndex *anIndex)
+{
+    Uint32 i;
+
+    anIndex->numPts = 0U;
+    anIndex->maxPts = 1024U;
+    anIndex->hashSize = 2048U;
+
+    anIndex->gridPts = (Sint32 *)( malloc(
+	3 * anIndex->maxPts * sizeof( Sint32)
+    ));
+    anIndex->ptSlots = (Uint32 *)( malloc(
+	anIndex->hashSize * sizeof( Uint32)
+    ));
+
+    if( ( anIndex->gridPts == NULL) || ( anIndex->ptSlots == NULL))
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( i = 0U; i < anIndex->hashSize; i++)
+    {
+	anIndex->ptSlots[i] = CXGEN_NONE;
+
+    } /* End for */
+
+} /* End function InitGridIndex */
+
+
+/**
+ * Frees the space taken by an index of grid points.
+ */
+void FreeGridIndex( GridIndex *anIndex)
+{
+    free( anIndex->gridPts);
+    anIndex->gridPts = NULL;
+
+    free( anIndex->ptSlots);
+    anIndex->ptSlots = NULL;
+
+    anIndex->numPts = 0U;
+    anIndex->maxPts = 0U;
+    anIndex->hashSize = 0U;
+
+} /* End function FreeGridIndex */
+
+
+/**
+ * Returns the number of the given point in the given index. If it is
+ * not in the index, it is added to it if 'canAdd' is GL_TRUE,
+ * otherwise CXGEN_NONE is returned.
+ */
+Uint32 FindGridPoint(
+    GridIndex *anIndex, const Sint32 aPt[3], GLboolean canAdd
+)
+{
+    Uint32 slotNum = HashGridPoint( aPt, anIndex->hashSize);
+    Uint32 ptNum;
+
+    while( ( ptNum = anIndex->ptSlots[slotNum]) != CXGEN_NONE)
+    {
+	const Sint32 *slotPt = anIndex->gridPts + 3 * ptNum;
+
+	if( ( slotPt[0] == aPt[0]) &&
+	    ( slotPt[1] == aPt[1]) &&
+	    ( slotPt[2] == aPt[2])
+	)
+	{
+	    return ptNum;
+
+	} /* End if */
+
+	slotNum = ( slotNum + 1U) & ( anIndex->hashSize - 1U);
+
+    } /* End while */
+
+    if( canAdd == GL_FALSE)
+    {
+	return CXGEN_NONE;
+
+    } /* End if */
+
+
+    /* Add the point */
+    if( anIndex->numPts == anIndex->maxPts)
+    {
+	anIndex->maxPts *= 2U;
+	anIndex->gridPts = (Sint32 *)( realloc(
+	    anIndex->gridPts, 3 * anIndex->maxPts * sizeof( Sint32)
+	));
+
+	if( anIndex->gridPts == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+    } /* End if */
+
+    ptNum = anIndex->numPts++;
+    anIndex->gridPts[3 * ptNum + 0] = aPt[0];
+    anIndex->gridPts[3 * ptNum + 1] = aPt[1];
+    anIndex->gridPts[3 * ptNum + 2] = aPt[2];
+    anIndex->ptSlots[slotNum] = ptNum;
+
+    /* Keep the hash table at most half full */
+    if( 2U * anIndex->numPts > anIndex->hashSize)
+    {
+	Uint32 i;
+
+	free( anIndex->ptSlots);
+
+	anIndex->hashSize *= 2U;
+	anIndex->ptSlots = (Uint32 *)( malloc(
+	    anIndex->hashSize * sizeof( Uint32)
+	));
+
+	if( anIndex->ptSlots == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	for( i = 0U; i < anIndex->hashSize; i++)
+	{
+	    anIndex->ptSlots[i] = CXGEN_NONE;
+
+	} /* End for */
+
+	for( i = 0U; i < anIndex->numPts; i++)
+	{
+	    slotNum = HashGridPoint(
+		anIndex->gridPts + 3 * i, anIndex->hashSize
+	    );
+
+	    while( anIndex->ptSlots[slotNum] != CXGEN_NONE)
+	    {
+		slotNum = ( slotNum + 1U) & ( anIndex->hashSize - 1U);
+
+	    } /* End while */
+
+	    anIndex->ptSlots[slotNum] = i;
+
+	} /* End for */
+
+    } /* End if */
+
+    return ptNum;
+
+} /* End function FindGridPoint */
+
+
+/**
+ * Returns the slot of the given hash table size at which to start
+ * looking for the given point.
+ */
+Uint32 HashGridPoint( const Sint32 aPt[3], Uint32 hashSize)
+{
+    Uint32 hashVal;
+
+    hashVal = (Uint32 )aPt[0] * 73856093U;
+    hashVal ^= (Uint32 )aPt[1] * 19349663U;
+    hashVal ^= (Uint32 )aPt[2] * 83492791U;
+    hashVal ^= ( hashVal >> 16);
+
+    return ( hashVal & ( hashSize - 1U));
+
+} /* End function HashGridPoint */
+
+
+/**
+ * Returns the rows of voxels of the brick at the given position. If
+ * there is no such brick, an empty brick is added if 'canAdd' is
+ * GL_TRUE, otherwise NULL is returned.
+ */
+Uint8 *GetBrickRows(
+    VoxGrid *voxGrid, const Sint32 brickPos[3], GLboolean canAdd
+)
+{
+    Uint32 numBricks = voxGrid->brickIndex.numPts;
+    Uint32 brickNum;
+
+    brickNum = FindGridPoint( &( voxGrid->brickIndex), brickPos, canAdd);
+    if( brickNum == CXGEN_NONE)
+    {
+	return NULL;
+
+    } /* End if */
+
+    /* A brick just added has no voxels marked yet */
+    if( voxGrid->brickIndex.numPts > numBricks)
+    {
+	if( brickNum >= voxGrid->maxBricks)
+	{
+	    voxGrid->maxBricks = voxGrid->brickIndex.maxPts;
+	    voxGrid->brickRows = (Uint8 *)( realloc(
+		voxGrid->brickRows, voxGrid->maxBricks * BRICK_ROWS
+	    ));
+
+	    if( voxGrid->brickRows == NULL)
+	    {
+		fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+		exit( EXIT_FAILURE);
+
+	    } /* End if */
+
+	} /* End if */
+
+	memset( voxGrid->brickRows + brickNum * BRICK_ROWS, 0, BRICK_ROWS);
+
+    } /* End if */
+
+    return ( voxGrid->brickRows + brickNum * BRICK_ROWS);
+
+} /* End function GetBrickRows */
+
+
+/**
+ * Marks the voxels of the given grid touched by the given triangle if
+ * 'toMark' is GL_TRUE, otherwise unmarks them (in just the bricks that
+ * the grid already has).
+ */
+void MarkTriVoxels(
+    VoxGrid *voxGrid, const GLdouble triPts[3][3], GLboolean toMark
+)
+{
+    GLdouble gridPts[3][3];
+    Sint32 minVox[3], maxVox[3];
+    Sint32 brickPos[3];
+    int i, j;
+
+    /* Work in units of voxels from the origin of the grid, and find
+     * the voxels within the bounding box of the triangle
+     */
+    for( j = 0; j < 3; j++)
+    {
+	GLdouble minOrd, maxOrd;
+
+	for( i = 0; i < 3; i++)
+	{
+	    gridPts[i][j] =
+		( triPts[i][j] - voxGrid->origin[j]) / voxGrid->voxelSize;
+
+	} /* End for */
+
+	minOrd = gridPts[0][j];
+	maxOrd = gridPts[0][j];
+
+	for( i = 1; i < 3; i++)
+	{
+	    minOrd = ( gridPts[i][j] < minOrd) ? gridPts[i][j] : minOrd;
+	    maxOrd = ( gridPts[i][j] > maxOrd) ? gridPts[i][j] : maxOrd;
+
+	} /* End for */
+
+	minVox[j] = (Sint32 )floor( minOrd - CXGEN_BOX_SLACK);
+	maxVox[j] = (Sint32 )floor( maxOrd + CXGEN_BOX_SLACK);
+
+    } /* End for */
+
+    for( brickPos[2] = ( minVox[2] >> BRICK_SHIFT);
+	brickPos[2] <= ( maxVox[2] >> BRICK_SHIFT);
+	brickPos[2]++
+    )
+    {
+	for( brickPos[1] = ( minVox[1] >> BRICK_SHIFT);
+	    brickPos[1] <= ( maxVox[1] >> BRICK_SHIFT);
+	    brickPos[1]++
+	)
+	{
+	    for( brickPos[0] = ( minVox[0] >> BRICK_SHIFT);
+		brickPos[0] <= ( maxVox[0] >> BRICK_SHIFT);
+		brickPos[0]++
+	    )
+	    {
+		MarkBrickVoxels(
+		    voxGrid, brickPos, gridPts, minVox, maxVox, toMark
+		);
+
+	    } /* End for */
+
+	} /* End for */
+
+    } /* End for */
+
+} /* End function MarkTriVoxels */
+
+
+/**
+ * Marks (or unmarks, if 'toMark' is GL_FALSE) the voxels of the brick
+ * at the given position, from 'minVox' to 'maxVox', touched by the
+ * given triangle (in units of voxels from the origin of the grid).
+ */
+void MarkBrickVoxels(
+    VoxGrid *voxGrid, const Sint32 brickPos[3],
+    const GLdouble gridPts[3][3],
+    const Sint32 minVox[3], const Sint32 maxVox[3], GLboolean toMark
+)
+{
+    GLdouble boxPts[3][3];
+    Sint32 fromVox[3], toVox[3], aVox[3];
+    Uint8 *brickRows;
+    int i, j;
+
+    brickRows = GetBrickRows( voxGrid, brickPos, GL_FALSE);
+    if( ( brickRows == NULL) && ( toMark == GL_FALSE))
+    {
+	return;
+
+    } /* End if */
+
+    for( j = 0; j < 3; j++)
+    {
+	fromVox[j] = brickPos[j] << BRICK_SHIFT;
+	toVox[j] = fromVox[j] + ( BRICK_DIM - 1);
+
+	fromVox[j] = ( minVox[j] > fromVox[j]) ? minVox[j] : fromVox[j];
+	toVox[j] = ( maxVox[j] < toVox[j]) ? maxVox[j] : toVox[j];
+
+    } /* End for */
+
+    for( aVox[2] = fromVox[2]; aVox[2] <= toVox[2]; aVox[2]++)
+    {
+	for( aVox[1] = fromVox[1]; aVox[1] <= toVox[1]; aVox[1]++)
+	{
+	    for( aVox[0] = fromVox[0]; aVox[0] <= toVox[0]; aVox[0]++)
+	    {
+		Uint8 rowBit = (Uint8 )( 1U << ( aVox[0] & ( BRICK_DIM - 1)));
+		int rowNum =
+		    ( aVox[2] & ( BRICK_DIM - 1)) * BRICK_DIM +
+		    ( aVox[1] & ( BRICK_DIM - 1));
+		GLboolean isMarked =
+		    ( ( brickRows != NULL) &&
+		      ( ( brickRows[rowNum] & rowBit) != 0U)
+		    ) ? GL_TRUE : GL_FALSE;
+
+		if( isMarked == toMark)
+		{
+		    continue;
+
+		} /* End if */
+
+		/* Put the centre of the voxel at the origin */
+		for( i = 0; i < 3; i++)
+		{
+		    for( j = 0; j < 3; j++)
+		    {
+			boxPts[i][j] = gridPts[i][j] - ( aVox[j] + 0.5);
+
+		    } /* End for */
+
+		} /* End for */
+
+		if( TriTouchesBox( boxPts, 0.5 + CXGEN_BOX_SLACK) == GL_FALSE)
+		{
+		    continue;
+
+		} /* End if */
+
+		if( toMark == GL_TRUE)
+		{
+		    if( brickRows == NULL)
+		    {
+			brickRows = GetBrickRows( voxGrid, brickPos, GL_TRUE);
+
+		    } /* End if */
+
+		    brickRows[rowNum] |= rowBit;
+
+		} /* End if */
+		else
+		{
+		    brickRows[rowNum] &= (Uint8 )~rowBit;
+
+		} /* End else */
+
+	    } /* End for */
+
+	} /* End for */
+
+    } /* End for */
+
+} /* End function MarkBrickVoxels */
+
+
+/**
+ * Returns GL_TRUE if the given triangle touches the axis-aligned box
+ * centred at the origin, with the given half of the length of its
+ * edges. This is the test by Tomas Akenine-Moller ("Fast 3D
+ * Triangle-Box Overlap Testing") - the two do not touch only if their
+ * projections on one of the axes of the box, the normal of the
+ * triangle, or the cross products of the axes of the box and the edges
+ * of the triangle do not overlap.
+ */
+GLboolean TriTouchesBox( const GLdouble triPts[3][3], GLdouble halfSize)
+{
+    GLdouble triEdges[3][3];
+    GLdouble anAxis[3];
+    int i, j;
+
+    /* The axes of the box */
+    for( i = 0; i < 3; i++)
+    {
+	anAxis[0] = ( i == 0) ? 1.0 : 0.0;
+	anAxis[1] = ( i == 1) ? 1.0 : 0.0;
+	anAxis[2] = ( i == 2) ? 1.0 : 0.0;
+
+	if( IsSeparatingAxis( anAxis, triPts, halfSize) == GL_TRUE)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+    } /* End for */
+
+    for( i = 0; i < 3; i++)
+    {
+	for( j = 0; j < 3; j++)
+	{
+	    triEdges[i][j] = triPts[( i + 1) % 3][j] - triPts[i][j];
+
+	} /* End for */
+
+    } /* End for */
+
+    /* The normal of the triangle */
+    anAxis[0] =
+	triEdges[0][1] * triEdges[1][2] - triEdges[0][2] * triEdges[1][1];
+    anAxis[1] =
+	triEdges[0][2] * triEdges[1][0] - triEdges[0][0] * triEdges[1][2];
+    anAxis[2] =
+	triEdges[0][0] * triEdges[1][1] - triEdges[0][1] * triEdges[1][0];
+
+    if( IsSeparatingAxis( anAxis, triPts, halfSize) == GL_TRUE)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    /* The cross products of the axes of the box and the edges */
+    for( i = 0; i < 3; i++)
+    {
+	for( j = 0; j < 3; j++)
+	{
+	    int nextOrd = ( j + 1) % 3;
+	    int lastOrd = ( j + 2) % 3;
+
+	    anAxis[j] = 0.0;
+	    anAxis[nextOrd] = -triEdges[i][lastOrd];
+	    anAxis[lastOrd] = triEdges[i][nextOrd];
+
+	    if( IsSeparatingAxis( anAxis, triPts, halfSize) == GL_TRUE)
+	    {
+		return GL_FALSE;
+
+	    } /* End if */
+
+	} /* End for */
+
+    } /* End for */
+
+    return GL_TRUE;
+
+} /* End function TriTouchesBox */
+
+
+/**
+ * Returns GL_TRUE if the projections of the given triangle and of the
+ * box centred at the origin with the given half edge on the given axis
+ * do not overlap.
+ */
+GLboolean IsSeparatingAxis(
+    const GLdouble anAxis[3], const GLdouble triPts[3][3], GLdouble halfSize
+)
+{
+    GLdouble minProj, maxProj, boxRadius;
+    int i;
+
+    minProj = maxProj =
+	anAxis[0] * triPts[0][0] +
+	anAxis[1] * triPts[0][1] +
+	anAxis[2] * triPts[0][2];
+
+    for( i = 1; i < 3; i++)
+    {
+	GLdouble aProj =
+	    anAxis[0] * triPts[i][0] +
+	    anAxis[1] * triPts[i][1] +
+	    anAxis[2] * triPts[i][2];
+
+	minProj = ( aProj < minProj) ? aProj : minProj;
+	maxProj = ( aProj > maxProj) ? aProj : maxProj;
+
+    } /* End for */
+
+    boxRadius = halfSize *
+	( fabs( anAxis[0]) + fabs( anAxis[1]) + fabs( anAxis[2]));
+
+    return ( ( minProj > boxRadius) || ( maxProj < -boxRadius)) ?
+	GL_TRUE : GL_FALSE;
+
+} /* End function IsSeparatingAxis */
+
+
+/**
+ * Adds the exposed faces of the marked voxels of the given brick -
+ * those against voxels that are not marked - to the given list, as
+ * rectangles of faces.
+ */
+void AddBrickFaces( VoxGrid *voxGrid, Uint32 brickNum, CXRectList *rectList)
+{
+    /* The voxels of the brick and of the layer of voxels around it in
+     * the bricks on each side, indexed by (z,y,x) from the layer
+     */
+    Uint8 isMarked[BRICK_DIM + 2][BRICK_DIM + 2][BRICK_DIM + 2];
+
+    const Uint8 *brickRows = voxGrid->brickRows + brickNum * BRICK_ROWS;
+    const Sint32 *brickPos = voxGrid->brickIndex.gridPts + 3 * brickNum;
+    Uint8 faceMask[BRICK_DIM];
+    int axis, facesUp, slice, i, j;
+    int aVox[3], toVox[3];
+
+    memset( isMarked, 0, sizeof( isMarked));
+
+    for( aVox[2] = 0; aVox[2] < BRICK_DIM; aVox[2]++)
+    {
+	for( aVox[1] = 0; aVox[1] < BRICK_DIM; aVox[1]++)
+	{
+	    for( aVox[0] = 0; aVox[0] < BRICK_DIM; aVox[0]++)
+	    {
+		isMarked[aVox[2] + 1][aVox[1] + 1][aVox[0] + 1] =
+		    VOXEL_MARKED( brickRows, aVox[0], aVox[1], aVox[2]);
+
+	    } /* End for */
+
+	} /* End for */
+
+    } /* End for */
+
+    /* The layers of voxels on the six sides of the brick */
+    for( axis = 0; axis < 3; axis++)
+    {
+	int uAxis = ( axis + 1) % 3;
+	int vAxis = ( axis + 2) % 3;
+
+	for( facesUp = 0; facesUp < 2; facesUp++)
+	{
+	    const Uint8 *nbrRows;
+	    Sint32 nbrPos[3];
+
+	    nbrPos[0] = brickPos[0];
+	    nbrPos[1] = brickPos[1];
+	    nbrPos[2] = brickPos[2];
+	    nbrPos[axis] += ( facesUp == 1) ? 1 : -1;
+
+	    nbrRows = GetBrickRows( voxGrid, nbrPos, GL_FALSE);
+	    if( nbrRows == NULL)
+	    {
+		continue;
+
+	    } /* End if */
+
+	    for( j = 0; j < BRICK_DIM; j++)
+	    {
+		for( i = 0; i < BRICK_DIM; i++)
+		{
+		    aVox[axis] = ( facesUp == 1) ? 0 : ( BRICK_DIM - 1);
+		    aVox[uAxis] = i;
+		    aVox[vAxis] = j;
+
+		    toVox[axis] = ( facesUp == 1) ? ( BRICK_DIM + 1) : 0;
+		    toVox[uAxis] = i + 1;
+		    toVox[vAxis] = j + 1;
+
+		    isMarked[toVox[2]][toVox[1]][toVox[0]] =
+			VOXEL_MARKED( nbrRows, aVox[0], aVox[1], aVox[2]);
+
+		} /* End for */
+
+	    } /* End for */
+
+	} /* End for */
+
+    } /* End for */
+
+
+    /* Find the exposed faces in each slice of the brick across each
+     * axis, facing either way
+     */
+    for( axis = 0; axis < 3; axis++)
+    {
+	int uAxis = ( axis + 1) % 3;
+	int vAxis = ( axis + 2) % 3;
+
+	for( facesUp = 0; facesUp < 2; facesUp++)
+	{
+	    for( slice = 0; slice < BRICK_DIM; slice++)
+	    {
+		for( j = 0; j < BRICK_DIM; j++)
+		{
+		    faceMask[j] = 0U;
+
+		    for( i = 0; i < BRICK_DIM; i++)
+		    {
+			aVox[axis] = slice + 1;
+			aVox[uAxis] = i + 1;
+			aVox[vAxis] = j + 1;
+
+			toVox[0] = aVox[0];
+			toVox[1] = aVox[1];
+			toVox[2] = aVox[2];
+			toVox[axis] += ( facesUp == 1) ? 1 : -1;
+
+			if( ( isMarked[aVox[2]][aVox[1]][aVox[0]] != 0U) &&
+			    ( isMarked[toVox[2]][toVox[1]][toVox[0]] == 0U)
+			)
+			{
+			    faceMask[j] |= (Uint8 )( 1U << i);
+
+			} /* End if */
+
+		    } /* End for */
+
+		} /* End for */
+
+		AddFaceRects(
+		    rectList, brickPos, axis, facesUp, slice, faceMask
+		);
+
+	    } /* End for */
+
+	} /* End for */
+
+    } /* End for */
+
+} /* End function AddBrickFaces */
+
+
+/**
+ * Adds the exposed faces in the given slice of the brick at the given
+ * position to the given list, as rectangles of faces. Bit 'i' of
+ * 'faceMask[j]' is set if the face at (i,j) along the axes after the
+ * given one is exposed. Each rectangle is grown as far as it can be
+ * along the first of these axes, then along the second.
+ */
+void AddFaceRects(
+    CXRectList *rectList, const Sint32 brickPos[3],
+    int axis, int facesUp, int slice, Uint8 faceMask[BRICK_DIM]
+)
+{
+    int uAxis = ( axis + 1) % 3;
+    int vAxis = ( axis + 2) % 3;
+    CXRect aRect;
+    int j;
+
+    aRect.axis = (Uint8 )axis;
+    aRect.facesUp = (Uint8 )facesUp;
+    aRect.plane = ( brickPos[axis] << BRICK_SHIFT) + slice + facesUp;
+
+    for( j = 0; j < BRICK_DIM; j++)
+    {
+	while( faceMask[j] != 0U)
+	{
+	    int uStart = 0;
+	    int uEnd, vEnd;
+	    Uint8 runMask;
+
+	    while( ( ( faceMask[j] >> uStart) & 1U) == 0U)
+	    {
+		uStart++;
+
+	    } /* End while */
+
+	    uEnd = uStart;
+	    while( ( uEnd < BRICK_DIM) &&
+		( ( ( faceMask[j] >> uEnd) & 1U) != 0U)
+	    )
+	    {
+		uEnd++;
+
+	    } /* End while */
+
+	    runMask = (Uint8 )( ( ( 1U << ( uEnd - uStart)) - 1U) << uStart);
+
+	    vEnd = j + 1;
+	    while( ( vEnd < BRICK_DIM) &&
+		( ( faceMask[vEnd] & runMask) == runMask)
+	    )
+	    {
+		faceMask[vEnd] &= (Uint8 )~runMask;
+		vEnd++;
+
+	    } /* End while */
+
+	    faceMask[j] &= (Uint8 )~runMask;
+
+	    aRect.uMin = ( brickPos[uAxis] << BRICK_SHIFT) + uStart;
+	    aRect.uMax = ( brickPos[uAxis] << BRICK_SHIFT) + uEnd;
+	    aRect.vMin = ( brickPos[vAxis] << BRICK_SHIFT) + j;
+	    aRect.vMax = ( brickPos[vAxis] << BRICK_SHIFT) + vEnd;
+
+	    AddRect( rectList, &aRect);
+
+	} /* End while */
+
+    } /* End for */
+
+} /* End function AddFaceRects */
+
+
+/**
+ * Adds the given rectangle to the given list.
+ */
+void AddRect( CXRectList *rectList, const CXRect *aRect)
+{
+    if( rectList->numRects == rectList->maxRects)
+    {
+	rectList->maxRects =
+	    ( rectList->maxRects == 0U) ? 1024U : ( 2U * rectList->maxRects);
+
+	rectList->rects = (CXRect *)( realloc(
+	    rectList->rects, rectList->maxRects * sizeof( CXRect)
+	));
+
+	if( rectList->rects == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+    } /* End if */
+
+    rectList->rects[rectList->numRects++] = *aRect;
+
+} /* End function AddRect */
+
+
+/**
+ * Merges each rectangle of the given list with the next one along the
+ * first of the axes after its own (if 'alongU' is GL_TRUE) or along
+ * the second one, where the two are on the same side of the same plane
+ * and together make a rectangle. Returns the number of rectangles
+ * merged away.
+ */
+Uint32 MergeRects( CXRectList *rectList, GLboolean alongU)
+{
+    CXRect *rects = rectList->rects;
+    Uint32 numLeft = 0U;
+    Uint32 i;
+
+    if( rectList->numRects == 0U)
+    {
+	return 0U;
+
+    } /* End if */
+
+    /* Rectangles that could be merged are next to each other, once
+     * they are sorted on their plane and their extent across the axis
+     * to merge along, then on where they start along it
+     */
+    qsort(
+	rects, rectList->numRects, sizeof( CXRect),
+	( alongU == GL_TRUE) ? CompareRectsAlongU : CompareRectsAlongV
+    );
+
+    for( i = 1U; i < rectList->numRects; i++)
+    {
+	CXRect *lastRect = rects + numLeft;
+	CXRect *aRect = rects + i;
+
+	GLboolean canMerge =
+	    ( ( lastRect->axis == aRect->axis) &&
+	      ( lastRect->facesUp == aRect->facesUp) &&
+	      ( lastRect->plane == aRect->plane)
+	    ) ? GL_TRUE : GL_FALSE;
+
+	if( ( canMerge == GL_TRUE) && ( alongU == GL_TRUE) &&
+	    ( lastRect->vMin == aRect->vMin) &&
+	    ( lastRect->vMax == aRect->vMax) &&
+	    ( lastRect->uMax == aRect->uMin)
+	)
+	{
+	    lastRect->uMax = aRect->uMax;
+
+	} /* End if */
+	else if( ( canMerge == GL_TRUE) && ( alongU == GL_FALSE) &&
+	    ( lastRect->uMin == aRect->uMin) &&
+	    ( lastRect->uMax == aRect->uMax) &&
+	    ( lastRect->vMax == aRect->vMin)
+	)
+	{
+	    lastRect->vMax = aRect->vMax;
+
+	} /* End else-if */
+	else
+	{
+	    numLeft++;
+	    rects[numLeft] = *aRect;
+
+	} /* End else */
+
+    } /* End for */
+
+    numLeft++;
+
+    i = rectList->numRects - numLeft;
+    rectList->numRects = numLeft;
+
+    return i;
+
+} /* End function MergeRects */
+
+
+/**
+ * Compares two rectangles on their axis, facing, plane, 'vMin',
+ * 'vMax' and 'uMin' (in that order), for qsort( ).
+ */
+int CompareRectsAlongU( const void *rect1, const void *rect2)
+{
+    const CXRect *aRect = (const CXRect *)rect1;
+    const CXRect *bRect = (const CXRect *)rect2;
+    Sint32 keyDiff;
+
+    keyDiff = ( aRect->axis != bRect->axis) ?
+	( aRect->axis - bRect->axis) : ( aRect->facesUp - bRect->facesUp);
+
+    if( keyDiff == 0)
+    {
+	keyDiff = ( aRect->plane != bRect->plane) ?
+	    ( ( aRect->plane < bRect->plane) ? -1 : 1) : 0;
+
+    } /* End if */
+
+    if( keyDiff == 0)
+    {
+	keyDiff = ( aRect->vMin != bRect->vMin) ?
+	    ( ( aRect->vMin < bRect->vMin) ? -1 : 1) : 0;
+
+    } /* End if */
+
+    if( keyDiff == 0)
+    {
+	keyDiff = ( aRect->vMax != bRect->vMax) ?
+	    ( ( aRect->vMax < bRect->vMax) ? -1 : 1) : 0;
+
+    } /* End if */
+
+    if( keyDiff == 0)
+    {
+	keyDiff = ( aRect->uMin != bRect->uMin) ?
+	    ( ( aRect->uMin < bRect->uMin) ? -1 : 1) : 0;
+
+    } /* End if */
+
+    return (int )keyDiff;
+
+} /* End function CompareRectsAlongU */
+
+
+/**
+ * Compares two rectangles on their axis, facing, plane, 'uMin',
+ * 'uMax' and 'vMin' (in that order), for qsort( ).
+ */
+int CompareRectsAlongV( const void *rect1, const void *rect2)
+{
+    const CXRect *aRect = (const CXRect *)rect1;
+    const CXRect *bRect = (const CXRect *)rect2;
+    Sint32 keyDiff;
+
+    keyDiff = ( aRect->axis != bRect->axis) ?
+	( aRect->axis - bRect->axis) : ( aRect->facesUp - bRect->facesUp);
+
+    if( keyDiff == 0)
+    {
+	keyDiff = ( aRect->plane != bRect->plane) ?
+	    ( ( aRect->plane < bRect->plane) ? -1 : 1) : 0;
+
+    } /* End if */
+
+    if( keyDiff == 0)
+    {
+	keyDiff = ( aRect->uMin != bRect->uMin) ?
+	    ( ( aRect->uMin < bRect->uMin) ? -1 : 1) : 0;
+
+    } /* End if */
+
+    if( keyDiff == 0)
+    {
+	keyDiff = ( aRect->uMax != bRect->uMax) ?
+	    ( ( aRect->uMax < bRect->uMax) ? -1 : 1) : 0;
+
+    } /* End if */
+
+    if( keyDiff == 0)
+    {
+	keyDiff = ( aRect->vMin != bRect->vMin) ?
+	    ( ( aRect->vMin < bRect->vMin) ? -1 : 1) : 0;
+
+    } /* End if */
+
+    return (int )keyDiff;
+
+} /* End function CompareRectsAlongV */
+
+
+/**
+ * Makes a collision mesh of the given triangles kept (with vertices at
+ * the given clusters) and of two triangles for each of the given
+ * rectangles of voxel faces, facing the way the rectangle does. Only
+ * the clusters used by the triangles kept become vertices of the mesh,
+ * and the corners of the rectangles at the same point of the given
+ * grid are made the same vertex.
+ */
+CXMesh *MakeCXMesh(
+    VoxGrid *voxGrid, const GLdouble *clusterPts, Uint32 numClusters,
+    const Uint32 *keptTris, Uint32 numKept, CXRectList *rectList
+)
+{
+    CXMesh *retVal;
+    GridIndex cornerIndex;
+    Uint32 *clusterVerts;
+    Uint32 numClusterVerts = 0U;
+    Uint32 i, j;
+
+    /* NOTE: Uses calloc( ) to initialise the contents to 0 */
+    retVal = (CXMesh *)( calloc( 1, sizeof( CXMesh)));
+    clusterVerts = (Uint32 *)( malloc( ( numClusters + 1) * sizeof( Uint32)));
+
+    if( ( retVal != NULL) && ( clusterVerts != NULL))
+    {
+	retVal->numTri = numKept + 2U * rectList->numRects;
+	retVal->triVerts = (Uint32 *)( malloc(
+	    ( 3 * retVal->numTri + 1) * sizeof( Uint32)
+	));
+
+    } /* End if */
+
+    if( ( retVal == NULL) || ( clusterVerts == NULL) ||
+	( retVal->triVerts == NULL)
+    )
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    /* The triangles kept */
+    for( i = 0U; i < numClusters; i++)
+    {
+	clusterVerts[i] = CXGEN_NONE;
+
+    } /* End for */
+
+    for( i = 0U; i < 3U * numKept; i++)
+    {
+	if( clusterVerts[keptTris[i]] == CXGEN_NONE)
+	{
+	    clusterVerts[keptTris[i]] = numClusterVerts++;
+
+	} /* End if */
+
+	retVal->triVerts[i] = clusterVerts[keptTris[i]];
+
+    } /* End for */
+
+    /* The rectangles, with their vertices after those of the clusters */
+    InitGridIndex( &cornerIndex);
+
+    for( i = 0U; i < rectList->numRects; i++)
+    {
+	const CXRect *aRect = rectList->rects + i;
+	int uAxis = ( aRect->axis + 1) % 3;
+	int vAxis = ( aRect->axis + 2) % 3;
+	Uint32 cornerVerts[4];
+	Uint32 *triVerts = retVal->triVerts + 3 * numKept + 6 * i;
+
+	/* The corners, anticlockwise seen from along the axis */
+	for( j = 0U; j < 4U; j++)
+	{
+	    Sint32 aPt[3];
+
+	    aPt[aRect->axis] = aRect->plane;
+	    aPt[uAxis] =
+		( ( j == 1U) || ( j == 2U)) ? aRect->uMax : aRect->uMin;
+	    aPt[vAxis] = ( j >= 2U) ? aRect->vMax : aRect->vMin;
+
+	    cornerVerts[j] = numClusterVerts +
+		FindGridPoint( &cornerIndex, aPt, GL_TRUE);
+
+	} /* End for */
+
+	triVerts[0] = cornerVerts[0];
+	triVerts[3] = cornerVerts[0];
+	triVerts[4] = cornerVerts[2];
+
+	if( aRect->facesUp == 1U)
+	{
+	    triVerts[1] = cornerVerts[1];
+	    triVerts[2] = cornerVerts[2];
+	    triVerts[5] = cornerVerts[3];
+
+	} /* End if */
+	else
+	{
+	    triVerts[1] = cornerVerts[2];
+	    triVerts[2] = cornerVerts[1];
+	    triVerts[4] = cornerVerts[3];
+	    triVerts[5] = cornerVerts[2];
+
+	} /* End else */
+
+    } /* End for */
+
+
+    /* Place the vertices */
+    retVal->numVerts = numClusterVerts + cornerIndex.numPts;
+    retVal->vertCoords = (GLfloat *)( malloc(
+	( 3 * retVal->numVerts + 1) * sizeof( GLfloat)
+    ));
+
+    if( retVal->vertCoords == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( i = 0U; i < numClusters; i++)
+    {
+	if( clusterVerts[i] != CXGEN_NONE)
+	{
+	    GLfloat *aVert = retVal->vertCoords + 3 * clusterVerts[i];
+
+	    aVert[0] = (GLfloat )clusterPts[3 * i + 0];
+	    aVert[1] = (GLfloat )clusterPts[3 * i + 1];
+	    aVert[2] = (GLfloat )clusterPts[3 * i + 2];
+
+	} /* End if */
+
+    } /* End for */
+
+    for( i = 0U; i < 3U * cornerIndex.numPts; i++)
+    {
+	retVal->vertCoords[3 * numClusterVerts + i] = (GLfloat )(
+	    voxGrid->origin[i % 3U] +
+	    cornerIndex.gridPts[i] * voxGrid->voxelSize
+	);
+
+    } /* End for */
+
+    FreeGridIndex( &cornerIndex);
+    free( clusterVerts);
+
+    retVal->minX = retVal->maxX = 0.0F;
+    retVal->minY = retVal->maxY = 0.0F;
+    retVal->minZ = retVal->maxZ = 0.0F;
+
+    if( retVal->numVerts > 0U)
+    {
+	retVal->minX = retVal->maxX = retVal->vertCoords[0];
+	retVal->minY = retVal->maxY = retVal->vertCoords[1];
+	retVal->minZ = retVal->maxZ = retVal->vertCoords[2];
+
+    } /* End if */
+
+    for( i = 1U; i < retVal->numVerts; i++)
+    {
+	const GLfloat *aVert = retVal->vertCoords + 3 * i;
+
+	retVal->minX = ( aVert[0] < retVal->minX) ? aVert[0] : retVal->minX;
+	retVal->maxX = ( aVert[0] > retVal->maxX) ? aVert[0] : retVal->maxX;
+
+	retVal->minY = ( aVert[1] < retVal->minY) ? aVert[1] : retVal->minY;
+	retVal->maxY = ( aVert[1] > retVal->maxY) ? aVert[1] : retVal->maxY;
+
+	retVal->minZ = ( aVert[2] < retVal->minZ) ? aVert[2] : retVal->minZ;
+	retVal->maxZ = ( aVert[2] > retVal->maxZ) ? aVert[2] : retVal->maxZ;
+
+    } /* End for */
+
+    return retVal;
+
+} /* End function MakeCXMesh */
@@ -0,0 +1,65 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * CXGEN.H: Declarations for generating a collision mesh from the
+ * triangles of a render model.
+ */
+
+/**
+ * The collision mesh is generated by:
+ *
+ *   1. putting the vertices of the model into clusters, one for each
+ *      cube ("voxel") of a grid over the model that has any of them,
+ *      placed at the average of their positions - so that vertices
+ *      duplicated just for their texture mappings, or closer together
+ *      than the viewer could ever walk between, become one;
+ *
+ *   2. keeping the triangles that still have three different clusters
+ *      for their vertices, just once each (a wall with a triangle for
+ *      either side is still a single wall for collisions);
+ *
+ *   3. enclosing the parts of the model too thin for the grid (poles,
+ *      railings, finials, etc.), whose triangles have collapsed into
+ *      lines or points, in the surface of the voxels that they touch
+ *      and that no triangle kept passes through, made of as few
+ *      rectangles as can be managed.
+ *
+ * Every triangle of the model is thus within about a voxel of the
+ * collision mesh, and nothing thicker than a voxel can be walked
+ * through. On the other hand, openings narrower than about a voxel are
+ * closed up, so the voxels must be small enough for the doors and
+ * passages of the model to still be walked through.
+ */
+
+#ifndef _CXGEN_H
+#define _CXGEN_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+#include "gld.h"
+#include "cxmesh.h"
+
+
+/* Default edge of the voxels - half of a stride of the viewer through
+ * the models (see "vtaj.c")
+ */
+#define CXGEN_DEF_VOXEL_SIZE 2.5F
+
+
+/* Function Prototypes */
+
+/**
+ * Generates a collision mesh enclosing the triangles of the given
+ * GLData, using voxels with edges of the given size, ready to be used
+ * or saved (see IndexCXMesh( ) in "cxmesh.h").
+ */
+extern CXMesh *GenCXMesh( GLData *glData, GLfloat voxelSize);
+
+#endif    /* _CXGEN_H */
@@ -0,0 +1,548 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * CXMESH.C: Saving and loading collision meshes.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "cxmesh.h"
+
+/* Files are mapped into memory where "mmap( )" is available */
+#if defined( unix) || defined( __unix__) || defined( __APPLE__)
+    #define CX_USE_MMAP
+    #include <sys/types.h>
+    #include <sys/mman.h>
+#endif
+
+
+/* More vertices or triangles than this can only be from a corrupt
+ * file (their arrays would not fit in memory)
+ */
+#define CX_MAX_ITEMS 0x00FFFFFFU
+
+/* Size of the fixed part of a CX file, before the arrays */
+#define CX_HEADER_SIZE 48U
+
+/* Rounds up the given number of bytes to a multiple of CX_ALIGN */
+#define CX_PADDED( numBytes) \
+    ( ( ( numBytes) + ( CX_ALIGN - 1U)) & ~( (size_t )( CX_ALIGN - 1U)))
+
+
+/* Local function prototypes */
+
+static void WritePadded(
+    const void *someData, size_t numBytes, FILE *outFile
+);
+static GLboolean CheckCXMesh( CXMesh *cxMesh);
+
+
+void IndexCXMesh( CXMesh *cxMesh)
+{
+    GLfloat *triBounds, *centroids;
+    Uint32 *triOrder, *sortedVerts;
+    Uint32 i;
+    int k, m;
+
+    free( cxMesh->triPlanes);
+    free( cxMesh->nodes);
+
+    triBounds = (GLfloat *)( malloc(
+	( 6 * cxMesh->numTri + 1) * sizeof( GLfloat)
+    ));
+    centroids = (GLfloat *)( malloc(
+	( 3 * cxMesh->numTri + 1) * sizeof( GLfloat)
+    ));
+    triOrder = (Uint32 *)( malloc( ( cxMesh->numTri + 1) * sizeof( Uint32)));
+    sortedVerts = (Uint32 *)( malloc(
+	( 3 * cxMesh->numTri + 1) * sizeof( Uint32)
+    ));
+    cxMesh->triPlanes = (GLfloat *)( malloc(
+	( 4 * cxMesh->numTri + 1) * sizeof( GLfloat)
+    ));
+
+    if( ( triBounds == NULL) || ( centroids == NULL) ||
+	( triOrder == NULL) || ( sortedVerts == NULL) ||
+	( cxMesh->triPlanes == NULL)
+    )
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+
+    /* Build the BVH over the bounds of the triangles */
+    for( i = 0U; i < cxMesh->numTri; i++)
+    {
+	GLfloat *bbMin = triBounds + 6 * i;
+	GLfloat *bbMax = bbMin + 3;
+
+	for( m = 0; m < 3; m++)
+	{
+	    bbMin[m] = +FLT_MAX;
+	    bbMax[m] = -FLT_MAX;
+	    centroids[3 * i + m] = 0.0F;
+
+	    for( k = 0; k < 3; k++)
+	    {
+		GLfloat aCoord =
+		    cxMesh->vertCoords[3 * cxMesh->triVerts[3 * i + k] + m];
+
+		bbMin[m] = ( aCoord < bbMin[m]) ? aCoord : bbMin[m];
+		bbMax[m] = ( aCoord > bbMax[m]) ? aCoord : bbMax[m];
+		centroids[3 * i + m] += aCoord / 3.0F;
+
+	    } /* End for */
+
+	} /* End for */
+
+    } /* End for */
+
+    cxMesh->nodes = GenBVHNodes(
+	cxMesh->numTri, triBounds, centroids, triOrder, &( cxMesh->numNodes)
+    );
+
+
+    /* Put the triangles in the order of the leaves, and work out
+     * their planes
+     */
+    for( i = 0U; i < cxMesh->numTri; i++)
+    {
+	GLdouble triPts[3][3], triNormal[3];
+	GLdouble edge1[3], edge2[3];
+	GLdouble normalMag;
+	GLfloat *aPlane = cxMesh->triPlanes + 4 * i;
+
+	for( k = 0; k < 3; k++)
+	{
+	    sortedVerts[3 * i + k] = cxMesh->triVerts[3 * triOrder[i] + k];
+
+	    for( m = 0; m < 3; m++)
+	    {
+		triPts[k][m] =
+		    cxMesh->vertCoords[3 * sortedVerts[3 * i + k] + m];
+
+	    } /* End for */
+
+	} /* End for */
+
+	for( m = 0; m < 3; m++)
+	{
+	    edge1[m] = triPts[1][m] - triPts[0][m];
+	    edge2[m] = triPts[2][m] - triPts[0][m];
+
+	} /* End for */
+
+	triNormal[0] = edge1[1] * edge2[2] - edge1[2] * edge2[1];
+	triNormal[1] = edge1[2] * edge2[0] - edge1[0] * edge2[2];
+	triNormal[2] = edge1[0] * edge2[1] - edge1[1] * edge2[0];
+
+	normalMag = sqrt(
+	    triNormal[0] * triNormal[0] + triNormal[1] * triNormal[1] +
+	    triNormal[2] * triNormal[2]
+	);
+
+	/* (A triangle without an area has no plane, and is never hit.) */
+	if( normalMag > 0.0)
+	{
+	    for( m = 0; m < 3; m++)
+	    {
+		triNormal[m] /= normalMag;
+
+	    } /* End for */
+
+	} /* End if */
+
+	aPlane[0] = (GLfloat )triNormal[0];
+	aPlane[1] = (GLfloat )triNormal[1];
+	aPlane[2] = (GLfloat )triNormal[2];
+	aPlane[3] = (GLfloat )-(
+	    triNormal[0] * triPts[0][0] + triNormal[1] * triPts[0][1] +
+	    triNormal[2] * triPts[0][2]
+	);
+
+    } /* End for */
+
+    free( cxMesh->triVerts);
+    cxMesh->triVerts = sortedVerts;
+
+    free( triOrder);
+    free( centroids);
+    free( triBounds);
+
+} /* End function IndexCXMesh */
+
+
+void SaveCXMesh( CXMesh *cxMesh, FILE *outFile)
+{
+    if( cxMesh != NULL)
+    {
+	Uint8 cxHeader[CX_HEADER_SIZE];
+	Uint8 *headerPos = cxHeader;
+
+	/* Put together the fixed part */
+	memset( cxHeader, 0, sizeof( cxHeader));
+
+	memcpy( headerPos, CX_FILE_MAGIC, sizeof( CX_FILE_MAGIC));
+	headerPos += sizeof( CX_FILE_MAGIC);
+	*headerPos = CX_DATA_VER;
+	headerPos += 4;
+
+	memcpy( headerPos, &( cxMesh->numVerts), sizeof( Uint32));
+	headerPos += sizeof( Uint32);
+	memcpy( headerPos, &( cxMesh->numTri), sizeof( Uint32));
+	headerPos += sizeof( Uint32);
+	memcpy( headerPos, &( cxMesh->numNodes), sizeof( Uint32));
+	headerPos += 2 * sizeof( Uint32);
+
+	memcpy( headerPos, &( cxMesh->minX), sizeof( GLfloat));
+	headerPos += sizeof( GLfloat);
+	memcpy( headerPos, &( cxMesh->maxX), sizeof( GLfloat));
+	headerPos += sizeof( GLfloat);
+	memcpy( headerPos, &( cxMesh->minY), sizeof( GLfloat));
+	headerPos += sizeof( GLfloat);
+	memcpy( headerPos, &( cxMesh->maxY), sizeof( GLfloat));
+	headerPos += sizeof( GLfloat);
+	memcpy( headerPos, &( cxMesh->minZ), sizeof( GLfloat));
+	headerPos += sizeof( GLfloat);
+	memcpy( headerPos, &( cxMesh->maxZ), sizeof( GLfloat));
+
+	WritePadded( cxHeader, sizeof( cxHeader), outFile);
+
+	/* Write out the arrays */
+	WritePadded(
+	    cxMesh->vertCoords, 3 * cxMesh->numVerts * sizeof( GLfloat),
+	    outFile
+	);
+	WritePadded(
+	    cxMesh->triVerts, 3 * cxMesh->numTri * sizeof( Uint32), outFile
+	);
+	WritePadded(
+	    cxMesh->triPlanes, 4 * cxMesh->numTri * sizeof( GLfloat),
+	    outFile
+	);
+	WritePadded(
+	    cxMesh->nodes, cxMesh->numNodes * sizeof( BVHNode), outFile
+	);
+
+    } /* End if */
+
+} /* End function SaveCXMesh */
+
+
+CXMesh *LoadCXMesh( FILE *inFile)
+{
+    CXMesh *retVal = NULL;
+    Uint8 *fileData = NULL;
+    long fileSize;
+    GLboolean isMapped = GL_FALSE;
+
+    if( inFile == NULL)
+    {
+	return NULL;
+
+    } /* End if */
+
+    /* Get at the whole of the file */
+    if( ( fseek( inFile, 0L, SEEK_END) != 0) ||
+	( ( fileSize = ftell( inFile)) < (long )CX_HEADER_SIZE) ||
+	( fseek( inFile, 0L, SEEK_SET) != 0)
+    )
+    {
+#ifdef GLD_DEBUG
+	fprintf( stderr, "\nERROR: Truncated or unreadable collision mesh!\n");
+#endif
+	return NULL;
+
+    } /* End if */
+
+#ifdef CX_USE_MMAP
+    fileData = (Uint8 *)( mmap(
+	NULL, (size_t )fileSize, PROT_READ, MAP_PRIVATE, fileno( inFile), 0
+    ));
+    if( fileData == (Uint8 *)MAP_FAILED)
+    {
+	fileData = NULL;
+
+    } /* End if */
+    else
+    {
+	isMapped = GL_TRUE;
+
+    } /* End else */
+#endif
+
+    if( fileData == NULL)
+    {
+	fileData = (Uint8 *)( malloc( (size_t )fileSize));
+	if( fileData == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	if( fread( fileData, 1, (size_t )fileSize, inFile) !=
+	    (size_t )fileSize
+	)
+	{
+#ifdef GLD_DEBUG
+	    fprintf( stderr, "\nERROR: Could not read collision mesh!\n");
+#endif
+	    free( fileData);
+	    return NULL;
+
+	} /* End if */
+
+    } /* End if */
+
+    retVal = (CXMesh *)( calloc( 1, sizeof( CXMesh)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->fileData = fileData;
+    retVal->fileSize = (size_t )fileSize;
+    retVal->isMapped = isMapped;
+
+    if( CheckCXMesh( retVal) == GL_FALSE)
+    {
+	FreeCXMesh( retVal);
+	retVal = NULL;
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function LoadCXMesh */
+
+
+void FreeCXMesh( CXMesh *cxMesh)
+{
+    if( cxMesh != NULL)
+    {
+	if( cxMesh->fileData == NULL)
+	{
+	    free( cxMesh->vertCoords);
+	    free( cxMesh->triVerts);
+	    free( cxMesh->triPlanes);
+	    free( cxMesh->nodes);
+
+	} /* End if */
+#ifdef CX_USE_MMAP
+	else if( cxMesh->isMapped == GL_TRUE)
+	{
+	    munmap( cxMesh->fileData, cxMesh->fileSize);
+
+	} /* End else-if */
+#endif
+	else
+	{
+	    free( cxMesh->fileData);
+
+	} /* End else */
+
+	cxMesh->fileData = NULL;
+	cxMesh->vertCoords = NULL;
+	cxMesh->numVerts = 0U;
+	cxMesh->triVerts = NULL;
+	cxMesh->triPlanes = NULL;
+	cxMesh->numTri = 0U;
+	cxMesh->nodes = NULL;
+	cxMesh->numNodes = 0U;
+
+	free( cxMesh);
+
+    } /* End if */
+
+} /* End function FreeCXMesh */
+
+
+/**
+ * Writes out the given data, followed by as many zero bytes as are
+ * needed to end it at a multiple of CX_ALIGN bytes.
+ */
+void WritePadded( const void *someData, size_t numBytes, FILE *outFile)
+{
+    static const Uint8 zeroBytes[CX_ALIGN] = { 0U };
+
+    if( numBytes > 0U)
+    {
+	fwrite( someData, 1, numBytes, outFile);
+
+    } /* End if */
+
+    fwrite( zeroBytes, 1, ( CX_PADDED( numBytes) - numBytes), outFile);
+
+} /* End function WritePadded */
+
+
+/**
+ * Checks the contents of the CX file that the given collision mesh
+ * was loaded from, filling in the mesh from it. Returns GL_FALSE if
+ * the file is not a valid one.
+ */
+GLboolean CheckCXMesh( CXMesh *cxMesh)
+{
+    const Uint8 *fileData = (const Uint8 *)( cxMesh->fileData);
+    const Uint8 *headerPos = fileData;
+    size_t dataPos;
+    Uint8 *nodeDepths;
+    Uint32 i;
+    GLboolean retVal = GL_TRUE;
+
+    if( ( memcmp( CX_FILE_MAGIC, headerPos, sizeof( CX_FILE_MAGIC)) != 0) ||
+	( headerPos[sizeof( CX_FILE_MAGIC)] != CX_DATA_VER)
+    )
+    {
+#ifdef GLD_DEBUG
+	fprintf( stderr,
+	    "\nERROR: Invalid collision mesh or incorrect version!\n"
+	);
+#endif
+	return GL_FALSE;
+
+    } /* End if */
+
+    headerPos += sizeof( CX_FILE_MAGIC) + 4;
+
+    memcpy( &( cxMesh->numVerts), headerPos, sizeof( Uint32));
+    headerPos += sizeof( Uint32);
+    memcpy( &( cxMesh->numTri), headerPos, sizeof( Uint32));
+    headerPos += sizeof( Uint32);
+    memcpy( &( cxMesh->numNodes), headerPos, sizeof( Uint32));
+    headerPos += 2 * sizeof( Uint32);
+
+    memcpy( &( cxMesh->minX), headerPos, sizeof( GLfloat));
+    headerPos += sizeof( GLfloat);
+    memcpy( &( cxMesh->maxX), headerPos, sizeof( GLfloat));
+    headerPos += sizeof( GLfloat);
+    memcpy( &( cxMesh->minY), headerPos, sizeof( GLfloat));
+    headerPos += sizeof( GLfloat);
+    memcpy( &( cxMesh->maxY), headerPos, sizeof( GLfloat));
+    headerPos += sizeof( GLfloat);
+    memcpy( &( cxMesh->minZ), headerPos, sizeof( GLfloat));
+    headerPos += sizeof( GLfloat);
+    memcpy( &( cxMesh->maxZ), headerPos, sizeof( GLfloat));
+
+    /* The arrays must exactly fill up the rest of the file */
+    if( ( cxMesh->numVerts > CX_MAX_ITEMS) ||
+	( cxMesh->numTri > CX_MAX_ITEMS) ||
+	( cxMesh->numNodes > 2 * CX_MAX_ITEMS) ||
+	( ( cxMesh->numTri > 0U) && ( cxMesh->numNodes == 0U))
+    )
+    {
+	retVal = GL_FALSE;
+
+    } /* End if */
+    else
+    {
+	dataPos = CX_HEADER_SIZE;
+
+	cxMesh->vertCoords = (GLfloat *)( fileData + dataPos);
+	dataPos += CX_PADDED( 3 * cxMesh->numVerts * sizeof( GLfloat));
+
+	cxMesh->triVerts = (Uint32 *)( fileData + dataPos);
+	dataPos += CX_PADDED( 3 * cxMesh->numTri * sizeof( Uint32));
+
+	cxMesh->triPlanes = (GLfloat *)( fileData + dataPos);
+	dataPos += CX_PADDED( 4 * cxMesh->numTri * sizeof( GLfloat));
+
+	cxMesh->nodes = (BVHNode *)( fileData + dataPos);
+	dataPos += CX_PADDED( cxMesh->numNodes * sizeof( BVHNode));
+
+	retVal = ( dataPos == cxMesh->fileSize) ? GL_TRUE : GL_FALSE;
+
+    } /* End else */
+
+    /* Every triangle must use vertices that are there */
+    for( i = 0U; ( retVal == GL_TRUE) && ( i < 3 * cxMesh->numTri); i++)
+    {
+	if( cxMesh->triVerts[i] >= cxMesh->numVerts)
+	{
+	    retVal = GL_FALSE;
+
+	} /* End if */
+
+    } /* End for */
+
+    /* Every node must use triangles that are there, and the children
+     * of a node must come after it, with no more than BVH_MAX_DEPTH
+     * levels in all (so that the hierarchy can be walked safely).
+     */
+    nodeDepths = (Uint8 *)( calloc( cxMesh->numNodes + 1, sizeof( Uint8)));
+    if( nodeDepths == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( i = 0U; ( retVal == GL_TRUE) && ( i < cxMesh->numNodes); i++)
+    {
+	const BVHNode *aNode = cxMesh->nodes + i;
+
+	if( aNode->numTri > 0U)
+	{
+	    if( ( aNode->first > cxMesh->numTri) ||
+		( aNode->numTri > cxMesh->numTri - aNode->first)
+	    )
+	    {
+		retVal = GL_FALSE;
+
+	    } /* End if */
+
+	} /* End if */
+	else if( ( aNode->first <= i) ||
+	    ( aNode->first >= cxMesh->numNodes - 1U) ||
+	    ( nodeDepths[i] >= ( BVH_MAX_DEPTH - 1))
+	)
+	{
+	    retVal = GL_FALSE;
+
+	} /* End else-if */
+	else
+	{
+	    Uint8 childDepth = nodeDepths[i] + 1U;
+
+	    if( nodeDepths[aNode->first] < childDepth)
+	    {
+		nodeDepths[aNode->first] = childDepth;
+
+	    } /* End if */
+
+	    if( nodeDepths[aNode->first + 1U] < childDepth)
+	    {
+		nodeDepths[aNode->first + 1U] = childDepth;
+
+	    } /* End if */
+
+	} /* End else */
+
+    } /* End for */
+
+    free( nodeDepths);
+
+#ifdef GLD_DEBUG
+    if( retVal == GL_FALSE)
+    {
+	fprintf( stderr, "\nERROR: Truncated or corrupt collision mesh!\n");
+
+    } /* End if */
+#endif
+
+    return retVal;
+
+} /* End function CheckCXMesh */
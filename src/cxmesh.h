@@ -0,0 +1,151 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * CXMESH.H: Declarations for the collision mesh file format functions.
+ * ('CX' stands for collision.)
+ */
+
+/**
+ * A collision mesh has only what the collision detection needs - the
+ * positions of its vertices (without the texture mappings, and so
+ * without the duplicate vertices for the same position with different
+ * mappings), a single array of triangles (without the texture map
+ * of each), the plane of each triangle and a BVH over the triangles
+ * (see "bvh.h"), so that only those near a movement need be tested.
+ *
+ * Stream format for a CX file:
+ *
+ *  1. File Type Identifier: "CXM" (4 bytes, including the '\0')
+ *  2. Version: Major + Minor (4 high + 4 low bits). Currently 0x20 (8 bits)
+ *  3. Padding (3 bytes)
+ *
+ *  4. numVerts: number of vertices (32 bits)
+ *  5. numTri: number of triangles (32 bits)
+ *  6. numNodes: number of nodes of the BVH (32 bits)
+ *  7. Padding (32 bits)
+ *
+ *  8. minX: Minimum overall X ordinate value (32-bit float)
+ *  9. maxX: Maximum overall X ordinate value (32-bit float)
+ *
+ * 10. minY: Minimum overall Y ordinate value (32-bit float)
+ * 11. maxY: Maximum overall Y ordinate value (32-bit float)
+ *
+ * 12. minZ: Minimum overall Z ordinate value (32-bit float)
+ * 13. maxZ: Maximum overall Z ordinate value (32-bit float)
+ *
+ * 14. vertCoords: 'numVerts' vertex coordinates (each 3 x 32-bit floats)
+ * 15. triVerts: 'numTri' triads of vertex indices, in anticlockwise
+ *         order seen from outside (each 3 x 32 bits)
+ * 16. triPlanes: 'numTri' planes of the triangles (each 4 x 32-bit
+ *         floats - see CXMesh below)
+ * 17. nodes: 'numNodes' nodes of the BVH, the root first (each a
+ *         BVHNode - 6 x 32-bit floats followed by 2 x 32 bits)
+ *
+ * Each of 14 to 17 begins at a multiple of CX_ALIGN bytes from the
+ * start of the file (the bytes in between being zero), so that the
+ * file can be mapped into memory and used just as it is.
+ *
+ * NOTE: All numbers are little-endian.
+ */
+
+#ifndef _CXMESH_H
+#define _CXMESH_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include <stdio.h>
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+#include "bvh.h"
+
+
+/* These form the "signature" of a saved collision mesh file */
+#define CX_FILE_MAGIC "CXM"
+#define CX_DATA_VER 0x20
+
+/* Alignment of the arrays in a CX file */
+#define CX_ALIGN 16
+
+
+/* Data type definitions */
+
+/* Run-time representation of a CX file */
+typedef struct _cx_mesh
+{
+    Uint32 numVerts;
+    GLfloat *vertCoords;    /* 'numVerts' packed triads of (x,y,z) values */
+
+    GLfloat minX, maxX;
+    GLfloat minY, maxY;
+    GLfloat minZ, maxZ;
+
+    Uint32 numTri;
+    Uint32 *triVerts;       /* 'numTri' packed triads of vertex indices */
+
+    /* 'numTri' packed planes (a,b,c,d) of the triangles, with (a,b,c)
+     * the unit normal facing outside and ( a*x + b*y + c*z + d) zero
+     * for the points (x,y,z) on the plane.
+     */
+    GLfloat *triPlanes;
+
+    /* The BVH over the triangles - the triangles of a leaf are those
+     * numbered from its 'first'.
+     */
+    Uint32 numNodes;
+    BVHNode *nodes;
+
+    /* The contents of the CX file that the mesh was loaded from (the
+     * arrays above point into it), or NULL for a freshly generated
+     * mesh.
+     */
+    void *fileData;
+    size_t fileSize;
+    GLboolean isMapped;     /* Mapped into memory rather than read in */
+
+} CXMesh;
+
+
+/* Function Prototypes */
+
+/**
+ * Works out the planes of the triangles of a freshly generated
+ * collision mesh and builds its BVH, reordering its triangles to suit
+ * the BVH. This must be done before the mesh is saved or used.
+ */
+extern void IndexCXMesh( CXMesh *cxMesh);
+
+
+/**
+ * Saves the given collision mesh into the given file. The file must
+ * be opened for writing binary data, must have sufficient permissions
+ * and the disc must not be full.
+ */
+extern void SaveCXMesh( CXMesh *cxMesh, FILE *outFile);
+
+
+/**
+ * Loads a collision mesh from the given file. The file must have been
+ * opened for reading binary data, must have sufficient permissions,
+ * etc. Where it can be, the file is mapped into memory instead of
+ * being read in (the file can be closed afterwards) - so the file must
+ * never be written over while the mesh is in use, only replaced with a
+ * new file (by renaming it over the old one, say).
+ *
+ * Returns NULL on error.
+ */
+extern CXMesh *LoadCXMesh( FILE *inFile);
+
+
+/**
+ * Frees a collision mesh that has either been loaded from a file or
+ * freshly generated.
+ */
+extern void FreeCXMesh( CXMesh *cxMesh);
+
+#endif    /* _CXMESH_H */
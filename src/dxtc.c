@@ -0,0 +1,691 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * DXTC.C: Compression of textures into the S3TC DXT1 format and the
+ * DXT files holding them.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "texload.h"
+#include "dxtc.h"
+
+
+/* Number of iterations used to find the principal axis of the
+ * colours of a block.
+ */
+#define DXT_AXIS_ITERATIONS 8
+
+/* The end points are first pulled in by this fraction of the extent
+ * of the colours.
+ */
+#define DXT_INSET_FRACTION 16.0F
+
+
+/* Local function prototypes */
+
+static void EncodeBlock( Uint8 blockTexels[16][4], Uint8 *aBlock);
+static Uint32 FitIndices( 
+    Uint8 blockTexels[16][4], GLboolean hasTransparent,
+    Uint16 *colour0, Uint16 *colour1, int *blockError
+);
+static Uint16 PackRGB565( const GLfloat rgbVal[3]);
+static void UnpackRGB565( Uint16 packedVal, int rgbVal[3]);
+
+
+Uint32 GetDXT1Size( int width, int height)
+{
+    Uint32 blocksX = (Uint32 )( ( width + 3) / 4);
+    Uint32 blocksY = (Uint32 )( ( height + 3) / 4);
+
+    return ( blocksX * blocksY * DXT1_BLOCK_SIZE);
+
+} /* End function GetDXT1Size */
+
+
+void EncodeDXT1( 
+    const Uint8 *rgbaPixels, int width, int height, Uint8 *dxtBlocks
+)
+{
+    Uint8 blockTexels[16][4];
+    int bx, by, i, j, m;
+
+    for( by = 0; by < height; by += 4)
+    {
+	for( bx = 0; bx < width; bx += 4)
+	{
+	    /* Blocks hanging over the edges of small images repeat
+	     * the texels at the edges.
+	     */
+	    for( j = 0; j < 4; j++)
+	    {
+		int y = ( ( by + j) < height) ? ( by + j) : ( height - 1);
+
+		for( i = 0; i < 4; i++)
+		{
+		    int x = ( ( bx + i) < width) ? ( bx + i) : ( width - 1);
+
+		    for( m = 0; m < 4; m++)
+		    {
+			blockTexels[4*j + i][m] = 
+			    rgbaPixels[4 * ( y*width + x) + m];
+
+		    } /* End for */
+
+		} /* End for */
+
+	    } /* End for */
+
+	    EncodeBlock( blockTexels, dxtBlocks);
+	    dxtBlocks += DXT1_BLOCK_SIZE;
+
+	} /* End for */
+
+    } /* End for */
+
+} /* End function EncodeDXT1 */
+
+
+DXTImage *GenDXTImage( const Uint8 *rgbaPixels, int width, int height)
+{
+    DXTImage *retVal;
+    const Uint8 *levelPixels = rgbaPixels;
+    int levelWidth = width, levelHeight = height;
+
+    retVal = (DXTImage *)( malloc( sizeof( DXTImage)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->width = (Uint16 )width;
+    retVal->height = (Uint16 )height;
+    retVal->numLevels = 0U;
+
+    while( retVal->numLevels < DXT_MAX_LEVELS)
+    {
+	Uint8 *dxtBlocks;
+	Uint8 *nextPixels;
+
+	dxtBlocks = (Uint8 *)( 
+	    malloc( GetDXT1Size( levelWidth, levelHeight))
+	);
+	if( dxtBlocks == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	EncodeDXT1( levelPixels, levelWidth, levelHeight, dxtBlocks);
+	retVal->levelData[retVal->numLevels++] = dxtBlocks;
+
+	if( ( levelWidth == 1) && ( levelHeight == 1))
+	{
+	    break;
+
+	} /* End if */
+
+	nextPixels = HalveImage( levelPixels, levelWidth, levelHeight);
+	if( levelPixels != rgbaPixels)
+	{
+	    free( (Uint8 *)levelPixels);
+
+	} /* End if */
+	levelPixels = nextPixels;
+
+	levelWidth = ( levelWidth > 1) ? ( levelWidth / 2) : 1;
+	levelHeight = ( levelHeight > 1) ? ( levelHeight / 2) : 1;
+
+    } /* End while */
+
+    if( levelPixels != rgbaPixels)
+    {
+	free( (Uint8 *)levelPixels);
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function GenDXTImage */
+
+
+void SaveDXTImage( DXTImage *dxtImage, FILE *outFile)
+{
+    if( dxtImage != NULL)
+    {
+	Uint8 dxtVer = DXT_VER;
+	int i;
+
+	/* Write out the format signature and version */
+	fwrite( 
+	    DXT_FILE_MAGIC, 
+	    sizeof( char), ( strlen( DXT_FILE_MAGIC) + 1),
+	    outFile
+	);
+	fwrite( &dxtVer, sizeof( dxtVer), 1, outFile);
+
+	/* Write out the image size */
+	fwrite( &( dxtImage->width), sizeof( dxtImage->width), 1, outFile);
+	fwrite( &( dxtImage->height), sizeof( dxtImage->height), 1, outFile);
+	fwrite( 
+	    &( dxtImage->numLevels), sizeof( dxtImage->numLevels), 1, outFile
+	);
+
+	/* Write out the blocks of each mipmap level */
+	for( i = 0; i < dxtImage->numLevels; i++)
+	{
+	    int levelWidth = ( dxtImage->width >> i);
+	    int levelHeight = ( dxtImage->height >> i);
+
+	    levelWidth = ( levelWidth > 0) ? levelWidth : 1;
+	    levelHeight = ( levelHeight > 0) ? levelHeight : 1;
+
+	    fwrite( 
+		dxtImage->levelData[i], 
+		sizeof( Uint8), GetDXT1Size( levelWidth, levelHeight),
+		outFile
+	    );
+
+	} /* End for */
+
+    } /* End if */
+
+} /* End function SaveDXTImage */
+
+
+DXTImage *LoadDXTImage( FILE *inFile)
+{
+    DXTImage *retVal = NULL;
+    char savedSig[sizeof( DXT_FILE_MAGIC)];
+    Uint8 dxtVer = 0U;
+    int i;
+
+    if( ( fread( savedSig, sizeof( char), sizeof( savedSig), inFile) != 
+	    sizeof( savedSig)) ||
+	( fread( &dxtVer, sizeof( dxtVer), 1, inFile) != 1) ||
+	( memcmp( savedSig, DXT_FILE_MAGIC, sizeof( savedSig)) != 0) ||
+	( dxtVer != DXT_VER)
+    )
+    {
+	return NULL;
+
+    } /* End if */
+
+    retVal = (DXTImage *)( malloc( sizeof( DXTImage)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->numLevels = 0U;
+
+    if( ( fread( &( retVal->width), sizeof( retVal->width), 1, inFile) != 1) ||
+	( fread( &( retVal->height), sizeof( retVal->height), 1, inFile) != 1) ||
+	( fread( 
+	    &( retVal->numLevels), sizeof( retVal->numLevels), 1, inFile
+	  ) != 1) ||
+	( retVal->numLevels > DXT_MAX_LEVELS)
+    )
+    {
+	retVal->numLevels = 0U;
+	FreeDXTImage( retVal);
+	return NULL;
+
+    } /* End if */
+
+    for( i = 0; i < retVal->numLevels; i++)
+    {
+	int levelWidth = ( retVal->width >> i);
+	int levelHeight = ( retVal->height >> i);
+	Uint32 levelSize;
+
+	levelWidth = ( levelWidth > 0) ? levelWidth : 1;
+	levelHeight = ( levelHeight > 0) ? levelHeight : 1;
+	levelSize = GetDXT1Size( levelWidth, levelHeight);
+
+	retVal->levelData[i] = (Uint8 *)( malloc( levelSize));
+	if( retVal->levelData[i] == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	if( fread( retVal->levelData[i], sizeof( Uint8), levelSize, inFile) !=
+	    levelSize
+	)
+	{
+	    /* Truncated file */
+	    retVal->numLevels = (Uint8 )( i + 1);
+	    FreeDXTImage( retVal);
+	    return NULL;
+
+	} /* End if */
+
+    } /* End for */
+
+    return retVal;
+
+} /* End function LoadDXTImage */
+
+
+void FreeDXTImage( DXTImage *dxtImage)
+{
+    if( dxtImage != NULL)
+    {
+	int i;
+
+	for( i = 0; i < dxtImage->numLevels; i++)
+	{
+	    free( dxtImage->levelData[i]);
+
+	} /* End for */
+
+	free( dxtImage);
+
+    } /* End if */
+
+} /* End function FreeDXTImage */
+
+
+/**
+ * Compresses a block of 4x4 texels into DXT1. The end points of the
+ * colour line are first taken from the extent of the opaque texels'
+ * colours along their principal axis (pulled in a little, as the
+ * extremes are usually outliers), and then refined to the least
+ * squares fit for the colours chosen for the texels.
+ */
+void EncodeBlock( Uint8 blockTexels[16][4], Uint8 *aBlock)
+{
+    GLfloat meanVal[3], covar[3][3], pAxis[3], endPts[2][3];
+    GLfloat minProj, maxProj, axisLen, insetProj;
+    GLfloat sumAA, sumBB, sumAB, sumAX[3], sumBX[3], aDet;
+    int numOpaque, blockError, newError;
+    Uint16 colour0, colour1, newColour0, newColour1;
+    Uint32 texIndices, newIndices;
+    int i, j, m, n;
+
+    /* Find the mean and the covariance of the opaque colours */
+    numOpaque = 0;
+    for( m = 0; m < 3; m++)
+    {
+	meanVal[m] = 0.0F;
+
+    } /* End for */
+
+    for( i = 0; i < 16; i++)
+    {
+	if( blockTexels[i][3] >= TEX_ALPHA_LIMIT)
+	{
+	    numOpaque++;
+	    for( m = 0; m < 3; m++)
+	    {
+		meanVal[m] += (GLfloat )blockTexels[i][m];
+
+	    } /* End for */
+
+	} /* End if */
+
+    } /* End for */
+
+    if( numOpaque == 0)
+    {
+	/* Entirely transparent */
+	aBlock[0] = aBlock[1] = aBlock[2] = aBlock[3] = 0x00;
+	aBlock[4] = aBlock[5] = aBlock[6] = aBlock[7] = 0xFF;
+	return;
+
+    } /* End if */
+
+    for( m = 0; m < 3; m++)
+    {
+	meanVal[m] /= (GLfloat )numOpaque;
+
+	for( n = 0; n < 3; n++)
+	{
+	    covar[m][n] = 0.0F;
+
+	} /* End for */
+
+    } /* End for */
+
+    for( i = 0; i < 16; i++)
+    {
+	if( blockTexels[i][3] >= TEX_ALPHA_LIMIT)
+	{
+	    for( m = 0; m < 3; m++)
+	    {
+		for( n = 0; n < 3; n++)
+		{
+		    covar[m][n] += 
+			( (GLfloat )blockTexels[i][m] - meanVal[m]) *
+			( (GLfloat )blockTexels[i][n] - meanVal[n]);
+
+		} /* End for */
+
+	    } /* End for */
+
+	} /* End if */
+
+    } /* End for */
+
+
+    /* Find the principal axis by power iteration */
+    pAxis[0] = pAxis[1] = pAxis[2] = 1.0F;
+    for( j = 0; j < DXT_AXIS_ITERATIONS; j++)
+    {
+	GLfloat newAxis[3];
+
+	for( m = 0; m < 3; m++)
+	{
+	    newAxis[m] = covar[m][0]*pAxis[0] + covar[m][1]*pAxis[1] + 
+		covar[m][2]*pAxis[2];
+
+	} /* End for */
+
+	axisLen = (GLfloat )sqrt( 
+	    newAxis[0]*newAxis[0] + newAxis[1]*newAxis[1] + 
+	    newAxis[2]*newAxis[2]
+	);
+
+	if( axisLen < 1.0e-6F)
+	{
+	    /* All the colours are (nearly) the same */
+	    pAxis[0] = pAxis[1] = pAxis[2] = 0.0F;
+	    break;
+
+	} /* End if */
+
+	for( m = 0; m < 3; m++)
+	{
+	    pAxis[m] = newAxis[m] / axisLen;
+
+	} /* End for */
+
+    } /* End for */
+
+    minProj = maxProj = 0.0F;
+    for( i = 0; i < 16; i++)
+    {
+	if( blockTexels[i][3] >= TEX_ALPHA_LIMIT)
+	{
+	    GLfloat aProj = 0.0F;
+
+	    for( m = 0; m < 3; m++)
+	    {
+		aProj += ( (GLfloat )blockTexels[i][m] - meanVal[m]) * pAxis[m];
+
+	    } /* End for */
+
+	    minProj = ( aProj < minProj) ? aProj : minProj;
+	    maxProj = ( aProj > maxProj) ? aProj : maxProj;
+
+	} /* End if */
+
+    } /* End for */
+
+    insetProj = ( maxProj - minProj) / DXT_INSET_FRACTION;
+    for( m = 0; m < 3; m++)
+    {
+	endPts[0][m] = meanVal[m] + ( maxProj - insetProj) * pAxis[m];
+	endPts[1][m] = meanVal[m] + ( minProj + insetProj) * pAxis[m];
+
+    } /* End for */
+
+    colour0 = PackRGB565( endPts[0]);
+    colour1 = PackRGB565( endPts[1]);
+    texIndices = FitIndices( 
+	blockTexels, ( ( numOpaque < 16) ? GL_TRUE : GL_FALSE),
+	&colour0, &colour1, &blockError
+    );
+
+
+    /* Refine the end points - each opaque texel is a known mix of the
+     * two of them, so they can be solved for as a linear least squares
+     * problem.
+     */
+    sumAA = sumBB = sumAB = 0.0F;
+    for( m = 0; m < 3; m++)
+    {
+	sumAX[m] = sumBX[m] = 0.0F;
+
+    } /* End for */
+
+    for( i = 0; i < 16; i++)
+    {
+	Uint32 texIndex = ( texIndices >> ( 2*i)) & 0x03U;
+	GLfloat wtA, wtB;
+
+	if( blockTexels[i][3] < TEX_ALPHA_LIMIT)
+	{
+	    continue;
+
+	} /* End if */
+
+	switch( texIndex)
+	{
+	case 0U:
+	    wtA = 1.0F;
+	    break;
+
+	case 1U:
+	    wtA = 0.0F;
+	    break;
+
+	case 2U:
+	    wtA = ( colour0 > colour1) ? ( 2.0F / 3.0F) : 0.5F;
+	    break;
+
+	default:
+	    wtA = 1.0F / 3.0F;
+	    break;
+
+	} /* End switch */
+
+	wtB = 1.0F - wtA;
+
+	sumAA += wtA * wtA;
+	sumBB += wtB * wtB;
+	sumAB += wtA * wtB;
+
+	for( m = 0; m < 3; m++)
+	{
+	    sumAX[m] += wtA * (GLfloat )blockTexels[i][m];
+	    sumBX[m] += wtB * (GLfloat )blockTexels[i][m];
+
+	} /* End for */
+
+    } /* End for */
+
+    aDet = sumAA * sumBB - sumAB * sumAB;
+    if( ( aDet > 1.0e-3F) || ( aDet < -1.0e-3F))
+    {
+	for( m = 0; m < 3; m++)
+	{
+	    endPts[0][m] = ( sumAX[m] * sumBB - sumBX[m] * sumAB) / aDet;
+	    endPts[1][m] = ( sumBX[m] * sumAA - sumAX[m] * sumAB) / aDet;
+
+	} /* End for */
+
+	newColour0 = PackRGB565( endPts[0]);
+	newColour1 = PackRGB565( endPts[1]);
+	newIndices = FitIndices( 
+	    blockTexels, ( ( numOpaque < 16) ? GL_TRUE : GL_FALSE),
+	    &newColour0, &newColour1, 
+	    &newError
+	);
+
+	if( newError < blockError)
+	{
+	    colour0 = newColour0;
+	    colour1 = newColour1;
+	    texIndices = newIndices;
+
+	} /* End if */
+
+    } /* End if */
+
+    aBlock[0] = (Uint8 )( colour0 & 0xFF);
+    aBlock[1] = (Uint8 )( colour0 >> 8);
+    aBlock[2] = (Uint8 )( colour1 & 0xFF);
+    aBlock[3] = (Uint8 )( colour1 >> 8);
+    aBlock[4] = (Uint8 )( texIndices & 0xFF);
+    aBlock[5] = (Uint8 )( ( texIndices >> 8) & 0xFF);
+    aBlock[6] = (Uint8 )( ( texIndices >> 16) & 0xFF);
+    aBlock[7] = (Uint8 )( ( texIndices >> 24) & 0xFF);
+
+} /* End function EncodeBlock */
+
+
+/**
+ * Orders the given colours to select the mode of a block, and returns
+ * the nearest colour for each texel (the first texel in the lowest
+ * bits), along with the total squared error.
+ */
+Uint32 FitIndices( 
+    Uint8 blockTexels[16][4], GLboolean hasTransparent,
+    Uint16 *colour0, Uint16 *colour1, int *blockError
+)
+{
+    int palette[4][3];
+    int numColours, i, j, m;
+    Uint16 tmpColour;
+    Uint32 retVal;
+
+    /* With transparent texels, the first colour must not be greater
+     * than the second; otherwise it must be greater to get four
+     * colours.
+     */
+    if( ( ( hasTransparent == GL_TRUE) && ( *colour0 > *colour1)) ||
+	( ( hasTransparent == GL_FALSE) && ( *colour0 < *colour1))
+    )
+    {
+	tmpColour = *colour0;
+	*colour0 = *colour1;
+	*colour1 = tmpColour;
+
+    } /* End if */
+
+    UnpackRGB565( *colour0, palette[0]);
+    UnpackRGB565( *colour1, palette[1]);
+
+    if( *colour0 > *colour1)
+    {
+	numColours = 4;
+	for( m = 0; m < 3; m++)
+	{
+	    palette[2][m] = ( 2*palette[0][m] + palette[1][m] + 1) / 3;
+	    palette[3][m] = ( palette[0][m] + 2*palette[1][m] + 1) / 3;
+
+	} /* End for */
+
+    } /* End if */
+    else
+    {
+	/* The fourth "colour" is transparent black */
+	numColours = 3;
+	for( m = 0; m < 3; m++)
+	{
+	    palette[2][m] = ( palette[0][m] + palette[1][m]) / 2;
+
+	} /* End for */
+
+    } /* End else */
+
+    retVal = 0U;
+    *blockError = 0;
+    for( i = 15; i >= 0; i--)
+    {
+	Uint32 bestIndex = 3U;
+
+	if( blockTexels[i][3] >= TEX_ALPHA_LIMIT)
+	{
+	    int bestDist = -1;
+
+	    for( j = 0; j < numColours; j++)
+	    {
+		int aDist = 0;
+
+		for( m = 0; m < 3; m++)
+		{
+		    int compDiff = (int )blockTexels[i][m] - palette[j][m];
+
+		    aDist += compDiff * compDiff;
+
+		} /* End for */
+
+		if( ( bestDist < 0) || ( aDist < bestDist))
+		{
+		    bestDist = aDist;
+		    bestIndex = (Uint32 )j;
+
+		} /* End if */
+
+	    } /* End for */
+
+	    *blockError += bestDist;
+
+	} /* End if */
+
+	retVal = ( retVal << 2) | bestIndex;
+
+    } /* End for */
+
+    return retVal;
+
+} /* End function FitIndices */
+
+
+/**
+ * Rounds an RGB colour to the nearest RGB 5:6:5 colour.
+ */
+Uint16 PackRGB565( const GLfloat rgbVal[3])
+{
+    int compVal[3];
+    int m;
+
+    for( m = 0; m < 3; m++)
+    {
+	GLfloat maxVal = ( m == 1) ? 63.0F : 31.0F;
+	GLfloat scaledVal = ( rgbVal[m] * maxVal / 255.0F) + 0.5F;
+
+	scaledVal = ( scaledVal < 0.0F) ? 0.0F : scaledVal;
+	scaledVal = ( scaledVal > maxVal) ? maxVal : scaledVal;
+	compVal[m] = (int )scaledVal;
+
+    } /* End for */
+
+    return (Uint16 )( ( compVal[0] << 11) | ( compVal[1] << 5) | compVal[2]);
+
+} /* End function PackRGB565 */
+
+
+/**
+ * Expands an RGB 5:6:5 colour to 8 bits per component, as OpenGL
+ * implementations do.
+ */
+void UnpackRGB565( Uint16 packedVal, int rgbVal[3])
+{
+    int redVal = ( packedVal >> 11) & 0x1F;
+    int greenVal = ( packedVal >> 5) & 0x3F;
+    int blueVal = packedVal & 0x1F;
+
+    rgbVal[0] = ( redVal << 3) | ( redVal >> 2);
+    rgbVal[1] = ( greenVal << 2) | ( greenVal >> 4);
+    rgbVal[2] = ( blueVal << 3) | ( blueVal >> 2);
+
+} /* End function UnpackRGB565 */
+
+
@@ -0,0 +1,126 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * DXTC.H: Declarations for the compressed texture (DXT) functions.
+ */
+
+/**
+ * Textures can be stored in the "texture cache" as complete mipmap
+ * chains, compressed in the S3TC "DXT1" (also known as "BC1") format,
+ * which OpenGL implementations with the "GL_EXT_texture_compression_s3tc"
+ * extension can use directly. DXT1 needs just 4 bits per texel, an
+ * eighth of the memory taken by uncompressed RGBA texels.
+ *
+ * DXT1 stores each block of 4x4 texels as two 16-bit (RGB 5:6:5)
+ * colours and a 2-bit index per texel choosing between them, two
+ * colours in between them, or - if the first colour is not greater
+ * than the second - just one colour in between and transparent black.
+ * The latter lets us keep the "sufficiently black is transparent"
+ * rule (see "texload.h") for blocks that have transparent texels.
+ *
+ * Stream format for a DXT file:
+ *
+ *  1. File Type Identifier: "DXT" (4 bytes, including the '\0')
+ *  2. Version: Major + Minor (4 high + 4 low bits). Currently 0x10 (8 bits)
+ *
+ *  3. width: width of the largest mipmap level (16 bits)
+ *  4. height: height of the largest mipmap level (16 bits)
+ *  5. numLevels: number of mipmap levels, down to 1x1 (8 bits)
+ *
+ *  6. For( 0 <= i < numLevels),
+ *         the DXT1 blocks of level 'i', row by row (64 bits each)
+ *
+ * NOTE: All numbers are little-endian.
+ */
+
+#ifndef _DXTC_H
+#define _DXTC_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include <stdio.h>
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+
+/* These form the "signature" of a DXT file */
+#define DXT_FILE_MAGIC "DXT"
+#define DXT_VER 0x10
+
+/* Size of a DXT1 block of 4x4 texels, in bytes */
+#define DXT1_BLOCK_SIZE 8
+
+/* Maximum number of mipmap levels (for up to 32768x32768 texels) */
+#define DXT_MAX_LEVELS 16
+
+
+/* Data type definitions */
+
+/* Run-time representation of a DXT file */
+typedef struct _dxt_image
+{
+    Uint16 width;
+    Uint16 height;
+
+    Uint8 numLevels;
+    Uint8 *levelData[DXT_MAX_LEVELS];   /* DXT1 blocks of each level */
+
+} DXTImage;
+
+
+/* Function Prototypes */
+
+/**
+ * Returns the size in bytes of a DXT1 image of the given size.
+ */
+extern Uint32 GetDXT1Size( int width, int height);
+
+
+/**
+ * Compresses the given RGBA image (with the first row at the top) into
+ * the given DXT1 blocks. Texels with an alpha below 128 are made
+ * transparent, the others opaque.
+ */
+extern void EncodeDXT1( 
+    const Uint8 *rgbaPixels, int width, int height, Uint8 *dxtBlocks
+);
+
+
+/**
+ * Generates a DXT image, with a complete mipmap chain, from the given
+ * RGBA image. Texels of the smaller mipmap levels are opaque if at
+ * least half of the texels they replace are opaque, and get the
+ * average colour of those opaque texels.
+ */
+extern DXTImage *GenDXTImage( const Uint8 *rgbaPixels, int width, int height);
+
+
+/**
+ * Saves the given DXT image into the given file, which must be opened
+ * for writing binary data.
+ */
+extern void SaveDXTImage( DXTImage *dxtImage, FILE *outFile);
+
+
+/**
+ * Loads a DXT image from the given file, which must have been opened
+ * for reading binary data.
+ *
+ * Returns NULL on error.
+ */
+extern DXTImage *LoadDXTImage( FILE *inFile);
+
+
+/**
+ * Frees the memory used by a DXT image.
+ */
+extern void FreeDXTImage( DXTImage *dxtImage);
+
+#endif    /* _DXTC_H */
+
+
@@ -0,0 +1,3040 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * ENGINE.C: The engine that shows the models of a scene, either as
+ * GLData or as BSP Tree models, from the point of view of a viewer
+ * walking through it.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "coldet.h"
+#include "glutil.h"
+#include "texload.h"
+#include "pick.h"
+#include "engine.h"
+#include "vtaj.h"
+
+
+/* Literal constants */
+
+/* Separation of the eyes of a stereo pair, and the distance at which
+ * the images of the two eyes coincide.
+ */
+#define STEREO_EYE_SEP 2.0
+#define STEREO_FOCAL_DIST 100.0
+
+/* The minimap is a view looking straight down at the viewer from this
+ * height, shown in a square of side ( scrHeight / MINIMAP_SCALE) at the
+ * top right corner of the screen.
+ */
+#define MINIMAP_HEIGHT 1500.0
+#define MINIMAP_FIELD_OF_VIEW 30.0
+#define MINIMAP_SCALE 3
+#define MINIMAP_MARGIN 8
+#define MINIMAP_MARKER_SIZE 20.0F
+
+/* The minimap gets the nearer part of the depth range, so that it
+ * covers the main view without having to be drawn after it.
+ */
+#define MINIMAP_MAX_DEPTH 0.4
+#define MAIN_VIEW_MIN_DEPTH 0.5
+
+/* What a partition plane of a BSP Tree hides from all the views of a
+ * frame - the sub-tree behind it, and the triangles in it (which face
+ * away from every view).
+ */
+#define PLANE_HIDES_BACK 0x01U
+#define PLANE_HIDES_TRIANGLES 0x02U
+
+/* Percentage of the loading done between updates of the progress shown */
+#define ENGINE_PROGRESS_STEP 5U
+
+
+/* Data types used locally */
+
+/* A model to be shown, as read in - either a GLData model and its
+ * clusters, or a BSP Tree model.
+ */
+typedef struct _shown_model
+{
+    GLData *gldModel;
+    ClusterData *clusterData;
+    BSPTreeData *bspModel;
+
+    /* When read in again, the images of its textures if it uses other
+     * textures than before (NULL otherwise).
+     */
+    Uint16 numTexImages;
+    TexImage **texImages;
+
+} ShownModel;
+
+
+/* Local function prototypes */
+
+static GLboolean LoadModels( VTEngine *vtEngine, const char *sceneName);
+static GLboolean ReadShownModel( 
+    SceneModel *aModel, GLboolean useBSP, GLDVertLayout vertLayout,
+    ShownModel *shownModel
+);
+static void SetInstModel( ModelInst *anInst, const ShownModel *shownModel);
+static Uint16 GetShownMaps( const ShownModel *shownModel, char ***mapNames);
+static GLboolean HasSameMaps( 
+    Uint16 numMaps, char **mapNames, Uint16 oldNumMaps, char **oldMapNames
+);
+static GLData *ReadGLDModel( const char *fileName, const char *modelName);
+static BSPTreeData *ReadBSPModel( 
+    const char *fileName, const char *modelName
+);
+static CXMesh *ReadCXModel( const char *fileName, const char *modelName);
+static int LoadModelTask( TaskPool *taskPool, void *taskData);
+static int LoadColDetTask( TaskPool *taskPool, void *taskData);
+static int InitTexObjTask( TaskPool *taskPool, void *taskData);
+static int LoadTexTask( TaskPool *taskPool, void *taskData);
+static int UploadTexTask( TaskPool *taskPool, void *taskData);
+static GLboolean FinishLoading( 
+    VTEngine *vtEngine, EngineProgressFn progressFn, void *cbData
+);
+static void FreeLoads( VTEngine *vtEngine);
+static void InitQueues( VTEngine *vtEngine);
+static void InitInstQueues( ModelInst *anInst, GLboolean useBSP);
+static void SetRingOffsets( VTEngine *vtEngine);
+static void FreeInstQueues( ModelInst *anInst);
+static void FreeInstTextures( ModelInst *anInst);
+static void FreeInstModel( ModelInst *anInst);
+static void *ReloadAsset( const char *fileName, void *fileData);
+static void ReloadModelTextures( 
+    EngineAsset *anAsset, ShownModel *shownModel
+);
+static void SetAssetMaps( 
+    EngineAsset *anAsset, Uint16 numMaps, char **mapNames
+);
+static void FreeReloadedAsset( void *loadedData, void *fileData);
+static void FreeReloadedModel( ShownModel *shownModel);
+static void FreeAssets( VTEngine *vtEngine);
+static void SwapInstModel( 
+    VTEngine *vtEngine, ModelInst *anInst, ShownModel *shownModel
+);
+static GLboolean CanMoveTo( 
+    VTEngine *vtEngine, const GLfloat srcPt[3], const GLfloat destPt[3]
+);
+static void UpdateActiveModels( VTEngine *vtEngine, GLboolean canEnter);
+static void QueueGLDClusters( VTEngine *vtEngine, ModelInst *anInst);
+static void DrawModel( 
+    VTEngine *vtEngine, ModelInst *anInst, const GLushort *ringIndices
+);
+static void SetModelViews( VTEngine *vtEngine, ModelInst *anInst);
+static void InitInstTextures( ModelInst *anInst);
+static void SetTexPriorities( ModelInst *anInst);
+static void NoteTexTriangles( 
+    TexStream *texStream, GLData *gldModel, BSPTreeData *bspModel
+);
+static void NoteBSPTexTriangles( 
+    TexStream *texStream, BSPTreeData *bspModel, BSPTree *aTree
+);
+static GLboolean GetMapFileNames( 
+    const char *mapName, char *dxtFileName, char *jpgFileName
+);
+static void DrawBSPTree( 
+    VTEngine *vtEngine, ModelInst *anInst, BSPTree *aTree
+);
+static Uint8 GetPlaneHides( 
+    VTEngine *vtEngine, ModelInst *anInst, Uint16 planeIndex
+);
+static void SetupViews( VTEngine *vtEngine);
+static void SetViewMatrices(
+    ViewDef *aView, GLdouble left, GLdouble right, GLdouble top,
+    const GLdouble center[3], const GLdouble up[3]
+);
+static void ApplyView( VTEngine *vtEngine, Uint32 viewNum);
+static void ApplyModelView( 
+    VTEngine *vtEngine, ModelInst *anInst, Uint32 viewNum
+);
+static void DrawMinimapBackground( VTEngine *vtEngine);
+static void DrawMinimapMarker( VTEngine *vtEngine);
+
+
+VTEngine *GenEngine( 
+    const char *sceneName, GLboolean useBSP, GLDVertLayout vertLayout,
+    int texReduction
+)
+{
+    VTEngine *retVal;
+
+    /* NOTE: Uses calloc( ) to initialise the contents to 0 */
+    retVal = (VTEngine *)( calloc( 1, sizeof( VTEngine)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->useBSP = useBSP;
+    retVal->vertLayout = vertLayout;
+    retVal->texReduction = texReduction;
+
+    /* Start loading all the models */
+    if( LoadModels( retVal, sceneName) == GL_FALSE)
+    {
+	FreeEngine( retVal);
+	return NULL;
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function GenEngine */
+
+
+GLboolean InitEngineGraphics(
+    VTEngine *vtEngine, int scrWidth, int scrHeight, GLboolean stereoMode,
+    EngineProgressFn progressFn, void *cbData
+)
+{
+    vtEngine->scrWidth = scrWidth;
+    vtEngine->scrHeight = scrHeight;
+    vtEngine->stereoMode = stereoMode;
+
+    /* OpenGL initialisation */
+    glClearColor( 0.0F, 0.4F, 0.6F, 0.0F); 
+    CHECK_GL_ERROR;
+
+    glEnable( GL_DEPTH_TEST);
+    CHECK_GL_ERROR;
+
+    glClearDepth( +1.0F);
+    CHECK_GL_ERROR;
+
+    glDepthFunc( GL_LEQUAL);
+    CHECK_GL_ERROR;
+
+    glFrontFace( GL_CCW);
+    CHECK_GL_ERROR;
+
+    glCullFace( GL_BACK);
+    CHECK_GL_ERROR;
+
+    if( vtEngine->useBSP == GL_TRUE)
+    {
+	glDisable( GL_CULL_FACE);
+	CHECK_GL_ERROR;
+
+    } /* End if */
+    else 
+    {
+	glEnable( GL_CULL_FACE);
+	CHECK_GL_ERROR;
+
+    } /* End else */
+
+    glEnable( GL_TEXTURE_2D);
+    CHECK_GL_ERROR;
+
+    glTexEnvf( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    CHECK_GL_ERROR;
+
+    glDisable( GL_ALPHA_TEST);
+    CHECK_GL_ERROR;
+
+    glAlphaFunc( GL_GREATER, 0.5F);
+    CHECK_GL_ERROR;
+
+    glShadeModel( GL_FLAT);
+    CHECK_GL_ERROR;
+
+
+    /* Wait for the models, and the textures to hand over to OpenGL */
+    if( FinishLoading( vtEngine, progressFn, cbData) == GL_FALSE)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    /* Hand the indices of the triangles found visible each frame
+     * straight to OpenGL, if we can.
+     */
+    if( vtEngine->useBSP == GL_TRUE)
+    {
+	vtEngine->idxRing = GenIndexRing( vtEngine->numRingIndices);
+
+    } /* End if */
+
+    /* Ready for prime time */
+
+    glEnableClientState( GL_VERTEX_ARRAY);
+    CHECK_GL_ERROR;
+
+    glEnableClientState( GL_TEXTURE_COORD_ARRAY);
+    CHECK_GL_ERROR;
+
+
+    glColor4f( 1.0F, 1.0F, 1.0F, 0.0F);
+
+    glHint( GL_PERSPECTIVE_CORRECTION_HINT, GL_FASTEST);
+    CHECK_GL_ERROR;
+
+    return GL_TRUE;
+
+} /* End function InitEngineGraphics */
+
+
+void PlaceEngineViewer(
+    VTEngine *vtEngine, const GLfloat vPos[3], GLfloat angleOfView
+)
+{
+    vtEngine->vPos[0] = vPos[0];
+    vtEngine->vPos[1] = vPos[1];
+    vtEngine->vPos[2] = vPos[2];
+    vtEngine->angleOfView = angleOfView;
+
+    /* Show the models for the viewer's position */
+    UpdateActiveModels( vtEngine, GL_FALSE);
+
+    SetupViews( vtEngine);
+    ApplyView( vtEngine, 0U);
+
+} /* End function PlaceEngineViewer */
+
+
+GLboolean MoveEngineViewer( VTEngine *vtEngine, const GLfloat destPt[3])
+{
+    GLboolean retVal = GL_FALSE;
+
+    if( CanMoveTo( vtEngine, vtEngine->vPos, destPt) == GL_TRUE)
+    {
+	vtEngine->vPos[0] = destPt[0];
+	vtEngine->vPos[1] = destPt[1];
+	vtEngine->vPos[2] = destPt[2];
+
+	retVal = GL_TRUE;
+
+    } /* End if */
+
+    /* Show the models for the viewer's new position */
+    UpdateActiveModels( vtEngine, GL_TRUE);
+
+    if( retVal == GL_TRUE)
+    {
+	SetupViews( vtEngine);
+	ApplyView( vtEngine, 0U);
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function MoveEngineViewer */
+
+
+void TurnEngineViewer( VTEngine *vtEngine, GLdouble turnAngle)
+{
+    vtEngine->angleOfView += turnAngle;
+
+    if( vtEngine->angleOfView > ( 2.0F * M_PI))
+    {
+	vtEngine->angleOfView -= ( 2.0F * M_PI);
+
+    } /* End if */
+    else if( vtEngine->angleOfView < 0.0F)
+    {
+	vtEngine->angleOfView += ( 2.0F * M_PI);
+
+    } /* End else-if */
+
+    SetupViews( vtEngine);
+    ApplyView( vtEngine, 0U);
+
+} /* End function TurnEngineViewer */
+
+
+void ShowEngineMinimap( VTEngine *vtEngine, GLboolean showMinimap)
+{
+    vtEngine->showMinimap = showMinimap;
+
+    SetupViews( vtEngine);
+    ApplyView( vtEngine, 0U);
+
+} /* End function ShowEngineMinimap */
+
+
+void RenderEngineFrame( VTEngine *vtEngine)
+{
+    register Uint32 i;
+    Uint32 n, v;
+    GLushort *ringIndices = NULL;
+
+    glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+
+    /* Queue the triangles straight into the index ring, if any */
+    if( vtEngine->idxRing != NULL)
+    {
+	ringIndices = MapIndexRing( vtEngine->idxRing);
+
+    } /* End if */
+
+    /* Work out which of the models shown can be seen in any of the
+     * views, and which of their triangles.
+     */
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	ModelInst *anInst = ( vtEngine->modelInsts + n);
+
+	anInst->isVisible = GL_FALSE;
+
+	if( anInst->isActive == GL_FALSE)
+	{
+	    continue;
+
+	} /* End if */
+
+	for( v = 0U; v < vtEngine->numViews; v++)
+	{
+	    if( IsBoxInFrustum( 
+		    anInst->sceneModel->minCorner, 
+		    anInst->sceneModel->maxCorner, 
+		    vtEngine->views[v].frustum
+		) == GL_TRUE
+	    )
+	    {
+		anInst->isVisible = GL_TRUE;
+		break;
+
+	    } /* End if */
+
+	} /* End for */
+
+	if( anInst->isVisible == GL_FALSE)
+	{
+	    continue;
+
+	} /* End if */
+
+	SetModelViews( vtEngine, anInst);
+
+	if( vtEngine->useBSP == GL_TRUE)
+	{
+	    /* Clear display queue */
+	    memset( anInst->numVerts, 0, ( anInst->numMaps * sizeof( Uint32)));
+
+	    anInst->queueIndices = anInst->vertIndices;
+
+	    if( ringIndices != NULL)
+	    {
+		for( i = 0U; i < anInst->numMaps; i++)
+		{
+		    anInst->ringVertIndices[i] = 
+			( ringIndices + anInst->ringOffsets[i]);
+
+		} /* End for */
+
+		anInst->queueIndices = anInst->ringVertIndices;
+
+	    } /* End if */
+
+	    /* Nothing worked out for the partition planes in earlier
+	     * frames holds for this one.
+	     */
+	    anInst->bspFrame++;
+	    if( anInst->bspFrame == 0U)
+	    {
+		memset( 
+		    anInst->planeFrames, 0, 
+		    ( anInst->bspModel->numPlanes * sizeof( Uint32))
+		);
+		anInst->bspFrame = 1U;
+
+	    } /* End if */
+
+	    DrawBSPTree( vtEngine, anInst, anInst->bspModel->bspTree);
+
+	} /* End if */
+	else
+	{
+	    QueueGLDClusters( vtEngine, anInst);
+
+	} /* End else */
+
+    } /* End for */
+
+    if( ringIndices != NULL)
+    {
+	UnmapIndexRing( vtEngine->idxRing);
+
+    } /* End if */
+
+
+    if( vtEngine->showMinimap == GL_TRUE)
+    {
+	DrawMinimapBackground( vtEngine);
+
+    } /* End if */
+
+
+    /* Now draw all the queued triangles */
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	if( vtEngine->modelInsts[n].isVisible == GL_TRUE)
+	{
+	    DrawModel( vtEngine, ( vtEngine->modelInsts + n), ringIndices);
+
+	} /* End if */
+
+    } /* End for */
+
+    if( ringIndices != NULL)
+    {
+	RetireIndexRing( vtEngine->idxRing);
+
+    } /* End if */
+
+    if( vtEngine->showMinimap == GL_TRUE)
+    {
+	DrawMinimapMarker( vtEngine);
+
+    } /* End if */
+
+    /* Leave the main view in place (for picking, etc.) */
+    ApplyView( vtEngine, 0U);
+
+} /* End function RenderEngineFrame */
+
+
+void PrefetchEngineView(
+    VTEngine *vtEngine, const GLfloat vPos[3], GLfloat angleOfView
+)
+{
+    ViewDef aView;
+    GLdouble center[3], upDir[3];
+    GLdouble top, halfWidth;
+    Uint32 n;
+    Uint16 i;
+    int m;
+
+    /* The main view the viewer would have there. (The eyes of a stereo
+     * pair are too close together for one to need textures that the
+     * other does not, so a single view spanning the screen is used.)
+     */
+    aView.vpX = aView.vpY = 0;
+    aView.vpWidth = (GLsizei )vtEngine->scrWidth;
+    aView.vpHeight = (GLsizei )vtEngine->scrHeight;
+
+    aView.viewDir[0] = cos( angleOfView);
+    aView.viewDir[1] = 0.0;
+    aView.viewDir[2] = sin( angleOfView);
+
+    for( m = 0; m < 3; m++)
+    {
+	aView.eyePos[m] = vPos[m];
+	center[m] = vPos[m] + aView.viewDir[m];
+
+    } /* End for */
+
+    upDir[0] = 0.0;
+    upDir[1] = 1.0;
+    upDir[2] = 0.0;
+
+    top = NEAR_Z_CLIP * tan( ( FIELD_OF_VIEW / 2.0) * M_PI / 180.0);
+    halfWidth = 
+	top * (GLdouble )vtEngine->scrWidth / (GLdouble )vtEngine->scrHeight;
+
+    SetViewMatrices( &aView, -halfWidth, halfWidth, top, center, upDir);
+
+    /* Leave the views of this frame in place */
+    ApplyView( vtEngine, 0U);
+
+    /* Request the textures of the models that would be shown there
+     * whose triangles could be seen in the view.
+     */
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	ModelInst *anInst = ( vtEngine->modelInsts + n);
+	SceneModel *aModel = anInst->sceneModel;
+	GLfloat eyePos[3];
+	GLdouble pixelScale;
+
+	if( ( anInst->texStream == NULL) ||
+	    ( IsSceneModelActive( aModel, vPos) == GL_FALSE) ||
+	    ( IsBoxInFrustum( 
+		aModel->minCorner, aModel->maxCorner, aView.frustum
+	    ) == GL_FALSE)
+	)
+	{
+	    continue;
+
+	} /* End if */
+
+	WorldToModelPoint( aModel, aView.eyePos, eyePos);
+	pixelScale = aView.pixelScale * aModel->scale;
+
+	for( i = 0U; i < anInst->numMaps; i++)
+	{
+	    StreamedTex *aTex = ( anInst->texStream->textures + i);
+	    GLfloat worldMin[3], worldMax[3];
+
+	    GetWorldBox( 
+		aModel, aTex->minCorner, aTex->maxCorner, worldMin, worldMax
+	    );
+
+	    if( IsBoxInFrustum( worldMin, worldMax, aView.frustum) == GL_TRUE)
+	    {
+		RequestStreamedTex( anInst->texStream, i, eyePos, pixelScale);
+
+	    } /* End if */
+
+	} /* End for */
+
+    } /* End for */
+
+} /* End function PrefetchEngineView */
+
+
+void UpdateEngineTextures( VTEngine *vtEngine)
+{
+    Uint32 n;
+
+    /* Including those of the models that are not being shown */
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	if( vtEngine->modelInsts[n].texStream != NULL)
+	{
+	    UpdateTexStream( vtEngine->modelInsts[n].texStream);
+
+	} /* End if */
+
+    } /* End for */
+
+} /* End function UpdateEngineTextures */
+
+
+GLboolean WatchEngineFiles( VTEngine *vtEngine)
+{
+    EngineAsset *anAsset;
+    Uint32 n, k;
+    Uint16 i;
+
+    if( vtEngine->hotLoader != NULL)
+    {
+	return GL_TRUE;
+
+    } /* End if */
+
+    /* Each model shown, its collision mesh (if any) and the JPEG image
+     * and compressed form of each of its textures (at most - see
+     * below).
+     */
+    vtEngine->numAssets = 0U;
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	ModelInst *anInst = ( vtEngine->modelInsts + n);
+
+	vtEngine->numAssets += 1U + 2U * (Uint32 )anInst->numMaps;
+	if( anInst->colDetModel != NULL)
+	{
+	    vtEngine->numAssets++;
+
+	} /* End if */
+
+    } /* End for */
+
+    /* NOTE: Uses calloc( ) to initialise the contents to 0 */
+    vtEngine->assets = (EngineAsset *)( 
+	calloc( vtEngine->numAssets, sizeof( EngineAsset))
+    );
+    if( vtEngine->assets == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    vtEngine->hotLoader = GenHotLoader( );
+
+    anAsset = vtEngine->assets;
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	ModelInst *anInst = ( vtEngine->modelInsts + n);
+	SceneModel *aModel = anInst->sceneModel;
+	EngineAsset *firstAsset = anAsset;
+
+	anAsset->assetType = ENGINE_ASSET_MODEL;
+	SetAssetMaps( anAsset, anInst->numMaps, anInst->mapNames);
+	WatchHotFile( 
+	    vtEngine->hotLoader,
+	    ( ( vtEngine->useBSP == GL_TRUE) ? 
+		aModel->bspFileName : aModel->gldFileName),
+	    ReloadAsset, FreeReloadedAsset, anAsset
+	);
+	anAsset++;
+
+	if( anInst->colDetModel != NULL)
+	{
+	    anAsset->assetType = ENGINE_ASSET_COLDET;
+	    WatchHotFile( 
+		vtEngine->hotLoader, aModel->colDetFileName,
+		ReloadAsset, FreeReloadedAsset, anAsset
+	    );
+	    anAsset++;
+
+	} /* End if */
+
+	for( i = 0U; i < anInst->numMaps; i++)
+	{
+	    /* A texture whose files can not be named is not watched (if
+	     * they can, the name of the texture map fits too, being a
+	     * part of that of its JPEG image)
+	     */
+	    if( GetMapFileNames( 
+		    anInst->mapNames[i], anAsset->dxtFileName,
+		    anAsset->jpgFileName
+		) == GL_FALSE
+	    )
+	    {
+		continue;
+
+	    } /* End if */
+
+	    anAsset->assetType = ENGINE_ASSET_TEXTURE;
+	    anAsset->texNum = i;
+	    strcpy( anAsset->mapName, anInst->mapNames[i]);
+	    anAsset[1] = anAsset[0];
+
+	    /* The JPEG image, read without the (now out of date) cached
+	     * form, and the cached form, when "make texcache" updates it
+	     */
+	    WatchHotFile( 
+		vtEngine->hotLoader, anAsset[0].jpgFileName,
+		ReloadAsset, FreeReloadedAsset, ( anAsset + 0)
+	    );
+	    anAsset[0].dxtFileName[0] = '\0';
+
+	    WatchHotFile( 
+		vtEngine->hotLoader, anAsset[1].dxtFileName,
+		ReloadAsset, FreeReloadedAsset, ( anAsset + 1)
+	    );
+
+	    anAsset += 2;
+
+	} /* End for */
+
+	for( k = 0U; k < (Uint32 )( anAsset - firstAsset); k++)
+	{
+	    firstAsset[k].instNum = n;
+	    firstAsset[k].sceneModel = aModel;
+	    firstAsset[k].useBSP = vtEngine->useBSP;
+	    firstAsset[k].vertLayout = vtEngine->vertLayout;
+	    firstAsset[k].texReduction = vtEngine->texReduction;
+
+	} /* End for */
+
+    } /* End for */
+
+    vtEngine->numAssets = (Uint32 )( anAsset - vtEngine->assets);
+
+    if( StartHotLoader( vtEngine->hotLoader) == GL_FALSE)
+    {
+	FreeHotLoader( vtEngine->hotLoader);
+	vtEngine->hotLoader = NULL;
+	FreeAssets( vtEngine);
+
+	return GL_FALSE;
+
+    } /* End if */
+
+    return GL_TRUE;
+
+} /* End function WatchEngineFiles */
+
+
+void SwapEngineReloads( VTEngine *vtEngine)
+{
+    void *loadedData, *fileData;
+
+    if( vtEngine->hotLoader == NULL)
+    {
+	return;
+
+    } /* End if */
+
+    while( ( loadedData = TakeHotLoad( vtEngine->hotLoader, &fileData)) != 
+	NULL
+    )
+    {
+	EngineAsset *anAsset = (EngineAsset *)fileData;
+	ModelInst *anInst = ( vtEngine->modelInsts + anAsset->instNum);
+
+	if( anAsset->assetType == ENGINE_ASSET_MODEL)
+	{
+	    SwapInstModel( vtEngine, anInst, (ShownModel *)loadedData);
+	    FreeReloadedModel( (ShownModel *)loadedData);
+
+	} /* End if */
+	else if( anAsset->assetType == ENGINE_ASSET_COLDET)
+	{
+	    FreeCXMesh( anInst->colDetModel);
+	    anInst->colDetModel = (CXMesh *)loadedData;
+
+	} /* End else-if */
+	else if( ( anInst->texStream != NULL) &&
+	    ( anAsset->texNum < anInst->numMaps) &&
+	    ( strcmp( 
+		anAsset->mapName, anInst->mapNames[anAsset->texNum]) == 0
+	    )
+	)
+	{
+	    SetStreamedTexImage( 
+		anInst->texStream, anAsset->texNum, (TexImage *)loadedData
+	    );
+
+	} /* End else-if */
+	else
+	{
+	    /* The model no longer uses the texture */
+	    FreeTexImage( (TexImage *)loadedData);
+
+	} /* End else */
+
+    } /* End while */
+
+} /* End function SwapEngineReloads */
+
+
+void IdentifyEngineSurface( VTEngine *vtEngine, int scrX, int scrY)
+{
+    PickResult aResult, bestResult;
+    ModelInst *bestInst = NULL;
+    GLfloat bestDist = 0.0F;
+    GLdouble winX, winY;
+    Uint32 n, v;
+
+    /* Pick through the centre of the pixel, in the topmost view
+     * containing it.
+     */
+    winX = scrX + 0.5;
+    winY = ( vtEngine->scrHeight - scrY) - 0.5;
+
+    for( v = ( vtEngine->numViews - 1U); v > 0U; v--)
+    {
+	if( ( winX >= vtEngine->views[v].vpX) && 
+	    ( winX < ( vtEngine->views[v].vpX + vtEngine->views[v].vpWidth)) &&
+	    ( winY >= vtEngine->views[v].vpY) && 
+	    ( winY < ( vtEngine->views[v].vpY + vtEngine->views[v].vpHeight))
+	)
+	{
+	    break;
+
+	} /* End if */
+
+    } /* End for */
+
+    /* Find the nearest surface of any of the models shown */
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	ModelInst *anInst = ( vtEngine->modelInsts + n);
+
+	if( anInst->isActive == GL_FALSE)
+	{
+	    continue;
+
+	} /* End if */
+
+	if( anInst->pickBVH == NULL)
+	{
+	    GLData *pickModel = anInst->gldModel;
+
+	    if( vtEngine->useBSP == GL_TRUE)
+	    {
+		const char *mdlName = anInst->sceneModel->gldFileName;
+		FILE *mdlFile;
+
+		if( ( mdlFile = fopen( mdlName, "rb")) == NULL)
+		{
+		    fprintf( 
+			stderr,
+			"\nERROR: Could not read GLD model \"%s\" for "
+			"picking\n",
+			mdlName
+		    );
+		    perror( "Details");
+		    continue;
+
+		} /* End if */
+
+		pickModel = LoadGLData( mdlFile);
+		fclose( mdlFile);
+
+		if( pickModel == NULL)
+		{
+		    continue;
+
+		} /* End if */
+
+		anInst->pickModel = pickModel;
+
+	    } /* End if */
+
+	    anInst->pickBVH = GenBVHData( pickModel);
+
+	} /* End if */
+
+	ApplyModelView( vtEngine, anInst, v);
+
+	if( PickSurface( anInst->pickBVH, winX, winY, &aResult) == GL_TRUE)
+	{
+	    /* Distances in the model's coordinates are scaled */
+	    aResult.distance *= anInst->sceneModel->scale;
+
+	    if( ( bestInst == NULL) || ( aResult.distance < bestDist))
+	    {
+		bestInst = anInst;
+		bestDist = aResult.distance;
+		bestResult = aResult;
+
+	    } /* End if */
+
+	} /* End if */
+
+    } /* End for */
+
+    ApplyView( vtEngine, 0U);
+
+    if( bestInst != NULL)
+    {
+	GLfloat hitPos[3];
+
+	ModelToWorldPoint( bestInst->sceneModel, bestResult.hitPos, hitPos);
+
+	printf( "\n");
+	printf( "Picked Surface: \n");
+	printf( "\tModel: \"%s\"\n", bestInst->sceneModel->name);
+	printf( "\tTriangle: %u\n", bestResult.triNum);
+	printf( "\tTexture Map: \"%s\"\n", bestResult.mapName);
+	printf( 
+	    "\tHitPos: (%f, %f, %f)\n",
+	    hitPos[0], hitPos[1], hitPos[2]
+	);
+	printf( "\tDistance: %.2f\n", bestResult.distance);
+
+    } /* End if */
+    else
+    {
+	printf( "\nNo surface picked\n");
+
+    } /* End else */
+
+} /* End function IdentifyEngineSurface */
+
+
+void FreeEngine( VTEngine *vtEngine)
+{
+    Uint32 n;
+
+    if( vtEngine == NULL)
+    {
+	return;
+
+    } /* End if */
+
+    /* Stop loading the models and textures, if still loading them */
+    FreeLoads( vtEngine);
+
+    /* Stop watching the files of the scene (before letting go of
+     * what the loader reads them in as)
+     */
+    FreeHotLoader( vtEngine->hotLoader);
+    vtEngine->hotLoader = NULL;
+    FreeAssets( vtEngine);
+
+    /* Free the ring of indices */
+    FreeIndexRing( vtEngine->idxRing);
+    vtEngine->idxRing = NULL;
+
+    /* Free each model and associated resources */
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	ModelInst *anInst = ( vtEngine->modelInsts + n);
+
+	FreeInstQueues( anInst);
+	FreeInstTextures( anInst);
+	FreeInstModel( anInst);
+
+	FreeCXMesh( anInst->colDetModel);
+	anInst->colDetModel = NULL;
+
+    } /* End for */
+
+    free( vtEngine->modelInsts);
+    vtEngine->modelInsts = NULL;
+    vtEngine->numInsts = 0U;
+
+    FreeScene( vtEngine->theScene);
+    vtEngine->theScene = NULL;
+
+    free( vtEngine);
+
+} /* End function FreeEngine */
+
+
+/**
+ * Read in the scene manifest, and start loading the GLData or BSP Tree
+ * version of each model listed in it as needed, as well as the
+ * collision meshes used for collision detection - each in a task of
+ * its own, on the threads of the engine's task pool. Returns GL_FALSE
+ * if the scene could not be read.
+ */
+GLboolean LoadModels( VTEngine *vtEngine, const char *sceneName)
+{
+    Uint32 n;
+
+    if( ( vtEngine->theScene = LoadScene( sceneName)) == NULL)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    /* NOTE: Uses calloc( ) to initialise the contents to 0 */
+    vtEngine->modelInsts = (ModelInst *)( 
+	calloc( vtEngine->theScene->numModels, sizeof( ModelInst))
+    );
+    vtEngine->modelLoads = (ModelLoad *)( 
+	calloc( vtEngine->theScene->numModels, sizeof( ModelLoad))
+    );
+    if( ( vtEngine->modelInsts == NULL) || ( vtEngine->modelLoads == NULL))
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    vtEngine->numInsts = vtEngine->theScene->numModels;
+
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	vtEngine->modelInsts[n].sceneModel = ( vtEngine->theScene->models + n);
+
+	vtEngine->modelLoads[n].vtEngine = vtEngine;
+	vtEngine->modelLoads[n].instNum = n;
+
+    } /* End for */
+
+    vtEngine->loadPool = GenTaskPool( ENGINE_LOAD_THREADS);
+
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	AddPoolTask( 
+	    vtEngine->loadPool, LoadModelTask, ( vtEngine->modelLoads + n),
+	    GL_FALSE, 0U, NULL
+	);
+
+	if( vtEngine->modelInsts[n].sceneModel->colDetFileName[0] != '\0')
+	{
+	    AddPoolTask( 
+		vtEngine->loadPool, LoadColDetTask, ( vtEngine->modelLoads + n),
+		GL_FALSE, 0U, NULL
+	    );
+
+	} /* End if */
+
+    } /* End for */
+
+    return GL_TRUE;
+
+} /* End function LoadModels */
+
+
+/**
+ * Reads in the model to be shown for a model of the scene, clusters its
+ * triangles and creates its drawing queues, and then adds the tasks
+ * loading its textures: one creating their texture objects and, for
+ * each texture, one decoding its image and one handing it over to
+ * OpenGL once both are done.
+ */
+int LoadModelTask( TaskPool *taskPool, void *taskData)
+{
+    ModelLoad *modelLoad = (ModelLoad *)taskData;
+    VTEngine *vtEngine = modelLoad->vtEngine;
+    ModelInst *anInst = ( vtEngine->modelInsts + modelLoad->instNum);
+    ShownModel shownModel;
+    Uint32 preTasks[2];
+    Uint16 i;
+
+    if( ReadShownModel( 
+	    anInst->sceneModel, vtEngine->useBSP, vtEngine->vertLayout, 
+	    &shownModel
+	) == GL_FALSE
+    )
+    {
+	return -1;
+
+    } /* End if */
+
+    SetInstModel( anInst, &shownModel);
+    InitInstQueues( anInst, vtEngine->useBSP);
+
+    if( anInst->numMaps == 0U)
+    {
+	return 0;
+
+    } /* End if */
+
+    /* NOTE: Uses calloc( ) to initialise the contents to 0 */
+    modelLoad->numMaps = anInst->numMaps;
+    modelLoad->texLoads = 
+	(TexLoad *)( calloc( anInst->numMaps, sizeof( TexLoad)));
+    if( modelLoad->texLoads == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    /* (The tasks added here need not wait for this one, which has done
+     * all they need by the time they are added.)
+     */
+    modelLoad->texObjTask = AddPoolTask( 
+	taskPool, InitTexObjTask, modelLoad, GL_TRUE, 0U, NULL
+    );
+
+    for( i = 0U; i < anInst->numMaps; i++)
+    {
+	TexLoad *texLoad = ( modelLoad->texLoads + i);
+
+	texLoad->modelLoad = modelLoad;
+	texLoad->texNum = i;
+
+	preTasks[0] = modelLoad->texObjTask;
+	preTasks[1] = AddPoolTask( 
+	    taskPool, LoadTexTask, texLoad, GL_FALSE, 0U, NULL
+	);
+
+	AddPoolTask( taskPool, UploadTexTask, texLoad, GL_TRUE, 2U, preTasks);
+
+    } /* End for */
+
+    return 0;
+
+} /* End function LoadModelTask */
+
+
+/**
+ * Reads in the collision mesh of a model of the scene.
+ */
+int LoadColDetTask( TaskPool *taskPool, void *taskData)
+{
+    ModelLoad *modelLoad = (ModelLoad *)taskData;
+    ModelInst *anInst = 
+	( modelLoad->vtEngine->modelInsts + modelLoad->instNum);
+    SceneModel *aModel = anInst->sceneModel;
+
+    (void )taskPool;
+
+    anInst->colDetModel = ReadCXModel( aModel->colDetFileName, aModel->name);
+
+    return ( anInst->colDetModel != NULL) ? 0 : -1;
+
+} /* End function LoadColDetTask */
+
+
+/**
+ * Creates the texture objects of a model of the scene (on the thread
+ * whose OpenGL context is current).
+ */
+int InitTexObjTask( TaskPool *taskPool, void *taskData)
+{
+    ModelLoad *modelLoad = (ModelLoad *)taskData;
+
+    (void )taskPool;
+
+    InitInstTextures( modelLoad->vtEngine->modelInsts + modelLoad->instNum);
+
+    return 0;
+
+} /* End function InitTexObjTask */
+
+
+/**
+ * Decodes the image of a texture of a model of the scene, preferring
+ * its compressed form in the texture cache. Whether the OpenGL
+ * implementation supports it is not yet known, so that is left to
+ * UploadTexTask( ) to check. (A texture that can not be loaded is just
+ * left out, as before.)
+ */
+int LoadTexTask( TaskPool *taskPool, void *taskData)
+{
+    TexLoad *texLoad = (TexLoad *)taskData;
+    ModelLoad *modelLoad = texLoad->modelLoad;
+    ModelInst *anInst = ( modelLoad->vtEngine->modelInsts + modelLoad->instNum);
+    char dxtFileName[ENGINE_MAX_MAP_PATH];
+    char jpgFileName[ENGINE_MAX_MAP_PATH];
+
+    (void )taskPool;
+
+    if( GetMapFileNames( 
+	    anInst->mapNames[texLoad->texNum], dxtFileName, jpgFileName
+	) == GL_TRUE
+    )
+    {
+	texLoad->texImage = ReadTexImage( 
+	    dxtFileName, jpgFileName, modelLoad->vtEngine->texReduction
+	);
+
+    } /* End if */
+
+    return 0;
+
+} /* End function LoadTexTask */
+
+
+/**
+ * Hands the decoded image of a texture of a model of the scene over to
+ * OpenGL (on the thread whose OpenGL context is current) - decoding its
+ * JPEG image instead if the image is compressed and the OpenGL
+ * implementation does not support S3TC compressed textures.
+ */
+int UploadTexTask( TaskPool *taskPool, void *taskData)
+{
+    TexLoad *texLoad = (TexLoad *)taskData;
+    ModelLoad *modelLoad = texLoad->modelLoad;
+    ModelInst *anInst = ( modelLoad->vtEngine->modelInsts + modelLoad->instNum);
+    TexImage *texImage = texLoad->texImage;
+
+    (void )taskPool;
+
+    texLoad->texImage = NULL;
+
+    if( ( texImage != NULL) && 
+	( texImage->texFormat == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) &&
+	( hasS3TCTextures == GL_FALSE)
+    )
+    {
+	char dxtFileName[ENGINE_MAX_MAP_PATH];
+	char jpgFileName[ENGINE_MAX_MAP_PATH];
+
+	FreeTexImage( texImage);
+
+	texImage = NULL;
+	if( GetMapFileNames( 
+		anInst->mapNames[texLoad->texNum], dxtFileName, jpgFileName
+	    ) == GL_TRUE
+	)
+	{
+	    texImage = LoadTexImage( 
+		NULL, jpgFileName, modelLoad->vtEngine->texReduction
+	    );
+
+	} /* End if */
+
+    } /* End if */
+
+    if( texImage != NULL)
+    {
+	SetStreamedTexImage( anInst->texStream, texLoad->texNum, texImage);
+
+    } /* End if */
+
+    return 0;
+
+} /* End function UploadTexTask */
+
+
+/**
+ * Runs the tasks loading the models and textures that must be run on
+ * this thread as they are ready, reporting the progress made to
+ * 'progressFn' (if not NULL), until all of them are done - and then
+ * lets go of the task pool and lays out the index ring. Returns
+ * GL_FALSE if any of the models could not be read.
+ */
+GLboolean FinishLoading( 
+    VTEngine *vtEngine, EngineProgressFn progressFn, void *cbData
+)
+{
+    Uint32 numDone, numTasks;
+    Uint32 percentShown = 0U;
+    GLboolean hasFailed;
+
+    if( progressFn != NULL)
+    {
+	progressFn( cbData, 0U);
+
+    } /* End if */
+
+    while( RunMainPoolTask( vtEngine->loadPool) == GL_TRUE)
+    {
+	/* Tasks are still being added as models are read in, so the
+	 * progress made is shown only once it has gone ahead for sure.
+	 */
+	numDone = GetPoolProgress( vtEngine->loadPool, &numTasks);
+
+	if( ( progressFn != NULL) && 
+	    ( ( ( numDone * 100U) / numTasks) >= 
+		( percentShown + ENGINE_PROGRESS_STEP))
+	)
+	{
+	    percentShown = ( numDone * 100U) / numTasks;
+	    progressFn( cbData, percentShown);
+
+	} /* End if */
+
+    } /* End while */
+
+    hasFailed = HasPoolFailed( vtEngine->loadPool);
+    FreeLoads( vtEngine);
+
+    if( hasFailed == GL_TRUE)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    SetRingOffsets( vtEngine);
+
+    if( progressFn != NULL)
+    {
+	progressFn( cbData, 100U);
+
+    } /* End if */
+
+    return GL_TRUE;
+
+} /* End function FinishLoading */
+
+
+/**
+ * Stops the tasks loading the models and textures, if any, and lets go
+ * of the images loaded but not handed over to OpenGL.
+ */
+void FreeLoads( VTEngine *vtEngine)
+{
+    Uint32 n;
+    Uint16 i;
+
+    FreeTaskPool( vtEngine->loadPool);
+    vtEngine->loadPool = NULL;
+
+    for( n = 0U; ( vtEngine->modelLoads != NULL) && ( n < vtEngine->numInsts); 
+	n++
+    )
+    {
+	ModelLoad *modelLoad = ( vtEngine->modelLoads + n);
+
+	for( i = 0U; i < modelLoad->numMaps; i++)
+	{
+	    FreeTexImage( modelLoad->texLoads[i].texImage);
+
+	} /* End for */
+
+	free( modelLoad->texLoads);
+
+    } /* End for */
+
+    free( vtEngine->modelLoads);
+    vtEngine->modelLoads = NULL;
+
+} /* End function FreeLoads */
+
+
+/**
+ * Reads in the GLData (laid out as given, and clustered) or BSP Tree
+ * version of the given model of the scene. Returns GL_FALSE if it
+ * could not be read.
+ */
+GLboolean ReadShownModel( 
+    SceneModel *aModel, GLboolean useBSP, GLDVertLayout vertLayout,
+    ShownModel *shownModel
+)
+{
+    shownModel->gldModel = NULL;
+    shownModel->clusterData = NULL;
+    shownModel->bspModel = NULL;
+    shownModel->numTexImages = 0U;
+    shownModel->texImages = NULL;
+
+    if( useBSP == GL_TRUE)
+    {
+	/* Use the BSP Tree version of the model */
+	if( aModel->bspFileName[0] == '\0')
+	{
+	    fprintf( 
+		stderr,
+		"\nERROR: No BSP model for \"%s\" in the scene\n",
+		aModel->name
+	    );
+	    return GL_FALSE;
+
+	} /* End if */
+
+	shownModel->bspModel = 
+	    ReadBSPModel( aModel->bspFileName, aModel->name);
+	if( shownModel->bspModel == NULL)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+    } /* End if */
+    else
+    {
+	/* Use the simple GLData format of the model */
+	shownModel->gldModel = 
+	    ReadGLDModel( aModel->gldFileName, aModel->name);
+	if( shownModel->gldModel == NULL)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+	SetGLDVertLayout( shownModel->gldModel, vertLayout);
+	shownModel->clusterData = GenClusterData( shownModel->gldModel);
+
+    } /* End else */
+
+    return GL_TRUE;
+
+} /* End function ReadShownModel */
+
+
+/**
+ * Makes the given model, as read in, the model shown for the given
+ * model of the scene.
+ */
+void SetInstModel( ModelInst *anInst, const ShownModel *shownModel)
+{
+    GLfloat minCorner[3], maxCorner[3];
+
+    anInst->gldModel = shownModel->gldModel;
+    anInst->clusterData = shownModel->clusterData;
+    anInst->bspModel = shownModel->bspModel;
+
+    if( anInst->bspModel != NULL)
+    {
+	/* NOTE: Uses calloc( ) so that no plane seems to have been
+	 * worked out for the first frame.
+	 */
+	anInst->bspFrame = 0U;
+	anInst->planeFrames = (Uint32 *)( 
+	    calloc( anInst->bspModel->numPlanes, sizeof( Uint32))
+	);
+	anInst->planeHides = (Uint8 *)( 
+	    malloc( anInst->bspModel->numPlanes * sizeof( Uint8))
+	);
+	if( ( ( anInst->planeFrames == NULL) || 
+	      ( anInst->planeHides == NULL)) &&
+	    ( anInst->bspModel->numPlanes > 0U)
+	)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	anInst->numMaps = anInst->bspModel->nMaps;
+	anInst->mapNames = anInst->bspModel->mapNames;
+	anInst->vertCoords = anInst->bspModel->vertCoords;
+	anInst->texCoords = anInst->bspModel->texCoords;
+	anInst->vertStride = 3U;
+	anInst->texStride = 2U;
+
+	minCorner[0] = anInst->bspModel->minX;
+	minCorner[1] = anInst->bspModel->minY;
+	minCorner[2] = anInst->bspModel->minZ;
+	maxCorner[0] = anInst->bspModel->maxX;
+	maxCorner[1] = anInst->bspModel->maxY;
+	maxCorner[2] = anInst->bspModel->maxZ;
+
+    } /* End if */
+    else
+    {
+	anInst->numMaps = anInst->gldModel->nMaps;
+	anInst->mapNames = anInst->gldModel->mapNames;
+	anInst->vertCoords = anInst->gldModel->vertCoords;
+	anInst->texCoords = anInst->gldModel->texCoords;
+	anInst->vertStride = anInst->gldModel->vertStride;
+	anInst->texStride = anInst->gldModel->texStride;
+
+	minCorner[0] = anInst->gldModel->minX;
+	minCorner[1] = anInst->gldModel->minY;
+	minCorner[2] = anInst->gldModel->minZ;
+	maxCorner[0] = anInst->gldModel->maxX;
+	maxCorner[1] = anInst->gldModel->maxY;
+	maxCorner[2] = anInst->gldModel->maxZ;
+
+    } /* End else */
+
+    SetSceneModelBounds( anInst->sceneModel, minCorner, maxCorner);
+
+} /* End function SetInstModel */
+
+
+/**
+ * Returns the number of texture maps used by the given model, as read
+ * in, setting 'mapNames' to their names.
+ */
+Uint16 GetShownMaps( const ShownModel *shownModel, char ***mapNames)
+{
+    if( shownModel->bspModel != NULL)
+    {
+	*mapNames = shownModel->bspModel->mapNames;
+	return shownModel->bspModel->nMaps;
+
+    } /* End if */
+
+    *mapNames = shownModel->gldModel->mapNames;
+    return shownModel->gldModel->nMaps;
+
+} /* End function GetShownMaps */
+
+
+/**
+ * Returns GL_TRUE if the given lists of texture maps are the same.
+ */
+GLboolean HasSameMaps( 
+    Uint16 numMaps, char **mapNames, Uint16 oldNumMaps, char **oldMapNames
+)
+{
+    Uint16 i;
+
+    if( numMaps != oldNumMaps)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    for( i = 0U; i < numMaps; i++)
+    {
+	if( strcmp( mapNames[i], oldMapNames[i]) != 0)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+    } /* End for */
+
+    return GL_TRUE;
+
+} /* End function HasSameMaps */
+
+
+/**
+ * Reads in the given GLData model of the given model of the scene.
+ * Returns NULL on failure.
+ */
+GLData *ReadGLDModel( const char *fileName, const char *modelName)
+{
+    FILE *mdlFile;
+    GLData *retVal = NULL;
+
+    if( ( mdlFile = fopen( fileName, "rb")) != NULL)
+    {
+	retVal = LoadGLData( mdlFile);
+	fclose( mdlFile);
+
+    } /* End if */
+
+    if( retVal == NULL)
+    {
+	fprintf( 
+	    stderr,
+	    "\nERROR: Could not read the GLD model \"%s\" of \"%s\"\n",
+	    fileName, modelName
+	);
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function ReadGLDModel */
+
+
+/**
+ * Reads in the given BSP Tree model of the given model of the scene.
+ * Returns NULL on failure.
+ */
+BSPTreeData *ReadBSPModel( const char *fileName, const char *modelName)
+{
+    FILE *mdlFile;
+    BSPTreeData *retVal = NULL;
+
+    if( ( mdlFile = fopen( fileName, "rb")) != NULL)
+    {
+	retVal = LoadBSPTreeData( mdlFile);
+	fclose( mdlFile);
+
+    } /* End if */
+
+    if( retVal == NULL)
+    {
+	fprintf( 
+	    stderr,
+	    "\nERROR: Could not read the BSP model \"%s\" of \"%s\"\n",
+	    fileName, modelName
+	);
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function ReadBSPModel */
+
+
+/**
+ * Reads in the given collision mesh of the given model of the scene.
+ * Returns NULL on failure.
+ */
+CXMesh *ReadCXModel( const char *fileName, const char *modelName)
+{
+    FILE *mdlFile;
+    CXMesh *retVal = NULL;
+
+    if( ( mdlFile = fopen( fileName, "rb")) != NULL)
+    {
+	retVal = LoadCXMesh( mdlFile);
+	fclose( mdlFile);
+
+    } /* End if */
+
+    if( retVal == NULL)
+    {
+	fprintf( 
+	    stderr,
+	    "\nERROR: Could not read the collision mesh \"%s\" of \"%s\"\n",
+	    fileName, modelName
+	);
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function ReadCXModel */
+
+
+/**
+ * Initialises various queues - vertex arrays, etc.
+ */
+void InitQueues( VTEngine *vtEngine)
+{
+    Uint32 n;
+
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	InitInstQueues( ( vtEngine->modelInsts + n), vtEngine->useBSP);
+
+    } /* End for */
+
+    SetRingOffsets( vtEngine);
+
+} /* End function InitQueues */
+
+
+/**
+ * Creates the drawing queues of the given model, leaving their places
+ * in the index ring to be set by SetRingOffsets( ).
+ */
+void InitInstQueues( ModelInst *anInst, GLboolean useBSP)
+{
+    Uint16 numMaps = anInst->numMaps;
+    Uint32 i;
+
+    /* Create the drawing queues */
+    anInst->numVerts = (Uint32 *)( malloc( numMaps * sizeof( Uint32)));
+    anInst->vertIndices = 
+	(GLushort **)( malloc( numMaps * sizeof( GLushort *)));
+    anInst->ringOffsets = (Uint32 *)( malloc( numMaps * sizeof( Uint32)));
+    anInst->ringVertIndices = 
+	(GLushort **)( malloc( numMaps * sizeof( GLushort *)));
+
+    if( ( ( anInst->numVerts == NULL) || ( anInst->vertIndices == NULL) ||
+	  ( anInst->ringOffsets == NULL) || 
+	  ( anInst->ringVertIndices == NULL)) &&
+	( numMaps > 0U)
+    )
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    anInst->queueIndices = anInst->vertIndices;
+
+    for( i = 0U; i < numMaps; i++)
+    {
+	Uint32 nTri;
+
+	nTri = ( useBSP == GL_TRUE) ? 
+	    anInst->bspModel->mapTriNums[i] :
+	    anInst->gldModel->mapTriNums[i];
+
+	anInst->numVerts[i] = 0U;
+	anInst->vertIndices[i] = (GLushort *)( 
+	    malloc( 3 * nTri * sizeof( GLushort))
+	);
+
+	if( anInst->vertIndices[i] == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+    } /* End for */
+
+} /* End function InitInstQueues */
+
+
+/**
+ * Works out the places of the drawing queues of all the models in the
+ * index ring's region for a frame.
+ */
+void SetRingOffsets( VTEngine *vtEngine)
+{
+    Uint32 i, n;
+
+    vtEngine->numRingIndices = 0U;
+
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	ModelInst *anInst = ( vtEngine->modelInsts + n);
+
+	for( i = 0U; i < anInst->numMaps; i++)
+	{
+	    Uint32 nTri;
+
+	    nTri = ( vtEngine->useBSP == GL_TRUE) ? 
+		anInst->bspModel->mapTriNums[i] :
+		anInst->gldModel->mapTriNums[i];
+
+	    /* Every model can be shown at once, so each has a part of
+	     * the index ring's region to itself.
+	     */
+	    anInst->ringOffsets[i] = vtEngine->numRingIndices;
+	    vtEngine->numRingIndices += 3U * nTri;
+
+	} /* End for */
+
+    } /* End for */
+
+} /* End function SetRingOffsets */
+
+
+/**
+ * Frees the drawing queues of the given model.
+ */
+void FreeInstQueues( ModelInst *anInst)
+{
+    Uint32 i;
+
+    for( i = 0U; 
+	( anInst->vertIndices != NULL) && ( i < anInst->numMaps); 
+	i++
+    )
+    {
+	anInst->numVerts[i] = 0U;
+	free( anInst->vertIndices[i]);
+	anInst->vertIndices[i] = NULL;
+
+    } /* End for */
+
+    free( anInst->numVerts);
+    anInst->numVerts = NULL;
+    free( anInst->vertIndices);
+    anInst->vertIndices = NULL;
+    free( anInst->ringOffsets);
+    anInst->ringOffsets = NULL;
+    free( anInst->ringVertIndices);
+    anInst->ringVertIndices = NULL;
+    anInst->queueIndices = NULL;
+
+} /* End function FreeInstQueues */
+
+
+/**
+ * Frees the textures of the given model, including their texture
+ * objects.
+ */
+void FreeInstTextures( ModelInst *anInst)
+{
+    FreeTexStream( anInst->texStream);
+    anInst->texStream = NULL;
+
+    if( anInst->textures != NULL)
+    {
+	glDeleteTextures( anInst->numMaps, anInst->textures);
+	CHECK_GL_ERROR;
+
+    } /* End if */
+
+    free( anInst->textures);
+    anInst->textures = NULL;
+    free( anInst->texPriorities);
+    anInst->texPriorities = NULL;
+
+} /* End function FreeInstTextures */
+
+
+/**
+ * Frees the model shown for the given model of the scene, and the
+ * models used for picking.
+ */
+void FreeInstModel( ModelInst *anInst)
+{
+    /* Free the models used for picking */
+    FreeBVHData( anInst->pickBVH);
+    anInst->pickBVH = NULL;
+    FreeGLData( anInst->pickModel);
+    anInst->pickModel = NULL;
+
+    FreeBSPTreeData( anInst->bspModel);
+    anInst->bspModel = NULL;
+    free( anInst->planeFrames);
+    anInst->planeFrames = NULL;
+    free( anInst->planeHides);
+    anInst->planeHides = NULL;
+    FreeClusterData( anInst->clusterData);
+    anInst->clusterData = NULL;
+    FreeGLData( anInst->gldModel);
+    anInst->gldModel = NULL;
+
+    anInst->numMaps = 0U;
+    anInst->mapNames = NULL;
+    anInst->vertCoords = anInst->texCoords = NULL;
+
+} /* End function FreeInstModel */
+
+
+/**
+ * Reads in again the given file of the scene, watched as the given
+ * EngineAsset. Called on the thread of the hot loader, so it must not
+ * touch the engine (or OpenGL). Returns NULL if it could not be read.
+ */
+void *ReloadAsset( const char *fileName, void *fileData)
+{
+    EngineAsset *anAsset = (EngineAsset *)fileData;
+    void *retVal = NULL;
+
+    (void )fileName;
+
+    if( anAsset->assetType == ENGINE_ASSET_MODEL)
+    {
+	ShownModel *shownModel;
+
+	shownModel = (ShownModel *)( malloc( sizeof( ShownModel)));
+	if( shownModel == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	if( ReadShownModel(
+		anAsset->sceneModel, anAsset->useBSP, anAsset->vertLayout,
+		shownModel
+	    ) == GL_TRUE
+	)
+	{
+	    ReloadModelTextures( anAsset, shownModel);
+	    retVal = shownModel;
+
+	} /* End if */
+	else
+	{
+	    free( shownModel);
+
+	} /* End else */
+
+    } /* End if */
+    else if( anAsset->assetType == ENGINE_ASSET_COLDET)
+    {
+	retVal = ReadCXModel( 
+	    anAsset->sceneModel->colDetFileName, anAsset->sceneModel->name
+	);
+
+    } /* End else-if */
+    else
+    {
+	retVal = LoadTexImage(
+	    ( ( anAsset->dxtFileName[0] != '\0') ? 
+		anAsset->dxtFileName : NULL),
+	    anAsset->jpgFileName, anAsset->texReduction
+	);
+
+    } /* End else */
+
+    return retVal;
+
+} /* End function ReloadAsset */
+
+
+/**
+ * Loads the images of the textures of the given model, as just read in
+ * again for the given file of the scene, if it uses other textures than
+ * the model last read in for it - so that only handing them over to
+ * OpenGL is left for when it is swapped in. (Called on the loader's
+ * thread, which alone uses the texture maps noted for the file.)
+ */
+void ReloadModelTextures( EngineAsset *anAsset, ShownModel *shownModel)
+{
+    char dxtFileName[ENGINE_MAX_MAP_PATH];
+    char jpgFileName[ENGINE_MAX_MAP_PATH];
+    char **mapNames;
+    Uint16 numMaps, i;
+
+    numMaps = GetShownMaps( shownModel, &mapNames);
+
+    if( HasSameMaps( 
+	    numMaps, mapNames, anAsset->numMaps, anAsset->mapNames
+	) == GL_TRUE
+    )
+    {
+	return;
+
+    } /* End if */
+
+    /* NOTE: Uses calloc( ) to initialise the contents to NULL */
+    shownModel->numTexImages = numMaps;
+    shownModel->texImages = 
+	(TexImage **)( calloc( numMaps, sizeof( TexImage *)));
+    if( shownModel->texImages == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( i = 0U; i < numMaps; i++)
+    {
+	if( GetMapFileNames( mapNames[i], dxtFileName, jpgFileName) == GL_TRUE)
+	{
+	    shownModel->texImages[i] = LoadTexImage( 
+		dxtFileName, jpgFileName, anAsset->texReduction
+	    );
+
+	} /* End if */
+
+    } /* End for */
+
+    SetAssetMaps( anAsset, numMaps, mapNames);
+
+} /* End function ReloadModelTextures */
+
+
+/**
+ * Notes the texture maps used by the model last read in for the given
+ * file of the scene (copying their names, since the model can be freed
+ * before it is read in again).
+ */
+void SetAssetMaps( EngineAsset *anAsset, Uint16 numMaps, char **mapNames)
+{
+    Uint16 i;
+
+    for( i = 0U; i < anAsset->numMaps; i++)
+    {
+	free( anAsset->mapNames[i]);
+
+    } /* End for */
+
+    free( anAsset->mapNames);
+    anAsset->mapNames = NULL;
+    anAsset->numMaps = 0U;
+
+    if( numMaps == 0U)
+    {
+	return;
+
+    } /* End if */
+
+    anAsset->mapNames = (char **)( malloc( numMaps * sizeof( char *)));
+    if( anAsset->mapNames == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( i = 0U; i < numMaps; i++)
+    {
+	anAsset->mapNames[i] = (char *)( malloc( strlen( mapNames[i]) + 1U));
+	if( anAsset->mapNames[i] == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	strcpy( anAsset->mapNames[i], mapNames[i]);
+
+    } /* End for */
+
+    anAsset->numMaps = numMaps;
+
+} /* End function SetAssetMaps */
+
+
+/**
+ * Frees what the given file of the scene was read in again as, if it
+ * is never swapped in.
+ */
+void FreeReloadedAsset( void *loadedData, void *fileData)
+{
+    EngineAsset *anAsset = (EngineAsset *)fileData;
+
+    if( anAsset->assetType == ENGINE_ASSET_MODEL)
+    {
+	ShownModel *shownModel = (ShownModel *)loadedData;
+
+	FreeBSPTreeData( shownModel->bspModel);
+	FreeClusterData( shownModel->clusterData);
+	FreeGLData( shownModel->gldModel);
+	FreeReloadedModel( shownModel);
+
+    } /* End if */
+    else if( anAsset->assetType == ENGINE_ASSET_COLDET)
+    {
+	FreeCXMesh( (CXMesh *)loadedData);
+
+    } /* End else-if */
+    else
+    {
+	FreeTexImage( (TexImage *)loadedData);
+
+    } /* End else */
+
+} /* End function FreeReloadedAsset */
+
+
+/**
+ * Frees a model read in again, along with the images of its textures
+ * not handed over to OpenGL - but not the model itself, which is freed
+ * with the model shown once it has been swapped in.
+ */
+void FreeReloadedModel( ShownModel *shownModel)
+{
+    Uint16 i;
+
+    for( i = 0U; i < shownModel->numTexImages; i++)
+    {
+	FreeTexImage( shownModel->texImages[i]);
+
+    } /* End for */
+
+    free( shownModel->texImages);
+    free( shownModel);
+
+} /* End function FreeReloadedModel */
+
+
+/**
+ * Lets go of the files of the scene watched for changes.
+ */
+void FreeAssets( VTEngine *vtEngine)
+{
+    Uint32 k;
+
+    for( k = 0U; k < vtEngine->numAssets; k++)
+    {
+	SetAssetMaps( vtEngine->assets + k, 0U, NULL);
+
+    } /* End for */
+
+    free( vtEngine->assets);
+    vtEngine->assets = NULL;
+    vtEngine->numAssets = 0U;
+
+} /* End function FreeAssets */
+
+
+/**
+ * Makes the given model, as read in again, the model shown for the
+ * given model of the scene, in place of the one it had - handing over
+ * to OpenGL the images of its textures read in along with it (which
+ * then belong to the model shown), if it uses other textures.
+ */
+void SwapInstModel( 
+    VTEngine *vtEngine, ModelInst *anInst, ShownModel *shownModel
+)
+{
+    GLboolean sameMaps;
+    Uint16 numMaps;
+    char **mapNames;
+    Uint32 n;
+    Uint16 i;
+
+    /* The textures can stay if the model still uses the same ones */
+    numMaps = GetShownMaps( shownModel, &mapNames);
+    sameMaps = HasSameMaps( 
+	numMaps, mapNames, anInst->numMaps, anInst->mapNames
+    );
+
+
+    /* The queues of all the models have their places in the index
+     * ring, so they are all made afresh.
+     */
+    FreeIndexRing( vtEngine->idxRing);
+    vtEngine->idxRing = NULL;
+
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	FreeInstQueues( vtEngine->modelInsts + n);
+
+    } /* End for */
+
+    if( sameMaps == GL_FALSE)
+    {
+	FreeInstTextures( anInst);
+
+    } /* End if */
+
+    FreeInstModel( anInst);
+    SetInstModel( anInst, shownModel);
+
+    InitQueues( vtEngine);
+
+    if( vtEngine->useBSP == GL_TRUE)
+    {
+	vtEngine->idxRing = GenIndexRing( vtEngine->numRingIndices);
+
+    } /* End if */
+
+
+    /* Texture levels are wanted for where the triangles now are */
+    if( sameMaps == GL_TRUE)
+    {
+	if( anInst->texStream != NULL)
+	{
+	    ClearStreamedTexTriangles( anInst->texStream);
+	    NoteTexTriangles( 
+		anInst->texStream, anInst->gldModel, anInst->bspModel
+	    );
+	    SetTexPriorities( anInst);
+
+	} /* End if */
+
+    } /* End if */
+    else if( anInst->numMaps > 0U)
+    {
+	InitInstTextures( anInst);
+
+	/* (The images were loaded on the loader's thread, which always
+	 * sees the textures change when this does.)
+	 */
+	for( i = 0U; i < shownModel->numTexImages; i++)
+	{
+	    if( shownModel->texImages[i] != NULL)
+	    {
+		SetStreamedTexImage( 
+		    anInst->texStream, i, shownModel->texImages[i]
+		);
+		shownModel->texImages[i] = NULL;
+
+	    } /* End if */
+
+	} /* End for */
+
+    } /* End else-if */
+
+    if( anInst->isActive == GL_TRUE)
+    {
+	glPrioritizeTextures( 
+	    anInst->numMaps, anInst->textures, anInst->texPriorities
+	);
+	CHECK_GL_ERROR;
+
+    } /* End if */
+
+} /* End function SwapInstModel */
+
+
+/**
+ * Returns GL_TRUE if the viewer can move between the given points
+ * without running into any of the models being shown.
+ */
+GLboolean CanMoveTo( 
+    VTEngine *vtEngine, const GLfloat srcPt[3], const GLfloat destPt[3]
+)
+{
+    Uint32 n;
+
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	ModelInst *anInst = ( vtEngine->modelInsts + n);
+
+	if( anInst->isActive == GL_FALSE)
+	{
+	    continue;
+
+	} /* End if */
+
+	if( anInst->colDetModel != NULL)
+	{
+	    GLfloat fromPt[3], toPt[3];
+	    GLfloat movableDist = 0.0F;
+
+	    WorldToModelPoint( anInst->sceneModel, srcPt, fromPt);
+	    WorldToModelPoint( anInst->sceneModel, destPt, toPt);
+
+	    if( hasCXCollision( 
+		    anInst->colDetModel, fromPt, toPt, &movableDist
+		) == GL_TRUE
+	    )
+	    {
+		return GL_FALSE;
+
+	    } /* End if */
+
+	} /* End if */
+
+	/* Quirks of the model - it can only be left through its door */
+	if( IsSceneMoveAllowed( anInst->sceneModel, srcPt, destPt) == GL_FALSE)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+    } /* End for */
+
+    return GL_TRUE;
+
+} /* End function CanMoveTo */
+
+
+/**
+ * Works out which models are shown for the viewer's position. If
+ * 'canEnter' is GL_TRUE, the viewer is moved to the entry point of a
+ * model, if any, that has just begun to be shown.
+ */
+void UpdateActiveModels( VTEngine *vtEngine, GLboolean canEnter)
+{
+    Uint32 n;
+    int m;
+
+    for( n = 0U; n < vtEngine->numInsts; n++)
+    {
+	ModelInst *anInst = ( vtEngine->modelInsts + n);
+	SceneModel *aModel = anInst->sceneModel;
+	GLboolean nowActive;
+
+	nowActive = IsSceneModelActive( aModel, vtEngine->vPos);
+
+	if( ( nowActive == GL_TRUE) && ( anInst->isActive == GL_FALSE))
+	{
+	    /* We have just moved in. Adjust the viewer's position.
+	     * (This is due to the quirks in the models.)
+	     */
+	    for( m = 0; m < 3; m++)
+	    {
+		if( ( canEnter == GL_TRUE) && ( aModel->hasEntry[m] == GL_TRUE))
+		{
+		    vtEngine->vPos[m] = aModel->entryPos[m];
+
+		} /* End if */
+
+	    } /* End for */
+
+	    glPrioritizeTextures( 
+		anInst->numMaps, anInst->textures, anInst->texPriorities
+	    );
+	    CHECK_GL_ERROR;
+
+	} /* End if */
+
+	anInst->isActive = nowActive;
+
+    } /* End for */
+
+} /* End function UpdateActiveModels */
+
+
+/**
+ * Queues the triangles of the given GLData model, leaving out the 
+ * clusters of triangles that face away from all the views. (These 
+ * would be culled by OpenGL anyway, but only after being transformed.)
+ */
+void QueueGLDClusters( VTEngine *vtEngine, ModelInst *anInst)
+{
+    ClusterData *clusterData = anInst->clusterData;
+    Uint32 i, j, v;
+
+    for( i = 0U; i < anInst->numMaps; i++)
+    {
+	const TriCluster *aCluster = clusterData->clusters[i];
+	Uint32 numVerts = 0U;
+
+	for( j = 0U; j < clusterData->mapClusterNums[i]; j++, aCluster++)
+	{
+	    for( v = 0U; v < vtEngine->numViews; v++)
+	    {
+		if( IsClusterBackFacing( 
+			aCluster, anInst->modelViews[v].eyePos
+		    ) == GL_FALSE
+		)
+		{
+		    break;
+
+		} /* End if */
+
+	    } /* End for */
+
+	    if( v < vtEngine->numViews)
+	    {
+		memcpy( 
+		    ( anInst->vertIndices[i] + numVerts),
+		    ( clusterData->indices[i] + aCluster->firstIndex),
+		    ( aCluster->numIndices * sizeof( GLushort))
+		);
+		numVerts += aCluster->numIndices;
+
+	    } /* End if */
+
+	} /* End for */
+
+	anInst->numVerts[i] = numVerts;
+
+    } /* End for */
+
+} /* End function QueueGLDClusters */
+
+
+/**
+ * Draws the triangles queued for the given model - from the index ring
+ * if 'ringIndices' is not NULL. The same queues serve all the views,
+ * and each texture is bound just once per frame, with the views
+ * switched in between instead - loading a couple of matrices is much
+ * cheaper than binding a texture.
+ */
+void DrawModel( 
+    VTEngine *vtEngine, ModelInst *anInst, const GLushort *ringIndices
+)
+{
+    register Uint32 i;
+    Uint32 v;
+
+    glVertexPointer( 
+	3, GL_FLOAT, (GLsizei )( anInst->vertStride * sizeof( GLfloat)),
+	anInst->vertCoords
+    );
+    CHECK_GL_ERROR;
+    glTexCoordPointer( 
+	2, GL_FLOAT, (GLsizei )( anInst->texStride * sizeof( GLfloat)),
+	anInst->texCoords
+    );
+    CHECK_GL_ERROR;
+
+    /* With more than one view, the triangles queued from a BSP Tree
+     * are those facing any of the views, so let OpenGL drop the ones
+     * facing away from each view.
+     */
+    if( vtEngine->useBSP == GL_TRUE)
+    {
+	if( ( anInst->sceneModel->noBSPCull == GL_FALSE) && 
+	    ( vtEngine->numViews > 1U)
+	)
+	{
+	    glEnable( GL_CULL_FACE);
+
+	} /* End if */
+	else
+	{
+	    glDisable( GL_CULL_FACE);
+
+	} /* End else */
+
+    } /* End if */
+
+    if( anInst->sceneModel->alphaTest == GL_TRUE)
+    {
+	glEnable( GL_ALPHA_TEST);
+
+    } /* End if */
+    else
+    {
+	glDisable( GL_ALPHA_TEST);
+
+    } /* End else */
+
+    ApplyModelView( vtEngine, anInst, 0U);
+
+    for( i = 0U; i < anInst->numMaps; i++)
+    {
+	if( anInst->numVerts[i] > 0U)
+	{
+	    glBindTexture( GL_TEXTURE_2D, anInst->textures[i]);
+
+	    for( v = 0U; v < vtEngine->numViews; v++)
+	    {
+		if( vtEngine->numViews > 1U)
+		{
+		    ApplyModelView( vtEngine, anInst, v);
+
+		} /* End if */
+
+		/* Let the texture streamer know what this view needs */
+		RequestStreamedTex( 
+		    anInst->texStream, (Uint16 )i, 
+		    anInst->modelViews[v].eyePos, 
+		    anInst->modelViews[v].pixelScale
+		);
+
+		glDrawElements( 
+		    GL_TRIANGLES, 
+		    anInst->numVerts[i], 
+		    GL_UNSIGNED_SHORT, 
+		    ( ( ringIndices != NULL) ?
+			GetIndexRingOffset( 
+			    vtEngine->idxRing, anInst->ringOffsets[i]
+			) :
+			anInst->vertIndices[i]
+		    )
+		);
+
+	    } /* End for */
+
+	} /* End if */
+
+    } /* End for */
+
+} /* End function DrawModel */
+
+
+/**
+ * Works out the views of this frame as seen from the coordinates of
+ * the given model.
+ */
+void SetModelViews( VTEngine *vtEngine, ModelInst *anInst)
+{
+    SceneModel *aModel = anInst->sceneModel;
+    Uint32 v;
+
+    for( v = 0U; v < vtEngine->numViews; v++)
+    {
+	ModelView *aView = ( anInst->modelViews + v);
+
+	WorldToModelPoint( aModel, vtEngine->views[v].eyePos, aView->eyePos);
+	WorldToModelDir( aModel, vtEngine->views[v].viewDir, aView->viewDir);
+	aView->minVisCos = vtEngine->views[v].minVisCos;
+	aView->pixelScale = vtEngine->views[v].pixelScale * aModel->scale;
+
+    } /* End for */
+
+} /* End function SetModelViews */
+
+
+/**
+ * Creates the texture objects of the given model and sets up their
+ * streaming, leaving the texture images to be loaded.
+ */
+void InitInstTextures( ModelInst *anInst)
+{
+    Uint16 numMaps = anInst->numMaps;
+
+    anInst->textures = 
+	(GLuint *)( malloc( sizeof( GLuint) * numMaps));
+    anInst->texPriorities = 
+	(GLfloat *)( malloc( sizeof( GLfloat) * numMaps));
+    if( ( anInst->textures == NULL) || ( anInst->texPriorities == NULL))
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    glGenTextures( numMaps, anInst->textures);
+    CHECK_GL_ERROR;
+
+    anInst->texStream = GenTexStream( numMaps, anInst->textures);
+    NoteTexTriangles( 
+	anInst->texStream, anInst->gldModel, anInst->bspModel
+    );
+
+    SetTexPriorities( anInst);
+
+} /* End function InitInstTextures */
+
+
+/**
+ * Sets the priorities of the textures of the given model from their
+ * relative abundance.
+ */
+void SetTexPriorities( ModelInst *anInst)
+{
+    Uint16 i;
+
+    for( i = 0U; i < anInst->numMaps; i++)
+    {
+	if( anInst->bspModel != NULL)
+	{
+	    anInst->texPriorities[i] = ( 
+		(GLfloat )( anInst->bspModel->mapTriNums[i]) / 
+		(GLfloat )( anInst->bspModel->numTri)
+	    );
+
+	} /* End if */
+	else
+	{
+	    anInst->texPriorities[i] = ( 
+		(GLfloat )( anInst->gldModel->mapTriNums[i]) / 
+		(GLfloat )( anInst->gldModel->numTri)
+	    );
+
+	} /* End else */
+
+    } /* End for */
+
+} /* End function SetTexPriorities */
+
+
+/**
+ * Notes the triangles using each of the textures of a model (given
+ * either as GLData or as a BSP Tree) for streaming the textures.
+ */
+void NoteTexTriangles( 
+    TexStream *texStream, GLData *gldModel, BSPTreeData *bspModel
+)
+{
+    if( bspModel != NULL)
+    {
+	NoteBSPTexTriangles( texStream, bspModel, bspModel->bspTree);
+
+    } /* End if */
+    else
+    {
+	Uint16 i;
+	Uint32 j;
+
+	for( i = 0U; i < gldModel->nMaps; i++)
+	{
+	    for( j = 0U; j < gldModel->mapTriNums[i]; j++)
+	    {
+		NoteStreamedTexTriangle( 
+		    texStream, i, 
+		    gldModel->vertCoords, gldModel->vertStride,
+		    gldModel->texCoords, gldModel->texStride,
+		    ( gldModel->triFaces[i] + 3*j)
+		);
+
+	    } /* End for */
+
+	} /* End for */
+
+    } /* End else */
+
+} /* End function NoteTexTriangles */
+
+
+/**
+ * Notes the triangles of the given BSP Tree for streaming textures.
+ */
+void NoteBSPTexTriangles( 
+    TexStream *texStream, BSPTreeData *bspModel, BSPTree *aTree
+)
+{
+    if( aTree != NULL)
+    {
+	Uint16 i;
+
+	for( i = 0U; i < aTree->numTri; i++)
+	{
+	    NoteStreamedTexTriangle( 
+		texStream, aTree->triDefs[i].texIndex, 
+		bspModel->vertCoords, 3U, bspModel->texCoords, 2U,
+		aTree->triDefs[i].vIndices
+	    );
+
+	} /* End for */
+
+	NoteBSPTexTriangles( texStream, bspModel, aTree->front);
+	NoteBSPTexTriangles( texStream, bspModel, aTree->back);
+
+    } /* End if */
+
+} /* End function NoteBSPTexTriangles */
+
+
+/**
+ * Puts the names of the compressed form of the given texture map in
+ * the texture cache and of its JPEG image in the given buffers (each
+ * of ENGINE_MAX_MAP_PATH chars). Returns GL_FALSE, leaving both empty,
+ * if either name does not fit (the names of the texture maps come
+ * from the model files, which can be changed while the demo runs).
+ */
+GLboolean GetMapFileNames( 
+    const char *mapName, char *dxtFileName, char *jpgFileName
+)
+{
+    const char *extPtr;
+    int baseLen, dxtLen, jpgLen;
+
+    /* The compressed form replaces the extension, if any, with ".dxt" */
+    extPtr = strrchr( mapName, '.');
+    baseLen = ( extPtr != NULL) ? 
+	(int )( extPtr - mapName) : (int )strlen( mapName);
+
+    dxtLen = snprintf( 
+	dxtFileName, ENGINE_MAX_MAP_PATH, "%s%.*s.dxt", 
+	TEX_CACHE_FOLDER_PFX, baseLen, mapName
+    );
+    jpgLen = snprintf( 
+	jpgFileName, ENGINE_MAX_MAP_PATH, "%s%s", IMGS_FOLDER_PFX, mapName
+    );
+
+    if( ( dxtLen < 0) || ( dxtLen >= ENGINE_MAX_MAP_PATH) ||
+	( jpgLen < 0) || ( jpgLen >= ENGINE_MAX_MAP_PATH)
+    )
+    {
+	fprintf( 
+	    stderr, "\nERROR: Name of texture map \"%s\" too long\n", mapName
+	);
+	dxtFileName[0] = '\0';
+	jpgFileName[0] = '\0';
+	return GL_FALSE;
+
+    } /* End if */
+
+    return GL_TRUE;
+
+} /* End function GetMapFileNames */
+
+
+/**
+ * Recursively draw a BSP Tree. Instead of actually drawing
+ * the triangles of the tree, collects vertex indices of visible
+ * triangles. Performs backface and view cone based culling,
+ * against all the views at once - a triangle or a subtree is
+ * culled only if it can not be seen in any of the views.
+ */
+void DrawBSPTree( VTEngine *vtEngine, ModelInst *anInst, BSPTree *aTree)
+{
+    register Uint16 i;
+
+    if( aTree != NULL)
+    {
+	GLboolean nodeHidden = GL_FALSE;
+	Uint8 planeHides;
+
+	planeHides = GetPlaneHides( vtEngine, anInst, aTree->planeIndex);
+
+
+	/* The front sub-tree is never culled: the vertices of its
+	 * triangles can be a little below the plane (having been merged
+	 * with nearby vertices by the BSP Tree compiler), more so than
+	 * the thickness of the plane that ClassifyPoint( ) allows for.
+	 */
+	if( aTree->front != NULL)
+	{
+	    DrawBSPTree( vtEngine, anInst, aTree->front);
+
+	} /* End if */
+
+
+	/* The triangles of a node all lie in its plane, so they are
+	 * backface culled together - a cluster with a normal cone of
+	 * no width. Backface culling can not be done for all the
+	 * models (the Taj interior, for one).
+	 */
+	if( ( anInst->sceneModel->noBSPCull == GL_FALSE) && 
+	    ( aTree->numTri > 0U)
+	)
+	{
+	    nodeHidden = 
+		( ( planeHides & PLANE_HIDES_TRIANGLES) != 0U) ? 
+		GL_TRUE : GL_FALSE;
+
+	} /* End if */
+
+	for( i = 0U; ( nodeHidden == GL_FALSE) && ( i < aTree->numTri); i++)
+	{
+	    register Uint32 tIndex;
+	    register BSPTriFace *aTri;
+
+	    aTri = ( aTree->triDefs + i);
+
+	    tIndex = anInst->numVerts[aTri->texIndex];
+
+	    anInst->queueIndices[aTri->texIndex][tIndex++] = 
+		aTri->vIndices[0];
+
+	    anInst->queueIndices[aTri->texIndex][tIndex++] = 
+		aTri->vIndices[1];
+
+	    anInst->queueIndices[aTri->texIndex][tIndex++] = 
+		aTri->vIndices[2];
+
+	    anInst->numVerts[aTri->texIndex] = tIndex;
+
+	} /* End for */
+
+
+	if( ( planeHides & PLANE_HIDES_BACK) != 0U)
+	{
+	    /* The back sub-tree can not be seen */
+
+	} /* End if */
+	else if( aTree->back != NULL)
+	{
+	    DrawBSPTree( vtEngine, anInst, aTree->back);
+
+	} /* End if */
+
+    } /* End if */
+
+} /* End function DrawBSPTree */
+
+
+/**
+ * Returns what the given partition plane of the BSP Tree of the given
+ * model hides from all the views of this frame (a combination of the
+ * PLANE_HIDES_* flags). Since the same plane is shared by many nodes
+ * of the tree, this is worked out only when the plane is first reached
+ * in a frame and just looked up after that.
+ */
+Uint8 GetPlaneHides( 
+    VTEngine *vtEngine, ModelInst *anInst, Uint16 planeIndex
+)
+{
+    BSPPlane *aPlane;
+    Uint8 planeHides;
+    Uint32 v;
+
+    if( anInst->planeFrames[planeIndex] == anInst->bspFrame)
+    {
+	return anInst->planeHides[planeIndex];
+
+    } /* End if */
+
+    aPlane = ( anInst->bspModel->partPlanes + planeIndex);
+    planeHides = ( PLANE_HIDES_BACK | PLANE_HIDES_TRIANGLES);
+
+    for( v = 0U; v < vtEngine->numViews; v++)
+    {
+	ModelView *aView = ( anInst->modelViews + v);
+	PointType vpRel;
+	GLdouble vpDotProd;
+
+	vpRel = ClassifyPoint( aView->eyePos, aPlane);
+
+	vpDotProd = 
+	    aView->viewDir[0]*aPlane->A +
+	    aView->viewDir[1]*aPlane->B +
+	    aView->viewDir[2]*aPlane->C;
+
+	if( ( vpRel != ABOVE_PLANE) || 
+	    ( vpDotProd <= aView->minVisCos)
+	)
+	{
+	    planeHides &= ~PLANE_HIDES_BACK;
+
+	} /* End if */
+
+	/* The triangles in the plane face this view if the eye is
+	 * above the plane.
+	 */
+	if( vpRel == ABOVE_PLANE)
+	{
+	    planeHides &= ~PLANE_HIDES_TRIANGLES;
+
+	} /* End if */
+
+    } /* End for */
+
+    anInst->planeFrames[planeIndex] = anInst->bspFrame;
+    anInst->planeHides[planeIndex] = planeHides;
+
+    return planeHides;
+
+} /* End function GetPlaneHides */
+
+
+/**
+ * Work out the views to be rendered from the viewer's position and
+ * orientation: the main view (or the two views of a stereo pair,
+ * side by side) and, if shown, the minimap.
+ */
+void SetupViews( VTEngine *vtEngine)
+{
+    GLdouble fwdDir[3], rightDir[3], upDir[3];
+    GLdouble center[3];
+    GLdouble top, halfWidth;
+    GLsizei mainWidth;
+    Uint32 numEyes;
+    Uint32 v;
+    int m;
+
+    fwdDir[0] = cos( vtEngine->angleOfView);
+    fwdDir[1] = 0.0;
+    fwdDir[2] = sin( vtEngine->angleOfView);
+
+    rightDir[0] = -fwdDir[2];
+    rightDir[1] = 0.0;
+    rightDir[2] = fwdDir[0];
+
+    upDir[0] = 0.0;
+    upDir[1] = 1.0;
+    upDir[2] = 0.0;
+
+    numEyes = ( vtEngine->stereoMode == GL_TRUE) ? 2U : 1U;
+    mainWidth = (GLsizei )( vtEngine->scrWidth / (int )numEyes);
+
+    top = NEAR_Z_CLIP * tan( ( FIELD_OF_VIEW / 2.0) * M_PI / 180.0);
+    halfWidth = top * (GLdouble )mainWidth / (GLdouble )vtEngine->scrHeight;
+
+    for( v = 0U; v < numEyes; v++)
+    {
+	ViewDef *aView = ( vtEngine->views + v);
+	GLdouble eyeOffset = 0.0;
+	GLdouble frustShift;
+
+	if( vtEngine->stereoMode == GL_TRUE)
+	{
+	    eyeOffset = 
+		( v == 0U) ? ( -STEREO_EYE_SEP / 2.0) : ( STEREO_EYE_SEP / 2.0);
+
+	} /* End if */
+
+	aView->vpX = (GLint )( v * mainWidth);
+	aView->vpY = 0;
+	aView->vpWidth = mainWidth;
+	aView->vpHeight = (GLsizei )vtEngine->scrHeight;
+
+	aView->minDepth = 
+	    ( vtEngine->showMinimap == GL_TRUE) ? MAIN_VIEW_MIN_DEPTH : 0.0;
+	aView->maxDepth = 1.0;
+
+	for( m = 0; m < 3; m++)
+	{
+	    aView->eyePos[m] = 
+		(GLfloat )( vtEngine->vPos[m] + ( eyeOffset * rightDir[m]));
+	    aView->viewDir[m] = fwdDir[m];
+	    center[m] = aView->eyePos[m] + fwdDir[m];
+
+	} /* End for */
+
+	/* The eyes look in parallel directions, with their frusta
+	 * sheared so that they coincide at STEREO_FOCAL_DIST.
+	 */
+	frustShift = -eyeOffset * NEAR_Z_CLIP / STEREO_FOCAL_DIST;
+
+	SetViewMatrices( 
+	    aView, ( -halfWidth + frustShift), ( halfWidth + frustShift), top,
+	    center, upDir
+	);
+
+    } /* End for */
+
+    vtEngine->numViews = numEyes;
+
+
+    if( vtEngine->showMinimap == GL_TRUE)
+    {
+	ViewDef *aView = ( vtEngine->views + vtEngine->numViews);
+	GLsizei mapSize = (GLsizei )( vtEngine->scrHeight / MINIMAP_SCALE);
+
+	aView->vpX = (GLint )( vtEngine->scrWidth - mapSize - MINIMAP_MARGIN);
+	aView->vpY = (GLint )( vtEngine->scrHeight - mapSize - MINIMAP_MARGIN);
+	aView->vpWidth = mapSize;
+	aView->vpHeight = mapSize;
+
+	aView->minDepth = 0.0;
+	aView->maxDepth = MINIMAP_MAX_DEPTH;
+
+	for( m = 0; m < 3; m++)
+	{
+	    aView->eyePos[m] = vtEngine->vPos[m];
+	    center[m] = vtEngine->vPos[m];
+
+	} /* End for */
+	aView->eyePos[1] += (GLfloat )MINIMAP_HEIGHT;
+
+	aView->viewDir[0] = 0.0;
+	aView->viewDir[1] = -1.0;
+	aView->viewDir[2] = 0.0;
+
+	/* The direction the viewer faces is "up" on the minimap */
+	top = NEAR_Z_CLIP * tan( ( MINIMAP_FIELD_OF_VIEW / 2.0) * M_PI / 180.0);
+	SetViewMatrices( aView, -top, top, top, center, fwdDir);
+
+	vtEngine->numViews++;
+
+    } /* End if */
+
+} /* End function SetupViews */
+
+
+/**
+ * Compute the matrices and the view cone of a view, whose eye position
+ * and view direction have already been set, given the extent of its
+ * (vertically symmetric) view frustum at the near clipping plane, the
+ * point it looks at and its "up" direction.
+ */
+void SetViewMatrices(
+    ViewDef *aView, GLdouble left, GLdouble right, GLdouble top,
+    const GLdouble center[3], const GLdouble up[3]
+)
+{
+    GLdouble maxX, tanSqrTheta;
+
+    glMatrixMode( GL_PROJECTION);
+    glLoadIdentity( );
+    glFrustum( left, right, -top, top, NEAR_Z_CLIP, FAR_Z_CLIP);
+    glGetDoublev( GL_PROJECTION_MATRIX, aView->projMatrix);
+
+    glMatrixMode( GL_MODELVIEW);
+    glLoadIdentity( );
+    gluLookAt( 
+	aView->eyePos[0], aView->eyePos[1], aView->eyePos[2],
+	center[0], center[1], center[2],
+	up[0], up[1], up[2]
+    );
+    glGetDoublev( GL_MODELVIEW_MATRIX, aView->mvMatrix);
+    CHECK_GL_ERROR;
+
+
+    /* Calculate 'minVisCos' for the BSP Tree renderer.
+     *
+     * Taking the angle from the viewpoint to the corners of
+     * the view frustum gives the angle of the 'view cone'.
+     * This is a much simpler, though less accurate, way of
+     * culling entire subtrees based on the relative position
+     * and orientation of the viewer and the partition plane
+     * of a BSP Tree, than frustum plane based culling.
+     * 
+     * The value being calculated here is the limit on the
+     * cosine of the angle between the view direction and
+     * the partition plane normal of a BSP Tree, for the 
+     * back subtree of the BSP Tree to be completely culled.
+     */
+    maxX = ( fabs( left) > fabs( right)) ? fabs( left) : fabs( right);
+
+    tanSqrTheta = ( ( maxX * maxX) + ( top * top)) / 
+	( NEAR_Z_CLIP * NEAR_Z_CLIP);
+
+    aView->minVisCos = sqrt( tanSqrTheta / ( tanSqrTheta + 1.0));
+
+    aView->pixelScale = 
+	( NEAR_Z_CLIP * (GLdouble )aView->vpHeight) / ( 2.0 * top);
+
+    /* For culling entire models */
+    GetFrustumPlanes( aView->projMatrix, aView->mvMatrix, aView->frustum);
+
+} /* End function SetViewMatrices */
+
+
+/**
+ * Make the given view current.
+ */
+void ApplyView( VTEngine *vtEngine, Uint32 viewNum)
+{
+    ViewDef *aView = ( vtEngine->views + viewNum);
+
+    glViewport( aView->vpX, aView->vpY, aView->vpWidth, aView->vpHeight);
+    glDepthRange( aView->minDepth, aView->maxDepth);
+
+    glMatrixMode( GL_PROJECTION);
+    glLoadMatrixd( aView->projMatrix);
+
+    glMatrixMode( GL_MODELVIEW);
+    glLoadMatrixd( aView->mvMatrix);
+
+} /* End function ApplyView */
+
+
+/**
+ * Make the given view current for drawing the given model.
+ */
+void ApplyModelView( VTEngine *vtEngine, ModelInst *anInst, Uint32 viewNum)
+{
+    ApplyView( vtEngine, viewNum);
+
+    if( anInst->sceneModel->isTransformed == GL_TRUE)
+    {
+	glMultMatrixf( anInst->sceneModel->toWorld);
+
+    } /* End if */
+
+} /* End function ApplyModelView */
+
+
+/**
+ * Fill the minimap with a background at the far end of its depth
+ * range. Since this is nearer than any part of the main view, the
+ * main view can not be drawn over the minimap.
+ */
+void DrawMinimapBackground( VTEngine *vtEngine)
+{
+    ApplyView( vtEngine, vtEngine->numViews - 1U);
+
+    glPushAttrib( GL_ENABLE_BIT | GL_CURRENT_BIT);
+    glDisable( GL_TEXTURE_2D);
+    glDisable( GL_ALPHA_TEST);
+    glDisable( GL_CULL_FACE);
+
+    glMatrixMode( GL_PROJECTION);
+    glLoadIdentity( );
+    glMatrixMode( GL_MODELVIEW);
+    glLoadIdentity( );
+
+    glColor4f( 0.0F, 0.2F, 0.3F, 1.0F);
+
+    glBegin( GL_QUADS);
+    glVertex3f( -1.0F, -1.0F, +1.0F);
+    glVertex3f( +1.0F, -1.0F, +1.0F);
+    glVertex3f( +1.0F, +1.0F, +1.0F);
+    glVertex3f( -1.0F, +1.0F, +1.0F);
+    glEnd( );
+
+    glPopAttrib( );
+    CHECK_GL_ERROR;
+
+} /* End function DrawMinimapBackground */
+
+
+/**
+ * Mark the viewer's position and heading on the minimap.
+ */
+void DrawMinimapMarker( VTEngine *vtEngine)
+{
+    GLfloat *vPos = vtEngine->vPos;
+    GLfloat fwdDir[2], rightDir[2];
+
+    fwdDir[0] = (GLfloat )cos( vtEngine->angleOfView);
+    fwdDir[1] = (GLfloat )sin( vtEngine->angleOfView);
+
+    rightDir[0] = -fwdDir[1];
+    rightDir[1] = fwdDir[0];
+
+    ApplyView( vtEngine, vtEngine->numViews - 1U);
+
+    glPushAttrib( GL_ENABLE_BIT | GL_CURRENT_BIT);
+    glDisable( GL_TEXTURE_2D);
+    glDisable( GL_ALPHA_TEST);
+    glDisable( GL_CULL_FACE);
+    glDisable( GL_DEPTH_TEST);
+
+    glColor4f( 1.0F, 1.0F, 0.0F, 1.0F);
+
+    glBegin( GL_TRIANGLES);
+    glVertex3f( 
+	vPos[0] + ( MINIMAP_MARKER_SIZE * fwdDir[0]),
+	vPos[1],
+	vPos[2] + ( MINIMAP_MARKER_SIZE * fwdDir[1])
+    );
+    glVertex3f( 
+	vPos[0] - ( MINIMAP_MARKER_SIZE * 0.5F * ( fwdDir[0] + rightDir[0])),
+	vPos[1],
+	vPos[2] - ( MINIMAP_MARKER_SIZE * 0.5F * ( fwdDir[1] + rightDir[1]))
+    );
+    glVertex3f( 
+	vPos[0] - ( MINIMAP_MARKER_SIZE * 0.5F * ( fwdDir[0] - rightDir[0])),
+	vPos[1],
+	vPos[2] - ( MINIMAP_MARKER_SIZE * 0.5F * ( fwdDir[1] - rightDir[1]))
+    );
+    glEnd( );
+
+    glPopAttrib( );
+    CHECK_GL_ERROR;
+
+} /* End function DrawMinimapMarker */
@@ -0,0 +1,434 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * ENGINE.H: Declarations for the engine that shows the models of a
+ * scene, built into the "libvtaj.a" library.
+ */
+
+/**
+ * All the state of the engine - the models of the scene, the viewer
+ * and the views rendered each frame - is kept in a VTEngine, which is
+ * passed to each of the functions below. Nothing is kept anywhere else,
+ * so that more than one scene can be loaded at once (for example, to
+ * compare different settings within the same program).
+ *
+ * The engine draws with whatever OpenGL context is current, and leaves
+ * creating it, showing the frames drawn and handling user input to the
+ * program using it (see "vtaj.c"):
+ *
+ *   1. GenEngine( ) reads the scene, and starts loading its models
+ *      and textures on other threads.
+ *   2. Once an OpenGL context is current (and InitGLExtensions( ) has
+ *      been called), InitEngineGraphics( ) waits for them to be loaded,
+ *      and hands the textures over to OpenGL.
+ *   3. PlaceEngineViewer( ) puts the viewer in the scene.
+ *   4. Each frame, RenderEngineFrame( ) draws the scene and, once the
+ *      frame has been shown, UpdateEngineTextures( ) streams in the
+ *      textures it needed (and those PrefetchEngineView( ) was asked
+ *      for). MoveEngineViewer( ), TurnEngineViewer( ) and
+ *      ShowEngineMinimap( ) change what is shown in later frames. If
+ *      WatchEngineFiles( ) was called, SwapEngineReloads( ) swaps in
+ *      the files of the scene changed since the last frame.
+ *   5. FreeEngine( ) lets go of everything.
+ *
+ * The only state shared by all engines is what "glutil.h" and
+ * "texload.h" find out about, or are told about, the OpenGL
+ * implementation.
+ *
+ * The loading is a graph of tasks run on a pool of ENGINE_LOAD_THREADS
+ * threads (see "taskpool.h"), so that the models, their collision
+ * meshes, their drawing queues and the decoding of their textures all
+ * go on at once - and alongside the program creating its window and
+ * OpenGL context in between steps 1 and 2. Only handing the textures
+ * over to OpenGL is left to the thread whose context is current.
+ */
+
+#ifndef _ENGINE_H
+#define _ENGINE_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+#include "gld.h"
+#include "bsp.h"
+#include "bvh.h"
+#include "cxmesh.h"
+#include "texstream.h"
+#include "idxring.h"
+#include "scene.h"
+#include "cluster.h"
+#include "hotload.h"
+#include "taskpool.h"
+
+
+/* Maximum number of views rendered in a frame - a stereo pair and
+ * the minimap.
+ */
+#define MAX_VIEWS 3
+
+/* Kinds of files of the scene watched for changes */
+#define ENGINE_ASSET_MODEL 0
+#define ENGINE_ASSET_COLDET 1
+#define ENGINE_ASSET_TEXTURE 2
+
+/* Longest name of a texture map, or of the files it is loaded from */
+#define ENGINE_MAX_MAP_PATH 256
+
+/* Threads loading the models and textures of a scene */
+#define ENGINE_LOAD_THREADS 4
+
+
+/* Data type definitions */
+
+/* A view rendered in each frame */
+typedef struct _view_def
+{
+    /* Part of the screen and of the depth range covered */
+    GLint vpX, vpY;
+    GLsizei vpWidth, vpHeight;
+    GLclampd minDepth, maxDepth;
+
+    GLdouble projMatrix[16];
+    GLdouble mvMatrix[16];
+
+    /* View cone, used by the BSP Tree renderer for culling. See
+     * SetViewMatrices( ) in "engine.c" for 'minVisCos'.
+     */
+    GLfloat eyePos[3];
+    GLdouble viewDir[3];
+    GLdouble minVisCos;
+
+    /* Length in pixels of a unit length one unit away from the eye,
+     * used to work out the texture mipmap levels needed.
+     */
+    GLdouble pixelScale;
+
+    /* Planes bounding the view frustum (see "scene.h") */
+    GLdouble frustum[6][4];
+
+} ViewDef;
+
+/* A view, as seen from the coordinates of a model */
+typedef struct _model_view
+{
+    GLfloat eyePos[3];
+    GLdouble viewDir[3];
+    GLdouble minVisCos;
+    GLdouble pixelScale;
+
+} ModelView;
+
+
+/* A model of the scene (see "scene.h") and what is needed to show it */
+typedef struct _model_inst
+{
+    SceneModel *sceneModel;
+
+    /* The model shown - only one of these is loaded - the collision
+     * mesh used for collision detection (if any) and the model used
+     * for picking (loaded when first needed).
+     */
+    GLData *gldModel;
+    BSPTreeData *bspModel;
+    CXMesh *colDetModel;
+    GLData *pickModel;
+    BVHData *pickBVH;
+
+    /* The texture maps, vertex coordinates and texture mappings of the
+     * model shown, with the number of GLfloats from one vertex to the
+     * next in each of the latter.
+     */
+    Uint16 numMaps;
+    char **mapNames;
+    GLfloat *vertCoords;
+    GLfloat *texCoords;
+    Uint32 vertStride;
+    Uint32 texStride;
+
+    /* Clusters of the triangles of the GLData model, so that those
+     * facing away from the viewer can be culled together.
+     */
+    ClusterData *clusterData;
+
+    /* What each partition plane of the BSP Tree model hides from the
+     * views of a frame, worked out only once in the frame, when the
+     * plane is first reached (see DrawBSPTree( ) in "engine.c"), along
+     * with the frame for which it was last worked out.
+     */
+    Uint32 bspFrame;
+    Uint32 *planeFrames;
+    Uint8 *planeHides;
+
+    /* Texture data */
+    GLuint *textures;
+    GLfloat *texPriorities;
+    TexStream *texStream;
+
+    /* Queued vertex and texture coordinate indices during each redraw,
+     * their offsets into the index ring's region for a frame, and the
+     * queues being filled in by DrawBSPTree( ) in this frame.
+     */
+    Uint32 *numVerts;
+    GLushort **vertIndices;
+    Uint32 *ringOffsets;
+    GLushort **ringVertIndices;
+    GLushort **queueIndices;
+
+    /* Is the model shown for the viewer's position, and can it be
+     * seen in any of the views of this frame?
+     */
+    GLboolean isActive;
+    GLboolean isVisible;
+
+    ModelView modelViews[MAX_VIEWS];
+
+} ModelInst;
+
+
+/* A model of the scene being loaded, and its textures being loaded */
+struct _tex_load;
+
+typedef struct _model_load
+{
+    struct _vt_engine *vtEngine;
+    Uint32 instNum;
+
+    /* Task creating the texture objects (see "taskpool.h") */
+    Uint32 texObjTask;
+
+    Uint16 numMaps;
+    struct _tex_load *texLoads;
+
+} ModelLoad;
+
+typedef struct _tex_load
+{
+    ModelLoad *modelLoad;
+    Uint16 texNum;
+
+    /* Loaded, but not yet handed over to OpenGL */
+    TexImage *texImage;
+
+} TexLoad;
+
+
+/* A file of the scene watched for changes */
+typedef struct _engine_asset
+{
+    int assetType;    /* ENGINE_ASSET_MODEL, etc. */
+    Uint32 instNum;
+    SceneModel *sceneModel;
+
+    /* How the models shown and their textures are read in */
+    GLboolean useBSP;
+    GLDVertLayout vertLayout;
+    int texReduction;
+
+    /* For models, the texture maps used by the model last read in (by
+     * the loader's thread alone, once it has started)
+     */
+    Uint16 numMaps;
+    char **mapNames;
+
+    /* For textures, the texture map and the files it is loaded from -
+     * the DXT file in the texture cache being left out (empty) when the
+     * file watched is the JPEG image, since a changed image leaves the
+     * cached one out of date.
+     */
+    Uint16 texNum;
+    char mapName[ENGINE_MAX_MAP_PATH];
+    char dxtFileName[ENGINE_MAX_MAP_PATH];
+    char jpgFileName[ENGINE_MAX_MAP_PATH];
+
+} EngineAsset;
+
+
+/* A scene being shown */
+typedef struct _vt_engine
+{
+    GLboolean useBSP;
+
+    /* Layout of the vertices of the GLData models (see "gld.h") */
+    GLDVertLayout vertLayout;
+
+    /* Factor by which the resolution of the textures is reduced (see
+     * "texload.h")
+     */
+    int texReduction;
+
+    /* Models to be shown, as listed in the scene manifest */
+    SceneData *theScene;
+
+    Uint32 numInsts;
+    ModelInst *modelInsts;
+
+    /* The screen dimensions */
+    int scrWidth;
+    int scrHeight;
+
+    /* Viewer information */
+    GLfloat angleOfView;
+    GLfloat vPos[3];
+
+    /* Views of the viewer's surroundings rendered in each frame */
+    GLboolean stereoMode;
+    GLboolean showMinimap;
+    Uint32 numViews;
+    ViewDef views[MAX_VIEWS];
+
+    /* With a BSP tree, the queues can instead be in a ring of indices in
+     * a buffer object (see "idxring.h"), each at its offset into the
+     * ring's region for a frame.
+     */
+    IndexRing *idxRing;
+    Uint32 numRingIndices;
+
+    /* Files of the scene watched for changes, if any, and the loader
+     * reading them in again as they change.
+     */
+    Uint32 numAssets;
+    EngineAsset *assets;
+    HotLoader *hotLoader;
+
+    /* Tasks loading the models and textures, until they are loaded */
+    TaskPool *loadPool;
+    ModelLoad *modelLoads;
+
+} VTEngine;
+
+
+/* Called with the percentage of the textures loaded so far */
+typedef void (*EngineProgressFn)( void *cbData, unsigned int percentDone);
+
+
+/* Function Prototypes */
+
+/**
+ * Reads in the given scene manifest and starts loading the GLData or
+ * BSP Tree version of each model listed in it, as well as the collision
+ * meshes used for collision detection and the textures, on other
+ * threads. The vertices of the GLData models are laid out as given,
+ * and the textures loaded at ( 1 / texReduction) of their resolution
+ * (see IsTextureReduction( ) in "texload.h").
+ *
+ * Returns the engine, or NULL if the scene could not be read.
+ */
+extern VTEngine *GenEngine( 
+    const char *sceneName, GLboolean useBSP, GLDVertLayout vertLayout,
+    int texReduction
+);
+
+
+/**
+ * Sets up the current OpenGL context for showing the scene in a screen
+ * of the given size (with a side-by-side stereo pair if 'stereoMode' is
+ * GL_TRUE), and waits for the models and textures to be loaded, handing
+ * the textures over to OpenGL as they are. If 'progressFn' is not NULL,
+ * it is called as they are loaded.
+ *
+ * Returns GL_FALSE if any of the models could not be read.
+ */
+extern GLboolean InitEngineGraphics(
+    VTEngine *vtEngine, int scrWidth, int scrHeight, GLboolean stereoMode,
+    EngineProgressFn progressFn, void *cbData
+);
+
+
+/**
+ * Puts the viewer at the given position, facing the given direction
+ * (an angle in radians in the XZ plane, from the X axis towards the Z
+ * axis).
+ */
+extern void PlaceEngineViewer(
+    VTEngine *vtEngine, const GLfloat vPos[3], GLfloat angleOfView
+);
+
+
+/**
+ * Moves the viewer to the given position, unless it would run into any
+ * of the models being shown. Returns GL_TRUE if the viewer was moved.
+ */
+extern GLboolean MoveEngineViewer(
+    VTEngine *vtEngine, const GLfloat destPt[3]
+);
+
+
+/**
+ * Turns the viewer by the given angle (in radians).
+ */
+extern void TurnEngineViewer( VTEngine *vtEngine, GLdouble turnAngle);
+
+
+/**
+ * Shows or hides the minimap in the top right corner of the screen.
+ */
+extern void ShowEngineMinimap( VTEngine *vtEngine, GLboolean showMinimap);
+
+
+/**
+ * Draws the scene as seen by the viewer into the current OpenGL
+ * context, leaving the main view in place.
+ */
+extern void RenderEngineFrame( VTEngine *vtEngine);
+
+
+/**
+ * Has the texture levels that the main view would need with the viewer
+ * at the given position, facing the given direction, streamed in as if
+ * they were needed in this frame - so that they are in place by the
+ * time the viewer gets there, when its path is known in advance (see
+ * "tour.h"). Must be called before UpdateEngineTextures( ).
+ */
+extern void PrefetchEngineView(
+    VTEngine *vtEngine, const GLfloat vPos[3], GLfloat angleOfView
+);
+
+
+/**
+ * Streams in the texture levels the last frame needed, and lets go of
+ * the ones no longer needed. This is best called after the frame has
+ * been shown.
+ */
+extern void UpdateEngineTextures( VTEngine *vtEngine);
+
+
+/**
+ * Starts watching the files of the scene - the models shown, their
+ * collision meshes and their textures (as JPEG images, or in the
+ * texture cache) - for changes, to read them in again on another
+ * thread - along with the textures of a model read in again, if it
+ * now uses other textures. Returns GL_FALSE if they can not be watched.
+ *
+ * (Textures used only by a model read in again are not watched, nor
+ * are those whose file names would be too long.)
+ */
+extern GLboolean WatchEngineFiles( VTEngine *vtEngine);
+
+
+/**
+ * Swaps in the files of the scene read in again since the last call,
+ * if they are being watched. Must be called between frames.
+ */
+extern void SwapEngineReloads( VTEngine *vtEngine);
+
+
+/**
+ * Identifies the surface seen through the given point in the screen
+ * (with the origin at the top left corner, as SDL has it) and prints
+ * its details.
+ */
+extern void IdentifyEngineSurface( VTEngine *vtEngine, int scrX, int scrY);
+
+
+/**
+ * Frees the engine and all its resources, including its OpenGL ones.
+ */
+extern void FreeEngine( VTEngine *vtEngine);
+
+#endif    /* _ENGINE_H */
@@ -18,6 +18,15 @@
 #include "gld.h"
 
 
+/* Alignment of the vertex definitions with GLD_PADDED_VERTS */
+#define GLD_VERT_ALIGN 32U
+
+
+/* Local function prototypes */
+
+static void AllocVertBlock( GLData *glData, GLDVertLayout vertLayout);
+
+
 GLData *GenGLData( 
     Uint32 nTri, 
     GLfloat *triVerts, 
@@ -164,6 +173,10 @@ GLData *GenGLData(
 
     } /* End if */
 
+    retVal->vertLayout = GLD_SEPARATE_VERTS;
+    retVal->vertStride = 3U;
+    retVal->texStride = 2U;
+
 
     /* Find out vertex indices of all the triangles,
      * generating vertex definitions as needed and weeding out 
@@ -365,18 +378,78 @@ GLData *GenGLData(
     } /* End if */
 
 
+    retVal->vertBlock = retVal->vertCoords;
+
     /* Done. */
     return retVal;
 
 } /* End function GenGLData */
 
 
+void SetGLDVertLayout( GLData *glData, GLDVertLayout vertLayout)
+{
+    GLfloat *oldVertCoords, *oldTexCoords, *oldVertBlock;
+    GLDVertLayout oldLayout;
+    Uint32 oldVertStride, oldTexStride;
+    Uint32 i;
+
+    if( ( glData == NULL) || ( glData->vertLayout == vertLayout))
+    {
+	return;
+
+    } /* End if */
+
+    oldLayout = glData->vertLayout;
+    oldVertCoords = glData->vertCoords;
+    oldTexCoords = glData->texCoords;
+    oldVertBlock = glData->vertBlock;
+    oldVertStride = glData->vertStride;
+    oldTexStride = glData->texStride;
+
+    AllocVertBlock( glData, vertLayout);
+
+    for( i = 0U; i < glData->nVertices; i++)
+    {
+	GLfloat *newVert = GLD_VERT_COORDS( glData, i);
+	GLfloat *newTex = GLD_TEX_COORDS( glData, i);
+	const GLfloat *oldVert = ( oldVertCoords + oldVertStride * i);
+	const GLfloat *oldTex = ( oldTexCoords + oldTexStride * i);
+
+	newVert[0] = oldVert[0];
+	newVert[1] = oldVert[1];
+	newVert[2] = oldVert[2];
+
+	newTex[0] = oldTex[0];
+	newTex[1] = oldTex[1];
+
+    } /* End for */
+
+    free( oldVertBlock);
+    if( oldLayout == GLD_SEPARATE_VERTS)
+    {
+	free( oldTexCoords);
+
+    } /* End if */
+
+} /* End function SetGLDVertLayout */
+
+
 void SaveGLData( GLData *glData, FILE *outFile)
 {
     if( glData != NULL)
     {
         unsigned int i;
 	Uint8 glDataVer = GLD_VER;
+	Uint8 vertLayout = (Uint8 )glData->vertLayout;
+
+	/* Keep writing files that older programs can read, unless the
+	 * layout needs the newer version.
+	 */
+	if( glData->vertLayout == GLD_SEPARATE_VERTS)
+	{
+	    glDataVer = GLD_SEPARATE_VER;
+
+	} /* End if */
 
         /* Write out the format signature */
         fwrite( 
@@ -423,17 +496,35 @@ void SaveGLData( GLData *glData, FILE *outFile)
 	    outFile
 	);
 
-	fwrite(
-	    glData->vertCoords,
-	    sizeof( GLfloat), ( 3 * glData->nVertices),
-	    outFile
-	);
+	if( glData->vertLayout == GLD_SEPARATE_VERTS)
+	{
+	    fwrite(
+		glData->vertCoords,
+		sizeof( GLfloat), ( 3 * glData->nVertices),
+		outFile
+	    );
 
-	fwrite(
-	    glData->texCoords,
-	    sizeof( GLfloat), ( 2 * glData->nVertices),
-	    outFile
-	);
+	    fwrite(
+		glData->texCoords,
+		sizeof( GLfloat), ( 2 * glData->nVertices),
+		outFile
+	    );
+
+	} /* End if */
+	else
+	{
+	    fwrite( &vertLayout, sizeof( vertLayout), 1, outFile);
+
+	    /* The padding, if any, is written out as well, so that the
+	     * vertices can be read back in one go.
+	     */
+	    fwrite(
+		glData->vertCoords,
+		sizeof( GLfloat), ( glData->vertStride * glData->nVertices),
+		outFile
+	    );
+
+	} /* End else */
 
         /* Write out the model bounds */
 	fwrite( &( glData->minX), sizeof( GLfloat), 1, outFile);
@@ -490,9 +581,11 @@ GLData *LoadGLData( FILE *inFile)
 	fread( &glDataVer, sizeof( glDataVer), 1, inFile);
 
 	if( ( strcmp( GLD_FILE_MAGIC, savedSig) == 0) && 
-	    ( glDataVer == GLD_VER)
+	    ( ( glDataVer == GLD_VER) || ( glDataVer == GLD_SEPARATE_VER))
         )
 	{
+	    Uint8 vertLayout = (Uint8 )GLD_SEPARATE_VERTS;
+
 	    free( savedSig);
 
 	    retVal = (GLData *)( malloc( sizeof( GLData)));
@@ -569,34 +662,61 @@ GLData *LoadGLData( FILE *inFile)
 		inFile
 	    );
 
-	    retVal->vertCoords = (GLfloat *)( malloc(
-	        retVal->nVertices * 3 * sizeof( GLfloat)
-	    ));
+	    if( glDataVer == GLD_VER)
+	    {
+		fread( &vertLayout, sizeof( vertLayout), 1, inFile);
 
-	    retVal->texCoords = (GLfloat *)( malloc(
-	        retVal->nVertices * 2 * sizeof( GLfloat)
-	    ));
+		if( vertLayout > (Uint8 )GLD_PADDED_VERTS)
+		{
+#ifdef GLD_DEBUG
+		    fprintf( stderr, 
+			"\nERROR: Unknown vertex layout (%u) in GLData!\n",
+			(unsigned int )vertLayout
+		    );
+#endif
+		    for( i = 0U; i < retVal->nMaps; i++)
+		    {
+			free( retVal->mapNames[i]);
 
-	    if( ( retVal->vertCoords == NULL) || 
-	        ( retVal->texCoords == NULL)
-	    )
-	    {
-		fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
-		exit( EXIT_FAILURE);
+		    } /* End for */
+		    free( retVal->mapNames);
+		    free( retVal->mapTriNums);
+		    free( retVal);
+
+		    return NULL;
+
+		} /* End if */
 
 	    } /* End if */
 
-	    fread( 
-	        retVal->vertCoords,
-	        sizeof( GLfloat), ( 3 * retVal->nVertices),
-		inFile
-	    );
+	    retVal->vertLayout = GLD_SEPARATE_VERTS;
+	    AllocVertBlock( retVal, (GLDVertLayout )vertLayout);
 
-	    fread( 
-	        retVal->texCoords,
-	        sizeof( GLfloat), ( 2 * retVal->nVertices),
-		inFile
-	    );
+	    if( retVal->vertLayout == GLD_SEPARATE_VERTS)
+	    {
+		fread( 
+		    retVal->vertCoords,
+		    sizeof( GLfloat), ( 3 * retVal->nVertices),
+		    inFile
+		);
+
+		fread( 
+		    retVal->texCoords,
+		    sizeof( GLfloat), ( 2 * retVal->nVertices),
+		    inFile
+		);
+
+	    } /* End if */
+	    else
+	    {
+		fread( 
+		    retVal->vertCoords,
+		    sizeof( GLfloat), 
+		    ( retVal->vertStride * retVal->nVertices),
+		    inFile
+		);
+
+	    } /* End else */
 
 	    /* Read in the model bounds */
 	    fread( &( retVal->minX), sizeof( GLfloat), 1, inFile);
@@ -685,12 +805,17 @@ void FreeGLData( GLData *glData)
 
 	glData->nMaps = 0U;
 
-        free( glData->vertCoords);
-	glData->vertCoords = NULL;
+	if( glData->vertLayout == GLD_SEPARATE_VERTS)
+	{
+	    free( glData->texCoords);
 
-        free( glData->texCoords);
+	} /* End if */
 	glData->texCoords = NULL;
 
+	free( glData->vertBlock);
+	glData->vertBlock = NULL;
+	glData->vertCoords = NULL;
+
 	glData->nVertices = 0U;
 
         free( glData->triFaces);
@@ -702,3 +827,71 @@ void FreeGLData( GLData *glData)
 } /* End function FreeGLData */
 
 
+/**
+ * Allocates space for the vertex definitions of the given GLData in
+ * the given layout, without freeing the space it already has.
+ */
+void AllocVertBlock( GLData *glData, GLDVertLayout vertLayout)
+{
+    size_t numVerts = ( glData->nVertices > 0U) ? glData->nVertices : 1U;
+
+    glData->vertLayout = vertLayout;
+
+    if( vertLayout == GLD_SEPARATE_VERTS)
+    {
+	glData->vertStride = 3U;
+	glData->texStride = 2U;
+
+	glData->vertBlock = 
+	    (GLfloat *)( malloc( 3U * numVerts * sizeof( GLfloat)));
+	glData->texCoords = 
+	    (GLfloat *)( malloc( 2U * numVerts * sizeof( GLfloat)));
+
+	if( ( glData->vertBlock == NULL) || ( glData->texCoords == NULL))
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	glData->vertCoords = glData->vertBlock;
+
+    } /* End if */
+    else
+    {
+	size_t blockSize;
+
+	glData->vertStride = glData->texStride = 
+	    ( vertLayout == GLD_PADDED_VERTS) ? 8U : 5U;
+
+	/* NOTE: Uses calloc( ) to initialise the padding to 0 */
+	blockSize = glData->vertStride * numVerts * sizeof( GLfloat);
+	if( vertLayout == GLD_PADDED_VERTS)
+	{
+	    blockSize += GLD_VERT_ALIGN;
+
+	} /* End if */
+
+	glData->vertBlock = (GLfloat *)( calloc( 1U, blockSize));
+	if( glData->vertBlock == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	glData->vertCoords = glData->vertBlock;
+	if( vertLayout == GLD_PADDED_VERTS)
+	{
+	    glData->vertCoords = (GLfloat *)( 
+		( (size_t )glData->vertBlock + ( GLD_VERT_ALIGN - 1U)) & 
+		~( (size_t )GLD_VERT_ALIGN - 1U)
+	    );
+
+	} /* End if */
+
+	glData->texCoords = glData->vertCoords + 3;
+
+    } /* End else */
+
+} /* End function AllocVertBlock */
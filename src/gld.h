@@ -15,15 +15,20 @@
  * Stream format for a GLD file:
  *
  *  1. File Type Identifier: "GLD" (4 bytes, including the '\0')
- *  2. Version: Major + Minor (4 high + 4 low bits). Currently 0x10 (8 bits)
+ *  2. Version: Major + Minor (4 high + 4 low bits). Currently 0x11 (8 bits)
  *
  *  3. nMaps: number of texture maps (16 bits)
  *  4. mapNames: 'nMaps' '\0' terminated strings
  *  5. mapTriNums: number of triangles using each of the maps ('nMaps'x32-bits)
  *
  *  6. nVertices: number of vertex definitions (16 bits)
- *  7. vertCoords: 'nVertices' vertex coordinates (each 3 x 32-bit floats)
- *  8. texCoords: 'nVertices' texture mappings (each 2 x 32-bit floats)
+ *  7. vertLayout: layout of the vertex definitions (8 bits, see GLDVertLayout)
+ *  8. For GLD_SEPARATE_VERTS,
+ *         vertCoords: 'nVertices' vertex coordinates (each 3 x 32-bit floats)
+ *         texCoords: 'nVertices' texture mappings (each 2 x 32-bit floats)
+ *     otherwise,
+ *         'nVertices' (x,y,z,u,v) values (each 5 x 32-bit floats), each 
+ *         followed by 3 x 32-bit floats of 0.0 for GLD_PADDED_VERTS
  *
  *  9. minX: Minimum overall X ordinate value (32-bit float)
  * 10. maxX: Maximum overall X ordinate value (32-bit float)
@@ -38,6 +43,10 @@
  * 16. For( 0 <= i < nMaps),
  *         'mapTriNums[i]' vertex definition indices (3 x 16 bits)
  *
+ * Version 0x10 files are the same, except that they do not have item 7
+ * and always have the vertex definitions in separate arrays. They are 
+ * still read in, and are written out for GLData using that layout.
+ *
  * NOTE: All numbers are little-endian and all strings are in 7-bit ASCII.
  */
 
@@ -53,7 +62,8 @@
 
 /* These form the "signature" of a GLD file */
 #define GLD_FILE_MAGIC "GLD"
-#define GLD_VER 0x10
+#define GLD_VER 0x11
+#define GLD_SEPARATE_VER 0x10
 
 
 /* Vertex coordinates differing only upto this value in their 
@@ -77,6 +87,25 @@
 
 /* Data type definitions */
 
+/* How the vertex coordinates and texture mappings are laid out */
+typedef enum
+{
+    /* An array of (x,y,z) values and another of (u,v) values */
+    GLD_SEPARATE_VERTS = 0,
+
+    /* A single array of (x,y,z,u,v) values, so that everything about 
+     * a vertex is fetched together.
+     */
+    GLD_INTERLEAVED_VERTS,
+
+    /* As above, with each vertex padded to 32 bytes and the array 
+     * aligned to 32 bytes, so that no vertex straddles cache lines.
+     */
+    GLD_PADDED_VERTS
+
+} GLDVertLayout;
+
+
 /* Run-time representation of a GLD file.
  */
 typedef struct _gldata
@@ -86,8 +115,17 @@ typedef struct _gldata
     Uint32 *mapTriNums;
 
     Uint16 nVertices;
-    GLfloat *vertCoords;  /* 'nVertices' packed triads of (x,y,z) values */
-    GLfloat *texCoords;   /* 'nVertices' packed pairs of (u,v) values */
+    GLfloat *vertCoords;  /* 'nVertices' triads of (x,y,z) values */
+    GLfloat *texCoords;   /* 'nVertices' pairs of (u,v) values */
+
+    /* The layout of the above, and the number of GLfloats from one 
+     * vertex to the next in each. With an interleaved layout, both 
+     * point into 'vertBlock', which is what has been allocated.
+     */
+    GLDVertLayout vertLayout;
+    Uint32 vertStride;
+    Uint32 texStride;
+    GLfloat *vertBlock;
 
     GLfloat minX, maxX;
     GLfloat minY, maxY;
@@ -103,6 +141,13 @@ typedef struct _gldata
 } GLData;
 
 
+/* The (x,y,z) and (u,v) values of the given vertex definition */
+#define GLD_VERT_COORDS( glData, vIndex) \
+    ( (glData)->vertCoords + (glData)->vertStride * (vIndex))
+#define GLD_TEX_COORDS( glData, vIndex) \
+    ( (glData)->texCoords + (glData)->texStride * (vIndex))
+
+
 /* Function Prototypes */
 
 /**
@@ -123,6 +168,14 @@ extern GLData *GenGLData(
 );
 
 
+/**
+ * Lays out the vertex definitions of the given GLData as given. GLData
+ * is generated with GLD_SEPARATE_VERTS, and loaded with the layout 
+ * it was saved with.
+ */
+extern void SetGLDVertLayout( GLData *glData, GLDVertLayout vertLayout);
+
+
 /**
  * Saves the given GLData into the given file. 
  * The file must be opened for writing binary
@@ -10,11 +10,13 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <float.h>
 #include <limits.h>
 
 #include "gld.h"
 #include "bsp.h"
+#include "bldcache.h"
 
 
 /* Constants representing information about command-line args */
@@ -26,9 +28,28 @@
 #define OUTFILE_ARG 2
 
 
+/* Change this whenever a change to the converter (or to the BSP Tree
+ * compiler) changes the BSP Tree it writes out, so that files built by
+ * the older version are no longer taken from the build cache.
+ */
+#define GLD2BSP_VERSION "GLD2BSP 7"
+
+
+/* Local function prototypes */
+
+static GLboolean ParseCostModel( 
+    const char *costSpec, BSPCostModel *costModel
+);
+
+
 /**
  * Entry point into the GLD2BSP converter program. Takes in the GLD 
- * model and output file names (in that order).
+ * model and output file names (in that order), optionally preceded by
+ * "-cache <folder>" to take the BSP Tree from (or put it in) the build
+ * cache in that folder (see "bldcache.h") and by "-cost <model>" to
+ * choose the partition planes with the given cost model (see
+ * ParseCostModel( )). With just "-check", it only checks that the
+ * BSP Tree compiler works out orientations right on this machine.
  *
  * All the polygons in the model are assumed to be just triangles,
  * textured and oriented correctly (vertices in anticlockwise
@@ -52,22 +73,114 @@ int main( int argc, char *argv[])
     Uint32 i, j, k;
     Uint32 triConverted;
 
+    const char *cacheDir = NULL;
+    GLboolean useCache = GL_FALSE;
+    BuildKey buildKey;
+
+    const char *costSpec = "balance";
+    BSPCostModel costModel;
+
 
-    /* Check command-line arguments */
-    if( argc != ( NUM_REQ_ARGS + 1))
+    if( ( argc == 2) && ( strcmp( "-check", argv[1]) == 0))
+    {
+	if( CheckBSPPredicates( ) == GL_FALSE)
+	{
+	    fprintf( stderr, "GLD2BSP: Orientation checks failed\n");
+	    return EXIT_FAILURE;
+
+	} /* End if */
+
+	printf( "GLD2BSP: Orientation checks passed\n");
+	return EXIT_SUCCESS;
+
+    } /* End if */
+
+
+    /* Check command-line arguments, moving the name of the programme
+     * past the options (if any) so that the rest are where they
+     * would be without them.
+     */
+    while( argc > 2)
+    {
+	if( strcmp( "-cache", argv[1]) == 0)
+	{
+	    cacheDir = argv[2];
+
+	} /* End if */
+	else if( strcmp( "-cost", argv[1]) == 0)
+	{
+	    costSpec = argv[2];
+
+	} /* End else-if */
+	else
+	{
+	    break;
+
+	} /* End else */
+
+	argv[2] = argv[PROG_NAME_ARG];
+	argv += 2;
+	argc -= 2;
+
+    } /* End while */
+
+    if( ( argc != ( NUM_REQ_ARGS + 1)) || 
+	( ParseCostModel( costSpec, &costModel) == GL_FALSE)
+    )
     {
         fprintf( stderr, 
 	    "GLD2BSP: Generate BSP Tree from a GLD model\n"
 	);
         fprintf( stderr, 
-	    "Usage: %s <gldfile> <outfile>\n", 
+	    "Usage: %s [-cache <folder>] [-cost <model>] "
+	    "<gldfile> <outfile>\n",
 	    argv[PROG_NAME_ARG]
 	);
+	fprintf( stderr, "   or: %s -check\n", argv[PROG_NAME_ARG]);
+	fprintf( stderr, 
+	    "(<model> is \"balance\", \"sah\" or "
+	    "\"sah,<node>,<split>,<axis>,<facade>\")\n"
+	);
 
         return EXIT_FAILURE;
 
     } /* End if */
 
+
+    /* See if the build cache already has the BSP Tree for this model */
+    if( cacheDir != NULL)
+    {
+	InitBuildKey( &buildKey, GLD2BSP_VERSION);
+
+	/* The programme itself is part of the key as well, when it can be
+	 * read (as when it is run by the make-file), so that rebuilding
+	 * it with some change also makes it build the file afresh.
+	 */
+	AddFileToBuildKey( &buildKey, argv[PROG_NAME_ARG]);
+	AddStringToBuildKey( &buildKey, costSpec);
+
+	if( AddFileToBuildKey( &buildKey, argv[GLD_FILE_ARG]) == GL_TRUE)
+	{
+	    useCache = GL_TRUE;
+
+	    if( FetchCachedBuild( 
+		    cacheDir, &buildKey, argv[OUTFILE_ARG]) == GL_TRUE
+	    )
+	    {
+		printf( 
+		    "GLD2BSP: BSP tree for \"%s\" taken from the build "
+		    "cache\n", argv[GLD_FILE_ARG]
+		);
+		fflush( stdout);
+
+		return EXIT_SUCCESS;
+
+	    } /* End if */
+
+	} /* End if */
+
+    } /* End if */
+
     
     /* Read in the model */
     inFile = fopen( argv[GLD_FILE_ARG], "rb");
@@ -137,20 +250,20 @@ int main( int argc, char *argv[])
 	        Uint16 vIndex = triFaceIndices[3*j + k];
 
 	        triVerts[9*triConverted + 3*k + 0] = 
-		    *( inModel->vertCoords + 3*vIndex + 0);
+		    *( GLD_VERT_COORDS( inModel, vIndex) + 0);
 
 	        triVerts[9*triConverted + 3*k + 1] = 
-		    *( inModel->vertCoords + 3*vIndex + 1);
+		    *( GLD_VERT_COORDS( inModel, vIndex) + 1);
 
 	        triVerts[9*triConverted + 3*k + 2] = 
-		    *( inModel->vertCoords + 3*vIndex + 2);
+		    *( GLD_VERT_COORDS( inModel, vIndex) + 2);
 
 
 	        triTexCoords[6*triConverted + 2*k + 0] = 
-		    *( inModel->texCoords + 2*vIndex + 0);
+		    *( GLD_TEX_COORDS( inModel, vIndex) + 0);
 
 	        triTexCoords[6*triConverted + 2*k + 1] = 
-		    *( inModel->texCoords + 2*vIndex + 1);
+		    *( GLD_TEX_COORDS( inModel, vIndex) + 1);
 
 	    } /* End for */
 	    
@@ -161,9 +274,21 @@ int main( int argc, char *argv[])
     } /* End for */
 
 
-    /* Generate the BSP Tree */
+    /* Generate the BSP Tree, if this build can be trusted to */
+    if( CheckBSPPredicates( ) == GL_FALSE)
+    {
+        fprintf( 
+	    stderr, 
+	    "\nFATAL ERROR: Orientations are not worked out right by "
+	    "this build!\n"
+	);
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
     bspData = GenBSPTreeData( 
-        nTri, triVerts, texIndices, triTexCoords, nMaps, texMapNames
+        nTri, triVerts, texIndices, triTexCoords, nMaps, texMapNames,
+	&costModel
     );
 
     if( bspData == NULL)
@@ -226,6 +351,20 @@ int main( int argc, char *argv[])
 
     } /* End if */
 
+    /* Keep a copy in the build cache for next time */
+    if( ( useCache == GL_TRUE) &&
+	( StoreCachedBuild( 
+	    cacheDir, &buildKey, argv[OUTFILE_ARG]) == GL_FALSE
+	)
+    )
+    {
+	fprintf( stderr,
+	    "\nWARNING: Unable to store BSP tree in the build cache \"%s\"!\n",
+	    cacheDir
+	);
+
+    } /* End if */
+
     printf( "GLD2BSP: Done.\n");
     fflush( stdout);
 
@@ -239,3 +378,55 @@ int main( int argc, char *argv[])
 } /* End function main */
 
 
+/**
+ * Sets up the given cost model from the given "-cost" option: either
+ * "balance" (the default), "sah" or "sah,<node>,<split>,<axis>,<facade>"
+ * (with the costs given explicitly, see BSPCostModel). Returns GL_FALSE
+ * if the option is not understood.
+ */
+GLboolean ParseCostModel( const char *costSpec, BSPCostModel *costModel)
+{
+    GLboolean retVal = GL_TRUE;
+
+    if( strcmp( costSpec, "balance") == 0)
+    {
+	InitBSPCostModel( costModel, BSP_COST_BALANCE);
+
+    } /* End if */
+    else if( strcmp( costSpec, "sah") == 0)
+    {
+	InitBSPCostModel( costModel, BSP_COST_SAH);
+
+    } /* End else-if */
+    else
+    {
+	float costs[4];
+	char extraChar;
+
+	InitBSPCostModel( costModel, BSP_COST_SAH);
+
+	if( sscanf( 
+		costSpec, "sah,%f,%f,%f,%f%c", 
+		&costs[0], &costs[1], &costs[2], &costs[3], &extraChar
+	    ) == 4
+	)
+	{
+	    costModel->nodeCost = costs[0];
+	    costModel->splitCost = costs[1];
+	    costModel->axisBias = costs[2];
+	    costModel->facadeBias = costs[3];
+
+	} /* End if */
+	else
+	{
+	    retVal = GL_FALSE;
+
+	} /* End else */
+
+    } /* End else */
+
+    return retVal;
+
+} /* End function ParseCostModel */
+
+
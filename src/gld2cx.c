@@ -0,0 +1,312 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * GLD2CX.C: GLData (GLD) to collision mesh (CX) converter.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gld.h"
+#include "cxmesh.h"
+#include "cxgen.h"
+#include "bldcache.h"
+
+
+/* Constants representing information about command-line args */
+
+#define NUM_REQ_ARGS 2
+
+#define PROG_NAME_ARG 0
+#define GLD_FILE_ARG 1
+#define OUTFILE_ARG 2
+
+
+/* Change this whenever a change to the converter (or to the code it
+ * uses) changes the collision mesh it writes out, so that files built
+ * by the older version are no longer taken from the build cache.
+ */
+#define GLD2CX_VERSION "GLD2CX 2"
+
+
+/**
+ * Entry point into the GLD2CX converter program. Takes in the GLD
+ * render model and output file names (in that order), optionally
+ * preceded by "-cache <folder>" to take the collision mesh from (or
+ * put it in) the build cache in that folder (see "bldcache.h") and by
+ * "-voxel <size>" to use voxels of that size (CXGEN_DEF_VOXEL_SIZE by
+ * default) to generate it (see "cxgen.h").
+ */
+int main( int argc, char *argv[])
+{
+    GLData *inModel = NULL;
+    CXMesh *cxMesh = NULL;
+    FILE *outFile, *inFile;
+    char *tmpFileName;
+
+    const char *cacheDir = NULL;
+    GLboolean useCache = GL_FALSE;
+    BuildKey buildKey;
+
+    const char *voxelSpec = NULL;
+    GLfloat voxelSize = CXGEN_DEF_VOXEL_SIZE;
+    char extraChar;
+    GLboolean argsOK = GL_TRUE;
+
+
+    /* Check command-line arguments, moving the name of the programme
+     * past the options (if any) so that the rest are where they
+     * would be without them.
+     */
+    while( argc > 2)
+    {
+	if( strcmp( "-cache", argv[1]) == 0)
+	{
+	    cacheDir = argv[2];
+
+	} /* End if */
+	else if( strcmp( "-voxel", argv[1]) == 0)
+	{
+	    voxelSpec = argv[2];
+
+	} /* End else-if */
+	else
+	{
+	    break;
+
+	} /* End else */
+
+	argv[2] = argv[PROG_NAME_ARG];
+	argv += 2;
+	argc -= 2;
+
+    } /* End while */
+
+    if( ( voxelSpec != NULL) &&
+	( ( sscanf( voxelSpec, "%f%c", &voxelSize, &extraChar) != 1) ||
+	  ( voxelSize <= 0.0F)
+	)
+    )
+    {
+	argsOK = GL_FALSE;
+
+    } /* End if */
+
+    if( ( argc != ( NUM_REQ_ARGS + 1)) || ( argsOK == GL_FALSE))
+    {
+	fprintf( stderr,
+	    "GLD2CX: Generate a collision mesh from a GLD model\n"
+	);
+	fprintf( stderr,
+	    "Usage: %s [-cache <folder>] [-voxel <size>] "
+	    "<gldfile> <outfile>\n",
+	    argv[PROG_NAME_ARG]
+	);
+
+	return EXIT_FAILURE;
+
+    } /* End if */
+
+
+    /* See if the build cache already has the collision mesh */
+    if( cacheDir != NULL)
+    {
+	char voxelKey[32];
+
+	InitBuildKey( &buildKey, GLD2CX_VERSION);
+
+	/* The programme itself is part of the key as well, when it can be
+	 * read (as when it is run by the make-file), so that rebuilding
+	 * it with some change also makes it build the file afresh.
+	 */
+	AddFileToBuildKey( &buildKey, argv[PROG_NAME_ARG]);
+
+	sprintf( voxelKey, "%.9g", (double )voxelSize);
+	AddStringToBuildKey( &buildKey, voxelKey);
+
+	if( AddFileToBuildKey( &buildKey, argv[GLD_FILE_ARG]) == GL_TRUE)
+	{
+	    useCache = GL_TRUE;
+
+	    if( FetchCachedBuild(
+		    cacheDir, &buildKey, argv[OUTFILE_ARG]) == GL_TRUE
+	    )
+	    {
+		printf(
+		    "GLD2CX: Collision mesh for \"%s\" taken from the build "
+		    "cache\n", argv[GLD_FILE_ARG]
+		);
+		fflush( stdout);
+
+		return EXIT_SUCCESS;
+
+	    } /* End if */
+
+	} /* End if */
+
+    } /* End if */
+
+
+    /* Read in the model */
+    inFile = fopen( argv[GLD_FILE_ARG], "rb");
+    if( inFile == NULL)
+    {
+	fprintf( stderr,
+	    "\nERROR: Unable to open file \"%s\" for reading!\n",
+	    argv[GLD_FILE_ARG]
+	);
+	return EXIT_FAILURE;
+
+    } /* End if */
+
+    inModel = LoadGLData( inFile);
+
+    fclose( inFile);
+
+    if( inModel == NULL)
+    {
+	fprintf( stderr,
+	    "\nERROR: Unable to read in GLD model from \"%s\"!\n",
+	    argv[GLD_FILE_ARG]
+	);
+	return EXIT_FAILURE;
+
+    } /* End if */
+
+    printf(
+	"GLD2CX: Read GLD model from \"%s\" (%lu triangles, "
+	"%u vertex definitions)\n",
+	argv[GLD_FILE_ARG],
+	(unsigned long )inModel->numTri, (unsigned int )inModel->nVertices
+    );
+    fflush( stdout);
+
+
+    /* Generate the collision mesh */
+    cxMesh = GenCXMesh( inModel, voxelSize);
+
+    if( cxMesh == NULL)
+    {
+	fprintf( stderr,
+	    "\nERROR: Could not generate collision mesh (voxels too small "
+	    "for the model?)!\n"
+	);
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    FreeGLData( inModel);
+
+    printf(
+	"GLD2CX: Generated collision mesh (%lu triangles, %lu vertices)\n",
+	(unsigned long )cxMesh->numTri, (unsigned long )cxMesh->numVerts
+    );
+    fflush( stdout);
+
+
+    /* Now write out the collision mesh to the given file - under a
+     * temporary name first, and then renamed, since a running demo
+     * watching the file might have the old one mapped into memory (see
+     * LoadCXMesh( ) in "cxmesh.h").
+     */
+    tmpFileName = (char *)( 
+	malloc( strlen( argv[OUTFILE_ARG]) + sizeof( ".tmp"))
+    );
+    if( tmpFileName == NULL)
+    {
+        fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    strcpy( tmpFileName, argv[OUTFILE_ARG]);
+    strcat( tmpFileName, ".tmp");
+
+    outFile = fopen( tmpFileName, "wb");
+
+    if( outFile == NULL)
+    {
+	fprintf( stderr,
+	    "\nERROR: Unable to open file \"%s\" for writing!\n",
+	    tmpFileName
+	);
+	return EXIT_FAILURE;
+
+    } /* End if */
+
+    SaveCXMesh( cxMesh, outFile);
+
+    /* Just to be sure */
+    fflush( outFile);
+    fclose( outFile);
+
+    /* Some systems do not rename over an existing file */
+    remove( argv[OUTFILE_ARG]);
+
+    if( rename( tmpFileName, argv[OUTFILE_ARG]) != 0)
+    {
+	fprintf( stderr,
+	    "\nERROR: Unable to rename \"%s\" to \"%s\"!\n",
+	    tmpFileName, argv[OUTFILE_ARG]
+	);
+	remove( tmpFileName);
+	return EXIT_FAILURE;
+
+    } /* End if */
+
+    free( tmpFileName);
+
+    printf( "GLD2CX: Collision mesh saved to \"%s\"\n", argv[OUTFILE_ARG]);
+    fflush( stdout);
+
+    FreeCXMesh( cxMesh);
+
+
+    /* Verify that the mesh was properly written out */
+    printf( "GLD2CX: Now loading back the saved data...\n");
+    fflush( stdout);
+
+    inFile = fopen( argv[OUTFILE_ARG], "rb");
+    cxMesh = LoadCXMesh( inFile);
+    fclose( inFile);
+
+    if( cxMesh == NULL)
+    {
+	fprintf( stderr,
+	    "\nERROR: Could not read back saved collision mesh!\n"
+	);
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    /* Keep a copy in the build cache for next time */
+    if( ( useCache == GL_TRUE) &&
+	( StoreCachedBuild(
+	    cacheDir, &buildKey, argv[OUTFILE_ARG]) == GL_FALSE
+	)
+    )
+    {
+	fprintf( stderr,
+	    "\nWARNING: Unable to store collision mesh in the build cache "
+	    "\"%s\"!\n",
+	    cacheDir
+	);
+
+    } /* End if */
+
+    printf( "GLD2CX: Done.\n");
+    fflush( stdout);
+
+
+    /* Free the loaded collision mesh */
+    FreeCXMesh( cxMesh);
+
+
+    return EXIT_SUCCESS;
+
+} /* End function main */
@@ -0,0 +1,367 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * GLDEBUG.C: Reporting OpenGL errors and other problems without
+ * slowing down rendering.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glutil.h"
+#include "gldebug.h"
+
+
+#ifdef VTAJ_DEBUG
+
+/* Atomic operations needed by the message queue */
+#if defined( __GNUC__)
+    #define ATOMIC_CAS( aPtr, oldVal, newVal) \
+	__sync_bool_compare_and_swap( ( aPtr), ( oldVal), ( newVal))
+    #define ATOMIC_INC( aPtr) \
+	(void )__sync_fetch_and_add( ( aPtr), 1U)
+    #define MEMORY_BARRIER( ) \
+	__sync_synchronize( )
+#elif defined( _WIN32)
+    #include <windows.h>
+    #define ATOMIC_CAS( aPtr, oldVal, newVal) \
+	( InterlockedCompareExchange( \
+	    (LONG volatile *)( aPtr), (LONG )( newVal), (LONG )( oldVal) \
+	  ) == (LONG )( oldVal))
+    #define ATOMIC_INC( aPtr) \
+	(void )InterlockedIncrement( (LONG volatile *)( aPtr))
+    #define MEMORY_BARRIER( ) \
+	MemoryBarrier( )
+#else
+    #error "Do not know how to do atomic operations on this platform"
+#endif
+
+
+/* Sources of messages */
+#ifndef GL_DEBUG_SOURCE_API
+    #define GL_DEBUG_SOURCE_API 0x8246
+    #define GL_DEBUG_SOURCE_WINDOW_SYSTEM 0x8247
+    #define GL_DEBUG_SOURCE_SHADER_COMPILER 0x8248
+    #define GL_DEBUG_SOURCE_THIRD_PARTY 0x8249
+    #define GL_DEBUG_SOURCE_APPLICATION 0x824A
+#endif
+
+
+/* Data type definitions */
+
+/* A message from the OpenGL implementation */
+typedef struct _gl_debug_msg
+{
+    volatile Uint32 isReady;    /* Filled in, but not yet printed */
+
+    GLenum source;
+    GLenum type;
+    GLenum severity;
+    GLuint id;
+    char text[GLDEBUG_MAX_MSG_LEN];
+
+} GLDebugMsg;
+
+
+/* Global data */
+
+static GLboolean usingCallback = GL_FALSE;
+
+/* Are errors still to be sampled with glGetError( ) once a frame? */
+static GLboolean sampleErrors = GL_TRUE;
+
+/* The message queue. The slot of the n-th message is given by
+ * ( n % GLDEBUG_QUEUE_LEN). Only the render loop reads messages.
+ */
+static GLDebugMsg msgQueue[GLDEBUG_QUEUE_LEN];
+static volatile Uint32 numWritten = 0U;
+static volatile Uint32 numRead = 0U;
+static volatile Uint32 numDropped = 0U;
+static Uint32 numDroppedShown = 0U;
+
+
+/* Local function prototypes */
+
+static void APIENTRY QueueGLDebugMessage(
+    GLenum source, GLenum type, GLuint id, GLenum severity,
+    GLsizei length, const char *message, const GLvoid *userParam
+);
+static const char *GetSourceName( GLenum source);
+static const char *GetTypeName( GLenum type);
+static const char *GetSeverityName( GLenum severity);
+
+
+void InitGLDebug( void)
+{
+    usingCallback = GL_FALSE;
+    sampleErrors = GL_TRUE;
+
+    if( hasDebugOutput == GL_TRUE)
+    {
+	pglDebugMessageCallback( QueueGLDebugMessage, NULL);
+	usingCallback = GL_TRUE;
+
+	/* Only "GL_KHR_debug" has an explicit switch and informational
+	 * messages, which are too many to be of any use. Without it,
+	 * "GL_ARB_debug_output" need not say anything outside a debug
+	 * context (which SDL 1.2 cannot ask for), so errors are still
+	 * sampled.
+	 */
+	if( HasGLVersion( 4, 3) || HasGLExtension( "GL_KHR_debug"))
+	{
+	    glEnable( GL_DEBUG_OUTPUT);
+
+	    pglDebugMessageControl( 
+		GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION,
+		0, NULL, GL_FALSE
+	    );
+
+	    if( glIsEnabled( GL_DEBUG_OUTPUT) == GL_TRUE)
+	    {
+		sampleErrors = GL_FALSE;
+
+	    } /* End if */
+
+	} /* End if */
+
+    } /* End if */
+
+    /* Clear out any errors from before */
+    while( glGetError( ) != GL_NO_ERROR)
+    {
+	/* Nothing to do */
+
+    } /* End while */
+
+    checkEachGLCall = GL_FALSE;
+
+} /* End function InitGLDebug */
+
+
+void DrainGLDebugMessages( void)
+{
+    if( usingCallback == GL_TRUE)
+    {
+	GLDebugMsg *aMsg;
+	Uint32 currDropped;
+
+	aMsg = ( msgQueue + ( numRead % GLDEBUG_QUEUE_LEN));
+	while( aMsg->isReady != 0U)
+	{
+	    /* Do not read the message before its flag */
+	    MEMORY_BARRIER( );
+
+	    fprintf( 
+		stderr,
+		"\nOpenGL %s (%s, %s, ID %u): %s\n",
+		GetTypeName( aMsg->type), GetSourceName( aMsg->source),
+		GetSeverityName( aMsg->severity), (unsigned int )aMsg->id,
+		aMsg->text
+	    );
+
+	    /* Hand back the slot only after we are done with it */
+	    aMsg->isReady = 0U;
+	    MEMORY_BARRIER( );
+	    numRead++;
+
+	    aMsg = ( msgQueue + ( numRead % GLDEBUG_QUEUE_LEN));
+
+	} /* End while */
+
+	currDropped = numDropped;
+	if( currDropped != numDroppedShown)
+	{
+	    fprintf( 
+		stderr,
+		"\nOpenGL debug messages dropped: %u\n",
+		(unsigned int )( currDropped - numDroppedShown)
+	    );
+	    numDroppedShown = currDropped;
+
+	} /* End if */
+
+    } /* End if */
+
+    if( sampleErrors == GL_TRUE)
+    {
+	GLenum glErr;
+	int numErrors = 0;
+
+	while( ( numErrors < GLDEBUG_MAX_SAMPLED_ERRORS) &&
+	    ( ( glErr = glGetError( )) != GL_NO_ERROR)
+	)
+	{
+	    fprintf( 
+		stderr,
+		"\nOpenGL ERROR during the last frame: %s\n",
+		gluErrorString( glErr)
+	    );
+	    numErrors++;
+
+	} /* End while */
+
+    } /* End if */
+
+} /* End function DrainGLDebugMessages */
+
+
+void StopGLDebug( void)
+{
+    DrainGLDebugMessages( );
+
+    if( usingCallback == GL_TRUE)
+    {
+	pglDebugMessageCallback( NULL, NULL);
+
+	/* A driver thread might have been in the callback */
+	DrainGLDebugMessages( );
+
+	usingCallback = GL_FALSE;
+
+    } /* End if */
+
+    sampleErrors = GL_TRUE;
+    checkEachGLCall = GL_TRUE;
+
+} /* End function StopGLDebug */
+
+
+/**
+ * Called by the OpenGL implementation, possibly from another thread,
+ * with a message for us.
+ */
+void APIENTRY QueueGLDebugMessage(
+    GLenum source, GLenum type, GLuint id, GLenum severity,
+    GLsizei length, const char *message, const GLvoid *userParam
+)
+{
+    GLDebugMsg *aMsg;
+    Uint32 msgNum;
+    size_t msgLen;
+
+    (void )userParam;
+
+    /* Claim the next slot, unless the queue is full */
+    do
+    {
+	msgNum = numWritten;
+	if( ( msgNum - numRead) >= GLDEBUG_QUEUE_LEN)
+	{
+	    ATOMIC_INC( &numDropped);
+	    return;
+
+	} /* End if */
+
+    } while( !ATOMIC_CAS( &numWritten, msgNum, ( msgNum + 1U)));
+
+    aMsg = ( msgQueue + ( msgNum % GLDEBUG_QUEUE_LEN));
+
+    aMsg->source = source;
+    aMsg->type = type;
+    aMsg->severity = severity;
+    aMsg->id = id;
+
+    msgLen = ( length >= 0) ? (size_t )length : strlen( message);
+    msgLen = ( msgLen < GLDEBUG_MAX_MSG_LEN) ? 
+	msgLen : ( GLDEBUG_MAX_MSG_LEN - 1U);
+    memcpy( aMsg->text, message, msgLen);
+    aMsg->text[msgLen] = '\0';
+
+    /* Do not let the flag be seen before the message */
+    MEMORY_BARRIER( );
+    aMsg->isReady = 1U;
+
+} /* End function QueueGLDebugMessage */
+
+
+/**
+ * Returns a printable name for the source of a message.
+ */
+const char *GetSourceName( GLenum source)
+{
+    switch( source)
+    {
+    case GL_DEBUG_SOURCE_API:
+	return "API";
+
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+	return "window system";
+
+    case GL_DEBUG_SOURCE_SHADER_COMPILER:
+	return "shader compiler";
+
+    case GL_DEBUG_SOURCE_THIRD_PARTY:
+	return "third party";
+
+    case GL_DEBUG_SOURCE_APPLICATION:
+	return "application";
+
+    default:
+	return "other";
+
+    } /* End switch */
+
+} /* End function GetSourceName */
+
+
+/**
+ * Returns a printable name for the type of a message.
+ */
+const char *GetTypeName( GLenum type)
+{
+    switch( type)
+    {
+    case GL_DEBUG_TYPE_ERROR:
+	return "ERROR";
+
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+	return "DEPRECATED";
+
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+	return "UNDEFINED BEHAVIOUR";
+
+    case GL_DEBUG_TYPE_PORTABILITY:
+	return "PORTABILITY";
+
+    case GL_DEBUG_TYPE_PERFORMANCE:
+	return "PERFORMANCE";
+
+    default:
+	return "MESSAGE";
+
+    } /* End switch */
+
+} /* End function GetTypeName */
+
+
+/**
+ * Returns a printable name for the severity of a message.
+ */
+const char *GetSeverityName( GLenum severity)
+{
+    switch( severity)
+    {
+    case GL_DEBUG_SEVERITY_HIGH:
+	return "high";
+
+    case GL_DEBUG_SEVERITY_MEDIUM:
+	return "medium";
+
+    case GL_DEBUG_SEVERITY_LOW:
+	return "low";
+
+    default:
+	return "notice";
+
+    } /* End switch */
+
+} /* End function GetSeverityName */
+
+#endif    /* VTAJ_DEBUG */
+
+
@@ -0,0 +1,88 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * GLDEBUG.H: Declarations for reporting OpenGL errors and other
+ * problems without slowing down rendering.
+ */
+
+/**
+ * Calling glGetError( ) after every OpenGL call (as CHECK_GL_ERROR
+ * does) makes the driver finish whatever it has queued up, so debug
+ * builds render much slower than release builds. While rendering, we
+ * instead have the OpenGL implementation hand over its messages to a
+ * callback, which just puts them into a queue; the queue is emptied
+ * and the messages printed once a frame, by the render loop.
+ *
+ * The callback might be called by a driver thread, possibly by more
+ * than one at the same time, so the queue does not use locks: a slot
+ * is claimed by atomically advancing the count of messages written,
+ * and marked ready once it has been filled in. If the queue is full,
+ * messages are dropped (and counted).
+ *
+ * Unless "GL_KHR_debug" (or OpenGL 4.3) has turned the debug output
+ * on, glGetError( ) is also called just once a frame - this still
+ * catches errors, although not the OpenGL call that caused them.
+ * ("GL_ARB_debug_output" alone need not report anything outside a
+ * debug context, which SDL 1.2 cannot create.)
+ *
+ * Only debug builds (with VTAJ_DEBUG defined) do any of this.
+ */
+
+#ifndef _GLDEBUG_H
+#define _GLDEBUG_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+
+/* Number of messages the queue can hold (a power of two) */
+#define GLDEBUG_QUEUE_LEN 64
+
+/* Longer messages are truncated */
+#define GLDEBUG_MAX_MSG_LEN 256
+
+/* Maximum number of errors reported per frame by glGetError( ) */
+#define GLDEBUG_MAX_SAMPLED_ERRORS 8
+
+
+/* Function Prototypes */
+
+#ifdef VTAJ_DEBUG
+
+/**
+ * Starts collecting OpenGL messages through the debug output callback
+ * if possible, and turns off the checks done by CHECK_GL_ERROR. Must
+ * be called after InitGLExtensions( ).
+ */
+extern void InitGLDebug( void);
+
+
+/**
+ * Prints the messages collected so far - and, unless the debug output
+ * is known to be on, the errors glGetError( ) reports. To be called
+ * once a frame.
+ */
+extern void DrainGLDebugMessages( void);
+
+
+/**
+ * Prints the messages still in the queue, stops collecting messages
+ * and turns the checks done by CHECK_GL_ERROR back on.
+ */
+extern void StopGLDebug( void);
+
+#else
+    #define InitGLDebug( )
+    #define DrainGLDebugMessages( )
+    #define StopGLDebug( )
+#endif
+
+#endif    /* _GLDEBUG_H */
+
+
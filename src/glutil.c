@@ -0,0 +1,279 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * GLUTIL.C: OpenGL helpers shared across the demo.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glutil.h"
+
+
+/* Global data */
+
+GLboolean hasVertexBufferObjects = GL_FALSE;
+GLboolean hasPixelBufferObjects = GL_FALSE;
+GLboolean hasPersistentBuffers = GL_FALSE;
+GLboolean hasBGRAPixels = GL_FALSE;
+GLboolean hasDebugOutput = GL_FALSE;
+GLboolean hasTextureLOD = GL_FALSE;
+GLboolean hasS3TCTextures = GL_FALSE;
+
+GLboolean checkEachGLCall = GL_TRUE;
+
+GLGenBuffersProc pglGenBuffers = NULL;
+GLDeleteBuffersProc pglDeleteBuffers = NULL;
+GLBindBufferProc pglBindBuffer = NULL;
+GLBufferDataProc pglBufferData = NULL;
+GLMapBufferProc pglMapBuffer = NULL;
+GLUnmapBufferProc pglUnmapBuffer = NULL;
+
+GLBufferStorageProc pglBufferStorage = NULL;
+GLMapBufferRangeProc pglMapBufferRange = NULL;
+GLFenceSyncProc pglFenceSync = NULL;
+GLClientWaitSyncProc pglClientWaitSync = NULL;
+GLDeleteSyncProc pglDeleteSync = NULL;
+
+GLCompressedTexImage2DProc pglCompressedTexImage2D = NULL;
+
+GLDebugMessageCallbackProc pglDebugMessageCallback = NULL;
+GLDebugMessageControlProc pglDebugMessageControl = NULL;
+
+
+/* Local function prototypes */
+
+static void *GetGLProc( const char *coreName, const char *arbName);
+
+
+void InitGLExtensions( void)
+{
+    hasBGRAPixels =
+	( HasGLVersion( 1, 2) || HasGLExtension( "GL_EXT_bgra")) ?
+	GL_TRUE : GL_FALSE;
+
+    hasTextureLOD =
+	( HasGLVersion( 1, 2) || HasGLExtension( "GL_SGIS_texture_lod")) ?
+	GL_TRUE : GL_FALSE;
+
+    hasVertexBufferObjects = GL_FALSE;
+    hasPixelBufferObjects = GL_FALSE;
+    hasPersistentBuffers = GL_FALSE;
+
+    if( HasGLVersion( 1, 5) ||
+	HasGLExtension( "GL_ARB_vertex_buffer_object")
+    )
+    {
+	pglGenBuffers = (GLGenBuffersProc )(
+	    GetGLProc( "glGenBuffers", "glGenBuffersARB")
+	);
+	pglDeleteBuffers = (GLDeleteBuffersProc )(
+	    GetGLProc( "glDeleteBuffers", "glDeleteBuffersARB")
+	);
+	pglBindBuffer = (GLBindBufferProc )(
+	    GetGLProc( "glBindBuffer", "glBindBufferARB")
+	);
+	pglBufferData = (GLBufferDataProc )(
+	    GetGLProc( "glBufferData", "glBufferDataARB")
+	);
+	pglMapBuffer = (GLMapBufferProc )(
+	    GetGLProc( "glMapBuffer", "glMapBufferARB")
+	);
+	pglUnmapBuffer = (GLUnmapBufferProc )(
+	    GetGLProc( "glUnmapBuffer", "glUnmapBufferARB")
+	);
+
+	if( ( pglGenBuffers != NULL) && ( pglDeleteBuffers != NULL) &&
+	    ( pglBindBuffer != NULL) && ( pglBufferData != NULL) &&
+	    ( pglMapBuffer != NULL) && ( pglUnmapBuffer != NULL)
+	)
+	{
+	    hasVertexBufferObjects = GL_TRUE;
+
+	} /* End if */
+
+    } /* End if */
+
+    if( ( hasVertexBufferObjects == GL_TRUE) &&
+	( HasGLVersion( 2, 1) ||
+	  HasGLExtension( "GL_ARB_pixel_buffer_object"))
+    )
+    {
+	hasPixelBufferObjects = GL_TRUE;
+
+    } /* End if */
+
+    if( ( hasVertexBufferObjects == GL_TRUE) &&
+	( HasGLVersion( 4, 4) ||
+	  ( HasGLExtension( "GL_ARB_buffer_storage") &&
+	    HasGLExtension( "GL_ARB_map_buffer_range") &&
+	    HasGLExtension( "GL_ARB_sync")))
+    )
+    {
+	/* None of these have "ARB" suffixed names. */
+	pglBufferStorage = (GLBufferStorageProc )(
+	    GetGLProc( "glBufferStorage", NULL)
+	);
+	pglMapBufferRange = (GLMapBufferRangeProc )(
+	    GetGLProc( "glMapBufferRange", NULL)
+	);
+	pglFenceSync = (GLFenceSyncProc )( GetGLProc( "glFenceSync", NULL));
+	pglClientWaitSync = (GLClientWaitSyncProc )(
+	    GetGLProc( "glClientWaitSync", NULL)
+	);
+	pglDeleteSync = (GLDeleteSyncProc )(
+	    GetGLProc( "glDeleteSync", NULL)
+	);
+
+	if( ( pglBufferStorage != NULL) && ( pglMapBufferRange != NULL) &&
+	    ( pglFenceSync != NULL) && ( pglClientWaitSync != NULL) &&
+	    ( pglDeleteSync != NULL)
+	)
+	{
+	    hasPersistentBuffers = GL_TRUE;
+
+	} /* End if */
+
+    } /* End if */
+
+    hasS3TCTextures = GL_FALSE;
+
+    if( HasGLExtension( "GL_EXT_texture_compression_s3tc") &&
+	( HasGLVersion( 1, 3) || 
+	  HasGLExtension( "GL_ARB_texture_compression"))
+    )
+    {
+	pglCompressedTexImage2D = (GLCompressedTexImage2DProc )(
+	    GetGLProc( "glCompressedTexImage2D", "glCompressedTexImage2DARB")
+	);
+
+	if( pglCompressedTexImage2D != NULL)
+	{
+	    hasS3TCTextures = GL_TRUE;
+
+	} /* End if */
+
+    } /* End if */
+
+    hasDebugOutput = GL_FALSE;
+
+    if( HasGLVersion( 4, 3) || HasGLExtension( "GL_KHR_debug") ||
+	HasGLExtension( "GL_ARB_debug_output")
+    )
+    {
+	pglDebugMessageCallback = (GLDebugMessageCallbackProc )(
+	    GetGLProc( "glDebugMessageCallback", "glDebugMessageCallbackARB")
+	);
+	pglDebugMessageControl = (GLDebugMessageControlProc )(
+	    GetGLProc( "glDebugMessageControl", "glDebugMessageControlARB")
+	);
+
+	if( ( pglDebugMessageCallback != NULL) && 
+	    ( pglDebugMessageControl != NULL)
+	)
+	{
+	    hasDebugOutput = GL_TRUE;
+
+	} /* End if */
+
+    } /* End if */
+
+#ifdef VTAJ_DEBUG
+    printf(
+	"GLUTIL: OpenGL %s (BGRA pixels: %s, vertex buffer objects: %s, "
+	"pixel buffer objects: %s, persistent buffers: %s, "
+	"debug output: %s, texture LOD: %s, S3TC textures: %s)\n",
+	(const char *)( glGetString( GL_VERSION)),
+	( ( hasBGRAPixels == GL_TRUE) ? "yes" : "no"),
+	( ( hasVertexBufferObjects == GL_TRUE) ? "yes" : "no"),
+	( ( hasPixelBufferObjects == GL_TRUE) ? "yes" : "no"),
+	( ( hasPersistentBuffers == GL_TRUE) ? "yes" : "no"),
+	( ( hasDebugOutput == GL_TRUE) ? "yes" : "no"),
+	( ( hasTextureLOD == GL_TRUE) ? "yes" : "no"),
+	( ( hasS3TCTextures == GL_TRUE) ? "yes" : "no")
+    );
+    fflush( stdout);
+#endif
+
+} /* End function InitGLExtensions */
+
+
+GLboolean HasGLExtension( const char *extName)
+{
+    const char *allExts = (const char *)( glGetString( GL_EXTENSIONS));
+    const char *aPtr;
+    size_t nameLen = strlen( extName);
+
+    if( ( allExts == NULL) || ( nameLen == 0U))
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    /* The name must match a complete, space-delimited word - some
+     * extension names are prefixes of others.
+     */
+    aPtr = allExts;
+    while( ( aPtr = strstr( aPtr, extName)) != NULL)
+    {
+	if( ( ( aPtr == allExts) || ( *( aPtr - 1) == ' ')) &&
+	    ( ( aPtr[nameLen] == ' ') || ( aPtr[nameLen] == '\0'))
+	)
+	{
+	    return GL_TRUE;
+
+	} /* End if */
+
+	aPtr += nameLen;
+
+    } /* End while */
+
+    return GL_FALSE;
+
+} /* End function HasGLExtension */
+
+
+GLboolean HasGLVersion( int major, int minor)
+{
+    const char *verStr = (const char *)( glGetString( GL_VERSION));
+    int glMajor = 0, glMinor = 0;
+
+    if( ( verStr == NULL) ||
+	( sscanf( verStr, "%d.%d", &glMajor, &glMinor) != 2)
+    )
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    return ( ( glMajor > major) ||
+	( ( glMajor == major) && ( glMinor >= minor))
+    ) ? GL_TRUE : GL_FALSE;
+
+} /* End function HasGLVersion */
+
+
+/**
+ * Looks up an OpenGL entry point, first by its core name and then,
+ * failing that, by the name it has in the corresponding ARB extension.
+ */
+void *GetGLProc( const char *coreName, const char *arbName)
+{
+    void *retVal = SDL_GL_GetProcAddress( coreName);
+
+    if( ( retVal == NULL) && ( arbName != NULL))
+    {
+	retVal = SDL_GL_GetProcAddress( arbName);
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function GetGLProc */
+
+
@@ -0,0 +1,281 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * GLUTIL.H: Declarations for OpenGL helpers shared across the demo -
+ * error checking and access to the few OpenGL extensions we use.
+ */
+
+#ifndef _GLUTIL_H
+#define _GLUTIL_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include <stddef.h>
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+
+/* Handy macro for checking OpenGL errors. Each check is a round trip
+ * to the driver, so the checks can be turned off (see "gldebug.h")
+ * where they would slow down rendering.
+ */
+#ifdef VTAJ_DEBUG
+    #define CHECK_GL_ERROR \
+	{ \
+	    GLenum glErr; \
+	    if( ( checkEachGLCall == GL_TRUE) && \
+		( ( glErr = glGetError( )) != GL_NO_ERROR) \
+	    ) \
+	    { \
+		fprintf( stderr, \
+		    "\nOpenGL ERROR around line %d: %s\n", \
+		    __LINE__, \
+		    gluErrorString( glErr)); \
+	    } \
+	}
+#else
+    #define CHECK_GL_ERROR
+#endif
+
+
+/* Calling convention for OpenGL entry points */
+#ifndef APIENTRY
+    #define APIENTRY
+#endif
+
+
+/* Tokens from OpenGL 1.2+ and extensions that "gl.h" might not define */
+
+#ifndef GL_BGRA
+    #define GL_BGRA 0x80E1
+#endif
+
+#ifndef GL_PIXEL_PACK_BUFFER
+    #define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+
+#ifndef GL_STREAM_READ
+    #define GL_STREAM_READ 0x88E1
+#endif
+
+#ifndef GL_READ_ONLY
+    #define GL_READ_ONLY 0x88B8
+#endif
+
+#ifndef GL_ELEMENT_ARRAY_BUFFER
+    #define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#endif
+
+#ifndef GL_STREAM_DRAW
+    #define GL_STREAM_DRAW 0x88E0
+#endif
+
+#ifndef GL_WRITE_ONLY
+    #define GL_WRITE_ONLY 0x88B9
+#endif
+
+#ifndef GL_MAP_WRITE_BIT
+    #define GL_MAP_WRITE_BIT 0x0002
+#endif
+
+#ifndef GL_MAP_PERSISTENT_BIT
+    #define GL_MAP_PERSISTENT_BIT 0x0040
+    #define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+    #define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+    #define GL_ALREADY_SIGNALED 0x911A
+    #define GL_TIMEOUT_EXPIRED 0x911B
+    #define GL_CONDITION_SATISFIED 0x911C
+    #define GL_WAIT_FAILED 0x911D
+    #define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+
+#ifndef GL_TEXTURE_BASE_LEVEL
+    #define GL_TEXTURE_BASE_LEVEL 0x813C
+    #define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+
+#ifndef GL_DEBUG_OUTPUT
+    #define GL_DEBUG_OUTPUT 0x92E0
+#endif
+
+#ifndef GL_DEBUG_SEVERITY_HIGH
+    #define GL_DEBUG_SEVERITY_HIGH 0x9146
+    #define GL_DEBUG_SEVERITY_MEDIUM 0x9147
+    #define GL_DEBUG_SEVERITY_LOW 0x9148
+#endif
+
+#ifndef GL_DEBUG_SEVERITY_NOTIFICATION
+    #define GL_DEBUG_SEVERITY_NOTIFICATION 0x826B
+#endif
+
+#ifndef GL_DEBUG_TYPE_ERROR
+    #define GL_DEBUG_TYPE_ERROR 0x824C
+    #define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR 0x824D
+    #define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR 0x824E
+    #define GL_DEBUG_TYPE_PORTABILITY 0x824F
+    #define GL_DEBUG_TYPE_PERFORMANCE 0x8250
+    #define GL_DEBUG_TYPE_OTHER 0x8251
+#endif
+
+
+/* Types of the extension entry points we look up at run time.
+ * (The 'ptrdiff_t' arguments are 'GLsizeiptr' and 'GLintptr', and
+ * the 'void *' sync objects are 'GLsync'.)
+ */
+
+typedef void (APIENTRY *GLGenBuffersProc)( GLsizei n, GLuint *buffers);
+typedef void (APIENTRY *GLDeleteBuffersProc)(
+    GLsizei n, const GLuint *buffers
+);
+typedef void (APIENTRY *GLBindBufferProc)( GLenum target, GLuint buffer);
+typedef void (APIENTRY *GLBufferDataProc)(
+    GLenum target, ptrdiff_t size, const GLvoid *data, GLenum usage
+);
+typedef GLvoid *(APIENTRY *GLMapBufferProc)( GLenum target, GLenum access);
+typedef GLboolean (APIENTRY *GLUnmapBufferProc)( GLenum target);
+typedef void (APIENTRY *GLBufferStorageProc)(
+    GLenum target, ptrdiff_t size, const GLvoid *data, GLbitfield flags
+);
+typedef GLvoid *(APIENTRY *GLMapBufferRangeProc)(
+    GLenum target, ptrdiff_t offset, ptrdiff_t length, GLbitfield access
+);
+
+typedef void *(APIENTRY *GLFenceSyncProc)(
+    GLenum condition, GLbitfield flags
+);
+typedef GLenum (APIENTRY *GLClientWaitSyncProc)(
+    void *sync, GLbitfield flags, Uint64 timeout
+);
+typedef void (APIENTRY *GLDeleteSyncProc)( void *sync);
+
+typedef void (APIENTRY *GLCompressedTexImage2DProc)(
+    GLenum target, GLint level, GLenum internalFormat,
+    GLsizei width, GLsizei height, GLint border,
+    GLsizei imageSize, const GLvoid *data
+);
+
+typedef void (APIENTRY *GLDebugProc)(
+    GLenum source, GLenum type, GLuint id, GLenum severity,
+    GLsizei length, const char *message, const GLvoid *userParam
+);
+typedef void (APIENTRY *GLDebugMessageCallbackProc)(
+    GLDebugProc callback, const GLvoid *userParam
+);
+typedef void (APIENTRY *GLDebugMessageControlProc)(
+    GLenum source, GLenum type, GLenum severity,
+    GLsizei count, const GLuint *ids, GLboolean enabled
+);
+
+
+/* Global data */
+
+/* Can vertex data (and indices) be kept in buffer objects? (OpenGL
+ * 1.5 or better, or the "GL_ARB_vertex_buffer_object" extension.)
+ */
+extern GLboolean hasVertexBufferObjects;
+
+/* Does the OpenGL implementation support buffer objects as sources
+ * and destinations of pixel transfers? (OpenGL 2.1 or better, or
+ * the "GL_ARB_pixel_buffer_object" extension.)
+ */
+extern GLboolean hasPixelBufferObjects;
+
+/* Can we read back pixels in BGRA order? (OpenGL 1.2 or better, or
+ * the "GL_EXT_bgra" extension.)
+ */
+extern GLboolean hasBGRAPixels;
+
+/* Can a buffer object stay mapped while OpenGL reads from it, with
+ * fences to tell us when it is done? (OpenGL 4.4 or better, or the
+ * "GL_ARB_buffer_storage", "GL_ARB_map_buffer_range" and "GL_ARB_sync"
+ * extensions.)
+ */
+extern GLboolean hasPersistentBuffers;
+
+/* Can the OpenGL implementation report errors and other problems
+ * through a callback? (OpenGL 4.3 or better, or the "GL_KHR_debug"
+ * or "GL_ARB_debug_output" extensions.)
+ */
+extern GLboolean hasDebugOutput;
+
+/* Can the range of mipmap levels used by a texture be restricted?
+ * (OpenGL 1.2 or better, or the "GL_SGIS_texture_lod" extension.)
+ */
+extern GLboolean hasTextureLOD;
+
+/* Can textures be given to OpenGL already compressed in the S3TC
+ * formats? (The "GL_EXT_texture_compression_s3tc" extension, along
+ * with OpenGL 1.3 or the "GL_ARB_texture_compression" extension.)
+ */
+extern GLboolean hasS3TCTextures;
+
+/* Should CHECK_GL_ERROR call glGetError( )? */
+extern GLboolean checkEachGLCall;
+
+/* Buffer object entry points - valid only if 'hasVertexBufferObjects'
+ * is set.
+ */
+extern GLGenBuffersProc pglGenBuffers;
+extern GLDeleteBuffersProc pglDeleteBuffers;
+extern GLBindBufferProc pglBindBuffer;
+extern GLBufferDataProc pglBufferData;
+extern GLMapBufferProc pglMapBuffer;
+extern GLUnmapBufferProc pglUnmapBuffer;
+
+/* Persistent mapping and fence entry points - valid only if
+ * 'hasPersistentBuffers' is set.
+ */
+extern GLBufferStorageProc pglBufferStorage;
+extern GLMapBufferRangeProc pglMapBufferRange;
+extern GLFenceSyncProc pglFenceSync;
+extern GLClientWaitSyncProc pglClientWaitSync;
+extern GLDeleteSyncProc pglDeleteSync;
+
+/* Compressed texture entry point - valid only if 'hasS3TCTextures'
+ * is set.
+ */
+extern GLCompressedTexImage2DProc pglCompressedTexImage2D;
+
+/* Debug output entry points - valid only if 'hasDebugOutput' is set */
+extern GLDebugMessageCallbackProc pglDebugMessageCallback;
+extern GLDebugMessageControlProc pglDebugMessageControl;
+
+
+/* Function Prototypes */
+
+/**
+ * Finds out which of the OpenGL extensions we can use are supported
+ * by the current context and looks up their entry points. Must be
+ * called after an OpenGL context has been created.
+ */
+extern void InitGLExtensions( void);
+
+
+/**
+ * Returns GL_TRUE if the given extension is in the extensions string
+ * of the current OpenGL context.
+ */
+extern GLboolean HasGLExtension( const char *extName);
+
+
+/**
+ * Returns GL_TRUE if the current OpenGL context is at least the given
+ * version.
+ */
+extern GLboolean HasGLVersion( int major, int minor);
+
+#endif    /* _GLUTIL_H */
+
+
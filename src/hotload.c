@@ -0,0 +1,537 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * HOTLOAD.C: Reloading files as they change on disc.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hotload.h"
+
+/* Folders are watched with "inotify" where it is available */
+#if defined( __linux__)
+    #define HOTLOAD_USE_INOTIFY
+    #include <unistd.h>
+    #include <poll.h>
+    #include <sys/inotify.h>
+#endif
+
+
+/* Bytes of "inotify" events read at a time - enough for several
+ * events, each with its file name.
+ */
+#define HOTLOAD_EVENT_BUF_SIZE 4096
+
+
+/* Local function prototypes */
+
+static int LoaderMain( void *someData);
+static void NoteChangedFiles( HotLoader *hotLoader);
+static void ReloadSettledFiles( HotLoader *hotLoader);
+static void QueueResult(
+    HotLoader *hotLoader, Uint32 fileNum, void *loadedData
+);
+
+
+HotLoader *GenHotLoader( void)
+{
+    HotLoader *retVal;
+
+    /* NOTE: Uses calloc( ) to initialise the contents to 0 */
+    retVal = (HotLoader *)( calloc( 1, sizeof( HotLoader)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->notifyFd = -1;
+
+    return retVal;
+
+} /* End function GenHotLoader */
+
+
+void WatchHotFile(
+    HotLoader *hotLoader, const char *fileName,
+    HotLoadFn loadFn, HotFreeFn freeFn, void *fileData
+)
+{
+    HotFile *aFile;
+    const char *slashPtr;
+    size_t dirLen;
+    Uint32 i;
+
+    if( hotLoader->loaderThread != NULL)
+    {
+	return;
+
+    } /* End if */
+
+    hotLoader->files = (HotFile *)( realloc(
+	hotLoader->files, ( hotLoader->numFiles + 1U) * sizeof( HotFile)
+    ));
+    if( hotLoader->files == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    aFile = ( hotLoader->files + hotLoader->numFiles);
+
+    aFile->fileName = (char *)( malloc(
+	( strlen( fileName) + 1) * sizeof( char)
+    ));
+    if( aFile->fileName == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    strcpy( aFile->fileName, fileName);
+
+    aFile->loadFn = loadFn;
+    aFile->freeFn = freeFn;
+    aFile->fileData = fileData;
+    aFile->isChanged = GL_FALSE;
+    aFile->changeTime = 0U;
+
+
+    /* Find its folder ("." for none) among those already watched */
+    slashPtr = strrchr( aFile->fileName, '/');
+    if( slashPtr != NULL)
+    {
+	aFile->baseName = slashPtr + 1;
+	dirLen = (size_t )( slashPtr - aFile->fileName);
+
+    } /* End if */
+    else
+    {
+	aFile->baseName = aFile->fileName;
+	dirLen = 0U;
+
+    } /* End else */
+
+    for( i = 0U; i < hotLoader->numDirs; i++)
+    {
+	const char *dirName = hotLoader->dirNames[i];
+
+	if( ( dirLen == 0U) ?
+	    ( strcmp( dirName, ".") == 0) :
+	    ( ( strlen( dirName) == dirLen) &&
+	      ( strncmp( dirName, aFile->fileName, dirLen) == 0))
+	)
+	{
+	    break;
+
+	} /* End if */
+
+    } /* End for */
+
+    if( i == hotLoader->numDirs)
+    {
+	char *dirName;
+
+	hotLoader->dirNames = (char **)( realloc(
+	    hotLoader->dirNames, ( hotLoader->numDirs + 1U) * sizeof( char *)
+	));
+	dirName = (char *)( malloc( ( dirLen + 2U) * sizeof( char)));
+	if( ( hotLoader->dirNames == NULL) || ( dirName == NULL))
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	if( dirLen == 0U)
+	{
+	    strcpy( dirName, ".");
+
+	} /* End if */
+	else
+	{
+	    strncpy( dirName, aFile->fileName, dirLen);
+	    dirName[dirLen] = '\0';
+
+	} /* End else */
+
+	hotLoader->dirNames[hotLoader->numDirs++] = dirName;
+
+    } /* End if */
+
+    aFile->dirNum = i;
+
+    hotLoader->numFiles++;
+
+} /* End function WatchHotFile */
+
+
+GLboolean StartHotLoader( HotLoader *hotLoader)
+{
+#ifdef HOTLOAD_USE_INOTIFY
+    Uint32 i;
+
+    if( hotLoader->loaderThread != NULL)
+    {
+	return GL_TRUE;
+
+    } /* End if */
+
+    if( ( hotLoader->notifyFd = inotify_init( )) < 0)
+    {
+	fprintf( stderr, "\nERROR: Could not watch files for changes!\n");
+	return GL_FALSE;
+
+    } /* End if */
+
+    hotLoader->dirWatches = (int *)( malloc(
+	( hotLoader->numDirs + 1U) * sizeof( int)
+    ));
+    if( hotLoader->dirWatches == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    /* Files written in place are closed after being written to, files
+     * written elsewhere and renamed are moved in.
+     */
+    for( i = 0U; i < hotLoader->numDirs; i++)
+    {
+	hotLoader->dirWatches[i] = inotify_add_watch(
+	    hotLoader->notifyFd, hotLoader->dirNames[i],
+	    ( IN_CLOSE_WRITE | IN_MOVED_TO)
+	);
+
+	if( hotLoader->dirWatches[i] < 0)
+	{
+	    fprintf( stderr,
+		"\nWARNING: Could not watch folder \"%s\" for changes!\n",
+		hotLoader->dirNames[i]
+	    );
+
+	} /* End if */
+
+    } /* End for */
+
+    hotLoader->stopLoader = GL_FALSE;
+    hotLoader->resultLock = SDL_CreateMutex( );
+    if( hotLoader->resultLock == NULL)
+    {
+	fprintf( stderr, "\nERROR: Could not create mutex! (%s)\n",
+	    SDL_GetError( )
+	);
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    hotLoader->loaderThread = SDL_CreateThread( LoaderMain, hotLoader);
+    if( hotLoader->loaderThread == NULL)
+    {
+	fprintf( stderr, "\nERROR: Could not create loader thread! (%s)\n",
+	    SDL_GetError( )
+	);
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    return GL_TRUE;
+
+#else
+    (void )hotLoader;
+
+    fprintf( stderr,
+	"\nERROR: Watching files for changes is not supported here!\n"
+    );
+    return GL_FALSE;
+
+#endif
+
+} /* End function StartHotLoader */
+
+
+void *TakeHotLoad( HotLoader *hotLoader, void **fileData)
+{
+    void *retVal = NULL;
+
+    if( hotLoader->loaderThread == NULL)
+    {
+	return NULL;
+
+    } /* End if */
+
+    SDL_LockMutex( hotLoader->resultLock);
+
+    if( hotLoader->numResults > 0U)
+    {
+	HotResult *aResult = hotLoader->results;
+
+	retVal = aResult->loadedData;
+	*fileData = hotLoader->files[aResult->fileNum].fileData;
+
+	hotLoader->numResults--;
+	memmove(
+	    hotLoader->results, ( hotLoader->results + 1),
+	    hotLoader->numResults * sizeof( HotResult)
+	);
+
+    } /* End if */
+
+    SDL_UnlockMutex( hotLoader->resultLock);
+
+    return retVal;
+
+} /* End function TakeHotLoad */
+
+
+void FreeHotLoader( HotLoader *hotLoader)
+{
+    Uint32 i;
+
+    if( hotLoader == NULL)
+    {
+	return;
+
+    } /* End if */
+
+    if( hotLoader->loaderThread != NULL)
+    {
+	SDL_LockMutex( hotLoader->resultLock);
+	hotLoader->stopLoader = GL_TRUE;
+	SDL_UnlockMutex( hotLoader->resultLock);
+
+	SDL_WaitThread( hotLoader->loaderThread, NULL);
+	hotLoader->loaderThread = NULL;
+
+	SDL_DestroyMutex( hotLoader->resultLock);
+	hotLoader->resultLock = NULL;
+
+    } /* End if */
+
+#ifdef HOTLOAD_USE_INOTIFY
+    if( hotLoader->notifyFd >= 0)
+    {
+	/* Closing it removes the watches as well */
+	close( hotLoader->notifyFd);
+
+    } /* End if */
+#endif
+
+    for( i = 0U; i < hotLoader->numResults; i++)
+    {
+	HotResult *aResult = ( hotLoader->results + i);
+	HotFile *aFile = ( hotLoader->files + aResult->fileNum);
+
+	aFile->freeFn( aResult->loadedData, aFile->fileData);
+
+    } /* End for */
+
+    free( hotLoader->results);
+
+    for( i = 0U; i < hotLoader->numFiles; i++)
+    {
+	free( hotLoader->files[i].fileName);
+
+    } /* End for */
+
+    free( hotLoader->files);
+
+    for( i = 0U; i < hotLoader->numDirs; i++)
+    {
+	free( hotLoader->dirNames[i]);
+
+    } /* End for */
+
+    free( hotLoader->dirNames);
+    free( hotLoader->dirWatches);
+
+    free( hotLoader);
+
+} /* End function FreeHotLoader */
+
+
+/**
+ * The loop run by the loader thread, noting the files that change and
+ * reading them in again once they have settled, until it is stopped.
+ */
+int LoaderMain( void *someData)
+{
+    HotLoader *hotLoader = (HotLoader *)someData;
+
+    for( ; ; )
+    {
+	GLboolean stopLoader;
+
+	SDL_LockMutex( hotLoader->resultLock);
+	stopLoader = hotLoader->stopLoader;
+	SDL_UnlockMutex( hotLoader->resultLock);
+
+	if( stopLoader == GL_TRUE)
+	{
+	    break;
+
+	} /* End if */
+
+	NoteChangedFiles( hotLoader);
+	ReloadSettledFiles( hotLoader);
+
+    } /* End for */
+
+    return 0;
+
+} /* End function LoaderMain */
+
+
+/**
+ * Waits (for at most HOTLOAD_POLL_MS) for changes to the folders
+ * watched, and marks the files changed.
+ */
+void NoteChangedFiles( HotLoader *hotLoader)
+{
+#ifdef HOTLOAD_USE_INOTIFY
+    /* NOTE: Aligned for the "inotify_event" structures read into it */
+    union
+    {
+	struct inotify_event anEvent;
+	char eventBytes[HOTLOAD_EVENT_BUF_SIZE];
+
+    } eventBuf;
+    struct pollfd pollFd;
+    ssize_t numBytes, bytesDone;
+
+    pollFd.fd = hotLoader->notifyFd;
+    pollFd.events = POLLIN;
+    pollFd.revents = 0;
+
+    if( ( poll( &pollFd, 1, HOTLOAD_POLL_MS) <= 0) ||
+	( ( pollFd.revents & POLLIN) == 0)
+    )
+    {
+	return;
+
+    } /* End if */
+
+    numBytes = read(
+	hotLoader->notifyFd, eventBuf.eventBytes, sizeof( eventBuf)
+    );
+
+    for( bytesDone = 0; bytesDone < numBytes; )
+    {
+	struct inotify_event *anEvent =
+	    (struct inotify_event *)( eventBuf.eventBytes + bytesDone);
+	Uint32 i;
+
+	bytesDone += (ssize_t )( sizeof( struct inotify_event) + anEvent->len);
+
+	if( anEvent->len == 0U)
+	{
+	    continue;
+
+	} /* End if */
+
+	for( i = 0U; i < hotLoader->numFiles; i++)
+	{
+	    HotFile *aFile = ( hotLoader->files + i);
+
+	    if( ( hotLoader->dirWatches[aFile->dirNum] == anEvent->wd) &&
+		( strcmp( aFile->baseName, anEvent->name) == 0)
+	    )
+	    {
+		/* Wait for it to settle from now on */
+		aFile->isChanged = GL_TRUE;
+		aFile->changeTime = SDL_GetTicks( );
+
+	    } /* End if */
+
+	} /* End for */
+
+    } /* End for */
+
+#else
+    (void )hotLoader;
+
+#endif
+
+} /* End function NoteChangedFiles */
+
+
+/**
+ * Reads in again the changed files that have not changed for
+ * HOTLOAD_SETTLE_MS, and queues what was read in.
+ */
+void ReloadSettledFiles( HotLoader *hotLoader)
+{
+    Uint32 nowTime = SDL_GetTicks( );
+    Uint32 i;
+
+    for( i = 0U; i < hotLoader->numFiles; i++)
+    {
+	HotFile *aFile = ( hotLoader->files + i);
+	void *loadedData;
+
+	if( ( aFile->isChanged == GL_FALSE) ||
+	    ( ( nowTime - aFile->changeTime) < HOTLOAD_SETTLE_MS)
+	)
+	{
+	    continue;
+
+	} /* End if */
+
+	aFile->isChanged = GL_FALSE;
+
+	printf( "HOTLOAD: Reloading \"%s\"\n", aFile->fileName);
+	fflush( stdout);
+
+	loadedData = aFile->loadFn( aFile->fileName, aFile->fileData);
+	if( loadedData != NULL)
+	{
+	    QueueResult( hotLoader, i, loadedData);
+
+	} /* End if */
+
+    } /* End for */
+
+} /* End function ReloadSettledFiles */
+
+
+/**
+ * Queues what was read in for the given file, to be taken with
+ * TakeHotLoad( ).
+ */
+void QueueResult( HotLoader *hotLoader, Uint32 fileNum, void *loadedData)
+{
+    SDL_LockMutex( hotLoader->resultLock);
+
+    if( hotLoader->numResults == hotLoader->maxResults)
+    {
+	hotLoader->maxResults =
+	    ( hotLoader->maxResults > 0U) ? ( 2U * hotLoader->maxResults) : 8U;
+	hotLoader->results = (HotResult *)( realloc(
+	    hotLoader->results, hotLoader->maxResults * sizeof( HotResult)
+	));
+	if( hotLoader->results == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+    } /* End if */
+
+    hotLoader->results[hotLoader->numResults].fileNum = fileNum;
+    hotLoader->results[hotLoader->numResults].loadedData = loadedData;
+    hotLoader->numResults++;
+
+    SDL_UnlockMutex( hotLoader->resultLock);
+
+} /* End function QueueResult */
@@ -0,0 +1,153 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * HOTLOAD.H: Declarations for reloading files as they change on disc.
+ */
+
+/**
+ * A hot loader watches the folders of the files it is given for files
+ * being written to or moved into them (with "inotify", and so only on
+ * Linux). Once a file has not changed for HOTLOAD_SETTLE_MS - so that
+ * a file written out in bits by "make" is not read half-way through -
+ * the load function given with the file is run on the loader's own
+ * thread to read it in again. What it loads is queued, to be taken by
+ * the thread using it with TakeHotLoad( ) when it is ready to swap it
+ * in (for example, between frames).
+ *
+ * The load functions run on another thread, so they must not use
+ * OpenGL, nor anything else the thread taking their results uses
+ * without a lock.
+ */
+
+#ifndef _HOTLOAD_H
+#define _HOTLOAD_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+#include "SDL_thread.h"
+
+
+/* Milliseconds a file must stay unchanged before it is reloaded */
+#define HOTLOAD_SETTLE_MS 250U
+
+/* Milliseconds the loader waits for changes before looking again at
+ * the files waiting to settle (and whether it is to stop)
+ */
+#define HOTLOAD_POLL_MS 50
+
+
+/* Data type definitions */
+
+/* Reads in the given file again, returning what was read in (or NULL
+ * if it could not be read), 'fileData' being as given for the file.
+ */
+typedef void *(*HotLoadFn)( const char *fileName, void *fileData);
+
+/* Frees what was read in for a file but never taken */
+typedef void (*HotFreeFn)( void *loadedData, void *fileData);
+
+
+/* A file being watched */
+typedef struct _hot_file
+{
+    char *fileName;
+    const char *baseName;   /* Part of 'fileName' after its folder */
+    Uint32 dirNum;          /* Index of its folder in 'dirNames' */
+
+    HotLoadFn loadFn;
+    HotFreeFn freeFn;
+    void *fileData;
+
+    /* Has it changed since it was last read, and when did it last
+     * change?
+     */
+    GLboolean isChanged;
+    Uint32 changeTime;
+
+} HotFile;
+
+
+/* Something read in and not yet taken */
+typedef struct _hot_result
+{
+    Uint32 fileNum;
+    void *loadedData;
+
+} HotResult;
+
+
+/* A hot loader */
+typedef struct _hot_loader
+{
+    Uint32 numFiles;
+    HotFile *files;
+
+    /* The folders of the files, and their "inotify" watches */
+    Uint32 numDirs;
+    char **dirNames;
+    int *dirWatches;
+    int notifyFd;
+
+    SDL_Thread *loaderThread;
+    GLboolean stopLoader;
+
+    /* Queue of what has been read in, guarded by 'resultLock' (as is
+     * 'stopLoader')
+     */
+    SDL_mutex *resultLock;
+    Uint32 numResults;
+    Uint32 maxResults;
+    HotResult *results;
+
+} HotLoader;
+
+
+/* Function Prototypes */
+
+/**
+ * Creates a hot loader, watching no files yet.
+ */
+extern HotLoader *GenHotLoader( void);
+
+
+/**
+ * Adds the given file to those watched, to be read in again with
+ * 'loadFn' whenever it changes (and what was read in freed with
+ * 'freeFn' if it is never taken). Files can only be added before the
+ * loader is started. The same file can be added more than once (say,
+ * with different 'fileData'), to be read in again for each.
+ */
+extern void WatchHotFile(
+    HotLoader *hotLoader, const char *fileName,
+    HotLoadFn loadFn, HotFreeFn freeFn, void *fileData
+);
+
+
+/**
+ * Starts watching the files. Returns GL_FALSE if they can not be
+ * watched (on platforms without "inotify", for example).
+ */
+extern GLboolean StartHotLoader( HotLoader *hotLoader);
+
+
+/**
+ * Returns the oldest of what has been read in and not yet taken
+ * (setting 'fileData' to that given for its file), or NULL if there is
+ * nothing more to take. Never waits for the loader.
+ */
+extern void *TakeHotLoad( HotLoader *hotLoader, void **fileData);
+
+
+/**
+ * Stops watching the files, and frees the loader along with whatever
+ * it read in that was not taken.
+ */
+extern void FreeHotLoader( HotLoader *hotLoader);
+
+#endif    /* _HOTLOAD_H */
@@ -0,0 +1,293 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * IDXRING.C: A ring of vertex indices in a buffer object, written
+ * afresh each frame.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "glutil.h"
+#include "idxring.h"
+
+
+/* Nanoseconds to wait for a fence at a time */
+#define IDXRING_WAIT_TIMEOUT ( (Uint64 )1000000000UL)
+
+/* Flags for creating and mapping a persistently mapped buffer object */
+#define IDXRING_MAP_FLAGS \
+    ( GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT)
+
+
+/* Local function prototypes */
+
+static void WaitForRegion( IndexRing *idxRing, int regionNum);
+
+
+IndexRing *GenIndexRing( Uint32 regionSize)
+{
+    IndexRing *retVal;
+    ptrdiff_t bufSize;
+    int i;
+
+    if( ( hasVertexBufferObjects == GL_FALSE) || ( regionSize == 0U))
+    {
+	return NULL;
+
+    } /* End if */
+
+    retVal = (IndexRing *)( malloc( sizeof( IndexRing)));
+
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->regionSize = regionSize;
+    retVal->isPersistent = GL_FALSE;
+    retVal->mappedIndices = NULL;
+    retVal->currRegion = 0;
+    retVal->numFrames = retVal->numWaits = 0U;
+
+    for( i = 0; i < IDXRING_NUM_REGIONS; i++)
+    {
+	retVal->regionFences[i] = NULL;
+
+    } /* End for */
+
+    pglGenBuffers( 1, &( retVal->bufferId));
+
+    if( hasPersistentBuffers == GL_TRUE)
+    {
+	bufSize = (ptrdiff_t )(
+	    IDXRING_NUM_REGIONS * regionSize * sizeof( GLushort)
+	);
+
+	pglBindBuffer( GL_ELEMENT_ARRAY_BUFFER, retVal->bufferId);
+	pglBufferStorage(
+	    GL_ELEMENT_ARRAY_BUFFER, bufSize, NULL, IDXRING_MAP_FLAGS
+	);
+	retVal->mappedIndices = (GLushort *)(
+	    pglMapBufferRange(
+		GL_ELEMENT_ARRAY_BUFFER, 0, bufSize, IDXRING_MAP_FLAGS
+	    )
+	);
+	pglBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0U);
+	CHECK_GL_ERROR;
+
+	if( retVal->mappedIndices != NULL)
+	{
+	    retVal->isPersistent = GL_TRUE;
+
+	} /* End if */
+	else
+	{
+	    /* The storage of a buffer object can not be changed once
+	     * set by glBufferStorage( ), so start afresh.
+	     */
+	    pglDeleteBuffers( 1, &( retVal->bufferId));
+	    pglGenBuffers( 1, &( retVal->bufferId));
+
+	} /* End else */
+
+    } /* End if */
+
+#ifdef VTAJ_DEBUG
+    printf(
+	"IDXRING: %lu indices a frame, %s\n",
+	(unsigned long )regionSize,
+	( ( retVal->isPersistent == GL_TRUE) ?
+	    "persistently mapped" : "orphaned each frame")
+    );
+    fflush( stdout);
+#endif
+
+    return retVal;
+
+} /* End function GenIndexRing */
+
+
+GLushort *MapIndexRing( IndexRing *idxRing)
+{
+    GLushort *retVal;
+
+    pglBindBuffer( GL_ELEMENT_ARRAY_BUFFER, idxRing->bufferId);
+
+    if( idxRing->isPersistent == GL_TRUE)
+    {
+	idxRing->currRegion =
+	    ( idxRing->currRegion + 1) % IDXRING_NUM_REGIONS;
+
+	WaitForRegion( idxRing, idxRing->currRegion);
+
+	retVal = idxRing->mappedIndices +
+	    ( idxRing->currRegion * idxRing->regionSize);
+
+    } /* End if */
+    else
+    {
+	/* Orphan the storage still being read from for earlier frames */
+	pglBufferData(
+	    GL_ELEMENT_ARRAY_BUFFER,
+	    (ptrdiff_t )( idxRing->regionSize * sizeof( GLushort)),
+	    NULL, GL_STREAM_DRAW
+	);
+
+	retVal = (GLushort *)(
+	    pglMapBuffer( GL_ELEMENT_ARRAY_BUFFER, GL_WRITE_ONLY)
+	);
+
+	if( retVal == NULL)
+	{
+	    pglBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0U);
+
+	} /* End if */
+
+    } /* End else */
+    CHECK_GL_ERROR;
+
+    idxRing->numFrames++;
+
+    return retVal;
+
+} /* End function MapIndexRing */
+
+
+void UnmapIndexRing( IndexRing *idxRing)
+{
+    if( idxRing->isPersistent == GL_FALSE)
+    {
+	/* NOTE: If the contents were lost (say, on a change of screen
+	 * mode), this frame might draw some wrong triangles, but the
+	 * next frame writes them afresh anyway.
+	 */
+	pglUnmapBuffer( GL_ELEMENT_ARRAY_BUFFER);
+	CHECK_GL_ERROR;
+
+    } /* End if */
+
+} /* End function UnmapIndexRing */
+
+
+const GLvoid *GetIndexRingOffset( IndexRing *idxRing, Uint32 indexNum)
+{
+    Uint32 regionStart;
+
+    regionStart = ( idxRing->isPersistent == GL_TRUE) ?
+	( idxRing->currRegion * idxRing->regionSize) : 0U;
+
+    return (const GLvoid *)(
+	(const GLubyte *)NULL +
+	( regionStart + indexNum) * sizeof( GLushort)
+    );
+
+} /* End function GetIndexRingOffset */
+
+
+void RetireIndexRing( IndexRing *idxRing)
+{
+    if( idxRing->isPersistent == GL_TRUE)
+    {
+	idxRing->regionFences[idxRing->currRegion] =
+	    pglFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0U);
+
+    } /* End if */
+
+    pglBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0U);
+    CHECK_GL_ERROR;
+
+} /* End function RetireIndexRing */
+
+
+void FreeIndexRing( IndexRing *idxRing)
+{
+    int i;
+
+    if( idxRing == NULL)
+    {
+	return;
+
+    } /* End if */
+
+#ifdef VTAJ_DEBUG
+    printf(
+	"IDXRING: %lu frames, %lu waits for OpenGL\n",
+	(unsigned long )idxRing->numFrames,
+	(unsigned long )idxRing->numWaits
+    );
+    fflush( stdout);
+#endif
+
+    for( i = 0; i < IDXRING_NUM_REGIONS; i++)
+    {
+	if( idxRing->regionFences[i] != NULL)
+	{
+	    pglDeleteSync( idxRing->regionFences[i]);
+	    idxRing->regionFences[i] = NULL;
+
+	} /* End if */
+
+    } /* End for */
+
+    /* NOTE: Deleting a buffer object unmaps it as well. */
+    pglDeleteBuffers( 1, &( idxRing->bufferId));
+    CHECK_GL_ERROR;
+
+    free( idxRing);
+
+} /* End function FreeIndexRing */
+
+
+/**
+ * Waits till OpenGL has finished drawing from the given region, if it
+ * has been used before.
+ */
+void WaitForRegion( IndexRing *idxRing, int regionNum)
+{
+    void *aFence = idxRing->regionFences[regionNum];
+    GLenum waitResult;
+
+    if( aFence == NULL)
+    {
+	return;
+
+    } /* End if */
+
+    /* Flush the commands the first time around, lest we wait for a
+     * fence that OpenGL has not even been asked to signal.
+     */
+    waitResult = pglClientWaitSync(
+	aFence, GL_SYNC_FLUSH_COMMANDS_BIT, 0U
+    );
+
+    if( waitResult == GL_TIMEOUT_EXPIRED)
+    {
+	idxRing->numWaits++;
+
+	do
+	{
+	    waitResult = pglClientWaitSync(
+		aFence, 0U, IDXRING_WAIT_TIMEOUT
+	    );
+
+	} while( waitResult == GL_TIMEOUT_EXPIRED);
+
+    } /* End if */
+
+    if( waitResult == GL_WAIT_FAILED)
+    {
+	fprintf( stderr, "\nIDXRING: Unable to wait for a fence!\n");
+
+    } /* End if */
+
+    pglDeleteSync( aFence);
+    idxRing->regionFences[regionNum] = NULL;
+
+} /* End function WaitForRegion */
@@ -0,0 +1,116 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * IDXRING.H: Declarations for a ring of vertex indices in a buffer
+ * object, written afresh each frame.
+ */
+
+/**
+ * When the triangles to draw are worked out anew every frame (as when
+ * walking a BSP tree), the vertex indices handed to glDrawElements( )
+ * would normally be in system memory and OpenGL would have to copy
+ * them all before it could return. Instead, the indices can be written
+ * straight into a buffer object that OpenGL reads them from.
+ *
+ * With persistent mapping (see "glutil.h") the buffer object holds
+ * IDXRING_NUM_REGIONS regions, each large enough for a frame, and stays
+ * mapped all the while. A frame writes into the region after the one
+ * used by the previous frame, and a fence placed after its drawing
+ * tells a later frame when OpenGL is done with the region. Otherwise,
+ * the buffer object holds just one region, whose storage is orphaned
+ * (let go of) and mapped afresh every frame, leaving it to OpenGL to
+ * keep the old storage around for as long as it is still being read.
+ *
+ * Each frame:
+ *
+ *   1. MapIndexRing( ) gives the region to write the indices into.
+ *   2. UnmapIndexRing( ) must be called once they have been written.
+ *   3. The triangles are drawn with the buffer object bound, passing
+ *      GetIndexRingOffset( ) to glDrawElements( ) for the indices.
+ *   4. RetireIndexRing( ) must be called after the last of these.
+ */
+
+#ifndef _IDXRING_H
+#define _IDXRING_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+
+/* Frames that can be in flight at once with persistent mapping */
+#define IDXRING_NUM_REGIONS 3
+
+
+/* Data type definitions */
+
+typedef struct _index_ring
+{
+    GLuint bufferId;
+    Uint32 regionSize;    /* Indices in the region for a frame */
+
+    GLboolean isPersistent;
+    GLushort *mappedIndices;    /* All the regions, if persistent */
+
+    int currRegion;
+    void *regionFences[IDXRING_NUM_REGIONS];
+
+    /* Statistics */
+    Uint32 numFrames;
+    Uint32 numWaits;
+
+} IndexRing;
+
+
+/* Function Prototypes */
+
+/**
+ * Creates a ring with room for the given number of indices each frame,
+ * in the current OpenGL context. Returns NULL if buffer objects are not
+ * supported.
+ */
+extern IndexRing *GenIndexRing( Uint32 regionSize);
+
+
+/**
+ * Binds the buffer object and returns the region to write this frame's
+ * indices into, waiting for OpenGL to finish with it if needed. Returns
+ * NULL (with nothing bound) if the buffer object could not be mapped.
+ */
+extern GLushort *MapIndexRing( IndexRing *idxRing);
+
+
+/**
+ * Makes the indices written into this frame's region available to
+ * OpenGL. The buffer object is left bound.
+ */
+extern void UnmapIndexRing( IndexRing *idxRing);
+
+
+/**
+ * Returns the value to pass to glDrawElements( ) to draw from the
+ * given index onwards in this frame's region.
+ */
+extern const GLvoid *GetIndexRingOffset(
+    IndexRing *idxRing, Uint32 indexNum
+);
+
+
+/**
+ * Notes that all the drawing from this frame's region has been issued
+ * and unbinds the buffer object.
+ */
+extern void RetireIndexRing( IndexRing *idxRing);
+
+
+/**
+ * Deletes the buffer object and frees the ring.
+ */
+extern void FreeIndexRing( IndexRing *idxRing);
+
+#endif    /* _IDXRING_H */
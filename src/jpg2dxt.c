@@ -0,0 +1,138 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * JPG2DXT.C: JPEG image to compressed texture (DXT) converter.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "texload.h"
+#include "dxtc.h"
+
+
+/* Constants representing information about command-line args */
+
+#define NUM_REQ_ARGS 2
+
+#define PROG_NAME_ARG 0
+#define JPG_FILE_ARG 1
+#define OUTFILE_ARG 2
+
+
+/**
+ * Entry point into the JPG2DXT converter program. Takes in the JPEG
+ * image and output file names (in that order).
+ *
+ * The image is given the same alpha channel as when it is loaded as
+ * a texture, and must have a width and height that are powers of 2.
+ */
+int main( int argc, char *argv[])
+{
+    Uint8 *rgbaPixels;
+    int width, height;
+    DXTImage *dxtImage = NULL;
+    FILE *outFile, *inFile;
+
+
+    /* Check command-line arguments */
+    if( argc != ( NUM_REQ_ARGS + 1))
+    {
+	fprintf( stderr, 
+	    "JPG2DXT: Generate a compressed (DXT1) texture from a JPEG image\n"
+	);
+	fprintf( stderr, 
+	    "Usage: %s <jpgfile> <outfile>\n", 
+	    argv[PROG_NAME_ARG]
+	);
+
+	return EXIT_FAILURE;
+
+    } /* End if */
+
+
+    /* Read in the image */
+    rgbaPixels = LoadJPGImage( argv[JPG_FILE_ARG], 1, &width, &height);
+    if( rgbaPixels == NULL)
+    {
+	fprintf( stderr, 
+	    "\nERROR: Unable to read in JPEG image from \"%s\"!\n",
+	    argv[JPG_FILE_ARG]
+	);
+	return EXIT_FAILURE;
+
+    } /* End if */
+
+    if( ( width > 0xFFFF) || ( height > 0xFFFF) ||
+	( ( width & ( width - 1)) != 0) || ( ( height & ( height - 1)) != 0)
+    )
+    {
+	fprintf( stderr, 
+	    "\nERROR: Size of \"%s\" (%dx%d) is not a power of 2!\n",
+	    argv[JPG_FILE_ARG], width, height
+	);
+	return EXIT_FAILURE;
+
+    } /* End if */
+
+
+    /* Compress it, along with its mipmaps */
+    dxtImage = GenDXTImage( rgbaPixels, width, height);
+    free( rgbaPixels);
+
+
+    /* Now write out the compressed image to the given file */
+    outFile = fopen( argv[OUTFILE_ARG], "wb");
+
+    if( outFile == NULL)
+    {
+	fprintf( stderr,
+	    "\nERROR: Unable to open file \"%s\" for writing!\n",
+	    argv[OUTFILE_ARG]
+	);
+	return EXIT_FAILURE;
+
+    } /* End if */
+
+    SaveDXTImage( dxtImage, outFile);
+
+    /* Just to be sure */
+    fflush( outFile);
+    fclose( outFile);
+
+    printf( "JPG2DXT: \"%s\" (%dx%d, %d levels) saved to \"%s\"\n", 
+	argv[JPG_FILE_ARG], width, height, (int )dxtImage->numLevels,
+	argv[OUTFILE_ARG]
+    );
+    fflush( stdout);
+
+    FreeDXTImage( dxtImage);
+
+
+    /* Verify that the image was properly written out */
+    inFile = fopen( argv[OUTFILE_ARG], "rb");
+    dxtImage = ( inFile != NULL) ? LoadDXTImage( inFile) : NULL;
+
+    if( inFile != NULL)
+    {
+	fclose( inFile);
+
+    } /* End if */
+
+    if( dxtImage == NULL)
+    {
+	fprintf( stderr, "\nERROR: Could not read back saved DXT image!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    FreeDXTImage( dxtImage);
+
+
+    return EXIT_SUCCESS;
+
+} /* End function main */
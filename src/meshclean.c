@@ -0,0 +1,1434 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * MESHCLEAN.C: Welding vertices, dropping degenerate triangles and
+ * merging coplanar triangles into polygons.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "gld.h"
+#include "meshclean.h"
+
+
+/* The texture coordinates of each vertex of a region must be within
+ * this of those given by the mapping of the region (an eighth of a
+ * texel of a 256x256 texture map), so that the merged polygon looks
+ * the same as the triangles it replaces.
+ */
+#define MESHCLEAN_TEX_EPSILON ( GLD_TEX_ORD_EPSILON / 8.0)
+
+/* Stands for "no triangle", "no region" or "no vertex" */
+#define MESHCLEAN_NONE 0xFFFFFFFFU
+
+
+/* Data types used locally */
+
+/* Something to be sorted by a key */
+typedef struct _sort_item
+{
+    double key;
+    Uint32 itemNum;
+
+} SortItem;
+
+
+/* A triangle being cleaned up */
+typedef struct _clean_tri
+{
+    Uint32 verts[3];        /* Welded vertices */
+    double normal[3];       /* Unit normal */
+    double area;
+    Uint32 regionNum;       /* MESHCLEAN_NONE if not yet in a region */
+    GLboolean isLive;       /* GL_FALSE if it is degenerate */
+
+} CleanTri;
+
+
+/* A region of adjacent triangles in the same plane, with texture
+ * coordinates given by the same linear mapping
+ */
+typedef struct _clean_region
+{
+    /* Its triangles in 'regionTris' of the MeshCleaner */
+    Uint32 firstTri;
+    Uint32 numTri;
+
+    Uint16 texIndex;
+
+    /* A point on its plane, the texture coordinates there and their
+     * gradients along the plane
+     */
+    double origin[3];
+    double normal[3];
+    double texCoords[2];
+    double uGrad[3], vGrad[3];
+
+    /* Whether it has been replaced by a polygon yet, or left alone */
+    GLboolean isTried;
+    GLboolean isMerged;
+
+} CleanRegion;
+
+
+/* Everything needed while cleaning up a set of triangles */
+typedef struct _mesh_cleaner
+{
+    Uint32 nTri;
+    CleanTri *tris;
+    const GLfloat *triTexCoords;
+    const Uint16 *texIndices;
+
+    Uint32 nVerts;
+    double *verts;
+
+    /* The live triangles using vertex 'i' are 'vertTris[j]' for
+     * 'vertTriStart[i]' <= j < 'vertTriStart[i + 1]'.
+     */
+    Uint32 *vertTriStart;
+    Uint32 *vertTris;
+
+    Uint32 numRegions;
+    CleanRegion *regions;
+    Uint32 *regionTris;
+
+    /* Scratch space for merging a region (the per-vertex arrays are
+     * valid only for vertices whose 'vertStamp' is the number of the
+     * region plus one).
+     */
+    Uint32 *vertStamp;
+    Uint32 *nextVert;
+    double *vertTexCoords;
+    Uint32 *loopVerts;
+    Uint32 *polyVerts;
+    Uint32 *polyPrev;
+    Uint32 *polyNext;
+    Uint32 *newTris;
+
+} MeshCleaner;
+
+
+/* Local function prototypes */
+
+static int CompareSortItems( const void *item1, const void *item2);
+static void WeldVerts( MeshCleaner *aCleaner, const GLfloat *triVerts);
+static void SetTriGeometry( MeshCleaner *aCleaner, CleanTri *aTri);
+static void FindVertTris( MeshCleaner *aCleaner);
+static void GrowRegions( MeshCleaner *aCleaner);
+static void SetRegionMapping(
+    MeshCleaner *aCleaner, CleanRegion *aRegion, Uint32 triNum
+);
+static GLboolean FitsRegion(
+    const MeshCleaner *aCleaner, const CleanRegion *aRegion, Uint32 triNum
+);
+static GLboolean HasEdge(
+    const CleanTri *aTri, Uint32 fromVert, Uint32 toVert
+);
+static GLboolean HasRegionEdge(
+    const MeshCleaner *aCleaner, Uint32 regionNum,
+    Uint32 fromVert, Uint32 toVert
+);
+static GLboolean IsRemovable(
+    const MeshCleaner *aCleaner, Uint32 regionNum, Uint32 vertNum
+);
+static GLboolean IsOnSegment(
+    const double *aPoint, const double *segStart, const double *segEnd
+);
+static double Orient(
+    const double *v0, const double *v1, const double *v2,
+    const double normal[3]
+);
+static double EdgeLen( const double *v0, const double *v1);
+static Uint32 MergeRegion(
+    MeshCleaner *aCleaner, Uint32 regionNum,
+    GLfloat *outVerts, GLfloat *outTexCoords, Uint16 *outTexIndices
+);
+static Uint32 SimplifyLoop(
+    const MeshCleaner *aCleaner, Uint32 regionNum, Uint32 loopLen
+);
+static GLboolean ClipEars(
+    MeshCleaner *aCleaner, const double normal[3], Uint32 polyLen
+);
+static double GetEarQuality(
+    const MeshCleaner *aCleaner, const double normal[3], Uint32 earPos
+);
+
+
+Uint32 CleanUpMesh(
+    Uint32 nTri, GLfloat *triVerts, Uint16 *texIndices, GLfloat *triTexCoords
+)
+{
+    MeshCleaner aCleaner;
+    GLfloat *outVerts, *outTexCoords;
+    Uint16 *outTexIndices;
+    Uint32 numOut = 0U;
+    Uint32 maxLoop = 3U * MESHCLEAN_MAX_REGION_TRI;
+    Uint32 i, j;
+    int m;
+
+#ifdef GLD_DEBUG
+    Uint32 numDropped = 0U;
+    Uint32 numMerged = 0U, numMergedTri = 0U, numNewTri = 0U;
+#endif
+
+    if( nTri == 0U)
+    {
+	return 0U;
+
+    } /* End if */
+
+    aCleaner.nTri = nTri;
+    aCleaner.triTexCoords = triTexCoords;
+    aCleaner.texIndices = texIndices;
+
+    aCleaner.tris = (CleanTri *)( malloc( nTri * sizeof( CleanTri)));
+    aCleaner.verts = (double *)( malloc( 3U * 3U * nTri * sizeof( double)));
+    aCleaner.regions =
+	(CleanRegion *)( malloc( nTri * sizeof( CleanRegion)));
+    aCleaner.regionTris = (Uint32 *)( malloc( nTri * sizeof( Uint32)));
+
+    aCleaner.loopVerts = (Uint32 *)( malloc( maxLoop * sizeof( Uint32)));
+    aCleaner.polyVerts = (Uint32 *)( malloc( maxLoop * sizeof( Uint32)));
+    aCleaner.polyPrev = (Uint32 *)( malloc( maxLoop * sizeof( Uint32)));
+    aCleaner.polyNext = (Uint32 *)( malloc( maxLoop * sizeof( Uint32)));
+    aCleaner.newTris = (Uint32 *)( malloc( 3U * maxLoop * sizeof( Uint32)));
+
+    outVerts = (GLfloat *)( malloc( 3U * 3U * nTri * sizeof( GLfloat)));
+    outTexCoords = (GLfloat *)( malloc( 3U * 2U * nTri * sizeof( GLfloat)));
+    outTexIndices = (Uint16 *)( malloc( nTri * sizeof( Uint16)));
+
+    if( ( aCleaner.tris == NULL) || ( aCleaner.verts == NULL) ||
+	( aCleaner.regions == NULL) || ( aCleaner.regionTris == NULL) ||
+	( aCleaner.loopVerts == NULL) || ( aCleaner.polyVerts == NULL) ||
+	( aCleaner.polyPrev == NULL) || ( aCleaner.polyNext == NULL) ||
+	( aCleaner.newTris == NULL) || ( outVerts == NULL) ||
+	( outTexCoords == NULL) || ( outTexIndices == NULL)
+    )
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+
+    /* Weld the vertices and weed out the degenerate triangles */
+    WeldVerts( &aCleaner, triVerts);
+
+    for( i = 0U; i < nTri; i++)
+    {
+	SetTriGeometry( &aCleaner, ( aCleaner.tris + i));
+
+#ifdef GLD_DEBUG
+	numDropped += ( aCleaner.tris[i].isLive == GL_FALSE) ? 1U : 0U;
+#endif
+
+    } /* End for */
+
+    aCleaner.vertStamp =
+	(Uint32 *)( calloc( aCleaner.nVerts, sizeof( Uint32)));
+    aCleaner.nextVert =
+	(Uint32 *)( malloc( aCleaner.nVerts * sizeof( Uint32)));
+    aCleaner.vertTexCoords =
+	(double *)( malloc( 2U * aCleaner.nVerts * sizeof( double)));
+
+    if( ( aCleaner.vertStamp == NULL) || ( aCleaner.nextVert == NULL) ||
+	( aCleaner.vertTexCoords == NULL)
+    )
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    FindVertTris( &aCleaner);
+
+
+    /* Group the triangles into regions */
+    GrowRegions( &aCleaner);
+
+
+    /* Put out the triangles, merging each region when we come across
+     * its first triangle.
+     */
+    for( i = 0U; i < nTri; i++)
+    {
+	CleanTri *aTri = ( aCleaner.tris + i);
+	CleanRegion *aRegion;
+
+	if( aTri->isLive == GL_FALSE)
+	{
+	    continue;
+
+	} /* End if */
+
+	aRegion = ( aCleaner.regions + aTri->regionNum);
+
+	if( ( aRegion->numTri > 1U) && ( aRegion->isTried == GL_FALSE))
+	{
+	    Uint32 numNew = MergeRegion(
+		&aCleaner, aTri->regionNum,
+		( outVerts + 9U*numOut), ( outTexCoords + 6U*numOut),
+		( outTexIndices + numOut)
+	    );
+
+	    aRegion->isTried = GL_TRUE;
+
+	    if( numNew > 0U)
+	    {
+		aRegion->isMerged = GL_TRUE;
+		numOut += numNew;
+
+#ifdef GLD_DEBUG
+		numMerged++;
+		numMergedTri += aRegion->numTri;
+		numNewTri += numNew;
+#endif
+
+	    } /* End if */
+
+	} /* End if */
+
+	if( aRegion->isMerged == GL_FALSE)
+	{
+	    /* Keep the triangle as it is, but with welded vertices */
+	    for( j = 0U; j < 3U; j++)
+	    {
+		const double *aVert = ( aCleaner.verts + 3U*aTri->verts[j]);
+
+		for( m = 0; m < 3; m++)
+		{
+		    outVerts[9U*numOut + 3U*j + m] = (GLfloat )aVert[m];
+
+		} /* End for */
+
+		outTexCoords[6U*numOut + 2U*j + 0U] =
+		    triTexCoords[6U*i + 2U*j];
+		outTexCoords[6U*numOut + 2U*j + 1U] =
+		    triTexCoords[6U*i + 2U*j + 1U];
+
+	    } /* End for */
+
+	    outTexIndices[numOut] = texIndices[i];
+	    numOut++;
+
+	} /* End if */
+
+    } /* End for */
+
+    memcpy( triVerts, outVerts, 9U * numOut * sizeof( GLfloat));
+    memcpy( triTexCoords, outTexCoords, 6U * numOut * sizeof( GLfloat));
+    memcpy( texIndices, outTexIndices, numOut * sizeof( Uint16));
+
+#ifdef GLD_DEBUG
+    printf(
+	"MESHCLEAN: %u vertices after welding, %u degenerate triangles "
+	"dropped\n", aCleaner.nVerts, numDropped
+    );
+    printf(
+	"MESHCLEAN: %u regions of %u triangles merged into %u triangles\n",
+	numMerged, numMergedTri, numNewTri
+    );
+    fflush( stdout);
+#endif
+
+
+    free( outVerts);
+    free( outTexCoords);
+    free( outTexIndices);
+
+    free( aCleaner.tris);
+    free( aCleaner.verts);
+    free( aCleaner.vertTriStart);
+    free( aCleaner.vertTris);
+    free( aCleaner.regions);
+    free( aCleaner.regionTris);
+    free( aCleaner.vertStamp);
+    free( aCleaner.nextVert);
+    free( aCleaner.vertTexCoords);
+    free( aCleaner.loopVerts);
+    free( aCleaner.polyVerts);
+    free( aCleaner.polyPrev);
+    free( aCleaner.polyNext);
+    free( aCleaner.newTris);
+
+    return numOut;
+
+} /* End function CleanUpMesh */
+
+
+/**
+ * Compares the given SortItems by their keys, for qsort( ).
+ */
+int CompareSortItems( const void *item1, const void *item2)
+{
+    const SortItem *aItem = (const SortItem *)item1;
+    const SortItem *bItem = (const SortItem *)item2;
+
+    if( aItem->key != bItem->key)
+    {
+	return ( aItem->key < bItem->key) ? -1 : 1;
+
+    } /* End if */
+
+    /* Keep the sort stable, so that the results do not depend on the
+     * C library.
+     */
+    return ( aItem->itemNum < bItem->itemNum) ? -1 :
+	( ( aItem->itemNum > bItem->itemNum) ? 1 : 0);
+
+} /* End function CompareSortItems */
+
+
+/**
+ * Finds the distinct vertices of the triangles, taking vertices within
+ * GLD_VERT_ORD_EPSILON of each other in each ordinate to be the same
+ * (the first of them found, sorting them along the X axis).
+ */
+void WeldVerts( MeshCleaner *aCleaner, const GLfloat *triVerts)
+{
+    Uint32 numCorners = 3U * aCleaner->nTri;
+    SortItem *corners;
+    Uint32 i, j;
+
+    corners = (SortItem *)( malloc( numCorners * sizeof( SortItem)));
+    if( corners == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( i = 0U; i < numCorners; i++)
+    {
+	corners[i].key = triVerts[3U*i];
+	corners[i].itemNum = i;
+
+    } /* End for */
+
+    qsort( corners, numCorners, sizeof( SortItem), CompareSortItems);
+
+    aCleaner->nVerts = 0U;
+
+    for( i = 0U; i < numCorners; i++)
+    {
+	Uint32 cornerNum = corners[i].itemNum;
+	const GLfloat *aVert = ( triVerts + 3U*cornerNum);
+	Uint32 vertNum = MESHCLEAN_NONE;
+
+	/* Look for an earlier vertex close enough to this one */
+	for( j = i;
+	    ( j > 0U) &&
+	    ( ( corners[i].key - corners[j - 1U].key) <= GLD_VERT_ORD_EPSILON);
+	    j--
+	)
+	{
+	    Uint32 otherNum = corners[j - 1U].itemNum;
+	    const GLfloat *otherVert = ( triVerts + 3U*otherNum);
+
+	    if( ( fabs( aVert[1] - otherVert[1]) <= GLD_VERT_ORD_EPSILON) &&
+		( fabs( aVert[2] - otherVert[2]) <= GLD_VERT_ORD_EPSILON)
+	    )
+	    {
+		vertNum = aCleaner->tris[otherNum / 3U].verts[otherNum % 3U];
+		break;
+
+	    } /* End if */
+
+	} /* End for */
+
+	if( vertNum == MESHCLEAN_NONE)
+	{
+	    vertNum = aCleaner->nVerts;
+	    aCleaner->verts[3U*vertNum + 0U] = aVert[0];
+	    aCleaner->verts[3U*vertNum + 1U] = aVert[1];
+	    aCleaner->verts[3U*vertNum + 2U] = aVert[2];
+
+	    aCleaner->nVerts++;
+
+	} /* End if */
+
+	aCleaner->tris[cornerNum / 3U].verts[cornerNum % 3U] = vertNum;
+
+    } /* End for */
+
+    free( corners);
+
+} /* End function WeldVerts */
+
+
+/**
+ * Works out the normal and the area of the given triangle, and marks
+ * it as degenerate if two of its vertices are the same or if it is no
+ * wider than GLD_VERT_ORD_EPSILON.
+ */
+void SetTriGeometry( MeshCleaner *aCleaner, CleanTri *aTri)
+{
+    const double *v0 = ( aCleaner->verts + 3U*aTri->verts[0]);
+    const double *v1 = ( aCleaner->verts + 3U*aTri->verts[1]);
+    const double *v2 = ( aCleaner->verts + 3U*aTri->verts[2]);
+    double edge1[3], edge2[3], crossLen, maxEdge;
+    int m;
+
+    aTri->regionNum = MESHCLEAN_NONE;
+    aTri->isLive = GL_FALSE;
+    aTri->area = 0.0;
+
+    if( ( aTri->verts[0] == aTri->verts[1]) ||
+	( aTri->verts[1] == aTri->verts[2]) ||
+	( aTri->verts[2] == aTri->verts[0])
+    )
+    {
+	return;
+
+    } /* End if */
+
+    for( m = 0; m < 3; m++)
+    {
+	edge1[m] = v1[m] - v0[m];
+	edge2[m] = v2[m] - v0[m];
+
+    } /* End for */
+
+    aTri->normal[0] = edge1[1]*edge2[2] - edge1[2]*edge2[1];
+    aTri->normal[1] = edge1[2]*edge2[0] - edge1[0]*edge2[2];
+    aTri->normal[2] = edge1[0]*edge2[1] - edge1[1]*edge2[0];
+
+    crossLen = sqrt(
+	aTri->normal[0]*aTri->normal[0] +
+	aTri->normal[1]*aTri->normal[1] +
+	aTri->normal[2]*aTri->normal[2]
+    );
+
+    /* Its height over its longest edge is twice its area divided by
+     * the length of that edge.
+     */
+    maxEdge = EdgeLen( v0, v1);
+    maxEdge = ( EdgeLen( v1, v2) > maxEdge) ? EdgeLen( v1, v2) : maxEdge;
+    maxEdge = ( EdgeLen( v2, v0) > maxEdge) ? EdgeLen( v2, v0) : maxEdge;
+
+    if( crossLen <= ( GLD_VERT_ORD_EPSILON * maxEdge))
+    {
+	return;
+
+    } /* End if */
+
+    for( m = 0; m < 3; m++)
+    {
+	aTri->normal[m] /= crossLen;
+
+    } /* End for */
+
+    aTri->area = 0.5 * crossLen;
+    aTri->isLive = GL_TRUE;
+
+} /* End function SetTriGeometry */
+
+
+/**
+ * Finds the live triangles using each vertex.
+ */
+void FindVertTris( MeshCleaner *aCleaner)
+{
+    Uint32 numUses = 0U;
+    Uint32 i, j;
+
+    aCleaner->vertTriStart =
+	(Uint32 *)( calloc( aCleaner->nVerts + 1U, sizeof( Uint32)));
+    aCleaner->vertTris =
+	(Uint32 *)( malloc( ( 3U * aCleaner->nTri + 1U) * sizeof( Uint32)));
+
+    if( ( aCleaner->vertTriStart == NULL) || ( aCleaner->vertTris == NULL))
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    /* Count them first, then work out where each vertex's list ends,
+     * and fill the lists in from their ends.
+     */
+    for( i = 0U; i < aCleaner->nTri; i++)
+    {
+	if( aCleaner->tris[i].isLive == GL_TRUE)
+	{
+	    for( j = 0U; j < 3U; j++)
+	    {
+		aCleaner->vertTriStart[aCleaner->tris[i].verts[j] + 1U]++;
+
+	    } /* End for */
+
+	    numUses += 3U;
+
+	} /* End if */
+
+    } /* End for */
+
+    for( i = 0U; i < aCleaner->nVerts; i++)
+    {
+	aCleaner->vertTriStart[i + 1U] += aCleaner->vertTriStart[i];
+
+    } /* End for */
+
+    for( i = aCleaner->nTri; i > 0U; i--)
+    {
+	const CleanTri *aTri = ( aCleaner->tris + i - 1U);
+
+	if( aTri->isLive == GL_TRUE)
+	{
+	    for( j = 0U; j < 3U; j++)
+	    {
+		Uint32 listEnd = --aCleaner->vertTriStart[aTri->verts[j] + 1U];
+
+		aCleaner->vertTris[listEnd] = i - 1U;
+
+	    } /* End for */
+
+	} /* End if */
+
+    } /* End for */
+
+    /* The end of the list of each vertex has now come down to its
+     * start, so the starts are one place further up than they should be.
+     */
+    memmove(
+	aCleaner->vertTriStart, ( aCleaner->vertTriStart + 1U),
+	aCleaner->nVerts * sizeof( Uint32)
+    );
+    aCleaner->vertTriStart[aCleaner->nVerts] = numUses;
+
+} /* End function FindVertTris */
+
+
+/**
+ * Groups the live triangles into regions, growing each region from the
+ * largest triangle not yet in one across the edges it shares with its
+ * neighbours.
+ */
+void GrowRegions( MeshCleaner *aCleaner)
+{
+    SortItem *seeds;
+    Uint32 numRegionTris = 0U;
+    Uint32 i, j, k;
+
+    seeds = (SortItem *)( malloc( aCleaner->nTri * sizeof( SortItem)));
+    if( seeds == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( i = 0U; i < aCleaner->nTri; i++)
+    {
+	seeds[i].key = -aCleaner->tris[i].area;
+	seeds[i].itemNum = i;
+
+    } /* End for */
+
+    qsort( seeds, aCleaner->nTri, sizeof( SortItem), CompareSortItems);
+
+    aCleaner->numRegions = 0U;
+
+    for( i = 0U; i < aCleaner->nTri; i++)
+    {
+	Uint32 seedNum = seeds[i].itemNum;
+	Uint32 regionNum = aCleaner->numRegions;
+	CleanRegion *aRegion = ( aCleaner->regions + regionNum);
+
+	if( ( aCleaner->tris[seedNum].isLive == GL_FALSE) ||
+	    ( aCleaner->tris[seedNum].regionNum != MESHCLEAN_NONE)
+	)
+	{
+	    continue;
+
+	} /* End if */
+
+	SetRegionMapping( aCleaner, aRegion, seedNum);
+
+	aRegion->firstTri = numRegionTris;
+	aRegion->numTri = 1U;
+	aRegion->isTried = GL_FALSE;
+	aRegion->isMerged = GL_FALSE;
+
+	aCleaner->tris[seedNum].regionNum = regionNum;
+	aCleaner->regionTris[numRegionTris++] = seedNum;
+
+	/* Look across each edge of each triangle added to the region */
+	for( j = aRegion->firstTri; j < numRegionTris; j++)
+	{
+	    const CleanTri *aTri = ( aCleaner->tris + aCleaner->regionTris[j]);
+
+	    for( k = 0U; k < 3U; k++)
+	    {
+		Uint32 fromVert = aTri->verts[k];
+		Uint32 toVert = aTri->verts[( k + 1U) % 3U];
+		Uint32 l;
+
+		for( l = aCleaner->vertTriStart[toVert];
+		    ( l < aCleaner->vertTriStart[toVert + 1U]) &&
+		    ( aRegion->numTri < MESHCLEAN_MAX_REGION_TRI);
+		    l++
+		)
+		{
+		    Uint32 otherNum = aCleaner->vertTris[l];
+		    CleanTri *otherTri = ( aCleaner->tris + otherNum);
+
+		    if( ( otherTri->regionNum == MESHCLEAN_NONE) &&
+			( HasEdge( otherTri, toVert, fromVert) == GL_TRUE) &&
+			( FitsRegion( aCleaner, aRegion, otherNum) == GL_TRUE)
+		    )
+		    {
+			otherTri->regionNum = regionNum;
+			aCleaner->regionTris[numRegionTris++] = otherNum;
+			aRegion->numTri++;
+
+		    } /* End if */
+
+		} /* End for */
+
+	    } /* End for */
+
+	} /* End for */
+
+	aCleaner->numRegions++;
+
+    } /* End for */
+
+    free( seeds);
+
+} /* End function GrowRegions */
+
+
+/**
+ * Sets the plane and the mapping of texture coordinates of the given
+ * region to those of the given triangle.
+ */
+void SetRegionMapping(
+    MeshCleaner *aCleaner, CleanRegion *aRegion, Uint32 triNum
+)
+{
+    const CleanTri *aTri = ( aCleaner->tris + triNum);
+    const GLfloat *texCoords = ( aCleaner->triTexCoords + 6U*triNum);
+    const double *v0 = ( aCleaner->verts + 3U*aTri->verts[0]);
+    const double *v1 = ( aCleaner->verts + 3U*aTri->verts[1]);
+    const double *v2 = ( aCleaner->verts + 3U*aTri->verts[2]);
+    double edge1[3], edge2[3], crossVec[3], crossSqr;
+    double uDiff1, uDiff2, vDiff1, vDiff2;
+    int m;
+
+    aRegion->texIndex = aCleaner->texIndices[triNum];
+
+    for( m = 0; m < 3; m++)
+    {
+	aRegion->origin[m] = v0[m];
+	aRegion->normal[m] = aTri->normal[m];
+
+	edge1[m] = v1[m] - v0[m];
+	edge2[m] = v2[m] - v0[m];
+
+    } /* End for */
+
+    crossVec[0] = edge1[1]*edge2[2] - edge1[2]*edge2[1];
+    crossVec[1] = edge1[2]*edge2[0] - edge1[0]*edge2[2];
+    crossVec[2] = edge1[0]*edge2[1] - edge1[1]*edge2[0];
+    crossSqr =
+	crossVec[0]*crossVec[0] + crossVec[1]*crossVec[1] +
+	crossVec[2]*crossVec[2];
+
+    aRegion->texCoords[0] = texCoords[0];
+    aRegion->texCoords[1] = texCoords[1];
+
+    uDiff1 = texCoords[2] - texCoords[0];
+    vDiff1 = texCoords[3] - texCoords[1];
+    uDiff2 = texCoords[4] - texCoords[0];
+    vDiff2 = texCoords[5] - texCoords[1];
+
+    /* The gradient of a value along the plane that changes by 'd1' 
+     * along 'edge1' and by 'd2' along 'edge2' is
+     * ( d1 * ( edge2 x N) + d2 * ( N x edge1)) / |N|^2, where 
+     * N = edge1 x edge2.
+     */
+    for( m = 0; m < 3; m++)
+    {
+	int m1 = ( m + 1) % 3;
+	int m2 = ( m + 2) % 3;
+	double e2CrossN = edge2[m1]*crossVec[m2] - edge2[m2]*crossVec[m1];
+	double nCrossE1 = crossVec[m1]*edge1[m2] - crossVec[m2]*edge1[m1];
+
+	aRegion->uGrad[m] = ( uDiff1*e2CrossN + uDiff2*nCrossE1) / crossSqr;
+	aRegion->vGrad[m] = ( vDiff1*e2CrossN + vDiff2*nCrossE1) / crossSqr;
+
+    } /* End for */
+
+} /* End function SetRegionMapping */
+
+
+/**
+ * Returns GL_TRUE if the given triangle can be added to the given
+ * region - that is, if it uses the same texture map, faces the same 
+ * way and each of its vertices is on the plane of the region, with 
+ * the texture coordinates given by the mapping of the region.
+ */
+GLboolean FitsRegion(
+    const MeshCleaner *aCleaner, const CleanRegion *aRegion, Uint32 triNum
+)
+{
+    const CleanTri *aTri = ( aCleaner->tris + triNum);
+    const GLfloat *texCoords = ( aCleaner->triTexCoords + 6U*triNum);
+    double normDot = 0.0;
+    Uint32 j;
+    int m;
+
+    if( aCleaner->texIndices[triNum] != aRegion->texIndex)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    for( m = 0; m < 3; m++)
+    {
+	normDot += aTri->normal[m] * aRegion->normal[m];
+
+    } /* End for */
+
+    if( normDot <= 0.0)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    for( j = 0U; j < 3U; j++)
+    {
+	const double *aVert = ( aCleaner->verts + 3U*aTri->verts[j]);
+	double planeDist = 0.0;
+	double uVal = aRegion->texCoords[0];
+	double vVal = aRegion->texCoords[1];
+
+	for( m = 0; m < 3; m++)
+	{
+	    double relPos = aVert[m] - aRegion->origin[m];
+
+	    planeDist += relPos * aRegion->normal[m];
+	    uVal += relPos * aRegion->uGrad[m];
+	    vVal += relPos * aRegion->vGrad[m];
+
+	} /* End for */
+
+	if( ( fabs( planeDist) > GLD_VERT_ORD_EPSILON) ||
+	    ( fabs( uVal - texCoords[2U*j]) > MESHCLEAN_TEX_EPSILON) ||
+	    ( fabs( vVal - texCoords[2U*j + 1U]) > MESHCLEAN_TEX_EPSILON)
+	)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+    } /* End for */
+
+    return GL_TRUE;
+
+} /* End function FitsRegion */
+
+
+/**
+ * Returns GL_TRUE if the given triangle has an edge going from the 
+ * first of the given vertices to the second.
+ */
+GLboolean HasEdge( const CleanTri *aTri, Uint32 fromVert, Uint32 toVert)
+{
+    Uint32 j;
+
+    for( j = 0U; j < 3U; j++)
+    {
+	if( ( aTri->verts[j] == fromVert) &&
+	    ( aTri->verts[( j + 1U) % 3U] == toVert)
+	)
+	{
+	    return GL_TRUE;
+
+	} /* End if */
+
+    } /* End for */
+
+    return GL_FALSE;
+
+} /* End function HasEdge */
+
+
+/**
+ * Returns GL_TRUE if a triangle of the given region has an edge going
+ * from the first of the given vertices to the second.
+ */
+GLboolean HasRegionEdge(
+    const MeshCleaner *aCleaner, Uint32 regionNum,
+    Uint32 fromVert, Uint32 toVert
+)
+{
+    Uint32 l;
+
+    for( l = aCleaner->vertTriStart[fromVert];
+	l < aCleaner->vertTriStart[fromVert + 1U];
+	l++
+    )
+    {
+	const CleanTri *aTri = ( aCleaner->tris + aCleaner->vertTris[l]);
+
+	if( ( aTri->regionNum == regionNum) &&
+	    ( HasEdge( aTri, fromVert, toVert) == GL_TRUE)
+	)
+	{
+	    return GL_TRUE;
+
+	} /* End if */
+
+    } /* End for */
+
+    return GL_FALSE;
+
+} /* End function HasRegionEdge */
+
+
+/**
+ * Returns GL_TRUE if the given vertex is used only by triangles of the
+ * given region, so that it can be left out of the merged polygon
+ * without leaving a crack next to some other triangle.
+ */
+GLboolean IsRemovable(
+    const MeshCleaner *aCleaner, Uint32 regionNum, Uint32 vertNum
+)
+{
+    Uint32 l;
+
+    for( l = aCleaner->vertTriStart[vertNum];
+	l < aCleaner->vertTriStart[vertNum + 1U];
+	l++
+    )
+    {
+	if( aCleaner->tris[aCleaner->vertTris[l]].regionNum != regionNum)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+    } /* End for */
+
+    return GL_TRUE;
+
+} /* End function IsRemovable */
+
+
+/**
+ * Returns GL_TRUE if the given point lies between the ends of the 
+ * given segment, within GLD_VERT_ORD_EPSILON of it.
+ */
+GLboolean IsOnSegment(
+    const double *aPoint, const double *segStart, const double *segEnd
+)
+{
+    double segVec[3], relPos[3], segSqr, alongSeg, offSeg;
+    int m;
+
+    segSqr = alongSeg = 0.0;
+    for( m = 0; m < 3; m++)
+    {
+	segVec[m] = segEnd[m] - segStart[m];
+	relPos[m] = aPoint[m] - segStart[m];
+
+	segSqr += segVec[m] * segVec[m];
+	alongSeg += segVec[m] * relPos[m];
+
+    } /* End for */
+
+    if( ( segSqr <= 0.0) || ( alongSeg <= 0.0) || ( alongSeg >= segSqr))
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    alongSeg /= segSqr;
+
+    offSeg = 0.0;
+    for( m = 0; m < 3; m++)
+    {
+	double offOrd = relPos[m] - alongSeg * segVec[m];
+
+	offSeg += offOrd * offOrd;
+
+    } /* End for */
+
+    return ( sqrt( offSeg) <= GLD_VERT_ORD_EPSILON) ? GL_TRUE : GL_FALSE;
+
+} /* End function IsOnSegment */
+
+
+/**
+ * Returns twice the area of the given triangle, positive if its 
+ * vertices go anticlockwise when seen from the side the given normal 
+ * points to.
+ */
+double Orient(
+    const double *v0, const double *v1, const double *v2,
+    const double normal[3]
+)
+{
+    double edge1[3], edge2[3];
+    int m;
+
+    for( m = 0; m < 3; m++)
+    {
+	edge1[m] = v1[m] - v0[m];
+	edge2[m] = v2[m] - v0[m];
+
+    } /* End for */
+
+    return (
+	( edge1[1]*edge2[2] - edge1[2]*edge2[1]) * normal[0] +
+	( edge1[2]*edge2[0] - edge1[0]*edge2[2]) * normal[1] +
+	( edge1[0]*edge2[1] - edge1[1]*edge2[0]) * normal[2]
+    );
+
+} /* End function Orient */
+
+
+/**
+ * Returns the distance between the given points.
+ */
+double EdgeLen( const double *v0, const double *v1)
+{
+    return sqrt(
+	( v1[0] - v0[0]) * ( v1[0] - v0[0]) +
+	( v1[1] - v0[1]) * ( v1[1] - v0[1]) +
+	( v1[2] - v0[2]) * ( v1[2] - v0[2])
+    );
+
+} /* End function EdgeLen */
+
+
+/**
+ * Replaces the triangles of the given region by as few triangles as
+ * are needed to cover the polygon they make up, if it has a single 
+ * boundary (no holes) and can be covered with fewer triangles. The new
+ * triangles are put in the given arrays, and their number returned;
+ * if the region is left alone, 0 is returned.
+ */
+Uint32 MergeRegion(
+    MeshCleaner *aCleaner, Uint32 regionNum,
+    GLfloat *outVerts, GLfloat *outTexCoords, Uint16 *outTexIndices
+)
+{
+    const CleanRegion *aRegion = ( aCleaner->regions + regionNum);
+    const Uint32 *regionTris = ( aCleaner->regionTris + aRegion->firstTri);
+    Uint32 stamp = regionNum + 1U;
+    Uint32 numVerts = 0U, loopLen = 0U, polyLen, numNew;
+    Uint32 firstVert = MESHCLEAN_NONE;
+    Uint32 aVert, i, j;
+    double oldArea = 0.0, newArea = 0.0, loopPerim = 0.0;
+    int m;
+
+    /* Find the vertices of the region, and the edges on its boundary
+     * (those not shared with another of its triangles), noting the 
+     * vertex after each vertex on the boundary.
+     */
+    for( i = 0U; i < aRegion->numTri; i++)
+    {
+	const CleanTri *aTri = ( aCleaner->tris + regionTris[i]);
+
+	oldArea += aTri->area;
+
+	for( j = 0U; j < 3U; j++)
+	{
+	    aVert = aTri->verts[j];
+
+	    if( aCleaner->vertStamp[aVert] != stamp)
+	    {
+		aCleaner->vertStamp[aVert] = stamp;
+		aCleaner->nextVert[aVert] = MESHCLEAN_NONE;
+		aCleaner->vertTexCoords[2U*aVert] = 
+		    aCleaner->triTexCoords[6U*regionTris[i] + 2U*j];
+		aCleaner->vertTexCoords[2U*aVert + 1U] = 
+		    aCleaner->triTexCoords[6U*regionTris[i] + 2U*j + 1U];
+
+		numVerts++;
+
+	    } /* End if */
+
+	} /* End for */
+
+    } /* End for */
+
+    for( i = 0U; i < aRegion->numTri; i++)
+    {
+	const CleanTri *aTri = ( aCleaner->tris + regionTris[i]);
+
+	for( j = 0U; j < 3U; j++)
+	{
+	    Uint32 fromVert = aTri->verts[j];
+	    Uint32 toVert = aTri->verts[( j + 1U) % 3U];
+
+	    if( HasRegionEdge(
+		    aCleaner, regionNum, toVert, fromVert) == GL_FALSE
+	    )
+	    {
+		/* A vertex where the boundary touches itself */
+		if( aCleaner->nextVert[fromVert] != MESHCLEAN_NONE)
+		{
+		    return 0U;
+
+		} /* End if */
+
+		aCleaner->nextVert[fromVert] = toVert;
+		firstVert = fromVert;
+		loopLen++;
+
+	    } /* End if */
+
+	} /* End for */
+
+    } /* End for */
+
+    /* A polygon without holes has V - E + F = 1, with each edge either 
+     * on the boundary or shared by two triangles.
+     */
+    if( ( firstVert == MESHCLEAN_NONE) ||
+	( ( ( 3U * aRegion->numTri + loopLen) % 2U) != 0U) ||
+	( ( numVerts + aRegion->numTri) != 
+	    ( ( 3U * aRegion->numTri + loopLen) / 2U + 1U))
+    )
+    {
+	return 0U;
+
+    } /* End if */
+
+    /* Its boundary must be a single loop */
+    aVert = firstVert;
+    for( i = 0U; i < loopLen; i++)
+    {
+	if( aCleaner->nextVert[aVert] == MESHCLEAN_NONE)
+	{
+	    return 0U;
+
+	} /* End if */
+
+	aCleaner->loopVerts[i] = aVert;
+	loopPerim += EdgeLen(
+	    ( aCleaner->verts + 3U*aVert),
+	    ( aCleaner->verts + 3U*aCleaner->nextVert[aVert])
+	);
+
+	aVert = aCleaner->nextVert[aVert];
+	if( ( aVert == firstVert) && ( i < ( loopLen - 1U)))
+	{
+	    return 0U;
+
+	} /* End if */
+
+    } /* End for */
+
+    /* Every vertex inside it is dropped, so must not be used by any
+     * other triangle.
+     */
+    for( i = 0U; i < aRegion->numTri; i++)
+    {
+	for( j = 0U; j < 3U; j++)
+	{
+	    aVert = aCleaner->tris[regionTris[i]].verts[j];
+
+	    if( ( aCleaner->nextVert[aVert] == MESHCLEAN_NONE) &&
+		( IsRemovable( aCleaner, regionNum, aVert) == GL_FALSE)
+	    )
+	    {
+		return 0U;
+
+	    } /* End if */
+
+	} /* End for */
+
+    } /* End for */
+
+    polyLen = SimplifyLoop( aCleaner, regionNum, loopLen);
+    if( ( polyLen < 3U) || ( ( polyLen - 2U) >= aRegion->numTri))
+    {
+	return 0U;
+
+    } /* End if */
+
+    if( ClipEars( aCleaner, aRegion->normal, polyLen) == GL_FALSE)
+    {
+	return 0U;
+
+    } /* End if */
+
+    /* The new triangles must cover the same area, give or take the 
+     * vertices dropped from the boundary.
+     */
+    numNew = polyLen - 2U;
+    for( i = 0U; i < numNew; i++)
+    {
+	const Uint32 *newTri = ( aCleaner->newTris + 3U*i);
+
+	newArea += 0.5 * Orient(
+	    ( aCleaner->verts + 3U*newTri[0]),
+	    ( aCleaner->verts + 3U*newTri[1]),
+	    ( aCleaner->verts + 3U*newTri[2]),
+	    aRegion->normal
+	);
+
+    } /* End for */
+
+    if( fabs( newArea - oldArea) > ( GLD_VERT_ORD_EPSILON * loopPerim))
+    {
+	return 0U;
+
+    } /* End if */
+
+    for( i = 0U; i < numNew; i++)
+    {
+	for( j = 0U; j < 3U; j++)
+	{
+	    aVert = aCleaner->newTris[3U*i + j];
+
+	    for( m = 0; m < 3; m++)
+	    {
+		outVerts[9U*i + 3U*j + m] = 
+		    (GLfloat )aCleaner->verts[3U*aVert + m];
+
+	    } /* End for */
+
+	    outTexCoords[6U*i + 2U*j + 0U] = 
+		(GLfloat )aCleaner->vertTexCoords[2U*aVert];
+	    outTexCoords[6U*i + 2U*j + 1U] = 
+		(GLfloat )aCleaner->vertTexCoords[2U*aVert + 1U];
+
+	} /* End for */
+
+	outTexIndices[i] = aRegion->texIndex;
+
+    } /* End for */
+
+    return numNew;
+
+} /* End function MergeRegion */
+
+
+/**
+ * Drops the vertices on straight stretches of the boundary of the 
+ * given region (in 'loopVerts') that no other triangle uses, putting
+ * the rest in 'polyVerts'. Returns the number of vertices left, or 0
+ * if the boundary has no corners.
+ */
+Uint32 SimplifyLoop(
+    const MeshCleaner *aCleaner, Uint32 regionNum, Uint32 loopLen
+)
+{
+    const Uint32 *loopVerts = aCleaner->loopVerts;
+    const double *verts = aCleaner->verts;
+    Uint32 startPos, aPos, bPos, cPos, i;
+    Uint32 polyLen = 0U;
+
+    /* Start from a vertex that has to be kept */
+    for( startPos = 0U; startPos < loopLen; startPos++)
+    {
+	Uint32 prevPos = ( startPos + loopLen - 1U) % loopLen;
+	Uint32 nextPos = ( startPos + 1U) % loopLen;
+
+	if( ( IsRemovable( 
+		aCleaner, regionNum, loopVerts[startPos]) == GL_FALSE) ||
+	    ( IsOnSegment(
+		( verts + 3U*loopVerts[startPos]),
+		( verts + 3U*loopVerts[prevPos]),
+		( verts + 3U*loopVerts[nextPos])) == GL_FALSE)
+	)
+	{
+	    break;
+
+	} /* End if */
+
+    } /* End for */
+
+    if( startPos == loopLen)
+    {
+	return 0U;
+
+    } /* End if */
+
+    /* From each vertex kept, go as far along the boundary as we can 
+     * with every vertex passed being removable and within 
+     * GLD_VERT_ORD_EPSILON of the straight line to where we got to.
+     */
+    aPos = startPos;
+    do
+    {
+	aCleaner->polyVerts[polyLen++] = loopVerts[aPos];
+
+	bPos = ( aPos + 1U) % loopLen;
+	while( bPos != startPos)
+	{
+	    GLboolean canSkip =
+		IsRemovable( aCleaner, regionNum, loopVerts[bPos]);
+
+	    cPos = ( bPos + 1U) % loopLen;
+
+	    for( i = ( aPos + 1U) % loopLen;
+		( canSkip == GL_TRUE) && ( i != cPos);
+		i = ( i + 1U) % loopLen
+	    )
+	    {
+		canSkip = IsOnSegment(
+		    ( verts + 3U*loopVerts[i]),
+		    ( verts + 3U*loopVerts[aPos]),
+		    ( verts + 3U*loopVerts[cPos])
+		);
+
+	    } /* End for */
+
+	    if( canSkip == GL_FALSE)
+	    {
+		break;
+
+	    } /* End if */
+
+	    bPos = cPos;
+
+	} /* End while */
+
+	aPos = bPos;
+
+    } while( aPos != startPos);
+
+    return polyLen;
+
+} /* End function SimplifyLoop */
+
+
+/**
+ * Triangulates the polygon in 'polyVerts', facing along the given 
+ * normal, by cutting off "ears" one after the other (the best shaped
+ * one first), putting the triangles in 'newTris'. Returns GL_FALSE if
+ * at some point no ear can be cut off.
+ */
+GLboolean ClipEars(
+    MeshCleaner *aCleaner, const double normal[3], Uint32 polyLen
+)
+{
+    Uint32 *polyPrev = aCleaner->polyPrev;
+    Uint32 *polyNext = aCleaner->polyNext;
+    Uint32 numLeft = polyLen;
+    Uint32 numNew = 0U;
+    Uint32 curPos = 0U;
+    Uint32 i;
+
+    for( i = 0U; i < polyLen; i++)
+    {
+	polyPrev[i] = ( i + polyLen - 1U) % polyLen;
+	polyNext[i] = ( i + 1U) % polyLen;
+
+    } /* End for */
+
+    while( numLeft >= 3U)
+    {
+	Uint32 bestPos = MESHCLEAN_NONE;
+	double bestQuality = 0.0;
+	Uint32 *newTri = ( aCleaner->newTris + 3U*numNew);
+
+	i = curPos;
+	do
+	{
+	    double earQuality = GetEarQuality( aCleaner, normal, i);
+
+	    if( earQuality > bestQuality)
+	    {
+		bestQuality = earQuality;
+		bestPos = i;
+
+	    } /* End if */
+
+	    i = polyNext[i];
+
+	} while( ( i != curPos) && ( numLeft > 3U));
+
+	if( bestPos == MESHCLEAN_NONE)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+	newTri[0] = aCleaner->polyVerts[polyPrev[bestPos]];
+	newTri[1] = aCleaner->polyVerts[bestPos];
+	newTri[2] = aCleaner->polyVerts[polyNext[bestPos]];
+	numNew++;
+
+	polyNext[polyPrev[bestPos]] = polyNext[bestPos];
+	polyPrev[polyNext[bestPos]] = polyPrev[bestPos];
+	curPos = polyNext[bestPos];
+	numLeft--;
+
+    } /* End while */
+
+    return GL_TRUE;
+
+} /* End function ClipEars */
+
+
+/**
+ * Returns how well shaped the triangle cut off at the given vertex of
+ * the polygon in 'polyVerts' would be (its area over the square of its
+ * longest side), or 0 if it is not an "ear" - a triangle inside the 
+ * polygon, wider than GLD_VERT_ORD_EPSILON, with no other vertex of 
+ * the polygon in it or close to its sides.
+ */
+double GetEarQuality(
+    const MeshCleaner *aCleaner, const double normal[3], Uint32 earPos
+)
+{
+    const Uint32 *polyVerts = aCleaner->polyVerts;
+    const double *v0 =
+	( aCleaner->verts + 3U*polyVerts[aCleaner->polyPrev[earPos]]);
+    const double *v1 = ( aCleaner->verts + 3U*polyVerts[earPos]);
+    const double *v2 =
+	( aCleaner->verts + 3U*polyVerts[aCleaner->polyNext[earPos]]);
+    double len01 = EdgeLen( v0, v1);
+    double len12 = EdgeLen( v1, v2);
+    double len20 = EdgeLen( v2, v0);
+    double twiceArea = Orient( v0, v1, v2, normal);
+    double vertEps = GLD_VERT_ORD_EPSILON;
+    double maxLen;
+    Uint32 i;
+
+    maxLen = ( len01 > len12) ? len01 : len12;
+    maxLen = ( len20 > maxLen) ? len20 : maxLen;
+
+    if( twiceArea <= ( maxLen * vertEps))
+    {
+	return 0.0;
+
+    } /* End if */
+
+    for( i = aCleaner->polyNext[aCleaner->polyNext[earPos]];
+	i != aCleaner->polyPrev[earPos];
+	i = aCleaner->polyNext[i]
+    )
+    {
+	const double *aPoint = ( aCleaner->verts + 3U*polyVerts[i]);
+
+	/* Twice the area over a side is the distance from it */
+	if( ( Orient( v0, v1, aPoint, normal) >= -( len01 * vertEps)) &&
+	    ( Orient( v1, v2, aPoint, normal) >= -( len12 * vertEps)) &&
+	    ( Orient( v2, v0, aPoint, normal) >= -( len20 * vertEps))
+	)
+	{
+	    return 0.0;
+
+	} /* End if */
+
+    } /* End for */
+
+    return ( twiceArea / ( maxLen * maxLen));
+
+} /* End function GetEarQuality */
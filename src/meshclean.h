@@ -0,0 +1,64 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * MESHCLEAN.H: Declarations for cleaning up the triangles of a model
+ * before generating GLData from them.
+ */
+
+/**
+ * The models exported from modelling packages usually have a few
+ * degenerate triangles, vertices that should have been the same but
+ * differ very slightly, and flat regions with the same texture that
+ * have been cut up into far more triangles than are needed to show
+ * them. Cleaning up the triangles:
+ *
+ *   1. welds together vertices closer than GLD_VERT_ORD_EPSILON in
+ *      each ordinate;
+ *
+ *   2. drops triangles that have no area left after welding (those
+ *      narrower than GLD_VERT_ORD_EPSILON);
+ *
+ *   3. grows regions of adjacent triangles that lie in the same plane,
+ *      use the same texture map and have texture coordinates given by
+ *      the same linear mapping from positions on the plane;
+ *
+ *   4. replaces each region that is a simple polygon (without holes) by
+ *      a triangulation of the polygon with the fewest triangles, after
+ *      removing its interior vertices and those on straight stretches
+ *      of its boundary that no other triangle uses.
+ *
+ * Since the texture coordinates vary linearly over each region, the
+ * polygon looks just as it did before, only with fewer triangles.
+ */
+
+#ifndef _MESHCLEAN_H
+#define _MESHCLEAN_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+
+/* Maximum number of triangles in a region merged into a polygon */
+#define MESHCLEAN_MAX_REGION_TRI 256U
+
+
+/* Function Prototypes */
+
+/**
+ * Cleans up the given triangles, in the form taken by GenGLData( ) -
+ * 'nTri' triangles with three vertices each in 'triVerts' and texture
+ * coordinates in 'triTexCoords', using the texture maps in
+ * 'texIndices'. The cleaned up triangles replace these in the same
+ * arrays. Returns the number of triangles left.
+ */
+extern Uint32 CleanUpMesh(
+    Uint32 nTri, GLfloat *triVerts, Uint16 *texIndices, GLfloat *triTexCoords
+);
+
+#endif    /* _MESHCLEAN_H */
@@ -16,6 +16,8 @@
 
 #include "gld.h"
 #include "obj3d.h"
+#include "meshclean.h"
+#include "bldcache.h"
 
 
 /* Constants representing information about command-line args */
@@ -26,16 +28,29 @@
 #define MDL_FILE_ARG 1
 #define MTL_LIB_ARG 2
 #define OUTFILE_ARG 3
+#define LAYOUT_ARG 4
+
+
+/* Change this whenever a change to the converter (or to the code it
+ * uses) changes the GLData it writes out, so that files built by the
+ * older version are no longer taken from the build cache.
+ */
+#define OBJ2GLD_VERSION "OBJ2GLD 2"
 
 
 /**
  * Entry point into the OBJ2GLD converter program. Takes in the OBJ 
- * model, the materials library and output file names (in that order).
+ * model, the materials library and output file names (in that order),
+ * optionally followed by the layout of the vertices in the output - 
+ * "separate" (the default), "interleaved" or "padded" (see "gld.h").
+ * These can be preceded by "-cache <folder>", to take the GLData from 
+ * (or put it in) the build cache in that folder (see "bldcache.h").
  *
  * All the polygons in the model are assumed to be just triangles,
  * textured and oriented correctly (vertices in anticlockwise
  * order). All of the textures referenced in the model must be
- * found in the materials library.
+ * found in the materials library. The triangles are cleaned up
+ * (see "meshclean.h") before the GLData is generated from them.
  */
 int main( int argc, char *argv[])
 {
@@ -53,17 +68,63 @@ int main( int argc, char *argv[])
     GLData *glData = NULL;
     FILE *outFile, *inFile;
 
+    GLDVertLayout vertLayout = GLD_SEPARATE_VERTS;
+    const char *layoutName = "separate";
+    GLboolean argsOK;
+
+    const char *cacheDir = NULL;
+    GLboolean useCache = GL_FALSE;
+    BuildKey buildKey;
+
     Uint16 i, j;
 
 
-    /* Check command-line arguments */
-    if( argc != ( NUM_REQ_ARGS + 1))
+    /* Check command-line arguments, moving the name of the programme
+     * past the cache option (if any) so that the rest are where they
+     * would be without it.
+     */
+    if( ( argc > 2) && ( strcmp( "-cache", argv[1]) == 0))
+    {
+	cacheDir = argv[2];
+	argv[2] = argv[PROG_NAME_ARG];
+	argv += 2;
+	argc -= 2;
+
+    } /* End if */
+
+    argsOK = ( argc == ( NUM_REQ_ARGS + 1)) ? GL_TRUE : GL_FALSE;
+
+    if( argc == ( NUM_REQ_ARGS + 2))
+    {
+	argsOK = GL_TRUE;
+	layoutName = argv[LAYOUT_ARG];
+
+	if( strcmp( "interleaved", argv[LAYOUT_ARG]) == 0)
+	{
+	    vertLayout = GLD_INTERLEAVED_VERTS;
+
+	} /* End if */
+	else if( strcmp( "padded", argv[LAYOUT_ARG]) == 0)
+	{
+	    vertLayout = GLD_PADDED_VERTS;
+
+	} /* End else-if */
+	else if( strcmp( "separate", argv[LAYOUT_ARG]) != 0)
+	{
+	    argsOK = GL_FALSE;
+
+	} /* End else-if */
+
+    } /* End if */
+
+    if( argsOK == GL_FALSE)
     {
         fprintf( stderr, 
 	    "OBJ2GLD: Generate GLData from a Wavefront OBJ model\n"
 	);
         fprintf( stderr, 
-	    "Usage: %s <objfile> <mtlfile> <outfile>\n", 
+	    "Usage: %s [-cache <folder>] <objfile> <mtlfile> <outfile> "
+	    "[separate|interleaved|padded]\n", 
 	    argv[PROG_NAME_ARG]
 	);
 
@@ -71,6 +132,43 @@ int main( int argc, char *argv[])
 
     } /* End if */
 
+
+    /* See if the build cache already has the GLData for these inputs */
+    if( cacheDir != NULL)
+    {
+	InitBuildKey( &buildKey, OBJ2GLD_VERSION);
+
+	/* The programme itself is part of the key as well, when it can be
+	 * read (as when it is run by the make-file), so that rebuilding
+	 * it with some change also makes it build the file afresh.
+	 */
+	AddFileToBuildKey( &buildKey, argv[PROG_NAME_ARG]);
+	AddStringToBuildKey( &buildKey, layoutName);
+
+	if( ( AddFileToBuildKey( &buildKey, argv[MDL_FILE_ARG]) == GL_TRUE) &&
+	    ( AddFileToBuildKey( &buildKey, argv[MTL_LIB_ARG]) == GL_TRUE)
+	)
+	{
+	    useCache = GL_TRUE;
+
+	    if( FetchCachedBuild( 
+		    cacheDir, &buildKey, argv[OUTFILE_ARG]) == GL_TRUE
+	    )
+	    {
+		printf( 
+		    "OBJ2GLD: GLData for \"%s\" taken from the build cache\n",
+		    argv[MDL_FILE_ARG]
+		);
+		fflush( stdout);
+
+		return EXIT_SUCCESS;
+
+	    } /* End if */
+
+	} /* End if */
+
+    } /* End if */
+
     
     /* Read in the model */
     inModel = ReadObjModel( argv[MDL_FILE_ARG]);
@@ -216,6 +314,14 @@ int main( int argc, char *argv[])
     FreeObjMaterialsLib( inMtlLib);
 
 
+    /* Weld vertices, drop degenerate triangles and merge flat regions */
+    i = nTri;
+    nTri = (Uint16 )CleanUpMesh( nTri, triVerts, texIndices, triTexCoords);
+
+    printf( "OBJ2GLD: Cleaned up %hu triangles into %hu\n", i, nTri);
+    fflush( stdout);
+
+
     /* Generate GLData */
     glData = GenGLData( 
         nTri, triVerts, texIndices, triTexCoords, nMaps, texMapNames
@@ -253,6 +359,8 @@ int main( int argc, char *argv[])
 
 
     /* Now write out the GLData to the given file */
+    SetGLDVertLayout( glData, vertLayout);
+
     outFile = fopen( argv[OUTFILE_ARG], "wb");
 
     if( outFile == NULL)
@@ -293,6 +401,20 @@ int main( int argc, char *argv[])
 
     } /* End if */
 
+    /* Keep a copy in the build cache for next time */
+    if( ( useCache == GL_TRUE) &&
+	( StoreCachedBuild( 
+	    cacheDir, &buildKey, argv[OUTFILE_ARG]) == GL_FALSE
+	)
+    )
+    {
+	fprintf( stderr,
+	    "\nWARNING: Unable to store GLData in the build cache \"%s\"!\n",
+	    cacheDir
+	);
+
+    } /* End if */
+
     printf( "OBJ2GLD: Done.\n");
     fflush( stdout);
 
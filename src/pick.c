@@ -0,0 +1,146 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * PICK.C: Identifying the surfaces of a model seen through a point on
+ * the screen, or hit by a ray.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "pick.h"
+
+
+/* Local function prototypes */
+
+static void FillResult(
+    const BVHData *bvhData, const BVHHit *aHit,
+    const GLfloat orig[3], const GLfloat dir[3], GLfloat dirLen,
+    PickResult *aResult
+);
+
+
+GLboolean CastPickRay(
+    const BVHData *bvhData,
+    const GLfloat orig[3], const GLfloat dir[3], GLfloat maxDist,
+    PickResult *aResult
+)
+{
+    GLfloat dirLen;
+    BVHHit aHit;
+
+    dirLen = (GLfloat )sqrt( dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2]);
+    if( dirLen <= 0.0F)
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    if( IntersectBVH(
+	    bvhData, orig, dir, 0.0F, ( maxDist / dirLen), GL_TRUE,
+	    NULL, NULL, &aHit
+	) == GL_FALSE
+    )
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    FillResult( bvhData, &aHit, orig, dir, dirLen, aResult);
+
+    return GL_TRUE;
+
+} /* End function CastPickRay */
+
+
+GLboolean PickSurface(
+    const BVHData *bvhData, GLdouble winX, GLdouble winY,
+    PickResult *aResult
+)
+{
+    GLdouble mvMatrix[16], projMatrix[16];
+    GLint viewPort[4];
+    GLdouble nearPt[3], farPt[3];
+    GLfloat orig[3], dir[3];
+    BVHHit aHit;
+    int m;
+
+    glGetDoublev( GL_MODELVIEW_MATRIX, mvMatrix);
+    glGetDoublev( GL_PROJECTION_MATRIX, projMatrix);
+    glGetIntegerv( GL_VIEWPORT, viewPort);
+
+    /* The points on the near and far clipping planes seen through
+     * the given point bound the ray.
+     */
+    if( ( gluUnProject(
+	    winX, winY, 0.0, mvMatrix, projMatrix, viewPort,
+	    &nearPt[0], &nearPt[1], &nearPt[2]
+	  ) == GL_FALSE) ||
+	( gluUnProject(
+	    winX, winY, 1.0, mvMatrix, projMatrix, viewPort,
+	    &farPt[0], &farPt[1], &farPt[2]
+	  ) == GL_FALSE)
+    )
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    for( m = 0; m < 3; m++)
+    {
+	orig[m] = (GLfloat )nearPt[m];
+	dir[m] = (GLfloat )( farPt[m] - nearPt[m]);
+
+    } /* End for */
+
+    if( IntersectBVH(
+	    bvhData, orig, dir, 0.0F, 1.0F, GL_TRUE, NULL, NULL, &aHit
+	) == GL_FALSE
+    )
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    FillResult(
+	bvhData, &aHit, orig, dir,
+	(GLfloat )sqrt( dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2]),
+	aResult
+    );
+
+    return GL_TRUE;
+
+} /* End function PickSurface */
+
+
+/**
+ * Fills in the result of a query from the hit found by it.
+ */
+void FillResult(
+    const BVHData *bvhData, const BVHHit *aHit,
+    const GLfloat orig[3], const GLfloat dir[3], GLfloat dirLen,
+    PickResult *aResult
+)
+{
+    int m;
+
+    aResult->triNum = aHit->aTri->triNum;
+    aResult->texIndex = aHit->aTri->texIndex;
+    aResult->mapName = bvhData->glData->mapNames[aHit->aTri->texIndex];
+
+    for( m = 0; m < 3; m++)
+    {
+	aResult->hitPos[m] = orig[m] + aHit->t * dir[m];
+
+    } /* End for */
+
+    aResult->distance = aHit->t * dirLen;
+
+} /* End function FillResult */
+
+
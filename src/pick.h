@@ -0,0 +1,88 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * PICK.H: Declarations for the functions that identify the surfaces
+ * of a model seen through a point on the screen, or hit by a ray.
+ */
+
+/**
+ * Queries are answered using a Bounding Volume Hierarchy (see "bvh.h")
+ * over the GLData model being shown, so they take a few microseconds
+ * even for the Taj exterior, rather than the time needed to test every
+ * triangle of the model.
+ *
+ * Triangles are identified by their number in the GLData model (see
+ * "bvh.h"), which does not change between runs of the demo as long as
+ * the model does not, and so can be used to attach annotations to
+ * surfaces.
+ *
+ * Only the geometry is considered - transparent parts of a texture
+ * (the holes in the grills, for example) can be picked like the rest
+ * of the surface they are on.
+ */
+
+#ifndef _PICK_H
+#define _PICK_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+#include "bvh.h"
+
+
+/* Data type definitions */
+
+/* A surface found by a query */
+typedef struct _pick_result
+{
+    Uint32 triNum;          /* Number of the triangle in the model */
+    Uint16 texIndex;        /* Texture map of the triangle */
+    const char *mapName;    /* Name of the texture map */
+
+    GLfloat hitPos[3];      /* Where the surface was hit */
+    GLfloat distance;       /* Distance of the hit from the ray origin */
+
+} PickResult;
+
+
+/* Function Prototypes */
+
+/**
+ * Finds the nearest front-facing surface hit by the ray from 'orig'
+ * along 'dir' (which need not be of unit length), within 'maxDist' of
+ * 'orig'.
+ *
+ * Returns GL_TRUE and fills in 'aResult' if a surface was hit, GL_FALSE
+ * otherwise.
+ */
+extern GLboolean CastPickRay(
+    const BVHData *bvhData,
+    const GLfloat orig[3], const GLfloat dir[3], GLfloat maxDist,
+    PickResult *aResult
+);
+
+
+/**
+ * Finds the nearest front-facing surface seen through the given point
+ * in window coordinates (with the origin at the lower left corner, as
+ * OpenGL has it), using the current modelview and projection matrices
+ * and viewport to unproject the point. Only surfaces between the near
+ * and far clipping planes are considered.
+ *
+ * Returns GL_TRUE and fills in 'aResult' if a surface was found,
+ * GL_FALSE otherwise.
+ */
+extern GLboolean PickSurface(
+    const BVHData *bvhData, GLdouble winX, GLdouble winY,
+    PickResult *aResult
+);
+
+#endif    /* _PICK_H */
+
+
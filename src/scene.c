@@ -0,0 +1,678 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * SCENE.C: Reading in the scene manifest, and placing and culling the
+ * models listed in it.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "scene.h"
+#include "vtaj.h"
+
+
+/* Local function prototypes */
+
+static void InitSceneModel( SceneModel *aModel);
+static GLboolean ParseSceneLine(
+    SceneModel *aModel, const char *keyWord, const char *args
+);
+static void SetSceneTransform( SceneModel *aModel);
+static GLboolean IsInRegion( const SceneModel *aModel, const GLfloat pt[3]);
+
+
+SceneData *LoadScene( const char *fileName)
+{
+    FILE *sceneFile;
+    char aLine[MAX_SCENE_LINE];
+    SceneData *retVal;
+    Uint32 maxModels = 0U;
+    Uint32 lineNum = 0U;
+    Uint32 i;
+
+    if( ( sceneFile = fopen( fileName, "r")) == NULL)
+    {
+	fprintf(
+	    stderr,
+	    "\nERROR: Could not read scene manifest \"%s\"\n", fileName
+	);
+	perror( "Details");
+	return NULL;
+
+    } /* End if */
+
+    retVal = (SceneData *)( malloc( sizeof( SceneData)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->numModels = 0U;
+    retVal->models = NULL;
+
+    while( fgets( aLine, MAX_SCENE_LINE, sceneFile) != NULL)
+    {
+	char keyWord[MAX_SCENE_NAME];
+	const char *aPtr = aLine;
+	GLboolean lineOK;
+
+	lineNum++;
+
+	/* Skip blank lines and comments */
+	aPtr += strspn( aPtr, " \t\r\n");
+	if( ( *aPtr == '\0') || ( *aPtr == '#'))
+	{
+	    continue;
+
+	} /* End if */
+
+	/* NOTE: The width here is MAX_SCENE_NAME - 1. */
+	sscanf( aPtr, "%63s", keyWord);
+	aPtr += strcspn( aPtr, " \t\r\n");
+
+	if( strcmp( "model", keyWord) == 0)
+	{
+	    SceneModel *aModel;
+
+	    if( retVal->numModels == maxModels)
+	    {
+		maxModels = ( maxModels == 0U) ? 8U : ( 2U * maxModels);
+		retVal->models = (SceneModel *)(
+		    realloc( retVal->models, maxModels * sizeof( SceneModel))
+		);
+
+		if( retVal->models == NULL)
+		{
+		    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+		    exit( EXIT_FAILURE);
+
+		} /* End if */
+
+	    } /* End if */
+
+	    aModel = ( retVal->models + retVal->numModels);
+	    InitSceneModel( aModel);
+
+	    lineOK = ( sscanf( aPtr, "%63s", aModel->name) == 1) ?
+		GL_TRUE : GL_FALSE;
+
+	    retVal->numModels++;
+
+	} /* End if */
+	else if( retVal->numModels == 0U)
+	{
+	    lineOK = GL_FALSE;
+
+	} /* End else-if */
+	else
+	{
+	    lineOK = ParseSceneLine(
+		( retVal->models + retVal->numModels - 1U), keyWord, aPtr
+	    );
+
+	} /* End else */
+
+	if( lineOK == GL_FALSE)
+	{
+	    fprintf(
+		stderr,
+		"\nERROR: Invalid line %u in scene manifest \"%s\"\n",
+		lineNum, fileName
+	    );
+	    FreeScene( retVal);
+	    fclose( sceneFile);
+	    return NULL;
+
+	} /* End if */
+
+    } /* End while */
+
+    fclose( sceneFile);
+
+    if( retVal->numModels == 0U)
+    {
+	fprintf(
+	    stderr,
+	    "\nERROR: No models in scene manifest \"%s\"\n", fileName
+	);
+	FreeScene( retVal);
+	return NULL;
+
+    } /* End if */
+
+    for( i = 0U; i < retVal->numModels; i++)
+    {
+	SceneModel *aModel = ( retVal->models + i);
+
+	if( aModel->gldFileName[0] == '\0')
+	{
+	    fprintf(
+		stderr,
+		"\nERROR: No GLD model for \"%s\" in scene manifest \"%s\"\n",
+		aModel->name, fileName
+	    );
+	    FreeScene( retVal);
+	    return NULL;
+
+	} /* End if */
+
+	SetSceneTransform( aModel);
+
+    } /* End for */
+
+    return retVal;
+
+} /* End function LoadScene */
+
+
+void FreeScene( SceneData *aScene)
+{
+    if( aScene != NULL)
+    {
+	free( aScene->models);
+	free( aScene);
+
+    } /* End if */
+
+} /* End function FreeScene */
+
+
+void SetSceneModelBounds(
+    SceneModel *aModel,
+    const GLfloat minCorner[3], const GLfloat maxCorner[3]
+)
+{
+    GetWorldBox( 
+	aModel, minCorner, maxCorner, aModel->minCorner, aModel->maxCorner
+    );
+
+} /* End function SetSceneModelBounds */
+
+
+void GetWorldBox(
+    const SceneModel *aModel,
+    const GLfloat minCorner[3], const GLfloat maxCorner[3],
+    GLfloat worldMin[3], GLfloat worldMax[3]
+)
+{
+    int c, m;
+
+    for( c = 0; c < 8; c++)
+    {
+	GLfloat aCorner[3], worldPt[3];
+
+	aCorner[0] = ( ( c & 1) != 0) ? maxCorner[0] : minCorner[0];
+	aCorner[1] = ( ( c & 2) != 0) ? maxCorner[1] : minCorner[1];
+	aCorner[2] = ( ( c & 4) != 0) ? maxCorner[2] : minCorner[2];
+
+	ModelToWorldPoint( aModel, aCorner, worldPt);
+
+	for( m = 0; m < 3; m++)
+	{
+	    if( ( c == 0) || ( worldPt[m] < worldMin[m]))
+	    {
+		worldMin[m] = worldPt[m];
+
+	    } /* End if */
+
+	    if( ( c == 0) || ( worldPt[m] > worldMax[m]))
+	    {
+		worldMax[m] = worldPt[m];
+
+	    } /* End if */
+
+	} /* End for */
+
+    } /* End for */
+
+} /* End function GetWorldBox */
+
+
+GLboolean IsSceneModelActive(
+    const SceneModel *aModel, const GLfloat vPos[3]
+)
+{
+    GLboolean retVal = GL_TRUE;
+
+    if( aModel->regionType == SHOWN_INSIDE)
+    {
+	retVal = IsInRegion( aModel, vPos);
+
+    } /* End if */
+    else if( aModel->regionType == SHOWN_OUTSIDE)
+    {
+	retVal = ( IsInRegion( aModel, vPos) == GL_TRUE) ? GL_FALSE : GL_TRUE;
+
+    } /* End else-if */
+
+    return retVal;
+
+} /* End function IsSceneModelActive */
+
+
+GLboolean IsSceneMoveAllowed(
+    const SceneModel *aModel,
+    const GLfloat srcPt[3], const GLfloat destPt[3]
+)
+{
+    if( ( aModel->regionType != SHOWN_INSIDE) ||
+	( aModel->doorSide == NO_DOOR) ||
+	( IsInRegion( aModel, srcPt) == GL_FALSE)
+    )
+    {
+	return GL_TRUE;
+
+    } /* End if */
+
+    return (
+	( ( destPt[0] < aModel->regionMin[0]) &&
+	  ( aModel->doorSide != DOOR_MIN_X)) ||
+	( ( destPt[0] > aModel->regionMax[0]) &&
+	  ( aModel->doorSide != DOOR_MAX_X)) ||
+	( ( destPt[2] < aModel->regionMin[1]) &&
+	  ( aModel->doorSide != DOOR_MIN_Z)) ||
+	( ( destPt[2] > aModel->regionMax[1]) &&
+	  ( aModel->doorSide != DOOR_MAX_Z))
+    ) ? GL_FALSE : GL_TRUE;
+
+} /* End function IsSceneMoveAllowed */
+
+
+void WorldToModelPoint(
+    const SceneModel *aModel, const GLfloat worldPt[3], GLfloat modelPt[3]
+)
+{
+    GLfloat relPt[3];
+
+    if( aModel->isTransformed == GL_FALSE)
+    {
+	modelPt[0] = worldPt[0];
+	modelPt[1] = worldPt[1];
+	modelPt[2] = worldPt[2];
+	return;
+
+    } /* End if */
+
+    relPt[0] = worldPt[0] - aModel->position[0];
+    relPt[1] = worldPt[1] - aModel->position[1];
+    relPt[2] = worldPt[2] - aModel->position[2];
+
+    modelPt[0] =
+	( aModel->cosYaw*relPt[0] - aModel->sinYaw*relPt[2]) / aModel->scale;
+    modelPt[1] = relPt[1] / aModel->scale;
+    modelPt[2] =
+	( aModel->sinYaw*relPt[0] + aModel->cosYaw*relPt[2]) / aModel->scale;
+
+} /* End function WorldToModelPoint */
+
+
+void ModelToWorldPoint(
+    const SceneModel *aModel, const GLfloat modelPt[3], GLfloat worldPt[3]
+)
+{
+    if( aModel->isTransformed == GL_FALSE)
+    {
+	worldPt[0] = modelPt[0];
+	worldPt[1] = modelPt[1];
+	worldPt[2] = modelPt[2];
+	return;
+
+    } /* End if */
+
+    worldPt[0] = aModel->position[0] + aModel->scale *
+	( aModel->cosYaw*modelPt[0] + aModel->sinYaw*modelPt[2]);
+    worldPt[1] = aModel->position[1] + aModel->scale * modelPt[1];
+    worldPt[2] = aModel->position[2] + aModel->scale *
+	( -aModel->sinYaw*modelPt[0] + aModel->cosYaw*modelPt[2]);
+
+} /* End function ModelToWorldPoint */
+
+
+void WorldToModelDir(
+    const SceneModel *aModel, const GLdouble worldDir[3],
+    GLdouble modelDir[3]
+)
+{
+    GLdouble dirX = worldDir[0];
+
+    modelDir[0] = aModel->cosYaw*dirX - aModel->sinYaw*worldDir[2];
+    modelDir[1] = worldDir[1];
+    modelDir[2] = aModel->sinYaw*dirX + aModel->cosYaw*worldDir[2];
+
+} /* End function WorldToModelDir */
+
+
+void GetFrustumPlanes(
+    const GLdouble projMatrix[16], const GLdouble mvMatrix[16],
+    GLdouble frustum[6][4]
+)
+{
+    GLdouble clipMatrix[16];
+    int r, c, k;
+
+    /* Both matrices are in column-major order, as OpenGL has them */
+    for( c = 0; c < 4; c++)
+    {
+	for( r = 0; r < 4; r++)
+	{
+	    clipMatrix[4*c + r] = 0.0;
+
+	    for( k = 0; k < 4; k++)
+	    {
+		clipMatrix[4*c + r] += projMatrix[4*k + r] * mvMatrix[4*c + k];
+
+	    } /* End for */
+
+	} /* End for */
+
+    } /* End for */
+
+    /* A point is inside if -w <= x, y, z <= w in clip coordinates -
+     * that is, if row 3 of the matrix plus or minus each of the rows 0,
+     * 1 and 2 gives a non-negative value.
+     */
+    for( r = 0; r < 3; r++)
+    {
+	for( c = 0; c < 4; c++)
+	{
+	    frustum[2*r][c] = clipMatrix[4*c + 3] + clipMatrix[4*c + r];
+	    frustum[2*r + 1][c] = clipMatrix[4*c + 3] - clipMatrix[4*c + r];
+
+	} /* End for */
+
+    } /* End for */
+
+} /* End function GetFrustumPlanes */
+
+
+GLboolean IsBoxInFrustum(
+    const GLfloat minCorner[3], const GLfloat maxCorner[3],
+    const GLdouble frustum[6][4]
+)
+{
+    int p;
+
+    for( p = 0; p < 6; p++)
+    {
+	const GLdouble *aPlane = frustum[p];
+	GLdouble maxDist;
+
+	/* The corner farthest along the plane's normal */
+	maxDist = aPlane[3] +
+	    aPlane[0] * ( ( aPlane[0] >= 0.0) ? maxCorner[0] : minCorner[0]) +
+	    aPlane[1] * ( ( aPlane[1] >= 0.0) ? maxCorner[1] : minCorner[1]) +
+	    aPlane[2] * ( ( aPlane[2] >= 0.0) ? maxCorner[2] : minCorner[2]);
+
+	if( maxDist < 0.0)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+    } /* End for */
+
+    return GL_TRUE;
+
+} /* End function IsBoxInFrustum */
+
+
+/**
+ * Sets up a model just named in a scene manifest.
+ */
+void InitSceneModel( SceneModel *aModel)
+{
+    int m;
+
+    aModel->name[0] = '\0';
+    aModel->gldFileName[0] = '\0';
+    aModel->bspFileName[0] = '\0';
+    aModel->colDetFileName[0] = '\0';
+
+    for( m = 0; m < 3; m++)
+    {
+	aModel->position[m] = 0.0F;
+	aModel->minCorner[m] = aModel->maxCorner[m] = 0.0F;
+	aModel->hasEntry[m] = GL_FALSE;
+	aModel->entryPos[m] = 0.0F;
+
+    } /* End for */
+
+    aModel->cosYaw = 1.0F;
+    aModel->sinYaw = 0.0F;
+    aModel->scale = 1.0F;
+
+    aModel->regionType = SHOWN_ALWAYS;
+    aModel->regionMin[0] = aModel->regionMin[1] = 0.0F;
+    aModel->regionMax[0] = aModel->regionMax[1] = 0.0F;
+    aModel->doorSide = NO_DOOR;
+
+    aModel->noBSPCull = GL_FALSE;
+    aModel->alphaTest = GL_FALSE;
+
+} /* End function InitSceneModel */
+
+
+/**
+ * Reads in a line, other than a "model" line, of the description of
+ * a model in a scene manifest. Returns GL_FALSE if the line is not
+ * valid.
+ */
+GLboolean ParseSceneLine(
+    SceneModel *aModel, const char *keyWord, const char *args
+)
+{
+    GLboolean retVal = GL_TRUE;
+
+    /* NOTE: The width of file names here is MAX_SCENE_PATH - 1. */
+    if( strcmp( "gld", keyWord) == 0)
+    {
+	retVal = ( sscanf( args, "%255s", aModel->gldFileName) == 1) ?
+	    GL_TRUE : GL_FALSE;
+
+    } /* End if */
+    else if( strcmp( "bsp", keyWord) == 0)
+    {
+	retVal = ( sscanf( args, "%255s", aModel->bspFileName) == 1) ?
+	    GL_TRUE : GL_FALSE;
+
+    } /* End else-if */
+    else if( strcmp( "coldet", keyWord) == 0)
+    {
+	retVal = ( sscanf( args, "%255s", aModel->colDetFileName) == 1) ?
+	    GL_TRUE : GL_FALSE;
+
+    } /* End else-if */
+    else if( strcmp( "position", keyWord) == 0)
+    {
+	retVal = ( sscanf(
+		args, "%f %f %f",
+		&( aModel->position[0]), &( aModel->position[1]),
+		&( aModel->position[2])
+	    ) == 3
+	) ? GL_TRUE : GL_FALSE;
+
+    } /* End else-if */
+    else if( strcmp( "yaw", keyWord) == 0)
+    {
+	float yawDeg;
+
+	retVal = ( sscanf( args, "%f", &yawDeg) == 1) ? GL_TRUE : GL_FALSE;
+
+	aModel->cosYaw = (GLfloat )cos( yawDeg * M_PI / 180.0);
+	aModel->sinYaw = (GLfloat )sin( yawDeg * M_PI / 180.0);
+
+    } /* End else-if */
+    else if( strcmp( "scale", keyWord) == 0)
+    {
+	retVal = ( ( sscanf( args, "%f", &( aModel->scale)) == 1) &&
+	    ( aModel->scale > 0.0F)
+	) ? GL_TRUE : GL_FALSE;
+
+    } /* End else-if */
+    else if( ( strcmp( "region", keyWord) == 0) ||
+	( strcmp( "outside", keyWord) == 0)
+    )
+    {
+	retVal = ( ( aModel->regionType == SHOWN_ALWAYS) &&
+	    ( sscanf(
+		args, "%f %f %f %f",
+		&( aModel->regionMin[0]), &( aModel->regionMax[0]),
+		&( aModel->regionMin[1]), &( aModel->regionMax[1])
+	    ) == 4)
+	) ? GL_TRUE : GL_FALSE;
+
+	aModel->regionType = ( strcmp( "region", keyWord) == 0) ?
+	    SHOWN_INSIDE : SHOWN_OUTSIDE;
+
+    } /* End else-if */
+    else if( strcmp( "door", keyWord) == 0)
+    {
+	char sideName[4];
+
+	aModel->doorSide = NO_DOOR;
+
+	if( sscanf( args, "%3s", sideName) == 1)
+	{
+	    if( strcmp( "-x", sideName) == 0)
+	    {
+		aModel->doorSide = DOOR_MIN_X;
+
+	    } /* End if */
+	    else if( strcmp( "+x", sideName) == 0)
+	    {
+		aModel->doorSide = DOOR_MAX_X;
+
+	    } /* End else-if */
+	    else if( strcmp( "-z", sideName) == 0)
+	    {
+		aModel->doorSide = DOOR_MIN_Z;
+
+	    } /* End else-if */
+	    else if( strcmp( "+z", sideName) == 0)
+	    {
+		aModel->doorSide = DOOR_MAX_Z;
+
+	    } /* End else-if */
+
+	} /* End if */
+
+	retVal = ( aModel->doorSide != NO_DOOR) ? GL_TRUE : GL_FALSE;
+
+    } /* End else-if */
+    else if( strcmp( "entry", keyWord) == 0)
+    {
+	char coordStr[3][32];
+	int m;
+
+	if( sscanf(
+		args, "%31s %31s %31s",
+		coordStr[0], coordStr[1], coordStr[2]
+	    ) != 3
+	)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+	for( m = 0; m < 3; m++)
+	{
+	    if( strcmp( "*", coordStr[m]) == 0)
+	    {
+		aModel->hasEntry[m] = GL_FALSE;
+
+	    } /* End if */
+	    else if( sscanf( coordStr[m], "%f", &( aModel->entryPos[m])) == 1)
+	    {
+		aModel->hasEntry[m] = GL_TRUE;
+
+	    } /* End else-if */
+	    else
+	    {
+		retVal = GL_FALSE;
+
+	    } /* End else */
+
+	} /* End for */
+
+    } /* End else-if */
+    else if( strcmp( "nocull", keyWord) == 0)
+    {
+	aModel->noBSPCull = GL_TRUE;
+
+    } /* End else-if */
+    else if( strcmp( "alphatest", keyWord) == 0)
+    {
+	aModel->alphaTest = GL_TRUE;
+
+    } /* End else-if */
+    else
+    {
+	retVal = GL_FALSE;
+
+    } /* End else */
+
+    return retVal;
+
+} /* End function ParseSceneLine */
+
+
+/**
+ * Works out the matrix placing a model in the world, once all of its
+ * description has been read in.
+ */
+void SetSceneTransform( SceneModel *aModel)
+{
+    GLfloat *aMatrix = aModel->toWorld;
+
+    aModel->isTransformed = (
+	( aModel->position[0] != 0.0F) || ( aModel->position[1] != 0.0F) ||
+	( aModel->position[2] != 0.0F) || ( aModel->sinYaw != 0.0F) ||
+	( aModel->cosYaw != 1.0F) || ( aModel->scale != 1.0F)
+    ) ? GL_TRUE : GL_FALSE;
+
+    /* Column-major, as OpenGL has it */
+    aMatrix[0] = aModel->scale * aModel->cosYaw;
+    aMatrix[1] = 0.0F;
+    aMatrix[2] = -aModel->scale * aModel->sinYaw;
+    aMatrix[3] = 0.0F;
+
+    aMatrix[4] = 0.0F;
+    aMatrix[5] = aModel->scale;
+    aMatrix[6] = 0.0F;
+    aMatrix[7] = 0.0F;
+
+    aMatrix[8] = aModel->scale * aModel->sinYaw;
+    aMatrix[9] = 0.0F;
+    aMatrix[10] = aModel->scale * aModel->cosYaw;
+    aMatrix[11] = 0.0F;
+
+    aMatrix[12] = aModel->position[0];
+    aMatrix[13] = aModel->position[1];
+    aMatrix[14] = aModel->position[2];
+    aMatrix[15] = 1.0F;
+
+} /* End function SetSceneTransform */
+
+
+/**
+ * Returns GL_TRUE if the given point is within the model's region in
+ * the XZ plane.
+ */
+GLboolean IsInRegion( const SceneModel *aModel, const GLfloat pt[3])
+{
+    return ( ( pt[0] > aModel->regionMin[0]) &&
+	( pt[0] < aModel->regionMax[0]) &&
+	( pt[2] > aModel->regionMin[1]) &&
+	( pt[2] < aModel->regionMax[1])
+    ) ? GL_TRUE : GL_FALSE;
+
+} /* End function IsInRegion */
@@ -0,0 +1,228 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * SCENE.H: Declarations for reading in the scene manifest, which lists
+ * the models shown by the demo, and for placing and culling them.
+ */
+
+/**
+ * A scene manifest lists the models in the scene. Each model starts
+ * with a "model" line and is described by the lines following it, up
+ * to the next "model" line:
+ *
+ *     model <name>
+ *         gld <file>            GLData version of the model (required)
+ *         bsp <file>            BSP Tree version (needed for "-bsp")
+ *         coldet <file>         Collision mesh (see "cxmesh.h")
+ *         position <x> <y> <z>  Where the model's origin is placed
+ *         yaw <degrees>         Rotation of the model about the Y axis
+ *         scale <factor>        Uniform scaling of the model
+ *         region <minX> <maxX> <minZ> <maxZ>
+ *                               The model is shown only while the viewer
+ *                               is within this part of the XZ plane...
+ *         outside <minX> <maxX> <minZ> <maxZ>
+ *                               ...or only while the viewer is not.
+ *         door <side>           The viewer can leave the region only
+ *                               through this side ("-x", "+x", "-z" or
+ *                               "+z") of it.
+ *         entry <x> <y> <z>     Where the viewer is moved to on entering
+ *                               the region ("*" keeps a coordinate).
+ *         nocull                Back-facing triangles of the BSP Tree
+ *                               version must not be culled.
+ *         alphatest             Transparent texels are not drawn.
+ *
+ * Without a "region" or "outside", a model is always shown. Regions,
+ * positions and entry points are in world coordinates; the files are
+ * in the model's own. Blank lines and lines starting with '#' are
+ * ignored.
+ *
+ * Models are transformed by scaling, then rotation, then translation.
+ * The bounds of each model in world coordinates are kept, so that a
+ * model can be skipped when none of the views can see them.
+ */
+
+#ifndef _SCENE_H
+#define _SCENE_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+
+/* Maximum lengths of a line, a model name and a file name in a scene
+ * manifest.
+ */
+#define MAX_SCENE_LINE 512
+#define MAX_SCENE_NAME 64
+#define MAX_SCENE_PATH 256
+
+
+/* Data type definitions */
+
+/* Which way, if any, the viewer can leave a model's region */
+typedef enum
+{
+    NO_DOOR = 0, DOOR_MIN_X, DOOR_MAX_X, DOOR_MIN_Z, DOOR_MAX_Z
+
+} DoorSide;
+
+
+/* Which positions of the viewer a model is shown for */
+typedef enum
+{
+    SHOWN_ALWAYS = 0, SHOWN_INSIDE, SHOWN_OUTSIDE
+
+} RegionType;
+
+
+/* A model in the scene */
+typedef struct _scene_model
+{
+    char name[MAX_SCENE_NAME];
+
+    char gldFileName[MAX_SCENE_PATH];
+    char bspFileName[MAX_SCENE_PATH];       /* Empty if none */
+    char colDetFileName[MAX_SCENE_PATH];    /* Empty if none */
+
+    /* Placement in the world */
+    GLboolean isTransformed;
+    GLfloat position[3];
+    GLfloat cosYaw, sinYaw;
+    GLfloat scale;
+    GLfloat toWorld[16];    /* For glMultMatrixf( ) */
+
+    /* Bounds in world coordinates (see SetSceneModelBounds( )) */
+    GLfloat minCorner[3], maxCorner[3];
+
+    /* Activation region, in the XZ plane */
+    RegionType regionType;
+    GLfloat regionMin[2], regionMax[2];
+    DoorSide doorSide;
+
+    GLboolean hasEntry[3];
+    GLfloat entryPos[3];
+
+    GLboolean noBSPCull;
+    GLboolean alphaTest;
+
+} SceneModel;
+
+
+/* All the models of a scene */
+typedef struct _scene_data
+{
+    Uint32 numModels;
+    SceneModel *models;
+
+} SceneData;
+
+
+/* Function Prototypes */
+
+/**
+ * Reads in the given scene manifest.
+ *
+ * Returns the scene, or NULL on error.
+ */
+extern SceneData *LoadScene( const char *fileName);
+
+
+/**
+ * Frees the given scene.
+ */
+extern void FreeScene( SceneData *aScene);
+
+
+/**
+ * Works out the bounds of the model in world coordinates from its
+ * bounds in its own coordinates.
+ */
+extern void SetSceneModelBounds(
+    SceneModel *aModel,
+    const GLfloat minCorner[3], const GLfloat maxCorner[3]
+);
+
+
+/**
+ * Works out the axis-aligned box, in world coordinates, bounding the
+ * given box in the coordinates of the given model.
+ */
+extern void GetWorldBox(
+    const SceneModel *aModel,
+    const GLfloat minCorner[3], const GLfloat maxCorner[3],
+    GLfloat worldMin[3], GLfloat worldMax[3]
+);
+
+
+/**
+ * Returns GL_TRUE if the model is shown to a viewer at the given
+ * position.
+ */
+extern GLboolean IsSceneModelActive(
+    const SceneModel *aModel, const GLfloat vPos[3]
+);
+
+
+/**
+ * Returns GL_FALSE if a viewer moving between the given points would
+ * leave the model's region through a side other than its door.
+ */
+extern GLboolean IsSceneMoveAllowed(
+    const SceneModel *aModel,
+    const GLfloat srcPt[3], const GLfloat destPt[3]
+);
+
+
+/**
+ * Converts a point from world coordinates to those of the model.
+ */
+extern void WorldToModelPoint(
+    const SceneModel *aModel, const GLfloat worldPt[3], GLfloat modelPt[3]
+);
+
+
+/**
+ * Converts a point from the coordinates of the model to world ones.
+ */
+extern void ModelToWorldPoint(
+    const SceneModel *aModel, const GLfloat modelPt[3], GLfloat worldPt[3]
+);
+
+
+/**
+ * Converts a direction from world coordinates to those of the model.
+ * The length of the direction is kept.
+ */
+extern void WorldToModelDir(
+    const SceneModel *aModel, const GLdouble worldDir[3],
+    GLdouble modelDir[3]
+);
+
+
+/**
+ * Works out the planes bounding the view frustum given by the
+ * projection and modelview matrices. A point ( x, y, z) is inside
+ * all of them if 'a*x + b*y + c*z + d' is not negative for each plane
+ * ( a, b, c, d).
+ */
+extern void GetFrustumPlanes(
+    const GLdouble projMatrix[16], const GLdouble mvMatrix[16],
+    GLdouble frustum[6][4]
+);
+
+
+/**
+ * Returns GL_FALSE if the given axis-aligned box is entirely outside
+ * the given view frustum, GL_TRUE if it might be inside.
+ */
+extern GLboolean IsBoxInFrustum(
+    const GLfloat minCorner[3], const GLfloat maxCorner[3],
+    const GLdouble frustum[6][4]
+);
+
+#endif    /* _SCENE_H */
@@ -0,0 +1,407 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * TASKPOOL.C: Running a graph of tasks on a pool of threads.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "taskpool.h"
+
+
+/* Local function prototypes */
+
+static int WorkerMain( void *someData);
+static Uint32 FindReadyTask( TaskPool *taskPool, GLboolean onMainThread);
+static void RunTask( TaskPool *taskPool, Uint32 taskNum);
+static void FinishTask( TaskPool *taskPool, Uint32 taskNum, int taskResult);
+
+
+TaskPool *GenTaskPool( int numThreads)
+{
+    TaskPool *retVal;
+    int i;
+
+    /* NOTE: Uses calloc( ) to initialise the contents to 0 */
+    retVal = (TaskPool *)( calloc( 1, sizeof( TaskPool)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->poolLock = SDL_CreateMutex( );
+    retVal->poolChanged = SDL_CreateCond( );
+    if( ( retVal->poolLock == NULL) || ( retVal->poolChanged == NULL))
+    {
+	fprintf( stderr, "\nERROR: Could not create mutex! (%s)\n",
+	    SDL_GetError( )
+	);
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    numThreads = ( numThreads < 1) ? 1 : numThreads;
+    numThreads = ( numThreads > TASKPOOL_MAX_THREADS) ?
+	TASKPOOL_MAX_THREADS : numThreads;
+
+    retVal->stopWorkers = GL_FALSE;
+    retVal->numThreads = numThreads;
+
+    for( i = 0; i < numThreads; i++)
+    {
+	retVal->workerThreads[i] = SDL_CreateThread( WorkerMain, retVal);
+	if( retVal->workerThreads[i] == NULL)
+	{
+	    fprintf( stderr, "\nERROR: Could not create worker thread! (%s)\n",
+		SDL_GetError( )
+	    );
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+    } /* End for */
+
+    return retVal;
+
+} /* End function GenTaskPool */
+
+
+Uint32 AddPoolTask(
+    TaskPool *taskPool, PoolTaskFn taskFn, void *taskData,
+    GLboolean onMainThread, Uint32 numPrereqs, const Uint32 *prereqs
+)
+{
+    PoolTask *aTask;
+    Uint32 taskNum, i;
+
+    SDL_LockMutex( taskPool->poolLock);
+
+    if( taskPool->numTasks == taskPool->maxTasks)
+    {
+	taskPool->maxTasks =
+	    ( taskPool->maxTasks == 0U) ? 64U : ( 2U * taskPool->maxTasks);
+	taskPool->tasks = (PoolTask *)( realloc(
+	    taskPool->tasks, taskPool->maxTasks * sizeof( PoolTask)
+	));
+
+	if( taskPool->tasks == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+    } /* End if */
+
+    taskNum = taskPool->numTasks++;
+    aTask = ( taskPool->tasks + taskNum);
+
+    aTask->taskFn = taskFn;
+    aTask->taskData = taskData;
+    aTask->onMainThread = onMainThread;
+    aTask->hasFailed = GL_FALSE;
+    aTask->numPending = 0U;
+    aTask->numDependents = 0U;
+    aTask->maxDependents = 0U;
+    aTask->dependents = NULL;
+
+    /* Wait only for the tasks not yet done */
+    for( i = 0U; i < numPrereqs; i++)
+    {
+	PoolTask *preTask = ( taskPool->tasks + prereqs[i]);
+
+	if( preTask->taskState == TASK_DONE)
+	{
+	    aTask->hasFailed =
+		( preTask->hasFailed == GL_TRUE) ? GL_TRUE : aTask->hasFailed;
+	    continue;
+
+	} /* End if */
+
+	if( preTask->numDependents == preTask->maxDependents)
+	{
+	    preTask->maxDependents = ( preTask->maxDependents == 0U) ?
+		4U : ( 2U * preTask->maxDependents);
+	    preTask->dependents = (Uint32 *)( realloc(
+		preTask->dependents, preTask->maxDependents * sizeof( Uint32)
+	    ));
+
+	    if( preTask->dependents == NULL)
+	    {
+		fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+		exit( EXIT_FAILURE);
+
+	    } /* End if */
+
+	} /* End if */
+
+	preTask->dependents[preTask->numDependents++] = taskNum;
+	aTask->numPending++;
+
+    } /* End for */
+
+    aTask->taskState = ( aTask->numPending > 0U) ? TASK_WAITING : TASK_READY;
+
+    if( aTask->taskState == TASK_READY)
+    {
+	SDL_CondBroadcast( taskPool->poolChanged);
+
+    } /* End if */
+
+    SDL_UnlockMutex( taskPool->poolLock);
+
+    return taskNum;
+
+} /* End function AddPoolTask */
+
+
+GLboolean RunMainPoolTask( TaskPool *taskPool)
+{
+    Uint32 taskNum;
+
+    SDL_LockMutex( taskPool->poolLock);
+
+    while( ( ( taskNum = FindReadyTask( taskPool, GL_TRUE)) ==
+	    taskPool->numTasks) &&
+	( taskPool->numDone < taskPool->numTasks)
+    )
+    {
+	SDL_CondWait( taskPool->poolChanged, taskPool->poolLock);
+
+    } /* End while */
+
+    if( taskNum == taskPool->numTasks)
+    {
+	/* All done */
+	SDL_UnlockMutex( taskPool->poolLock);
+	return GL_FALSE;
+
+    } /* End if */
+
+    RunTask( taskPool, taskNum);
+
+    SDL_UnlockMutex( taskPool->poolLock);
+
+    return GL_TRUE;
+
+} /* End function RunMainPoolTask */
+
+
+Uint32 GetPoolProgress( TaskPool *taskPool, Uint32 *numTasks)
+{
+    Uint32 retVal;
+
+    SDL_LockMutex( taskPool->poolLock);
+    retVal = taskPool->numDone;
+    *numTasks = taskPool->numTasks;
+    SDL_UnlockMutex( taskPool->poolLock);
+
+    return retVal;
+
+} /* End function GetPoolProgress */
+
+
+GLboolean HasPoolFailed( TaskPool *taskPool)
+{
+    GLboolean retVal;
+
+    SDL_LockMutex( taskPool->poolLock);
+    retVal = taskPool->hasFailed;
+    SDL_UnlockMutex( taskPool->poolLock);
+
+    return retVal;
+
+} /* End function HasPoolFailed */
+
+
+void FreeTaskPool( TaskPool *taskPool)
+{
+    Uint32 i;
+    int t;
+
+    if( taskPool == NULL)
+    {
+	return;
+
+    } /* End if */
+
+    SDL_LockMutex( taskPool->poolLock);
+    taskPool->stopWorkers = GL_TRUE;
+    SDL_CondBroadcast( taskPool->poolChanged);
+    SDL_UnlockMutex( taskPool->poolLock);
+
+    for( t = 0; t < taskPool->numThreads; t++)
+    {
+	SDL_WaitThread( taskPool->workerThreads[t], NULL);
+
+    } /* End for */
+
+    SDL_DestroyCond( taskPool->poolChanged);
+    SDL_DestroyMutex( taskPool->poolLock);
+
+    for( i = 0U; i < taskPool->numTasks; i++)
+    {
+	free( taskPool->tasks[i].dependents);
+
+    } /* End for */
+
+    free( taskPool->tasks);
+    free( taskPool);
+
+} /* End function FreeTaskPool */
+
+
+/**
+ * Runs the tasks meant for the worker threads as they are ready, until
+ * told to stop.
+ */
+int WorkerMain( void *someData)
+{
+    TaskPool *taskPool = (TaskPool *)someData;
+    Uint32 taskNum;
+
+    SDL_LockMutex( taskPool->poolLock);
+
+    while( taskPool->stopWorkers == GL_FALSE)
+    {
+	taskNum = FindReadyTask( taskPool, GL_FALSE);
+
+	if( taskNum == taskPool->numTasks)
+	{
+	    SDL_CondWait( taskPool->poolChanged, taskPool->poolLock);
+
+	} /* End if */
+	else
+	{
+	    RunTask( taskPool, taskNum);
+
+	} /* End else */
+
+    } /* End while */
+
+    SDL_UnlockMutex( taskPool->poolLock);
+
+    return 0;
+
+} /* End function WorkerMain */
+
+
+/**
+ * Returns the first task ready to be run on the main thread, if
+ * 'onMainThread' is GL_TRUE, or else on a worker thread - or the
+ * number of tasks if there is none. Must be called with the pool's
+ * lock held.
+ */
+Uint32 FindReadyTask( TaskPool *taskPool, GLboolean onMainThread)
+{
+    Uint32 *firstTask = ( onMainThread == GL_TRUE) ?
+	&( taskPool->firstMainTask) : &( taskPool->firstWorkerTask);
+    GLboolean canSkip = GL_TRUE;
+    Uint32 i;
+
+    for( i = *firstTask; i < taskPool->numTasks; i++)
+    {
+	PoolTask *aTask = ( taskPool->tasks + i);
+
+	if( aTask->onMainThread == onMainThread)
+	{
+	    if( aTask->taskState == TASK_READY)
+	    {
+		break;
+
+	    } /* End if */
+
+	    /* Tasks waiting for others must be looked at again later */
+	    if( aTask->taskState == TASK_WAITING)
+	    {
+		canSkip = GL_FALSE;
+
+	    } /* End if */
+
+	} /* End if */
+
+	if( canSkip == GL_TRUE)
+	{
+	    *firstTask = i + 1U;
+
+	} /* End if */
+
+    } /* End for */
+
+    return i;
+
+} /* End function FindReadyTask */
+
+
+/**
+ * Runs the given ready task - unless a task it depends on failed - and
+ * sets the tasks depending on it going. Must be called with the pool's
+ * lock held, which is let go of while the task runs.
+ */
+void RunTask( TaskPool *taskPool, Uint32 taskNum)
+{
+    PoolTask *aTask = ( taskPool->tasks + taskNum);
+    PoolTaskFn taskFn = aTask->taskFn;
+    void *taskData = aTask->taskData;
+    int taskResult = -1;
+
+    aTask->taskState = TASK_RUNNING;
+
+    /* (The tasks can move as more are added while this runs) */
+    if( aTask->hasFailed == GL_FALSE)
+    {
+	SDL_UnlockMutex( taskPool->poolLock);
+	taskResult = taskFn( taskPool, taskData);
+	SDL_LockMutex( taskPool->poolLock);
+
+    } /* End if */
+
+    FinishTask( taskPool, taskNum, taskResult);
+
+} /* End function RunTask */
+
+
+/**
+ * Marks the given task as done, with the given result, and readies the
+ * tasks that were waiting only for it. Must be called with the pool's
+ * lock held.
+ */
+void FinishTask( TaskPool *taskPool, Uint32 taskNum, int taskResult)
+{
+    PoolTask *aTask = ( taskPool->tasks + taskNum);
+    Uint32 i;
+
+    aTask->taskState = TASK_DONE;
+    aTask->hasFailed = ( taskResult != 0) ? GL_TRUE : GL_FALSE;
+
+    taskPool->numDone++;
+    taskPool->hasFailed =
+	( aTask->hasFailed == GL_TRUE) ? GL_TRUE : taskPool->hasFailed;
+
+    for( i = 0U; i < aTask->numDependents; i++)
+    {
+	PoolTask *depTask = ( taskPool->tasks + aTask->dependents[i]);
+
+	depTask->hasFailed =
+	    ( aTask->hasFailed == GL_TRUE) ? GL_TRUE : depTask->hasFailed;
+
+	depTask->numPending--;
+	if( depTask->numPending == 0U)
+	{
+	    depTask->taskState = TASK_READY;
+
+	} /* End if */
+
+    } /* End for */
+
+    /* Wake up the threads waiting for tasks to run, or to be done */
+    SDL_CondBroadcast( taskPool->poolChanged);
+
+} /* End function FinishTask */
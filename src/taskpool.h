@@ -0,0 +1,163 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * TASKPOOL.H: Declarations for running a graph of tasks on a pool of
+ * threads.
+ */
+
+/**
+ * A task pool runs tasks, each as soon as the tasks it depends on are
+ * done, on a few worker threads of its own. Tasks that must be run on
+ * a particular thread (for example, those using OpenGL, which only the
+ * thread whose context is current can) are instead run by that thread,
+ * one by one, with RunMainPoolTask( ).
+ *
+ * A task can add more tasks to the pool while it runs (say, one for
+ * each texture of a model it has just read in). Each task is added
+ * along with the tasks it depends on, and if any of these fails, it
+ * is not run at all and counts as having failed too.
+ *
+ * Tasks run on the worker threads must not use OpenGL, nor anything
+ * else used by other threads without a lock. The pool's lock is held
+ * between a task finishing and the tasks depending on it starting, so
+ * they see everything it did.
+ */
+
+#ifndef _TASKPOOL_H
+#define _TASKPOOL_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+#include "SDL_thread.h"
+
+
+/* Most worker threads a pool can have */
+#define TASKPOOL_MAX_THREADS 16
+
+/* States of a task */
+#define TASK_WAITING 0    /* For the tasks it depends on */
+#define TASK_READY 1
+#define TASK_RUNNING 2
+#define TASK_DONE 3
+
+
+/* Data type definitions */
+
+struct _task_pool;
+
+/* Runs a task, given the pool it is in (to add more tasks to it) and
+ * the data given for it. Returns 0 if successful, -1 otherwise.
+ */
+typedef int (*PoolTaskFn)( struct _task_pool *taskPool, void *taskData);
+
+
+/* A task */
+typedef struct _pool_task
+{
+    PoolTaskFn taskFn;
+    void *taskData;
+    GLboolean onMainThread;
+
+    int taskState;    /* TASK_WAITING, etc. */
+    GLboolean hasFailed;
+
+    /* Number of tasks it depends on that are not yet done, and the
+     * tasks depending on it
+     */
+    Uint32 numPending;
+    Uint32 numDependents;
+    Uint32 maxDependents;
+    Uint32 *dependents;
+
+} PoolTask;
+
+
+/* A task pool */
+typedef struct _task_pool
+{
+    /* The tasks, in the order they were added, and how many of them
+     * are done - all guarded by 'poolLock' (as is 'stopWorkers')
+     */
+    Uint32 numTasks;
+    Uint32 maxTasks;
+    PoolTask *tasks;
+    Uint32 numDone;
+    GLboolean hasFailed;
+
+    /* Tasks of either kind before these are already running or done,
+     * so looking for a task to run can start here.
+     */
+    Uint32 firstWorkerTask;
+    Uint32 firstMainTask;
+
+    SDL_mutex *poolLock;
+    SDL_cond *poolChanged;
+
+    int numThreads;
+    SDL_Thread *workerThreads[TASKPOOL_MAX_THREADS];
+    GLboolean stopWorkers;
+
+} TaskPool;
+
+
+/* Function Prototypes */
+
+/**
+ * Creates a task pool with the given number of worker threads (at
+ * least 1, at most TASKPOOL_MAX_THREADS), with no tasks yet.
+ */
+extern TaskPool *GenTaskPool( int numThreads);
+
+
+/**
+ * Adds a task to the pool, to be run with the given data once the
+ * given tasks (if any) are done - on the thread calling
+ * RunMainPoolTask( ) if 'onMainThread' is GL_TRUE, or else on one of
+ * the worker threads. Can be called from any thread, including from
+ * within a task.
+ *
+ * Returns the number of the task, by which later tasks can depend on
+ * it.
+ */
+extern Uint32 AddPoolTask(
+    TaskPool *taskPool, PoolTaskFn taskFn, void *taskData,
+    GLboolean onMainThread, Uint32 numPrereqs, const Uint32 *prereqs
+);
+
+
+/**
+ * Runs the next task of the pool that is to be run on the calling
+ * thread, waiting for one to be ready if need be. Returns GL_FALSE,
+ * without waiting, once all the tasks of the pool are done.
+ */
+extern GLboolean RunMainPoolTask( TaskPool *taskPool);
+
+
+/**
+ * Returns the number of tasks of the pool that are done, and in
+ * 'numTasks' the number of its tasks so far.
+ */
+extern Uint32 GetPoolProgress( TaskPool *taskPool, Uint32 *numTasks);
+
+
+/**
+ * Returns GL_TRUE if any of the tasks of the pool failed (or was not
+ * run since a task it depended on failed).
+ */
+extern GLboolean HasPoolFailed( TaskPool *taskPool);
+
+
+/**
+ * Waits for the tasks that are running on the worker threads, stops
+ * them and frees the pool - without running the tasks still to be
+ * run.
+ */
+extern void FreeTaskPool( TaskPool *taskPool);
+
+#endif    /* _TASKPOOL_H */
@@ -0,0 +1,635 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * TEXLOAD.C: Loading of JPEG images as textures.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef VTAJ_USE_LIBJPEG
+    #include <setjmp.h>
+    #include <jpeglib.h>
+#else
+    #include "SDL_image.h"
+#endif
+
+#include "glutil.h"
+#include "dxtc.h"
+#include "texload.h"
+
+
+/* Where the colour components and the alpha of an RGBA pixel are,
+ * when it is read as a 32-bit word.
+ */
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    #define RGB_HIGH_BITS 0x00808080U
+    #define ALPHA_MASK 0xFF000000U
+#else
+    #define RGB_HIGH_BITS 0x80808000U
+    #define ALPHA_MASK 0x000000FFU
+#endif
+
+
+/* Data type definitions */
+
+#ifdef VTAJ_USE_LIBJPEG
+
+/* Lets us recover from errors in libjpeg, instead of it exiting */
+typedef struct _jpg_error_mgr
+{
+    struct jpeg_error_mgr stdMgr;
+    jmp_buf errJmpBuf;
+
+} JPGErrorMgr;
+
+#endif
+
+
+/* Local function prototypes */
+
+static Uint8 *DecodeJPG( 
+    const char *fileName, int reduceFactor, int *width, int *height
+);
+static void ApplyColourKey( Uint8 *pixels, int numPixels);
+
+#ifdef VTAJ_USE_LIBJPEG
+static void HandleJPGError( j_common_ptr cinfo);
+#else
+static void ReduceImage( 
+    Uint8 *pixels, int reduceFactor, int *width, int *height
+);
+#endif
+
+
+GLboolean IsTextureReduction( int reduceFactor)
+{
+    return ( ( reduceFactor == 1) || ( reduceFactor == 2) ||
+	( reduceFactor == 4) || ( reduceFactor == TEX_MAX_REDUCTION)
+    ) ? GL_TRUE : GL_FALSE;
+
+} /* End function IsTextureReduction */
+
+
+Uint8 *LoadJPGImage( 
+    const char *fileName, int reduceFactor, int *width, int *height
+)
+{
+    Uint8 *bbPixels = DecodeJPG( fileName, reduceFactor, width, height);
+
+    if( bbPixels != NULL)
+    {
+	ApplyColourKey( bbPixels, ( *width * *height));
+
+    } /* End if */
+
+    return bbPixels;
+
+} /* End function LoadJPGImage */
+
+
+void SetTextureParams( GLuint texObjId)
+{
+    glBindTexture( GL_TEXTURE_2D, texObjId);
+    CHECK_GL_ERROR;
+
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    CHECK_GL_ERROR;
+
+    glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    CHECK_GL_ERROR;
+
+    glTexParameteri( 
+	GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR
+    );
+    CHECK_GL_ERROR;
+
+    glTexParameteri( 
+	GL_TEXTURE_2D, 
+	GL_TEXTURE_MIN_FILTER, 
+	GL_LINEAR_MIPMAP_NEAREST
+    );
+    CHECK_GL_ERROR;
+
+} /* End function SetTextureParams */
+
+
+void UploadTexture( 
+    GLuint texObjId, int width, int height, const Uint8 *pixels
+)
+{
+    SetTextureParams( texObjId);
+
+    gluBuild2DMipmaps(
+	GL_TEXTURE_2D,
+	GL_RGBA,
+	width, height,
+	GL_RGBA, GL_UNSIGNED_BYTE,
+	pixels
+    );
+    CHECK_GL_ERROR;
+
+} /* End function UploadTexture */
+
+
+int LoadJPGTexture( const char *fileName, int reduceFactor, GLuint texObjId)
+{
+    int width, height;
+    Uint8 *pixels = LoadJPGImage( fileName, reduceFactor, &width, &height);
+
+    if( pixels == NULL)
+    {
+	return -1;
+
+    } /* End if */
+
+    UploadTexture( texObjId, width, height, pixels);
+    free( pixels);
+
+    return 0;
+
+} /* End function LoadJPGTexture */
+
+
+DXTImage *LoadDXTMipmaps( const char *fileName, int reduceFactor)
+{
+    if( hasS3TCTextures == GL_FALSE)
+    {
+	return NULL;
+
+    } /* End if */
+
+    return ReadDXTMipmaps( fileName, reduceFactor);
+
+} /* End function LoadDXTMipmaps */
+
+
+DXTImage *ReadDXTMipmaps( const char *fileName, int reduceFactor)
+{
+    FILE *dxtFile;
+    DXTImage *dxtImage;
+    int firstLevel, i;
+
+    if( ( dxtFile = fopen( fileName, "rb")) == NULL)
+    {
+	return NULL;
+
+    } /* End if */
+
+    dxtImage = LoadDXTImage( dxtFile);
+    fclose( dxtFile);
+
+    /* Without all the levels down to 1x1, the texture would not be
+     * mipmap-complete and OpenGL would not use it at all.
+     */
+    if( ( dxtImage == NULL) || ( dxtImage->numLevels == 0U) ||
+	( ( dxtImage->width >> ( dxtImage->numLevels - 1)) > 1) ||
+	( ( dxtImage->height >> ( dxtImage->numLevels - 1)) > 1)
+    )
+    {
+	FreeDXTImage( dxtImage);
+	return NULL;
+
+    } /* End if */
+
+    /* A reduced resolution just means starting further down the chain */
+    firstLevel = 0;
+    for( i = reduceFactor; 
+	( i > 1) && ( firstLevel < ( dxtImage->numLevels - 1)); 
+	i /= 2
+    )
+    {
+	firstLevel++;
+
+    } /* End for */
+
+    if( firstLevel > 0)
+    {
+	for( i = 0; i < dxtImage->numLevels; i++)
+	{
+	    if( i < firstLevel)
+	    {
+		free( dxtImage->levelData[i]);
+
+	    } /* End if */
+	    else
+	    {
+		dxtImage->levelData[i - firstLevel] = dxtImage->levelData[i];
+
+	    } /* End else */
+
+	} /* End for */
+
+	dxtImage->numLevels -= (Uint8 )firstLevel;
+	dxtImage->width = (Uint16 )( dxtImage->width >> firstLevel);
+	dxtImage->height = (Uint16 )( dxtImage->height >> firstLevel);
+	dxtImage->width = ( dxtImage->width > 0U) ? dxtImage->width : 1U;
+	dxtImage->height = ( dxtImage->height > 0U) ? dxtImage->height : 1U;
+
+    } /* End if */
+
+    return dxtImage;
+
+} /* End function ReadDXTMipmaps */
+
+
+int LoadDXTTexture( const char *fileName, int reduceFactor, GLuint texObjId)
+{
+    DXTImage *dxtImage;
+    int i;
+
+    if( ( dxtImage = LoadDXTMipmaps( fileName, reduceFactor)) == NULL)
+    {
+	return -1;
+
+    } /* End if */
+
+    SetTextureParams( texObjId);
+
+    for( i = 0; i < dxtImage->numLevels; i++)
+    {
+	int levelWidth = ( dxtImage->width >> i);
+	int levelHeight = ( dxtImage->height >> i);
+
+	levelWidth = ( levelWidth > 0) ? levelWidth : 1;
+	levelHeight = ( levelHeight > 0) ? levelHeight : 1;
+
+	pglCompressedTexImage2D(
+	    GL_TEXTURE_2D,
+	    i,
+	    GL_COMPRESSED_RGBA_S3TC_DXT1_EXT,
+	    levelWidth, levelHeight,
+	    0,
+	    (GLsizei )GetDXT1Size( levelWidth, levelHeight),
+	    dxtImage->levelData[i]
+	);
+	CHECK_GL_ERROR;
+
+    } /* End for */
+
+    FreeDXTImage( dxtImage);
+
+    return 0;
+
+} /* End function LoadDXTTexture */
+
+
+Uint8 *HalveImage( const Uint8 *rgbaPixels, int width, int height)
+{
+    int newWidth = ( width > 1) ? ( width / 2) : 1;
+    int newHeight = ( height > 1) ? ( height / 2) : 1;
+    Uint8 *retVal;
+    int x, y, i, j, m;
+
+    retVal = (Uint8 *)( malloc( 4 * newWidth * newHeight * sizeof( Uint8)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( y = 0; y < newHeight; y++)
+    {
+	for( x = 0; x < newWidth; x++)
+	{
+	    int allSum[3], opaqueSum[3];
+	    int numOpaque = 0;
+	    Uint8 *newTexel = ( retVal + 4 * ( y*newWidth + x));
+
+	    for( m = 0; m < 3; m++)
+	    {
+		allSum[m] = opaqueSum[m] = 0;
+
+	    } /* End for */
+
+	    for( j = 0; j < 2; j++)
+	    {
+		int srcY = ( ( 2*y + j) < height) ? ( 2*y + j) : ( height - 1);
+
+		for( i = 0; i < 2; i++)
+		{
+		    int srcX = ( ( 2*x + i) < width) ? ( 2*x + i) : ( width - 1);
+		    const Uint8 *srcTexel = 
+			( rgbaPixels + 4 * ( srcY*width + srcX));
+
+		    for( m = 0; m < 3; m++)
+		    {
+			allSum[m] += srcTexel[m];
+
+		    } /* End for */
+
+		    if( srcTexel[3] >= TEX_ALPHA_LIMIT)
+		    {
+			numOpaque++;
+			for( m = 0; m < 3; m++)
+			{
+			    opaqueSum[m] += srcTexel[m];
+
+			} /* End for */
+
+		    } /* End if */
+
+		} /* End for */
+
+	    } /* End for */
+
+	    for( m = 0; m < 3; m++)
+	    {
+		newTexel[m] = ( numOpaque > 0) ?
+		    (Uint8 )( ( opaqueSum[m] + numOpaque / 2) / numOpaque) :
+		    (Uint8 )( ( allSum[m] + 2) / 4);
+
+	    } /* End for */
+
+	    newTexel[3] = ( numOpaque >= 2) ? 0xFF : 0x00;
+
+	} /* End for */
+
+    } /* End for */
+
+    return retVal;
+
+} /* End function HalveImage */
+
+
+#ifdef VTAJ_USE_LIBJPEG
+
+/**
+ * Decodes the given JPEG image with libjpeg into packed RGBA pixels,
+ * reducing its resolution as it is decoded if needed. The alpha
+ * channel is left for ApplyColourKey( ) to fill in.
+ */
+Uint8 *DecodeJPG( 
+    const char *fileName, int reduceFactor, int *width, int *height
+)
+{
+    struct jpeg_decompress_struct cinfo;
+    JPGErrorMgr errMgr;
+    FILE *jpgFile;
+    Uint8 * volatile bbPixels = NULL;
+
+    if( ( jpgFile = fopen( fileName, "rb")) == NULL)
+    {
+	fprintf( 
+	    stderr,
+	    "\nERROR: Could not load image \"%s\"\n", fileName
+	);
+	perror( "Details");
+	fflush( stderr);
+	return NULL;
+
+    } /* End if */
+
+    cinfo.err = jpeg_std_error( &errMgr.stdMgr);
+    errMgr.stdMgr.error_exit = HandleJPGError;
+
+    if( setjmp( errMgr.errJmpBuf) != 0)
+    {
+	/* libjpeg has already printed the details */
+	fprintf( 
+	    stderr,
+	    "\nERROR: Could not load image \"%s\"\n", fileName
+	);
+	fflush( stderr);
+
+	jpeg_destroy_decompress( &cinfo);
+	fclose( jpgFile);
+	free( bbPixels);
+	return NULL;
+
+    } /* End if */
+
+    jpeg_create_decompress( &cinfo);
+    jpeg_stdio_src( &cinfo, jpgFile);
+    jpeg_read_header( &cinfo, TRUE);
+
+    /* Let the inverse DCT produce the reduced image directly */
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = (unsigned int )reduceFactor;
+
+#ifdef JCS_EXTENSIONS
+    cinfo.out_color_space = JCS_EXT_RGBA;
+#else
+    cinfo.out_color_space = JCS_RGB;
+#endif
+
+    jpeg_start_decompress( &cinfo);
+
+    *width = (int )cinfo.output_width;
+    *height = (int )cinfo.output_height;
+
+    bbPixels = (Uint8 *)( malloc( 4 * *width * *height * sizeof( Uint8)));
+    if( bbPixels == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    while( cinfo.output_scanline < cinfo.output_height)
+    {
+	JSAMPROW aRow;
+
+	aRow = (JSAMPROW )( bbPixels + 4 * *width * cinfo.output_scanline);
+	jpeg_read_scanlines( &cinfo, &aRow, 1);
+
+#ifndef JCS_EXTENSIONS
+	{
+	    int i;
+
+	    /* Spread out the RGB pixels of the row, from its end */
+	    for( i = ( *width - 1); i >= 0; i--)
+	    {
+		aRow[4*i + 2] = aRow[3*i + 2];
+		aRow[4*i + 1] = aRow[3*i + 1];
+		aRow[4*i + 0] = aRow[3*i + 0];
+
+	    } /* End for */
+	}
+#endif
+
+    } /* End while */
+
+    jpeg_finish_decompress( &cinfo);
+    jpeg_destroy_decompress( &cinfo);
+    fclose( jpgFile);
+
+    return bbPixels;
+
+} /* End function DecodeJPG */
+
+
+/**
+ * Called by libjpeg on errors - prints the error and returns to
+ * DecodeJPG( ).
+ */
+void HandleJPGError( j_common_ptr cinfo)
+{
+    JPGErrorMgr *errMgr = (JPGErrorMgr *)( cinfo->err);
+
+    ( *( cinfo->err->output_message))( cinfo);
+
+    longjmp( errMgr->errJmpBuf, 1);
+
+} /* End function HandleJPGError */
+
+#else
+
+/**
+ * Decodes the given JPEG image with SDL_image into packed RGBA pixels,
+ * reducing its resolution afterwards if needed. The alpha channel is
+ * left for ApplyColourKey( ) to fill in.
+ */
+Uint8 *DecodeJPG( 
+    const char *fileName, int reduceFactor, int *width, int *height
+)
+{
+    SDL_Surface *image = NULL;
+    Uint8 *bbPixels = NULL;
+
+    image = IMG_Load( fileName);
+
+    if( image != NULL)
+    {
+	int i, totalPixels = ( image->w * image->h);
+
+	bbPixels = (Uint8 *)( malloc( 4 * totalPixels * sizeof( Uint8)));
+	if( bbPixels == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	for( i = 0; i < totalPixels; i++)
+	{
+	    /* For the moment, assume 24-bit RGB in 
+	     * little-endian form.
+	     */
+
+	    bbPixels[4*i + 0] = ((Uint8 *)( image->pixels))[3*i + 0];
+	    bbPixels[4*i + 1] = ((Uint8 *)( image->pixels))[3*i + 1];
+	    bbPixels[4*i + 2] = ((Uint8 *)( image->pixels))[3*i + 2];
+
+	} /* End for */
+
+	*width = image->w;
+	*height = image->h;
+
+	SDL_FreeSurface( image);
+
+	if( reduceFactor > 1)
+	{
+	    ReduceImage( bbPixels, reduceFactor, width, height);
+
+	} /* End if */
+
+    } /* End if */
+    else
+    {
+	fprintf( 
+	    stderr,
+	    "\nERROR: Could not load image \"%s\" (%s)\n",
+	    fileName, SDL_GetError( )
+	);
+	fflush( stderr);
+
+    } /* End else */
+
+    return bbPixels;
+
+} /* End function DecodeJPG */
+
+
+/**
+ * Reduces the resolution of the given RGB(A) image in place, by
+ * averaging blocks of ( reduceFactor x reduceFactor) pixels.
+ */
+void ReduceImage( Uint8 *pixels, int reduceFactor, int *width, int *height)
+{
+    int newWidth = ( *width / reduceFactor);
+    int newHeight = ( *height / reduceFactor);
+    int numSummed = ( reduceFactor * reduceFactor);
+    int x, y, i, j, m;
+
+    /* Each reduced pixel is written out before (or over) the first of
+     * the pixels it is made of, so none of the pixels still needed is
+     * overwritten.
+     */
+    for( y = 0; y < newHeight; y++)
+    {
+	for( x = 0; x < newWidth; x++)
+	{
+	    for( m = 0; m < 3; m++)
+	    {
+		int compSum = 0;
+
+		for( j = 0; j < reduceFactor; j++)
+		{
+		    for( i = 0; i < reduceFactor; i++)
+		    {
+			compSum += pixels[
+			    4 * ( ( y*reduceFactor + j) * *width +
+			    ( x*reduceFactor + i)) + m
+			];
+
+		    } /* End for */
+
+		} /* End for */
+
+		pixels[4 * ( y*newWidth + x) + m] = 
+		    (Uint8 )( ( compSum + ( numSummed / 2)) / numSummed);
+
+	    } /* End for */
+
+	} /* End for */
+
+    } /* End for */
+
+    *width = newWidth;
+    *height = newHeight;
+
+} /* End function ReduceImage */
+
+#endif    /* VTAJ_USE_LIBJPEG */
+
+
+/**
+ * Sets the alpha of each of the given RGBA pixels - zero if all of its
+ * colour components are at or below TEX_BLACK_LIMIT, 255 otherwise.
+ *
+ * The colour components of a pixel are tested together, as the bytes
+ * of a 32-bit word: adding ( 0x7F - TEX_BLACK_LIMIT) to the low seven
+ * bits of a byte sets its high bit if they are above the limit, without
+ * a carry into the next byte; OR-ing in the original high bit then
+ * covers bytes of 128 or more.
+ */
+void ApplyColourKey( Uint8 *pixels, int numPixels)
+{
+    Uint32 *rgbaWords = (Uint32 *)pixels;
+    int i;
+
+    for( i = 0; i < numPixels; i++)
+    {
+	Uint32 pixVal = rgbaWords[i];
+	Uint32 aboveLimit;
+
+	aboveLimit = ( 
+	    ( ( pixVal & 0x7F7F7F7FU) + 
+	      ( 0x01010101U * ( 0x7FU - TEX_BLACK_LIMIT))
+	    ) | pixVal
+	) & RGB_HIGH_BITS;
+
+	rgbaWords[i] = ( pixVal & ~ALPHA_MASK) | 
+	    ( ( aboveLimit != 0U) ? ALPHA_MASK : 0U);
+
+    } /* End for */
+
+} /* End function ApplyColourKey */
+
+
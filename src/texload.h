@@ -0,0 +1,147 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * TEXLOAD.H: Declarations for the texture loading functions.
+ */
+
+/**
+ * Textures are JPEG images. Since JPEG has no alpha channel, one is
+ * created while loading an image - "sufficiently black" pixels are
+ * considered transparent. This is used to show the grills in the
+ * Taj interiors (which are drawn with the alpha test enabled).
+ *
+ * Decoding an image and handing it over to OpenGL are separate steps,
+ * so that decoded images can be kept around and uploaded to more than
+ * one OpenGL context.
+ *
+ * Images are normally decoded through SDL_image. If VTAJ_USE_LIBJPEG
+ * is defined, they are instead decoded directly with libjpeg (ideally
+ * libjpeg-turbo, which can write out RGBA pixels itself), into the
+ * buffer that is finally returned. Reduced-resolution images are then
+ * produced by libjpeg while decoding, at a fraction of the cost of
+ * decoding the full image.
+ *
+ * Textures can also be loaded from DXT files (see "dxtc.h") made
+ * offline by "jpg2dxt", if the OpenGL implementation supports S3TC
+ * compressed textures. Such textures are uploaded as they are, with
+ * their precomputed mipmaps, and take up an eighth of the memory.
+ */
+
+#ifndef _TEXLOAD_H
+#define _TEXLOAD_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+#include "dxtc.h"
+
+
+/* Pixels with all of their colour components at or below this value
+ * are made transparent.
+ */
+#define TEX_BLACK_LIMIT 5
+
+/* Texels with an alpha below this are transparent */
+#define TEX_ALPHA_LIMIT 128
+
+/* Largest factor by which the resolution of images can be reduced */
+#define TEX_MAX_REDUCTION 8
+
+
+/* Function Prototypes */
+
+/**
+ * Returns GL_TRUE if images can be loaded at ( 1 / reduceFactor) of
+ * their width and height - that is, if 'reduceFactor' is 1 (no
+ * reduction), 2, 4 or TEX_MAX_REDUCTION. The functions below taking
+ * a 'reduceFactor' must be given one of these.
+ */
+extern GLboolean IsTextureReduction( int reduceFactor);
+
+
+/**
+ * Decodes the given JPEG image into packed RGBA pixels (with the
+ * first row at the top), creating the alpha channel as described
+ * above, at ( 1 / reduceFactor) of its resolution. The width and
+ * height of the (reduced) image are returned in the given variables.
+ *
+ * Returns the pixels (to be freed by the caller), or NULL on error.
+ */
+extern Uint8 *LoadJPGImage( 
+    const char *fileName, int reduceFactor, int *width, int *height
+);
+
+
+/**
+ * Binds the given texture object and sets up its wrapping (repeating)
+ * and filtering (mipmapped) modes.
+ */
+extern void SetTextureParams( GLuint texObjId);
+
+
+/**
+ * Makes the given RGBA image the (mipmapped, repeating) texture image
+ * of the given texture object, in the current OpenGL context.
+ */
+extern void UploadTexture( 
+    GLuint texObjId, int width, int height, const Uint8 *pixels
+);
+
+
+/**
+ * Loads the given JPEG image, at ( 1 / reduceFactor) of its
+ * resolution, as the texture image of the given texture object.
+ * Returns 0 if successful, -1 otherwise.
+ */
+extern int LoadJPGTexture( 
+    const char *fileName, int reduceFactor, GLuint texObjId
+);
+
+
+/**
+ * Loads the given DXT file, dropping the largest mipmap levels if the
+ * resolution is reduced by 'reduceFactor'. Returns NULL if S3TC
+ * textures are not supported, or if the file could not be loaded or
+ * does not have all the levels down to 1x1.
+ */
+extern DXTImage *LoadDXTMipmaps( const char *fileName, int reduceFactor);
+
+
+/**
+ * Loads the given DXT file as LoadDXTMipmaps( ) does, but whether or
+ * not S3TC textures are supported - so that it can be called before
+ * the OpenGL implementation is known.
+ */
+extern DXTImage *ReadDXTMipmaps( const char *fileName, int reduceFactor);
+
+
+/**
+ * Loads the given DXT file as the compressed texture image of the
+ * given texture object, skipping the largest mipmap levels if the
+ * resolution is reduced by 'reduceFactor'. Returns 0 if successful,
+ * -1 if S3TC textures are not supported or the file could not be
+ * loaded.
+ */
+extern int LoadDXTTexture( 
+    const char *fileName, int reduceFactor, GLuint texObjId
+);
+
+
+/**
+ * Returns a newly allocated RGBA image of half the width and height of
+ * the given one (but at least 1x1), to be freed by the caller. Each
+ * texel is opaque if at least half of the texels it replaces are, and
+ * is the average of the opaque ones among them - transparent texels
+ * are black, and would otherwise darken the edges of the opaque parts.
+ */
+extern Uint8 *HalveImage( const Uint8 *rgbaPixels, int width, int height);
+
+#endif    /* _TEXLOAD_H */
+
+
@@ -0,0 +1,753 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * TEXSTREAM.C: Streaming in the mipmap levels of textures as they are
+ * needed.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+
+#include "glutil.h"
+#include "texload.h"
+#include "texstream.h"
+
+
+/* Distances closer than this are treated as this */
+#define TEXSTREAM_MIN_DIST 1.0F
+
+/* Triangles spanning less than this in both texture coordinates show
+ * just a texel or two of a texture.
+ */
+#define TEXSTREAM_MIN_UV_SPAN ( 1.0F / 512.0F)
+
+
+/* Local function prototypes */
+
+static Uint32 GetLevelSize( StreamedTex *aTex, int level);
+static void UploadLevel( StreamedTex *aTex, int level);
+
+
+TexStream *GenTexStream( Uint16 numTex, const GLuint *texObjIds)
+{
+    TexStream *retVal;
+    Uint16 i;
+
+    retVal = (TexStream *)( malloc( sizeof( TexStream)));
+
+    /* NOTE: Uses calloc( ) to initialise the contents to 0 */
+    if( ( retVal == NULL) || ( ( retVal->textures = 
+	    (StreamedTex *)( calloc( numTex, sizeof( StreamedTex)))) == NULL)
+    )
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->numTex = numTex;
+    retVal->canStream = hasTextureLOD;
+    retVal->frameNum = 0U;
+    retVal->nextTex = 0U;
+
+    retVal->totalBytes = retVal->residentBytes = retVal->peakBytes = 0U;
+    retVal->numUploads = retVal->numEvictions = 0U;
+
+    for( i = 0U; i < numTex; i++)
+    {
+	retVal->textures[i].texObjId = texObjIds[i];
+
+    } /* End for */
+
+    ClearStreamedTexTriangles( retVal);
+
+    return retVal;
+
+} /* End function GenTexStream */
+
+
+void ClearStreamedTexTriangles( TexStream *texStream)
+{
+    Uint16 i;
+    int m;
+
+    for( i = 0U; i < texStream->numTex; i++)
+    {
+	StreamedTex *aTex = ( texStream->textures + i);
+
+	for( m = 0; m < 3; m++)
+	{
+	    aTex->minCorner[m] = FLT_MAX;
+	    aTex->maxCorner[m] = -FLT_MAX;
+
+	} /* End for */
+
+	aTex->unitsPerUV = 0.0F;
+
+    } /* End for */
+
+} /* End function ClearStreamedTexTriangles */
+
+
+void NoteStreamedTexTriangle( 
+    TexStream *texStream, Uint16 texNum,
+    const GLfloat *vertCoords, Uint32 vertStride,
+    const GLfloat *texCoords, Uint32 texStride,
+    const Uint16 vIndices[3]
+)
+{
+    StreamedTex *aTex = ( texStream->textures + texNum);
+    const GLfloat *vert0, *vert1, *vert2;
+    const GLfloat *texCoord0, *texCoord1, *texCoord2;
+    GLfloat edge1[3], edge2[3], len1, e2X, e2Y;
+    GLfloat uvSpan[2], uvGrad[2][2], sumSqr, aDet, discrim, maxGrad;
+    int k, m;
+
+    for( k = 0; k < 3; k++)
+    {
+	const GLfloat *aVert = ( vertCoords + vertStride*vIndices[k]);
+
+	for( m = 0; m < 3; m++)
+	{
+	    aTex->minCorner[m] = 
+		( aVert[m] < aTex->minCorner[m]) ? aVert[m] : aTex->minCorner[m];
+	    aTex->maxCorner[m] = 
+		( aVert[m] > aTex->maxCorner[m]) ? aVert[m] : aTex->maxCorner[m];
+
+	} /* End for */
+
+    } /* End for */
+
+
+    texCoord0 = ( texCoords + texStride*vIndices[0]);
+    texCoord1 = ( texCoords + texStride*vIndices[1]);
+    texCoord2 = ( texCoords + texStride*vIndices[2]);
+
+    /* Triangles with (almost) no texture coordinate variation show
+     * just a texel or two, and do not need the larger levels.
+     */
+    for( m = 0; m < 2; m++)
+    {
+	GLfloat minCoord, maxCoord;
+
+	minCoord = ( texCoord0[m] < texCoord1[m]) ? texCoord0[m] : texCoord1[m];
+	minCoord = ( texCoord2[m] < minCoord) ? texCoord2[m] : minCoord;
+	maxCoord = ( texCoord0[m] > texCoord1[m]) ? texCoord0[m] : texCoord1[m];
+	maxCoord = ( texCoord2[m] > maxCoord) ? texCoord2[m] : maxCoord;
+
+	uvSpan[m] = maxCoord - minCoord;
+
+    } /* End for */
+
+    if( ( uvSpan[0] < TEXSTREAM_MIN_UV_SPAN) && 
+	( uvSpan[1] < TEXSTREAM_MIN_UV_SPAN)
+    )
+    {
+	return;
+
+    } /* End if */
+
+
+    /* OpenGL chooses the mipmap level from how fast the texture
+     * coordinates change in the direction they change the fastest
+     * in. With the edges from the first vertex in the plane of the
+     * triangle as ( len1, 0) and ( e2X, e2Y), this is the largest
+     * singular value of the matrix mapping those to the changes in
+     * (u,v). Where this is the slowest, the texels look the largest.
+     */
+    vert0 = ( vertCoords + vertStride*vIndices[0]);
+    vert1 = ( vertCoords + vertStride*vIndices[1]);
+    vert2 = ( vertCoords + vertStride*vIndices[2]);
+
+    len1 = 0.0F;
+    for( m = 0; m < 3; m++)
+    {
+	edge1[m] = vert1[m] - vert0[m];
+	edge2[m] = vert2[m] - vert0[m];
+	len1 += edge1[m] * edge1[m];
+
+    } /* End for */
+
+    len1 = (GLfloat )sqrt( len1);
+    if( len1 < 1.0e-6F)
+    {
+	return;
+
+    } /* End if */
+
+    e2X = ( edge1[0]*edge2[0] + edge1[1]*edge2[1] + edge1[2]*edge2[2]) / len1;
+
+    e2Y = 0.0F;
+    for( m = 0; m < 3; m++)
+    {
+	GLfloat perpComp = edge2[m] - ( e2X * edge1[m] / len1);
+
+	e2Y += perpComp * perpComp;
+
+    } /* End for */
+
+    e2Y = (GLfloat )sqrt( e2Y);
+    if( e2Y < 1.0e-6F)
+    {
+	return;
+
+    } /* End if */
+
+    for( m = 0; m < 2; m++)
+    {
+	GLfloat delta1 = texCoord1[m] - texCoord0[m];
+	GLfloat delta2 = texCoord2[m] - texCoord0[m];
+
+	uvGrad[m][0] = delta1 / len1;
+	uvGrad[m][1] = ( delta2 - ( delta1 * e2X / len1)) / e2Y;
+
+    } /* End for */
+
+    sumSqr = uvGrad[0][0]*uvGrad[0][0] + uvGrad[0][1]*uvGrad[0][1] +
+	uvGrad[1][0]*uvGrad[1][0] + uvGrad[1][1]*uvGrad[1][1];
+    aDet = uvGrad[0][0]*uvGrad[1][1] - uvGrad[0][1]*uvGrad[1][0];
+
+    discrim = sumSqr*sumSqr - 4.0F*aDet*aDet;
+    discrim = ( discrim > 0.0F) ? discrim : 0.0F;
+    maxGrad = (GLfloat )sqrt( ( sumSqr + sqrt( discrim)) / 2.0F);
+
+    if( maxGrad > 1.0e-6F)
+    {
+	aTex->unitsPerUV = ( ( 1.0F / maxGrad) > aTex->unitsPerUV) ? 
+	    ( 1.0F / maxGrad) : aTex->unitsPerUV;
+
+    } /* End if */
+
+} /* End function NoteStreamedTexTriangle */
+
+
+TexImage *LoadTexImage( 
+    const char *dxtFileName, const char *jpgFileName, int reduceFactor
+)
+{
+    return ReadTexImage( 
+	( ( hasS3TCTextures == GL_TRUE) ? dxtFileName : NULL), jpgFileName,
+	reduceFactor
+    );
+
+} /* End function LoadTexImage */
+
+
+TexImage *ReadTexImage( 
+    const char *dxtFileName, const char *jpgFileName, int reduceFactor
+)
+{
+    TexImage *retVal;
+    DXTImage *dxtImage = NULL;
+    int i;
+
+    /* NOTE: Uses calloc( ) to initialise the contents to 0 */
+    retVal = (TexImage *)( calloc( 1, sizeof( TexImage)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    /* Prefer the compressed image from the texture cache */
+    if( ( dxtFileName != NULL) && 
+	( ( dxtImage = ReadDXTMipmaps( dxtFileName, reduceFactor)) != NULL)
+    )
+    {
+	retVal->texFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	retVal->width = dxtImage->width;
+	retVal->height = dxtImage->height;
+	retVal->numLevels = dxtImage->numLevels;
+
+	for( i = 0; i < retVal->numLevels; i++)
+	{
+	    retVal->levelData[i] = dxtImage->levelData[i];
+
+	} /* End for */
+
+	/* The levels now belong to the image */
+	dxtImage->numLevels = 0U;
+	FreeDXTImage( dxtImage);
+
+    } /* End if */
+    else
+    {
+	int levelWidth, levelHeight;
+	Uint8 *rgbaPixels;
+
+	rgbaPixels = LoadJPGImage( 
+	    jpgFileName, reduceFactor, &levelWidth, &levelHeight
+	);
+	if( rgbaPixels == NULL)
+	{
+	    free( retVal);
+	    return NULL;
+
+	} /* End if */
+
+	retVal->texFormat = GL_RGBA;
+	retVal->width = levelWidth;
+	retVal->height = levelHeight;
+	retVal->levelData[0] = rgbaPixels;
+	retVal->numLevels = 1;
+
+	while( ( ( levelWidth > 1) || ( levelHeight > 1)) &&
+	    ( retVal->numLevels < DXT_MAX_LEVELS)
+	)
+	{
+	    retVal->levelData[retVal->numLevels] = HalveImage( 
+		retVal->levelData[retVal->numLevels - 1], levelWidth, levelHeight
+	    );
+	    retVal->numLevels++;
+
+	    levelWidth = ( levelWidth > 1) ? ( levelWidth / 2) : 1;
+	    levelHeight = ( levelHeight > 1) ? ( levelHeight / 2) : 1;
+
+	} /* End while */
+
+    } /* End else */
+
+    return retVal;
+
+} /* End function ReadTexImage */
+
+
+void FreeTexImage( TexImage *texImage)
+{
+    if( texImage != NULL)
+    {
+	int i;
+
+	for( i = 0; i < texImage->numLevels; i++)
+	{
+	    free( texImage->levelData[i]);
+
+	} /* End for */
+
+	free( texImage);
+
+    } /* End if */
+
+} /* End function FreeTexImage */
+
+
+int LoadStreamedTexture( 
+    TexStream *texStream, Uint16 texNum,
+    const char *dxtFileName, const char *jpgFileName, int reduceFactor
+)
+{
+    TexImage *texImage;
+
+    texImage = LoadTexImage( dxtFileName, jpgFileName, reduceFactor);
+    if( texImage == NULL)
+    {
+	return -1;
+
+    } /* End if */
+
+    SetStreamedTexImage( texStream, texNum, texImage);
+
+    return 0;
+
+} /* End function LoadStreamedTexture */
+
+
+void SetStreamedTexImage( 
+    TexStream *texStream, Uint16 texNum, TexImage *texImage
+)
+{
+    StreamedTex *aTex = ( texStream->textures + texNum);
+    int i;
+
+    /* Let go of the image replaced, if any */
+    for( i = 0; i < aTex->numLevels; i++)
+    {
+	Uint32 levelSize = GetLevelSize( aTex, i);
+
+	texStream->totalBytes -= levelSize;
+	if( i >= aTex->residentLevel)
+	{
+	    texStream->residentBytes -= levelSize;
+
+	} /* End if */
+
+	free( aTex->levelData[i]);
+	aTex->levelData[i] = NULL;
+
+    } /* End for */
+
+    aTex->texFormat = texImage->texFormat;
+    aTex->width = texImage->width;
+    aTex->height = texImage->height;
+    aTex->numLevels = texImage->numLevels;
+
+    for( i = 0; i < aTex->numLevels; i++)
+    {
+	aTex->levelData[i] = texImage->levelData[i];
+
+    } /* End for */
+
+    /* The levels now belong to the texture */
+    free( texImage);
+
+
+    /* Work out which levels are always resident */
+    aTex->coarseLevel = 0;
+    if( texStream->canStream == GL_TRUE)
+    {
+	while( ( aTex->coarseLevel < ( aTex->numLevels - 1)) &&
+	    ( ( ( aTex->width >> aTex->coarseLevel) > TEXSTREAM_RESIDENT_SIZE) ||
+	      ( ( aTex->height >> aTex->coarseLevel) > TEXSTREAM_RESIDENT_SIZE))
+	)
+	{
+	    aTex->coarseLevel++;
+
+	} /* End while */
+
+    } /* End if */
+
+    aTex->residentLevel = aTex->wantedLevel = aTex->coarseLevel;
+    aTex->lastWanted = texStream->frameNum;
+
+    SetTextureParams( aTex->texObjId);
+
+    if( texStream->canStream == GL_TRUE)
+    {
+	glTexParameteri( 
+	    GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, ( aTex->numLevels - 1)
+	);
+	CHECK_GL_ERROR;
+
+	glTexParameteri( 
+	    GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, aTex->coarseLevel
+	);
+	CHECK_GL_ERROR;
+
+    } /* End if */
+
+    for( i = 0; i < aTex->numLevels; i++)
+    {
+	Uint32 levelSize = GetLevelSize( aTex, i);
+
+	texStream->totalBytes += levelSize;
+
+	if( i >= aTex->coarseLevel)
+	{
+	    UploadLevel( aTex, i);
+	    texStream->residentBytes += levelSize;
+
+	} /* End if */
+
+    } /* End for */
+
+    texStream->peakBytes = ( texStream->residentBytes > texStream->peakBytes) ?
+	texStream->residentBytes : texStream->peakBytes;
+
+    /* Without streaming, there is no need to keep the images around */
+    if( texStream->canStream == GL_FALSE)
+    {
+	for( i = 0; i < aTex->numLevels; i++)
+	{
+	    free( aTex->levelData[i]);
+	    aTex->levelData[i] = NULL;
+
+	} /* End for */
+
+    } /* End if */
+
+} /* End function SetStreamedTexImage */
+
+
+void RequestStreamedTex( 
+    TexStream *texStream, Uint16 texNum, 
+    const GLfloat eyePos[3], GLdouble pixelScale
+)
+{
+    StreamedTex *aTex = ( texStream->textures + texNum);
+    GLdouble texelsPerPixel, distSqr = 0.0;
+    int wantedLevel;
+    int m;
+
+    if( ( aTex->numLevels == 0) || ( aTex->unitsPerUV == 0.0F))
+    {
+	/* Not loaded, or has no texture coordinate variation */
+	return;
+
+    } /* End if */
+
+    /* Distance to the nearest point of the bounds of the triangles */
+    for( m = 0; m < 3; m++)
+    {
+	GLdouble delta = 0.0;
+
+	if( eyePos[m] < aTex->minCorner[m])
+	{
+	    delta = aTex->minCorner[m] - eyePos[m];
+
+	} /* End if */
+	else if( eyePos[m] > aTex->maxCorner[m])
+	{
+	    delta = eyePos[m] - aTex->maxCorner[m];
+
+	} /* End else-if */
+
+	distSqr += delta * delta;
+
+    } /* End for */
+
+    distSqr = ( distSqr > ( TEXSTREAM_MIN_DIST * TEXSTREAM_MIN_DIST)) ?
+	distSqr : ( TEXSTREAM_MIN_DIST * TEXSTREAM_MIN_DIST);
+
+    /* A texel of the largest level is ( unitsPerUV / texture size)
+     * units long, and that many times 'pixelScale' divided by the
+     * distance pixels long on the screen.
+     */
+    texelsPerPixel = sqrt( distSqr) * 
+	(GLdouble )( ( aTex->width > aTex->height) ? 
+	    aTex->width : aTex->height) /
+	( aTex->unitsPerUV * pixelScale);
+
+    wantedLevel = 0;
+    while( ( texelsPerPixel >= 2.0) && ( wantedLevel < aTex->coarseLevel))
+    {
+	texelsPerPixel /= 2.0;
+	wantedLevel++;
+
+    } /* End while */
+
+    aTex->wantedLevel = 
+	( wantedLevel < aTex->wantedLevel) ? wantedLevel : aTex->wantedLevel;
+
+} /* End function RequestStreamedTex */
+
+
+void UpdateTexStream( TexStream *texStream)
+{
+    Uint32 bytesLeft = TEXSTREAM_UPLOAD_BUDGET;
+    GLboolean budgetOver = GL_FALSE;
+    Uint16 n;
+
+    if( texStream->canStream == GL_FALSE)
+    {
+	return;
+
+    } /* End if */
+
+    for( n = 0U; n < texStream->numTex; n++)
+    {
+	Uint16 texNum = (Uint16 )( ( texStream->nextTex + n) % texStream->numTex);
+	StreamedTex *aTex = ( texStream->textures + texNum);
+	GLboolean levelsChanged = GL_FALSE;
+
+	if( aTex->numLevels == 0)
+	{
+	    continue;
+
+	} /* End if */
+
+	if( aTex->wantedLevel <= aTex->residentLevel)
+	{
+	    aTex->lastWanted = texStream->frameNum;
+
+	} /* End if */
+
+
+	/* Stream in the wanted levels, the smaller ones first. The first
+	 * frame is not held to the budget, so that the demo does not
+	 * start out blurred. Otherwise at least one level is uploaded in
+	 * a frame, however large.
+	 */
+	while( ( budgetOver == GL_FALSE) && 
+	    ( aTex->wantedLevel < aTex->residentLevel)
+	)
+	{
+	    Uint32 levelSize = GetLevelSize( aTex, ( aTex->residentLevel - 1));
+
+	    if( ( texStream->frameNum > 0U) && ( levelSize > bytesLeft) &&
+		( bytesLeft < TEXSTREAM_UPLOAD_BUDGET)
+	    )
+	    {
+		/* Let this texture go first in the next frame */
+		budgetOver = GL_TRUE;
+		texStream->nextTex = texNum;
+		break;
+
+	    } /* End if */
+
+	    if( levelsChanged == GL_FALSE)
+	    {
+		glBindTexture( GL_TEXTURE_2D, aTex->texObjId);
+		CHECK_GL_ERROR;
+
+	    } /* End if */
+
+	    aTex->residentLevel--;
+	    UploadLevel( aTex, aTex->residentLevel);
+	    levelsChanged = GL_TRUE;
+
+	    bytesLeft = ( levelSize < bytesLeft) ? ( bytesLeft - levelSize) : 0U;
+	    texStream->residentBytes += levelSize;
+	    texStream->numUploads++;
+
+	} /* End while */
+
+
+	/* Drop the largest level if it has not been wanted for a while */
+	if( ( aTex->residentLevel < aTex->coarseLevel) &&
+	    ( ( texStream->frameNum - aTex->lastWanted) > TEXSTREAM_EVICT_FRAMES)
+	)
+	{
+	    if( levelsChanged == GL_FALSE)
+	    {
+		glBindTexture( GL_TEXTURE_2D, aTex->texObjId);
+		CHECK_GL_ERROR;
+
+	    } /* End if */
+
+	    /* An empty image frees the memory taken by the level */
+	    glTexImage2D( 
+		GL_TEXTURE_2D, aTex->residentLevel, GL_RGBA, 0, 0, 0,
+		GL_RGBA, GL_UNSIGNED_BYTE, NULL
+	    );
+	    CHECK_GL_ERROR;
+
+	    texStream->residentBytes -= GetLevelSize( aTex, aTex->residentLevel);
+	    texStream->numEvictions++;
+
+	    aTex->residentLevel++;
+	    levelsChanged = GL_TRUE;
+
+	    /* The next level goes only after another while */
+	    aTex->lastWanted = texStream->frameNum;
+
+	} /* End if */
+
+	if( levelsChanged == GL_TRUE)
+	{
+	    glTexParameteri( 
+		GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, aTex->residentLevel
+	    );
+	    CHECK_GL_ERROR;
+
+	} /* End if */
+
+	/* Nothing is wanted in the next frame until it is requested */
+	aTex->wantedLevel = aTex->coarseLevel;
+
+    } /* End for */
+
+    texStream->peakBytes = ( texStream->residentBytes > texStream->peakBytes) ?
+	texStream->residentBytes : texStream->peakBytes;
+
+    texStream->frameNum++;
+
+} /* End function UpdateTexStream */
+
+
+void FreeTexStream( TexStream *texStream)
+{
+    if( texStream != NULL)
+    {
+	Uint16 i;
+	int j;
+
+#ifdef VTAJ_DEBUG
+	printf( 
+	    "TEXSTREAM: %u levels streamed in, %u dropped; "
+	    "%u KB resident (%u KB at most) of %u KB\n",
+	    (unsigned int )texStream->numUploads,
+	    (unsigned int )texStream->numEvictions,
+	    (unsigned int )( texStream->residentBytes / 1024U),
+	    (unsigned int )( texStream->peakBytes / 1024U),
+	    (unsigned int )( texStream->totalBytes / 1024U)
+	);
+	fflush( stdout);
+#endif
+
+	for( i = 0U; i < texStream->numTex; i++)
+	{
+	    for( j = 0; j < texStream->textures[i].numLevels; j++)
+	    {
+		free( texStream->textures[i].levelData[j]);
+
+	    } /* End for */
+
+	} /* End for */
+
+	free( texStream->textures);
+	free( texStream);
+
+    } /* End if */
+
+} /* End function FreeTexStream */
+
+
+/**
+ * Returns the size in bytes of the image of the given mipmap level of
+ * the given texture.
+ */
+Uint32 GetLevelSize( StreamedTex *aTex, int level)
+{
+    int levelWidth = ( aTex->width >> level);
+    int levelHeight = ( aTex->height >> level);
+
+    levelWidth = ( levelWidth > 0) ? levelWidth : 1;
+    levelHeight = ( levelHeight > 0) ? levelHeight : 1;
+
+    return ( aTex->texFormat == GL_RGBA) ?
+	( 4U * (Uint32 )levelWidth * (Uint32 )levelHeight) :
+	GetDXT1Size( levelWidth, levelHeight);
+
+} /* End function GetLevelSize */
+
+
+/**
+ * Hands over the image of the given mipmap level of the given texture,
+ * which must be bound, to OpenGL.
+ */
+void UploadLevel( StreamedTex *aTex, int level)
+{
+    int levelWidth = ( aTex->width >> level);
+    int levelHeight = ( aTex->height >> level);
+
+    levelWidth = ( levelWidth > 0) ? levelWidth : 1;
+    levelHeight = ( levelHeight > 0) ? levelHeight : 1;
+
+    if( aTex->texFormat == GL_RGBA)
+    {
+	glTexImage2D(
+	    GL_TEXTURE_2D,
+	    level,
+	    GL_RGBA,
+	    levelWidth, levelHeight,
+	    0,
+	    GL_RGBA, GL_UNSIGNED_BYTE,
+	    aTex->levelData[level]
+	);
+
+    } /* End if */
+    else
+    {
+	pglCompressedTexImage2D(
+	    GL_TEXTURE_2D,
+	    level,
+	    aTex->texFormat,
+	    levelWidth, levelHeight,
+	    0,
+	    (GLsizei )GetDXT1Size( levelWidth, levelHeight),
+	    aTex->levelData[level]
+	);
+
+    } /* End else */
+    CHECK_GL_ERROR;
+
+} /* End function UploadLevel */
+
+
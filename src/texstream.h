@@ -0,0 +1,223 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * TEXSTREAM.H: Declarations for streaming in the mipmap levels of
+ * textures as they are needed.
+ */
+
+/**
+ * Most of the textures of a model are either out of sight or too far
+ * away to need their largest mipmap levels at any given time, yet they
+ * would normally take up texture memory all the same. Instead, only the
+ * small mipmap levels (no larger than TEXSTREAM_RESIDENT_SIZE) of each
+ * texture are always kept in texture memory. The larger levels are kept
+ * in system memory and handed over to OpenGL when they are needed.
+ *
+ * The renderer reports each batch of triangles it draws, per view, with
+ * RequestStreamedTex( ). The mipmap level wanted is estimated from the
+ * distance of the viewer to the triangles using the texture and from
+ * their smallest texels. At the end of each frame, UpdateTexStream( )
+ * uploads the levels wanted that are missing - at most about
+ * TEXSTREAM_UPLOAD_BUDGET bytes a frame, so that the frame rate does
+ * not suffer - and drops the largest level of a texture once it has not
+ * been wanted for TEXSTREAM_EVICT_FRAMES frames.
+ *
+ * Restricting a texture to the mipmap levels that are present needs
+ * OpenGL 1.2 (or "GL_SGIS_texture_lod"). Without it, all the levels are
+ * uploaded at once.
+ */
+
+#ifndef _TEXSTREAM_H
+#define _TEXSTREAM_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+#include "dxtc.h"
+
+
+/* Mipmap levels no larger than this are always resident */
+#define TEXSTREAM_RESIDENT_SIZE 32
+
+/* Bytes of texture images uploaded in a frame, at most */
+#define TEXSTREAM_UPLOAD_BUDGET ( 1024U * 1024U)
+
+/* Frames after which an unwanted mipmap level is dropped */
+#define TEXSTREAM_EVICT_FRAMES 300U
+
+
+/* Data type definitions */
+
+/* A texture and its mipmap levels */
+typedef struct _streamed_tex
+{
+    GLuint texObjId;
+
+    /* GL_RGBA or GL_COMPRESSED_RGBA_S3TC_DXT1_EXT */
+    GLenum texFormat;
+
+    int width, height;
+    int numLevels;
+    Uint8 *levelData[DXT_MAX_LEVELS];
+
+    /* Bounds of the triangles using the texture, and the most world
+     * units covered by a unit of texture coordinates in any of them
+     * (that is, where its texels look the largest).
+     */
+    GLfloat minCorner[3], maxCorner[3];
+    GLfloat unitsPerUV;
+
+    int coarseLevel;      /* This level and the smaller are resident */
+    int residentLevel;    /* Largest level in texture memory */
+    int wantedLevel;      /* Largest level wanted in this frame */
+    Uint32 lastWanted;    /* Last frame 'residentLevel' was wanted in */
+
+} StreamedTex;
+
+
+/* The mipmap levels of a texture image, as loaded */
+typedef struct _tex_image
+{
+    GLenum texFormat;
+    int width, height;
+    int numLevels;
+    Uint8 *levelData[DXT_MAX_LEVELS];
+
+} TexImage;
+
+
+/* The textures of a model */
+typedef struct _tex_stream
+{
+    Uint16 numTex;
+    StreamedTex *textures;
+
+    GLboolean canStream;
+    Uint32 frameNum;
+    Uint16 nextTex;       /* Texture first in line for uploads */
+
+    /* Statistics */
+    Uint32 totalBytes;
+    Uint32 residentBytes;
+    Uint32 peakBytes;
+    Uint32 numUploads;
+    Uint32 numEvictions;
+
+} TexStream;
+
+
+/* Function Prototypes */
+
+/**
+ * Creates the streaming state for the given texture objects, in the
+ * current OpenGL context.
+ */
+extern TexStream *GenTexStream( Uint16 numTex, const GLuint *texObjIds);
+
+
+/**
+ * Adds a triangle, given by the indices of its vertices into the given
+ * arrays of (x,y,z) and (u,v) values (with the given number of GLfloats
+ * from one vertex to the next in each), to those using the given 
+ * texture. All the triangles using a texture should be added before it
+ * is first requested.
+ */
+extern void NoteStreamedTexTriangle( 
+    TexStream *texStream, Uint16 texNum,
+    const GLfloat *vertCoords, Uint32 vertStride,
+    const GLfloat *texCoords, Uint32 texStride,
+    const Uint16 vIndices[3]
+);
+
+
+/**
+ * Forgets the triangles added for all the textures, so that those of a
+ * changed model can be added instead.
+ */
+extern void ClearStreamedTexTriangles( TexStream *texStream);
+
+
+/**
+ * Loads the image of the given texture - from the given DXT file if
+ * S3TC compressed textures are supported and it can be loaded, from
+ * the given JPEG image otherwise - at ( 1 / reduceFactor) of its
+ * resolution (see "texload.h"), and uploads its resident mipmap
+ * levels. Returns 0 if successful, -1 otherwise.
+ */
+extern int LoadStreamedTexture( 
+    TexStream *texStream, Uint16 texNum,
+    const char *dxtFileName, const char *jpgFileName, int reduceFactor
+);
+
+
+/**
+ * Loads a texture image and its mipmap levels as LoadStreamedTexture( )
+ * does ('dxtFileName' can be NULL to always use the JPEG image), but
+ * without handing it over to OpenGL, so that it can be called from any
+ * thread. Returns NULL if the image could not be loaded.
+ */
+extern TexImage *LoadTexImage(
+    const char *dxtFileName, const char *jpgFileName, int reduceFactor
+);
+
+
+/**
+ * Loads a texture image as LoadTexImage( ) does, but from the given
+ * DXT file (if it can be loaded) whether or not S3TC compressed
+ * textures are supported - so that it can be called before the OpenGL
+ * implementation is known. A compressed image must then be loaded
+ * again with LoadTexImage( ) if they turn out not to be supported.
+ */
+extern TexImage *ReadTexImage(
+    const char *dxtFileName, const char *jpgFileName, int reduceFactor
+);
+
+
+/**
+ * Frees a texture image.
+ */
+extern void FreeTexImage( TexImage *texImage);
+
+
+/**
+ * Makes the given image (which then belongs to the stream) the image
+ * of the given texture, in place of the one it had (if any), and
+ * uploads its resident mipmap levels.
+ */
+extern void SetStreamedTexImage( 
+    TexStream *texStream, Uint16 texNum, TexImage *texImage
+);
+
+
+/**
+ * Notes that the given texture is used for drawing in a view with the
+ * given eye position, where a unit length one unit away from the eye
+ * is 'pixelScale' pixels long.
+ */
+extern void RequestStreamedTex( 
+    TexStream *texStream, Uint16 texNum, 
+    const GLfloat eyePos[3], GLdouble pixelScale
+);
+
+
+/**
+ * Uploads the mipmap levels wanted in this frame and drops those not
+ * wanted for a while. Must be called once every frame, after all the
+ * textures used in it have been requested.
+ */
+extern void UpdateTexStream( TexStream *texStream);
+
+
+/**
+ * Frees the streaming state and the images of the textures (but not
+ * the texture objects).
+ */
+extern void FreeTexStream( TexStream *texStream);
+
+#endif    /* _TEXSTREAM_H */
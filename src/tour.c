@@ -0,0 +1,255 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * TOUR.C: Guided tours along a fixed path through the scene.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "tour.h"
+#include "vtaj.h"
+
+
+/* Local function prototypes */
+
+static GLfloat CatmullRom(
+    GLfloat p0, GLfloat p1, GLfloat p2, GLfloat p3, GLfloat u
+);
+
+
+TourData *LoadTour( const char *fileName)
+{
+    FILE *tourFile;
+    char aLine[MAX_TOUR_LINE];
+    TourData *retVal;
+    Uint32 maxKeys = 0U;
+    Uint32 lineNum = 0U;
+
+    if( ( tourFile = fopen( fileName, "r")) == NULL)
+    {
+	fprintf(
+	    stderr,
+	    "\nERROR: Could not read tour file \"%s\"\n", fileName
+	);
+	perror( "Details");
+	return NULL;
+
+    } /* End if */
+
+    if( ( retVal = (TourData *)( malloc( sizeof( TourData)))) == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal->numKeys = 0U;
+    retVal->keys = NULL;
+    retVal->tourLength = 0.0F;
+
+    while( fgets( aLine, MAX_TOUR_LINE, tourFile) != NULL)
+    {
+	TourKey aKey;
+	const char *aPtr = aLine;
+	float angleDeg;
+	GLboolean isValid;
+
+	lineNum++;
+
+	/* Skip blank lines and comments */
+	aPtr += strspn( aPtr, " \t\r\n");
+	if( ( *aPtr == '\0') || ( *aPtr == '#'))
+	{
+	    continue;
+
+	} /* End if */
+
+	isValid = ( sscanf(
+		aPtr, "%f %f %f %f %f",
+		&aKey.keyTime, &aKey.vPos[0], &aKey.vPos[1], &aKey.vPos[2],
+		&angleDeg
+	    ) == 5
+	) ? GL_TRUE : GL_FALSE;
+
+	/* The first keyframe starts the tour, the others follow it */
+	if( retVal->numKeys == 0U)
+	{
+	    isValid = ( aKey.keyTime != 0.0F) ? GL_FALSE : isValid;
+
+	} /* End if */
+	else if( aKey.keyTime <= retVal->keys[retVal->numKeys - 1U].keyTime)
+	{
+	    isValid = GL_FALSE;
+
+	} /* End else-if */
+
+	if( isValid == GL_FALSE)
+	{
+	    fprintf(
+		stderr,
+		"\nERROR: Invalid keyframe on line %u of \"%s\"\n",
+		lineNum, fileName
+	    );
+	    FreeTour( retVal);
+	    fclose( tourFile);
+	    return NULL;
+
+	} /* End if */
+
+	aKey.angleOfView = (GLfloat )( ( angleDeg * M_PI) / 180.0);
+
+	/* Turn the shorter way round from the previous keyframe */
+	if( retVal->numKeys > 0U)
+	{
+	    GLfloat prevAngle = retVal->keys[retVal->numKeys - 1U].angleOfView;
+
+	    while( ( aKey.angleOfView - prevAngle) > M_PI)
+	    {
+		aKey.angleOfView -= ( 2.0F * M_PI);
+
+	    } /* End while */
+
+	    while( ( aKey.angleOfView - prevAngle) < -M_PI)
+	    {
+		aKey.angleOfView += ( 2.0F * M_PI);
+
+	    } /* End while */
+
+	} /* End if */
+
+	if( retVal->numKeys == maxKeys)
+	{
+	    maxKeys = ( maxKeys == 0U) ? 32U : ( 2U * maxKeys);
+	    retVal->keys = (TourKey *)(
+		realloc( retVal->keys, maxKeys * sizeof( TourKey))
+	    );
+
+	    if( retVal->keys == NULL)
+	    {
+		fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+		exit( EXIT_FAILURE);
+
+	    } /* End if */
+
+	} /* End if */
+
+	retVal->keys[retVal->numKeys++] = aKey;
+	retVal->tourLength = aKey.keyTime;
+
+    } /* End while */
+
+    fclose( tourFile);
+
+    if( retVal->numKeys == 0U)
+    {
+	fprintf( stderr, "\nERROR: No keyframes in \"%s\"\n", fileName);
+	FreeTour( retVal);
+	return NULL;
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function LoadTour */
+
+
+void GetTourPose(
+    const TourData *aTour, GLfloat tourTime,
+    GLfloat vPos[3], GLfloat *angleOfView
+)
+{
+    const TourKey *k0, *k1, *k2, *k3;
+    Uint32 i;
+    GLfloat u, theAngle;
+    int m;
+
+    /* Start over once past the end */
+    if( aTour->tourLength > 0.0F)
+    {
+	tourTime = (GLfloat )fmod( tourTime, aTour->tourLength);
+	tourTime = ( tourTime < 0.0F) ?
+	    ( tourTime + aTour->tourLength) : tourTime;
+
+    } /* End if */
+    else
+    {
+	tourTime = 0.0F;
+
+    } /* End else */
+
+    /* Find the keyframes the time falls between */
+    for( i = 0U; ( i + 2U) < aTour->numKeys; i++)
+    {
+	if( tourTime < aTour->keys[i + 1U].keyTime)
+	{
+	    break;
+
+	} /* End if */
+
+    } /* End for */
+
+    k1 = ( aTour->keys + i);
+    k2 = ( ( i + 1U) < aTour->numKeys) ? ( k1 + 1) : k1;
+
+    /* The ends of the path are taken to carry on as they are */
+    k0 = ( i > 0U) ? ( k1 - 1) : k1;
+    k3 = ( ( i + 2U) < aTour->numKeys) ? ( k2 + 1) : k2;
+
+    u = ( k2->keyTime > k1->keyTime) ?
+	( ( tourTime - k1->keyTime) / ( k2->keyTime - k1->keyTime)) : 0.0F;
+    u = ( u > 1.0F) ? 1.0F : u;
+
+    for( m = 0; m < 3; m++)
+    {
+	vPos[m] = CatmullRom(
+	    k0->vPos[m], k1->vPos[m], k2->vPos[m], k3->vPos[m], u
+	);
+
+    } /* End for */
+
+    theAngle = CatmullRom(
+	k0->angleOfView, k1->angleOfView, k2->angleOfView, k3->angleOfView, u
+    );
+
+    theAngle = (GLfloat )fmod( theAngle, ( 2.0 * M_PI));
+    *angleOfView = ( theAngle < 0.0F) ? ( theAngle + ( 2.0F * M_PI)) : theAngle;
+
+} /* End function GetTourPose */
+
+
+void FreeTour( TourData *aTour)
+{
+    if( aTour != NULL)
+    {
+	free( aTour->keys);
+	free( aTour);
+
+    } /* End if */
+
+} /* End function FreeTour */
+
+
+/**
+ * Returns the point at 'u' (from 0 to 1) along the Catmull-Rom spline
+ * segment from 'p1' to 'p2', with 'p0' before it and 'p3' after it.
+ */
+GLfloat CatmullRom(
+    GLfloat p0, GLfloat p1, GLfloat p2, GLfloat p3, GLfloat u
+)
+{
+    GLfloat uSqr = u * u;
+
+    return 0.5F * ( ( 2.0F * p1) +
+	( ( p2 - p0) * u) +
+	( ( ( 2.0F * p0) - ( 5.0F * p1) + ( 4.0F * p2) - p3) * uSqr) +
+	( ( ( 3.0F * p1) - p0 - ( 3.0F * p2) + p3) * uSqr * u)
+    );
+
+} /* End function CatmullRom */
@@ -0,0 +1,101 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * TOUR.H: Declarations for guided tours, which take the viewer along a
+ * fixed path through the scene.
+ */
+
+/**
+ * A tour file has one keyframe per line, giving the time in seconds
+ * from the start of the tour at which the viewer passes through it, the
+ * position of the viewer and the direction in which it looks, in
+ * degrees measured the way F1 in the demo shows it:
+ *
+ *     time x y z angle
+ *
+ * The times must increase from one keyframe to the next, starting at 0.
+ * Blank lines and lines starting with '#' are ignored.
+ *
+ * The viewer follows a Catmull-Rom spline through the keyframes, and
+ * turns the shorter way round from the direction of one keyframe to
+ * that of the next. Once past the last keyframe, the tour starts over
+ * from the first one (so the last keyframe is best placed where the
+ * first one is).
+ *
+ * Since the path is known in advance, where the viewer will be a few
+ * seconds later can be looked up as easily as where it is now - see
+ * PrefetchEngineView( ) in "engine.h".
+ */
+
+#ifndef _TOUR_H
+#define _TOUR_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+
+/* Maximum length of a line in a tour file */
+#define MAX_TOUR_LINE 256
+
+
+/* Data type definitions */
+
+/* A keyframe of a tour */
+typedef struct _tour_key
+{
+    GLfloat keyTime;        /* In seconds */
+    GLfloat vPos[3];
+
+    /* In radians, differing from that of the previous keyframe by no
+     * more than half a turn.
+     */
+    GLfloat angleOfView;
+
+} TourKey;
+
+
+/* A tour */
+typedef struct _tour_data
+{
+    Uint32 numKeys;
+    TourKey *keys;
+
+    /* Time taken by the whole tour, in seconds */
+    GLfloat tourLength;
+
+} TourData;
+
+
+/* Function Prototypes */
+
+/**
+ * Reads in the tour from the given tour file.
+ *
+ * Returns the tour, or NULL on error.
+ */
+extern TourData *LoadTour( const char *fileName);
+
+
+/**
+ * Works out the position and direction (in radians, between 0 and 2PI)
+ * of the viewer at the given time (in seconds) from the start of the
+ * tour.
+ */
+extern void GetTourPose(
+    const TourData *aTour, GLfloat tourTime,
+    GLfloat vPos[3], GLfloat *angleOfView
+);
+
+
+/**
+ * Frees the given tour.
+ */
+extern void FreeTour( TourData *aTour);
+
+#endif    /* _TOUR_H */
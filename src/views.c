@@ -0,0 +1,168 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * VIEWS.C: Handling of sets of views rendered to images.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "views.h"
+#include "vtaj.h"
+
+
+ViewPose *LoadViewPoses( const char *fileName, Uint32 *numViews)
+{
+    FILE *viewFile;
+    char aLine[MAX_VIEW_LINE];
+    ViewPose *views = NULL;
+    Uint32 maxViews = 0U;
+    Uint32 lineNum = 0U;
+
+    *numViews = 0U;
+
+    if( ( viewFile = fopen( fileName, "r")) == NULL)
+    {
+	fprintf(
+	    stderr,
+	    "\nERROR: Could not read views file \"%s\"\n", fileName
+	);
+	perror( "Details");
+	return NULL;
+
+    } /* End if */
+
+    while( fgets( aLine, MAX_VIEW_LINE, viewFile) != NULL)
+    {
+	ViewPose aView;
+	const char *aPtr = aLine;
+	float angleDeg;
+
+	lineNum++;
+
+	/* Skip blank lines and comments */
+	aPtr += strspn( aPtr, " \t\r\n");
+	if( ( *aPtr == '\0') || ( *aPtr == '#'))
+	{
+	    continue;
+
+	} /* End if */
+
+	if( sscanf(
+		aPtr, "%f %f %f %f",
+		&aView.vPos[0], &aView.vPos[1], &aView.vPos[2], &angleDeg
+	    ) != 4
+	)
+	{
+	    fprintf(
+		stderr,
+		"\nERROR: Invalid view on line %u of \"%s\"\n",
+		lineNum, fileName
+	    );
+	    free( views);
+	    fclose( viewFile);
+	    return NULL;
+
+	} /* End if */
+
+	aView.angleOfView = (GLfloat )( ( angleDeg * M_PI) / 180.0);
+
+	if( *numViews == maxViews)
+	{
+	    maxViews = ( maxViews == 0U) ? 64U : ( 2U * maxViews);
+	    views = (ViewPose *)( realloc( views, maxViews * sizeof( ViewPose)));
+
+	    if( views == NULL)
+	    {
+		fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+		exit( EXIT_FAILURE);
+
+	    } /* End if */
+
+	} /* End if */
+
+	views[( *numViews)++] = aView;
+
+    } /* End while */
+
+    fclose( viewFile);
+
+    return views;
+
+} /* End function LoadViewPoses */
+
+
+int SaveViewImage(
+    const char *prefix, Uint32 viewNum, int width, int height,
+    const Uint8 *pixels, GLboolean bottomUp
+)
+{
+    char fileName[FILENAME_MAX];
+    Uint8 *rgbRow;
+    FILE *outFile;
+    int retVal = 0;
+    int x, y;
+
+    sprintf( fileName, "%.*s%05u.ppm", FILENAME_MAX - 16, prefix, viewNum);
+
+    if( ( outFile = fopen( fileName, "wb")) == NULL)
+    {
+	fprintf(
+	    stderr, "\nERROR: Unable to open file \"%s\" for writing!\n",
+	    fileName
+	);
+	return -1;
+
+    } /* End if */
+
+    rgbRow = (Uint8 *)( malloc( 3 * width * sizeof( Uint8)));
+    if( rgbRow == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    fprintf( outFile, "P6\n%d %d\n255\n", width, height);
+
+    for( y = 0; y < height; y++)
+    {
+	const Uint8 *srcRow = pixels + 
+	    ( 4 * width * ( ( bottomUp == GL_TRUE) ? ( height - 1 - y) : y));
+
+	for( x = 0; x < width; x++)
+	{
+	    rgbRow[3*x + 0] = srcRow[4*x + 0];
+	    rgbRow[3*x + 1] = srcRow[4*x + 1];
+	    rgbRow[3*x + 2] = srcRow[4*x + 2];
+
+	} /* End for */
+
+	if( fwrite( rgbRow, 3 * width, 1, outFile) != 1)
+	{
+	    retVal = -1;
+	    break;
+
+	} /* End if */
+
+    } /* End for */
+
+    free( rgbRow);
+
+    if( ( fclose( outFile) != 0) || ( retVal != 0))
+    {
+	fprintf( stderr, "\nERROR: Could not save \"%s\"!\n", fileName);
+	retVal = -1;
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function SaveViewImage */
+
+
@@ -0,0 +1,72 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * VIEWS.H: Declarations for the functions handling sets of views,
+ * used by the tools that render views of the Taj to images.
+ */
+
+/**
+ * A views file has one view per line, giving the position of the
+ * viewer and the direction in which it looks, in degrees measured
+ * the way F1 in the demo shows it:
+ *
+ *     x y z angle
+ *
+ * Blank lines and lines starting with '#' are ignored.
+ */
+
+#ifndef _VIEWS_H
+#define _VIEWS_H
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+
+/* Maximum length of a line in a views file */
+#define MAX_VIEW_LINE 256
+
+
+/* Data type definitions */
+
+/* The position and orientation of the viewer for a view */
+typedef struct _view_pose
+{
+    GLfloat vPos[3];
+    GLfloat angleOfView;    /* In radians */
+
+} ViewPose;
+
+
+/* Function Prototypes */
+
+/**
+ * Reads in the views from the given views file. The number of views
+ * read is returned in the given variable.
+ *
+ * Returns the views (to be freed by the caller), or NULL on error.
+ */
+extern ViewPose *LoadViewPoses( const char *fileName, Uint32 *numViews);
+
+
+/**
+ * Saves the image of the given view as the binary PPM image
+ * "<prefix>nnnnn.ppm", where "nnnnn" is the view number. The pixels
+ * are packed RGBA values - with the bottom row first if 'bottomUp' is
+ * GL_TRUE (as OpenGL returns them), else with the top row first.
+ *
+ * Returns 0 if successful, -1 otherwise.
+ */
+extern int SaveViewImage(
+    const char *prefix, Uint32 viewNum, int width, int height,
+    const Uint8 *pixels, GLboolean bottomUp
+);
+
+#endif    /* _VIEWS_H */
+
+
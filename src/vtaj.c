@@ -16,6 +16,14 @@
  *   -w: windowed mode
  * -gld: use GLData models (default)
  * -bsp: use BSP Tree models
+ * -rec <name>: record frames to <name> when F2 is pressed - a Y4M
+ *      stream if <name> ends with ".y4m", PPM images otherwise
+ * -stereo: show a side-by-side stereo pair
+ * -t2, -t4, -t8: load textures at 1/2, 1/4 or 1/8 resolution
+ * -scene <file>: show the models listed in <file> (see "scene.h")
+ * -watch: reload the models and textures as they change
+ * -latch: handle input as late as possible before each frame
+ * -tour <file>: take the viewer on the tour in <file> (see "tour.h")
  * 
  * Requires SDL 1.2.3 or better, SDL_image 1.0 or better
  * and OpenGL 1.1 or better, on an i386-compatible platform.
@@ -41,219 +49,215 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <errno.h>
 #include <math.h>
-#include <limits.h>
-#include <float.h>
-
-#ifndef M_PI
-    # define M_PI		3.14159265358979323846F
-#endif
 
 /* We do not want SDL to automatically include "glext.h" */
 #define NO_SDL_GLEXT
 
 #include "SDL.h"
 #include "SDL_opengl.h"
-#include "SDL_image.h"
-
-#include "gld.h"
-#include "bsp.h"
-#include "coldet.h"
-
 
-/* Handy macro for checking OpenGL errors */
-#ifdef VTAJ_DEBUG
-    #define CHECK_GL_ERROR \
-        { \
-	    GLenum glErr; \
-	    if( ( glErr = glGetError( )) != GL_NO_ERROR) \
-	    { \
-	        fprintf( stderr, \
-		    "\nOpenGL ERROR around line %d: %s\n", \
-		    __LINE__, \
-		    gluErrorString( glErr)); \
-	    } \
-	}
-#else
-    #define CHECK_GL_ERROR
-#endif
+#include "glutil.h"
+#include "gldebug.h"
+#include "texload.h"
+#include "capture.h"
+#include "tour.h"
+#include "engine.h"
+#include "vtaj.h"
 
 
 /* Literal constants */
 
-#define FIELD_OF_VIEW 30.0F
-#define NEAR_Z_CLIP 1.0F
-#define FAR_Z_CLIP 6000.F
-
 #define VIEWER_STRIDE +5.0F
 #define VIEWER_UPDOWN_DELTA +5.0F
 #define VIEWER_TURN_ANGLE ( ( 3.0F * M_PI) / 180.0F)
 
-#define TAJ_INT_MIN_X -50.0F
-#define TAJ_INT_MAX_X +50.0F
-
-#define TAJ_INT_MIN_Z -290.0F
-#define TAJ_INT_MAX_Z -160.0F
+#define DEFAULT_CAPTURE_NAME "vtaj.y4m"
 
-#define IMGS_FOLDER_PFX "textures/"
-#define PROG_BAR_IMG "initwindow.jpg"
-
-#define TAJ_EXT_GLD_MODEL "models/externals.gld"
-#define TAJ_INT_GLD_MODEL "models/internals.gld"
-
-#define TAJ_EXT_BSP_MODEL "models/externals.bsp"
-#define TAJ_INT_BSP_MODEL "models/internals.bsp"
-
-#define TAJ_EXT_COLDET_MODEL "models/cx_ext.gld"
-#define TAJ_INT_COLDET_MODEL "models/cx_int.gld"
-
-
-/* Global data */
+/* Frames over which the late-latch mode finds how long rendering takes
+ * and how often frames are shown, the milliseconds it keeps spare
+ * before a frame is due and the most it ever waits.
+ */
+#define LATCH_HISTORY 30
+#define LATCH_MARGIN_MS 2U
+#define LATCH_MAX_WAIT_MS 20U
 
-static GLboolean useBSP = GL_FALSE;
+/* On a tour, the textures needed this many seconds ahead (and at each
+ * of the steps on the way there) are streamed in ahead of time.
+ */
+#define TOUR_LOOKAHEAD 3.0F
+#define TOUR_PREFETCH_STEPS 3
 
 
-/* Frames-per-second data */
-static Uint32 currFPS;
+/* Data type definitions */
 
-/* The screen dimensions */
-static int scrWidth = 800;
-static int scrHeight = 600;
-static GLboolean fullscreen = GL_TRUE;
+/* Options chosen on the command line */
+typedef struct _vtaj_opts
+{
+    /* The screen dimensions */
+    int scrWidth;
+    int scrHeight;
+    GLboolean fullscreen;
 
-/* Models to be shown */
-static GLData *extGldModel = NULL;
-static GLData *intGldModel = NULL;
+    GLboolean useBSP;
+    GLboolean stereoMode;
 
-static BSPTreeData *extBspModel = NULL;
-static BSPTreeData *intBspModel = NULL;
+    /* Where captured frames go */
+    const char *captureName;
 
-static GLData *extColDetModel = NULL;
-static GLData *intColDetModel = NULL;
+    /* The scene manifest listing the models to be shown */
+    const char *sceneName;
 
-/* Viewer information */
-static GLfloat angleOfView;
-static GLfloat vPos[3];
-static GLdouble vNorm[3];
-static GLdouble minVisCos = 0.0;
+    /* Layout of the vertices of the GLData models */
+    GLDVertLayout vertLayout;
 
-/* Texture data */
-static GLuint progBarTexture;
+    /* Factor by which the resolution of the textures is reduced */
+    int texReduction;
 
-static Uint16 numExtMaps;
-static Uint16 numIntMaps;
+    /* Reload the files of the scene as they change? */
+    GLboolean watchFiles;
 
-static GLuint *extTextures;
-static GLuint *intTextures;
+    /* Wait to handle input until just before each frame is rendered? */
+    GLboolean lateLatch;
 
-static GLfloat *extTexPriorities;
-static GLfloat *intTexPriorities;
+    /* The tour the viewer is taken on, if any */
+    const char *tourName;
 
-/* Queued vertex and texture coordinate indices during each redraw */
-static Uint32 *extNumVerts;
-static GLushort **extVertIndices;
+} VTOptions;
 
-static Uint32 *intNumVerts;
-static GLushort **intVertIndices;
 
-/* Inside/outside flag */
-static GLboolean insideTaj;
+/* The timing of the frames shown, and the latency of the input they
+ * show - from the input being seen to the swap of buffers showing it
+ * having completed.
+ */
+typedef struct _frame_timing
+{
+    /* Has input been seen but not handled yet, or handled but not
+     * shown yet, and since when?
+     */
+    GLboolean inputSeen;
+    Uint32 seenTime;
+    GLboolean inputHandled;
+    Uint32 handledTime;
+
+    /* Latency statistics, in milliseconds */
+    Uint32 numInputs;
+    Uint32 lastLatency;
+    Uint32 maxLatency;
+    Uint32 totalLatency;
+
+    /* Recent render times (until OpenGL has finished the frame) and
+     * frame periods (from one swap of buffers to the next, only for
+     * frames not held back by a wait to latch input), and how long the
+     * frame being rendered was held back
+     */
+    Uint32 numFrames;
+    Uint32 numPeriods;
+    Uint32 lastSwapTime;
+    Uint32 latchWait;
+    Uint32 renderTimes[LATCH_HISTORY];
+    Uint32 framePeriods[LATCH_HISTORY];
 
-/* Switched pointers depending on viewer's position */
-static GLData *currGldModel = NULL;
-static BSPTreeData *currBspModel = NULL;
-static GLData *currColDetModel = NULL;
-static GLuint *currTextures;
-static Uint32 *currNumVerts;
-static GLushort **currVertIndices;
+} FrameTiming;
 
 
 /* Local function prototypes */
 
-static void ParseCmdLine( int argc, char *argv[]);
-static void LoadModels( void);
-static void InitGraphics( void);
-static void InitQueues( void);
-static void HandleEvents( void);
-static void RenderFrame( void);
-static void ShowProgressBar( unsigned int percentComplete);
-static int LoadJPGTexture( const char *fileName, GLuint texObjId);
-static void InitTextures( void);
-static void DrawBSPTree( BSPTree *aTree);
-static void FreeResources( void);
+static void ParseCmdLine( int argc, char *argv[], VTOptions *vtOpts);
+static void InitGraphics( VTEngine *vtEngine, const VTOptions *vtOpts);
+static void HandleEvents( 
+    VTEngine *vtEngine, const VTOptions *vtOpts, const TourData *aTour
+);
+static void FollowTour( 
+    VTEngine *vtEngine, const TourData *aTour, Uint32 startTime
+);
+static void RenderFrame( 
+    VTEngine *vtEngine, Uint32 *currFPS, FrameTiming *frameTiming
+);
+static void PeekInput( FrameTiming *frameTiming);
+static void NoteInputHandled( FrameTiming *frameTiming);
+static void NoteFrameShown( 
+    FrameTiming *frameTiming, 
+    Uint32 startTime, Uint32 finishTime, Uint32 swapTime
+);
+static void WaitToLatch( FrameTiming *frameTiming);
+static void ShowProgressBar( void *cbData, unsigned int percentComplete);
+static void FreeResources( VTEngine *vtEngine, TourData *aTour);
 
 /**
  * The entry point to the program
  */
 int main( int argc, char *argv[])
 {
+    VTOptions vtOpts;
+    VTEngine *vtEngine;
+    TourData *aTour = NULL;
+    GLfloat vPos[3];
+    GLfloat angleOfView;
+
     /* Parse command-line arguments */
-    ParseCmdLine( argc, argv);
+    ParseCmdLine( argc, argv, &vtOpts);
+
+    /* Read in the tour, if any, before spending time on the models */
+    if( ( vtOpts.tourName != NULL) && 
+	( ( aTour = LoadTour( vtOpts.tourName)) == NULL)
+    )
+    {
+	exit( EXIT_FAILURE);
 
-    /* Load all the models */
-    LoadModels( );
+    } /* End if */
 
-    /* Initialise viewing queues (vertex arrays, indices, etc.) */
-    InitQueues( );
+    /* Start loading all the models (on other threads, while SDL and
+     * OpenGL are being initialised)
+     */
+    if( ( vtEngine = GenEngine( 
+	    vtOpts.sceneName, vtOpts.useBSP, vtOpts.vertLayout,
+	    vtOpts.texReduction
+	)) == NULL)
+    {
+	exit( EXIT_FAILURE);
 
-    /* Position the viewer - outside, and facing the Taj */
-    vPos[0] = vPos[1] = 0.0F;
-    vPos[2] = +330.0F;
-    angleOfView = (270.0F * M_PI) / 180.0F;
-    vNorm[0] = cos( angleOfView);
-    vNorm[1] = 0.0;
-    vNorm[2] = sin( angleOfView);
+    } /* End if */
 
-    
     /* Initialise SDL/OpenGL, load textures, etc. */
-    InitGraphics( );
+    InitGraphics( vtEngine, &vtOpts);
+
+    /* Pick up changes to the models and textures as they are made */
+    if( vtOpts.watchFiles == GL_TRUE)
+    {
+	if( WatchEngineFiles( vtEngine) == GL_TRUE)
+	{
+	    printf( "\nWatching the models and textures for changes\n");
+
+	} /* End if */
+
+    } /* End if */
 
 
-    /* Initialise model-related data */
-    insideTaj = GL_FALSE;
-    if( useBSP == GL_TRUE)
+    /* Position the viewer - at the start of the tour, if any, or else
+     * outside, and facing the Taj.
+     */
+    if( aTour != NULL)
     {
-        currBspModel = extBspModel;
+	GetTourPose( aTour, 0.0F, vPos, &angleOfView);
 
     } /* End if */
     else
     {
-        currGldModel = extGldModel;
+	vPos[0] = vPos[1] = 0.0F;
+	vPos[2] = +330.0F;
+	angleOfView = (270.0F * M_PI) / 180.0F;
 
     } /* End else */
 
-    currTextures = extTextures;
-    currColDetModel = extColDetModel;
-    currNumVerts = extNumVerts;
-    currVertIndices = extVertIndices;
-
-    glVertexPointer( 
-        3, GL_FLOAT, 0, 
-	( ( useBSP == GL_TRUE) ? 
-	    extBspModel->vertCoords : 
-	    extGldModel->vertCoords
-        )
-    );
-    CHECK_GL_ERROR;
-    glTexCoordPointer( 
-        2, GL_FLOAT, 0,
-	( ( useBSP == GL_TRUE) ? 
-	    extBspModel->texCoords : 
-	    extGldModel->texCoords
-        )
-    );
-    CHECK_GL_ERROR;
-
-    glPrioritizeTextures( numExtMaps, extTextures, extTexPriorities);
-    CHECK_GL_ERROR;
+    PlaceEngineViewer( vtEngine, vPos, angleOfView);
 
 
     /* Now show the models to the user and respond to his inputs */
-    HandleEvents( );
+    HandleEvents( vtEngine, &vtOpts, aTour);
 
     /* Done showing the Taj. Clean up resource usage */
-    FreeResources( );
+    FreeResources( vtEngine, aTour);
 
     return EXIT_SUCCESS;
 
@@ -261,16 +265,37 @@ int main( int argc, char *argv[])
 
 
 /**
- * Parse the command line and set appropriate flags and variables.
+ * Parse the command line and set the options chosen in 'vtOpts'.
  * This routine considers repeated specifications for the same class
  * (resolution, mode, etc.) as an error.
  */
-void ParseCmdLine( int argc, char *argv[])
+void ParseCmdLine( int argc, char *argv[], VTOptions *vtOpts)
 {
     GLboolean parseError = GL_FALSE;
     GLboolean resSelected = GL_FALSE;
     GLboolean scrModeSelected = GL_FALSE;
     GLboolean mdlFmtSelected = GL_FALSE;
+    GLboolean recNameSelected = GL_FALSE;
+    GLboolean stereoSelected = GL_FALSE;
+    GLboolean texReductionSelected = GL_FALSE;
+    GLboolean sceneSelected = GL_FALSE;
+    GLboolean layoutSelected = GL_FALSE;
+    GLboolean watchSelected = GL_FALSE;
+    GLboolean latchSelected = GL_FALSE;
+    GLboolean tourSelected = GL_FALSE;
+
+    vtOpts->scrWidth = 800;
+    vtOpts->scrHeight = 600;
+    vtOpts->fullscreen = GL_TRUE;
+    vtOpts->useBSP = GL_FALSE;
+    vtOpts->stereoMode = GL_FALSE;
+    vtOpts->captureName = DEFAULT_CAPTURE_NAME;
+    vtOpts->sceneName = SCENE_FILE;
+    vtOpts->vertLayout = GLD_INTERLEAVED_VERTS;
+    vtOpts->texReduction = 1;
+    vtOpts->watchFiles = GL_FALSE;
+    vtOpts->lateLatch = GL_FALSE;
+    vtOpts->tourName = NULL;
 
     /* If there are command line arguments, parse them */
     if( argc > 1)
@@ -284,8 +309,8 @@ void ParseCmdLine( int argc, char *argv[])
 	    )
 	    {
 		resSelected = GL_TRUE;
-		scrWidth = 640;
-		scrHeight = 480;
+		vtOpts->scrWidth = 640;
+		vtOpts->scrHeight = 480;
 
 	    } /* End if */
 	    else if( ( strcmp( "-8", argv[i]) == 0) && 
@@ -293,8 +318,8 @@ void ParseCmdLine( int argc, char *argv[])
 	    )
 	    {
 		resSelected = GL_TRUE;
-		scrWidth = 800;
-		scrHeight = 600;
+		vtOpts->scrWidth = 800;
+		vtOpts->scrHeight = 600;
 
 	    } /* End else-if */
 	    else if( ( strcmp( "-10", argv[i]) == 0) && 
@@ -302,8 +327,8 @@ void ParseCmdLine( int argc, char *argv[])
 	    )
 	    {
 		resSelected = GL_TRUE;
-		scrWidth = 1024;
-		scrHeight = 768;
+		vtOpts->scrWidth = 1024;
+		vtOpts->scrHeight = 768;
 
 	    } /* End else-if */
 	    else if( ( strcmp( "-w", argv[i]) == 0) && 
@@ -311,7 +336,7 @@ void ParseCmdLine( int argc, char *argv[])
 	    )
 	    {
 		scrModeSelected = GL_TRUE;
-		fullscreen = GL_FALSE;
+		vtOpts->fullscreen = GL_FALSE;
 
 	    } /* End else-if */
 	    else if( ( strcmp( "-f", argv[i]) == 0) && 
@@ -319,7 +344,7 @@ void ParseCmdLine( int argc, char *argv[])
 	    )
 	    {
 		scrModeSelected = GL_TRUE;
-		fullscreen = GL_TRUE;
+		vtOpts->fullscreen = GL_TRUE;
 
 	    } /* End else-if */
 	    else if( ( strcmp( "-gld", argv[i]) == 0) && 
@@ -327,7 +352,7 @@ void ParseCmdLine( int argc, char *argv[])
 	    )
 	    {
 		mdlFmtSelected = GL_TRUE;
-		useBSP = GL_FALSE;
+		vtOpts->useBSP = GL_FALSE;
 
 	    } /* End else-if */
 	    else if( ( strcmp( "-bsp", argv[i]) == 0) && 
@@ -335,7 +360,98 @@ void ParseCmdLine( int argc, char *argv[])
 	    )
 	    {
 		mdlFmtSelected = GL_TRUE;
-		useBSP = GL_TRUE;
+		vtOpts->useBSP = GL_TRUE;
+
+	    } /* End else-if */
+	    else if( ( strcmp( "-rec", argv[i]) == 0) && 
+		( recNameSelected == GL_FALSE) &&
+		( ( i + 1) < argc)
+	    )
+	    {
+		recNameSelected = GL_TRUE;
+		vtOpts->captureName = argv[++i];
+
+	    } /* End else-if */
+	    else if( ( strcmp( "-stereo", argv[i]) == 0) && 
+		( stereoSelected == GL_FALSE)
+	    )
+	    {
+		stereoSelected = GL_TRUE;
+		vtOpts->stereoMode = GL_TRUE;
+
+	    } /* End else-if */
+	    else if( ( strncmp( "-t", argv[i], 2) == 0) && 
+		( texReductionSelected == GL_FALSE) &&
+		( IsTextureReduction( atoi( argv[i] + 2)) == GL_TRUE)
+	    )
+	    {
+		texReductionSelected = GL_TRUE;
+		vtOpts->texReduction = atoi( argv[i] + 2);
+
+	    } /* End else-if */
+	    else if( ( strcmp( "-scene", argv[i]) == 0) && 
+		( sceneSelected == GL_FALSE) &&
+		( ( i + 1) < argc)
+	    )
+	    {
+		sceneSelected = GL_TRUE;
+		vtOpts->sceneName = argv[++i];
+
+	    } /* End else-if */
+	    else if( ( strcmp( "-verts", argv[i]) == 0) && 
+		( layoutSelected == GL_FALSE) &&
+		( ( i + 1) < argc)
+	    )
+	    {
+		layoutSelected = GL_TRUE;
+		i++;
+
+		if( strcmp( "separate", argv[i]) == 0)
+		{
+		    vtOpts->vertLayout = GLD_SEPARATE_VERTS;
+
+		} /* End if */
+		else if( strcmp( "interleaved", argv[i]) == 0)
+		{
+		    vtOpts->vertLayout = GLD_INTERLEAVED_VERTS;
+
+		} /* End else-if */
+		else if( strcmp( "padded", argv[i]) == 0)
+		{
+		    vtOpts->vertLayout = GLD_PADDED_VERTS;
+
+		} /* End else-if */
+		else
+		{
+		    parseError = GL_TRUE;
+		    break;
+
+		} /* End else */
+
+	    } /* End else-if */
+	    else if( ( strcmp( "-watch", argv[i]) == 0) && 
+		( watchSelected == GL_FALSE)
+	    )
+	    {
+		watchSelected = GL_TRUE;
+		vtOpts->watchFiles = GL_TRUE;
+
+	    } /* End else-if */
+	    else if( ( strcmp( "-latch", argv[i]) == 0) && 
+		( latchSelected == GL_FALSE)
+	    )
+	    {
+		latchSelected = GL_TRUE;
+		vtOpts->lateLatch = GL_TRUE;
+
+	    } /* End else-if */
+	    else if( ( strcmp( "-tour", argv[i]) == 0) && 
+		( tourSelected == GL_FALSE) &&
+		( ( i + 1) < argc)
+	    )
+	    {
+		tourSelected = GL_TRUE;
+		vtOpts->tourName = argv[++i];
 
 	    } /* End else-if */
 	    else
@@ -355,7 +471,9 @@ void ParseCmdLine( int argc, char *argv[])
         fprintf( stderr, "\nERROR: Invalid command line arguments!\n");
 	fprintf( 
 	    stderr, 
-	    "\nUsage: %s {-6 or -8 or -10} {-w or -f} {-gld or -bsp}\n",
+	    "\nUsage: %s {-6 or -8 or -10} {-w or -f} {-gld or -bsp} "
+	    "[-rec <name>] [-stereo] [-t2 or -t4 or -t8] [-scene <file>] "
+	    "[-verts <layout>] [-watch] [-latch] [-tour <file>]\n",
 	    argv[0]
 	);
 	fprintf(
@@ -386,182 +504,59 @@ void ParseCmdLine( int argc, char *argv[])
 	    stderr,
 	    "\t-bsp: use BSP Tree models\n"
 	);
-
-        exit( EXIT_FAILURE);
-
-    } /* End if */
-
-} /* End function ParseCmdLine */
-
-
-/**
- * Load the GLData or BSP Tree models of the Taj Exterior and
- * Interior as needed, as well as the models used for collision 
- * detection.
- */
-void LoadModels( void)
-{
-    FILE *extMdlFile, *intMdlFile;
-    FILE *extColDetFile, *intColDetFile;
-
-    /* Read in the Taj interior and exterior models */
-    if( useBSP == GL_TRUE)
-    {
-        /* Use the BSP Tree version of the models */
-
-	if( ( extMdlFile = fopen( TAJ_EXT_BSP_MODEL, "rb")) == NULL)
-	{
-	    fprintf( 
-	        stderr,
-	        "\nERROR: Could not read VirtualTaj Externals "
-		"BSP model \"%s\"\n", TAJ_EXT_BSP_MODEL
-	    );
-	    perror( "Details");
-	    exit( EXIT_FAILURE);
-
-	} /* End if */
-	else
-	{
-	    extBspModel = LoadBSPTreeData( extMdlFile);
-	    fclose( extMdlFile);
-
-	} /* End else */
-
-	if( ( intMdlFile = fopen( TAJ_INT_BSP_MODEL, "rb")) == NULL)
-	{
-	    fprintf( 
-	        stderr,
-	        "\nERROR: Could not read VirtualTaj Internals "
-		"BSP model \"%s\"\n", TAJ_INT_BSP_MODEL
-	    );
-	    perror( "Details");
-	    exit( EXIT_FAILURE);
-
-	} /* End if */
-	else
-	{
-	    intBspModel = LoadBSPTreeData( intMdlFile);
-	    fclose( intMdlFile);
-
-	} /* End else */
-        
-    } /* End if */
-    else
-    {
-        /* Use the simple GLData format of the models */
-
-	if( ( extMdlFile = fopen( TAJ_EXT_GLD_MODEL, "rb")) == NULL)
-	{
-	    fprintf( 
-	        stderr,
-	        "\nERROR: Could not read VirtualTaj Externals "
-		"GLD model \"%s\"\n", TAJ_EXT_GLD_MODEL
-	    );
-	    perror( "Details");
-	    exit( EXIT_FAILURE);
-
-	} /* End if */
-	else
-	{
-	    extGldModel = LoadGLData( extMdlFile);
-	    fclose( extMdlFile);
-
-	} /* End else */
-
-	if( ( intMdlFile = fopen( TAJ_INT_GLD_MODEL, "rb")) == NULL)
-	{
-	    fprintf( 
-	        stderr,
-	        "\nERROR: Could not read VirtualTaj Internals "
-		"GLD model \"%s\"\n", TAJ_INT_GLD_MODEL
-	    );
-	    perror( "Details");
-	    exit( EXIT_FAILURE);
-
-	} /* End if */
-	else
-	{
-	    intGldModel = LoadGLData( intMdlFile);
-	    fclose( intMdlFile);
-
-	} /* End else */
-
-    } /* End else */
-
-    
-    /* Find out the number of texture maps used in each model */
-    numExtMaps = ( useBSP == GL_TRUE) ?
-        extBspModel->nMaps : extGldModel->nMaps;
-
-    numIntMaps = ( useBSP == GL_TRUE) ?
-        intBspModel->nMaps : intGldModel->nMaps;
-
-
-    /* Read in the low polygon count models used for
-     * collision detection.
-     */
-    
-    extColDetFile = fopen( TAJ_EXT_COLDET_MODEL, "rb");
-    if( extColDetFile == NULL)
-    {
-        fprintf( 
-	    stderr, 
-	    "Unable to read the Taj exterior collision-detection model (%s)\n",
-	    TAJ_EXT_COLDET_MODEL
+	fprintf(
+	    stderr,
+	    "\t-rec: record frames to <name> on F2 (default \"%s\")\n",
+	    DEFAULT_CAPTURE_NAME
 	);
-	exit( EXIT_FAILURE);
-
-    } /* End if */
-
-    if( ( extColDetModel = LoadGLData( extColDetFile)) == NULL)
-    {
-        fprintf( 
-	    stderr, 
-	    "Unable to read the Taj exterior collision-detection model (%s)\n",
-	    TAJ_EXT_COLDET_MODEL
+	fprintf(
+	    stderr,
+	    "\t-stereo: show a side-by-side stereo pair\n"
 	);
-	exit( EXIT_FAILURE);
-
-    } /* End if */
-
-    fclose( extColDetFile);
-
-
-    intColDetFile = fopen( TAJ_INT_COLDET_MODEL, "rb");
-    if( intColDetFile == NULL)
-    {
-        fprintf( 
-	    stderr, 
-	    "Unable to read the Taj interior collision-detection model (%s)\n",
-	    TAJ_INT_COLDET_MODEL
+	fprintf(
+	    stderr,
+	    "\t-t<n>: load textures at 1/<n> resolution (n = 2, 4 or 8)\n"
 	);
-	exit( EXIT_FAILURE);
-
-    } /* End if */
-
-    if( ( intColDetModel = LoadGLData( intColDetFile)) == NULL)
-    {
-        fprintf( 
-	    stderr, 
-	    "Unable to read the Taj interior collision-detection model (%s)\n",
-	    TAJ_INT_COLDET_MODEL
+	fprintf(
+	    stderr,
+	    "\t-scene: show the models listed in <file> (default \"%s\")\n",
+	    SCENE_FILE
+	);
+	fprintf(
+	    stderr,
+	    "\t-verts: lay out GLData vertices as \"separate\", "
+	    "\"interleaved\" (default) or \"padded\"\n"
+	);
+	fprintf(
+	    stderr,
+	    "\t-watch: reload models and textures as they change\n"
+	);
+	fprintf(
+	    stderr,
+	    "\t-latch: handle input as late as possible before each frame\n"
+	);
+	fprintf(
+	    stderr,
+	    "\t-tour: take the viewer on the tour in <file>\n"
 	);
-	exit( EXIT_FAILURE);
 
-    } /* End if */
+        exit( EXIT_FAILURE);
 
-    fclose( intColDetFile);
+    } /* End if */
 
-} /* End function LoadModels */
+} /* End function ParseCmdLine */
 
 
 /**
  * Initialises SDL/OpenGL according to the needs of the program and
- * the user.
+ * the user, and has the engine finish loading the models and their
+ * textures.
  */
-void InitGraphics( void)
+void InitGraphics( VTEngine *vtEngine, const VTOptions *vtOpts)
 {
     Uint32 sdlVidFlags;
+    char texFileName[256];
+    GLuint progBarTexture;
 
     /* Initialize SDL for video output */
     if( SDL_Init( SDL_INIT_VIDEO) < 0) 
@@ -579,13 +574,16 @@ void InitGraphics( void)
     /* Create an OpenGL screen */
     sdlVidFlags = 0U;
     sdlVidFlags |= SDL_OPENGL;
-    if( fullscreen == GL_TRUE)
+    if( vtOpts->fullscreen == GL_TRUE)
     {
 	sdlVidFlags |= SDL_FULLSCREEN;
 
     } /* End if */
 
-    if( SDL_SetVideoMode( scrWidth, scrHeight, 0, sdlVidFlags) == NULL ) 
+    if( SDL_SetVideoMode( 
+	    vtOpts->scrWidth, vtOpts->scrHeight, 0, sdlVidFlags
+	) == NULL 
+    ) 
     {
         fprintf( 
 	    stderr, 
@@ -596,6 +594,9 @@ void InitGraphics( void)
 
     } /* End if */
 
+    /* Find out what the OpenGL implementation can do for us */
+    InitGLExtensions( );
+
     /* Set the title bar in environments that support it */
     SDL_WM_SetCaption( 
         "Virtual Taj Mahal Demo (by Ranjit Mathew)", NULL
@@ -605,278 +606,114 @@ void InitGraphics( void)
     SDL_ShowCursor( SDL_DISABLE);
 
     /* OpenGL initialisation */
-    glViewport( 0, 0, (GLsizei )scrWidth, (GLsizei )scrHeight); 
-    CHECK_GL_ERROR;
-
-    glClearColor( 0.0F, 0.4F, 0.6F, 0.0F); 
+    glViewport( 
+	0, 0, (GLsizei )vtOpts->scrWidth, (GLsizei )vtOpts->scrHeight
+    );
     CHECK_GL_ERROR;
 
-    glEnable( GL_DEPTH_TEST);
-    CHECK_GL_ERROR;
+    glMatrixMode( GL_PROJECTION);
+    glLoadIdentity( );
+    gluOrtho2D( 
+	0.0, (GLdouble )vtOpts->scrWidth, 0.0, (GLdouble )vtOpts->scrHeight
+    );
+    glMatrixMode( GL_MODELVIEW);
+    glLoadIdentity( );
 
-    glClearDepth( +1.0F);
-    CHECK_GL_ERROR;
+    /* Load texture for the progress bar window */
+    glGenTextures( 1, &progBarTexture);
 
-    glDepthFunc( GL_LEQUAL);
-    CHECK_GL_ERROR;
+    strcpy( texFileName, IMGS_FOLDER_PFX);
+    strcat( texFileName, PROG_BAR_IMG);
+    LoadJPGTexture( texFileName, vtOpts->texReduction, progBarTexture);
 
-    if( useBSP == GL_TRUE)
+    if( InitEngineGraphics( 
+	    vtEngine, vtOpts->scrWidth, vtOpts->scrHeight, vtOpts->stereoMode,
+	    ShowProgressBar, &progBarTexture
+	) == GL_FALSE
+    )
     {
-	glDisable( GL_CULL_FACE);
-	CHECK_GL_ERROR;
+	FreeEngine( vtEngine);
+	exit( EXIT_FAILURE);
 
     } /* End if */
-    else 
-    {
-	glFrontFace( GL_CCW);
-	CHECK_GL_ERROR;
 
-	glCullFace( GL_BACK);
-	CHECK_GL_ERROR;
+    /* We no longer need the progress bar texture */
+    glDeleteTextures( 1, &progBarTexture);
 
-	glEnable( GL_CULL_FACE);
-	CHECK_GL_ERROR;
+} /* End function InitGraphics */
 
-    } /* End else */
 
-    glEnable( GL_TEXTURE_2D);
-    CHECK_GL_ERROR;
+/**
+ * Handle user input and render updated frames - with the viewer taken
+ * along 'aTour', if not NULL, instead of being moved by the user.
+ */
+void HandleEvents( 
+    VTEngine *vtEngine, const VTOptions *vtOpts, const TourData *aTour
+)
+{
+    SDL_Event event;
+    GLboolean done = GL_FALSE;
+    GLboolean pickMode = GL_FALSE;
+    Uint32 currFPS = 0U;
+    Uint32 tourStart;
+    FrameTiming frameTiming;
 
-    glTexEnvf( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
-    CHECK_GL_ERROR;
 
-    glDisable( GL_ALPHA_TEST);
-    CHECK_GL_ERROR;
+    /* NOTE: Uses memset( ) to initialise the contents to 0 */
+    memset( &frameTiming, 0, sizeof( FrameTiming));
 
-    glAlphaFunc( GL_GREATER, 0.5F);
-    CHECK_GL_ERROR;
+    /* Errors are reported once a frame from here on */
+    InitGLDebug( );
 
-    glShadeModel( GL_FLAT);
-    CHECK_GL_ERROR;
+    /* Loop, drawing and checking events */
+    SDL_EnableKeyRepeat( 
+        SDL_DEFAULT_REPEAT_DELAY, 
+	SDL_DEFAULT_REPEAT_INTERVAL
+    );
 
+    tourStart = SDL_GetTicks( );
+    
+    while( done == GL_FALSE)
+    {
+	if( aTour != NULL)
+	{
+	    FollowTour( vtEngine, aTour, tourStart);
 
-    /* Initialise stuff */
+	} /* End if */
 
-    glMatrixMode( GL_PROJECTION);
-    glLoadIdentity( );
-    gluOrtho2D( 0.0, (GLdouble )scrWidth, 0.0, (GLdouble )scrHeight);
-    glMatrixMode( GL_MODELVIEW);
-    glLoadIdentity( );
+	RenderFrame( vtEngine, &currFPS, &frameTiming);
 
-    InitTextures( );
+	/* Have the frame showing the input rendered as soon as it is
+	 * handled, if so chosen.
+	 */
+	if( vtOpts->lateLatch == GL_TRUE)
+	{
+	    WaitToLatch( &frameTiming);
 
-    /* Ready for prime time */
+	} /* End if */
 
-    glEnableClientState( GL_VERTEX_ARRAY);
-    CHECK_GL_ERROR;
+        while( SDL_PollEvent( &event) != 0) 
+        {
+	    GLfloat destPt[3];
+	    GLfloat angleOfView = vtEngine->angleOfView;
+	    GLboolean triedToMove = GL_FALSE;
 
-    glEnableClientState( GL_TEXTURE_COORD_ARRAY);
-    CHECK_GL_ERROR;
+	    destPt[0] = vtEngine->vPos[0];
+	    destPt[1] = vtEngine->vPos[1];
+	    destPt[2] = vtEngine->vPos[2];
 
+	    if( ( event.type == SDL_KEYDOWN) || 
+		( event.type == SDL_MOUSEBUTTONDOWN)
+	    )
+	    {
+		NoteInputHandled( &frameTiming);
 
-    glMatrixMode( GL_PROJECTION);
-    glLoadIdentity( );
+	    } /* End if */
 
-    gluPerspective( 
-        FIELD_OF_VIEW, (GLfloat )scrWidth/(GLfloat )scrHeight,
-        NEAR_Z_CLIP, FAR_Z_CLIP
-    );
-    CHECK_GL_ERROR;
 
-    glColor4f( 1.0F, 1.0F, 1.0F, 0.0F);
-
-    glHint( GL_PERSPECTIVE_CORRECTION_HINT, GL_FASTEST);
-    CHECK_GL_ERROR;
-
-    glMatrixMode( GL_MODELVIEW);
-    glLoadIdentity( );
-    CHECK_GL_ERROR;
-
-    gluLookAt( 
-	vPos[0], vPos[1], vPos[2], 
-	vPos[0] + ( 1.0F * cos( angleOfView)), 
-	vPos[1], 
-	vPos[2] + ( 1.0F * sin( angleOfView)), 
-	0.0F, 1.0F, 0.0F
-    );
-    CHECK_GL_ERROR;
-
-} /* End function InitGraphics */
-
-
-/**
- * Initialises various queues - vertex arrays, etc.
- */
-void InitQueues( void)
-{
-    Uint32 i, j;
-
-    
-    /* Create the drawing queues */
-    extNumVerts = (Uint32 *)( malloc( numExtMaps * sizeof( Uint32)));
-    intNumVerts = (Uint32 *)( malloc( numIntMaps * sizeof( Uint32)));
-    extVertIndices = 
-        (GLushort **)( malloc( numExtMaps * sizeof( GLushort *)));
-    intVertIndices = 
-        (GLushort **)( malloc( numIntMaps * sizeof( GLushort *)));
-    
-    if( ( extNumVerts == NULL) || ( intNumVerts == NULL) ||
-        ( extVertIndices == NULL) || ( intVertIndices == NULL)
-    )
-    {
-        fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
-	exit( EXIT_FAILURE);
-
-    } /* End if */
-
-
-    for( i = 0U; i < numExtMaps; i++)
-    {
-        Uint32 nTri;
-
-        nTri = ( useBSP == GL_TRUE) ? 
-	    extBspModel->mapTriNums[i] :
-	    extGldModel->mapTriNums[i];
-
-        extVertIndices[i] = (GLushort *)( 
-	    malloc( 3 * nTri * sizeof( GLushort))
-	);
-
-	if( extVertIndices[i] == NULL)
-	{
-	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
-	    exit( EXIT_FAILURE);
-
-	} /* End if */
-
-    } /* End for */
-
-    for( i = 0U; i < numIntMaps; i++)
-    {
-        Uint32 nTri;
-
-        nTri = ( useBSP == GL_TRUE) ? 
-	    intBspModel->mapTriNums[i] :
-	    intGldModel->mapTriNums[i];
-
-        intVertIndices[i] = (GLushort *)( 
-	    malloc( 3 * nTri * sizeof( GLushort))
-	);
-
-	if( intVertIndices[i] == NULL)
-	{
-	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
-	    exit( EXIT_FAILURE);
-
-	} /* End if */
-
-    } /* End for */
-
-
-    /* Calculate 'minVisCos' for the BSP Tree renderer.
-     *
-     * Taking the angle from the viewpoint to the corners of
-     * the view frustum gives the angle of the 'view cone'.
-     * This is a much simpler, though less accurate, way of
-     * culling entire subtrees based on the relative position
-     * and orientation of the viewer and the partition plane
-     * of a BSP Tree, than frustum plane based culling.
-     * 
-     * The value being calculated here is the limit on the
-     * cosine of the angle between the view direction and
-     * the partition plane normal of a BSP Tree, for the 
-     * back subtree of the BSP Tree to be completely culled.
-     */
-    if( useBSP == GL_TRUE)
-    {
-        GLdouble tanSqrTheta;
-	GLdouble onePlusAspRatioSqr;
-	GLdouble tmpTerm;
-
-	tanSqrTheta = tan( ( FIELD_OF_VIEW / 2.0) * M_PI / 180.0);
-	tanSqrTheta *= tanSqrTheta;
-
-	onePlusAspRatioSqr = (GLdouble )scrWidth / (GLdouble )scrHeight;
-	onePlusAspRatioSqr *= onePlusAspRatioSqr;
-	onePlusAspRatioSqr += 1.0;
-
-	tmpTerm = tanSqrTheta * onePlusAspRatioSqr;
-
-	minVisCos = sqrt( tmpTerm / ( tmpTerm + 1.0));
-
-    } /* End if */
-
-
-    if( useBSP == GL_FALSE)
-    {
-        for( i = 0U; i < extGldModel->nMaps; i++)
-	{
-	    extNumVerts[i] = ( 3U * extGldModel->mapTriNums[i]);
-
-	    for( j = 0U; j < extGldModel->mapTriNums[i]; j++)
-	    {
-		extVertIndices[i][3*j + 0] = extGldModel->triFaces[i][3*j + 0];
-		extVertIndices[i][3*j + 1] = extGldModel->triFaces[i][3*j + 1];
-		extVertIndices[i][3*j + 2] = extGldModel->triFaces[i][3*j + 2];
-
-	    } /* End for */
-
-	} /* End for */
-
-        for( i = 0U; i < intGldModel->nMaps; i++)
-	{
-	    intNumVerts[i] = ( 3U * intGldModel->mapTriNums[i]);
-
-	    for( j = 0U; j < intGldModel->mapTriNums[i]; j++)
-	    {
-		intVertIndices[i][3*j + 0] = intGldModel->triFaces[i][3*j + 0];
-		intVertIndices[i][3*j + 1] = intGldModel->triFaces[i][3*j + 1];
-		intVertIndices[i][3*j + 2] = intGldModel->triFaces[i][3*j + 2];
-
-	    } /* End for */
-
-	} /* End for */
-
-    } /* End if */
-
-} /* End function InitQueues */
-
-
-/**
- * Handle user input and render updated frames.
- */
-void HandleEvents( void)
-{
-    SDL_Event event;
-    GLboolean done = GL_FALSE;
-
-
-    /* Loop, drawing and checking events */
-    SDL_EnableKeyRepeat( 
-        SDL_DEFAULT_REPEAT_DELAY, 
-	SDL_DEFAULT_REPEAT_INTERVAL
-    );
-    
-    while( done == GL_FALSE)
-    {
-	RenderFrame( );
-
-        while( SDL_PollEvent( &event) != 0) 
-        {
-	    GLfloat destPt[3], srcPt[3];
-	    GLfloat movableDist = 0.0F;
-	    GLboolean triedToMove = GL_FALSE;
-	    GLboolean changedPosn = GL_FALSE;
-	    GLboolean turnedAround = GL_FALSE;
-
-	    destPt[0] = srcPt[0] = vPos[0];
-	    destPt[1] = srcPt[1] = vPos[1];
-	    destPt[2] = srcPt[2] = vPos[2];
-
-
-            if( event.type == SDL_QUIT)
-            {
-                done = GL_TRUE;
+            if( event.type == SDL_QUIT)
+            {
+                done = GL_TRUE;
 
             } /* End if */
 	    else if( event.type == SDL_KEYDOWN)
@@ -900,23 +737,19 @@ void HandleEvents( void)
 		    break;
 
                 case SDLK_RIGHT:
-		    angleOfView += VIEWER_TURN_ANGLE;
-		    if( angleOfView > ( 2.0F * M_PI))
+		    if( aTour == NULL)
 		    {
-		        angleOfView -= ( 2.0F * M_PI);
+			TurnEngineViewer( vtEngine, +VIEWER_TURN_ANGLE);
 
 		    } /* End if */
-		    turnedAround = GL_TRUE;
 		    break;
 
                 case SDLK_LEFT:
-		    angleOfView -= VIEWER_TURN_ANGLE;
-		    if( angleOfView < 0.0F)
+		    if( aTour == NULL)
 		    {
-		        angleOfView += ( 2.0F * M_PI);
+			TurnEngineViewer( vtEngine, -VIEWER_TURN_ANGLE);
 
 		    } /* End if */
-		    turnedAround = GL_TRUE;
 		    break;
 
                 case SDLK_PAGEUP:
@@ -934,271 +767,179 @@ void HandleEvents( void)
 		    printf( "Current Engine Stats: \n");
 		    printf( 
 		        "\tEyePos: (%f, %f, %f)\n",
-		        vPos[0], vPos[1], vPos[2]
+			vtEngine->vPos[0], vtEngine->vPos[1], vtEngine->vPos[2]
 		    );
 		    printf( 
 		        "\tLookAt: %.2f Degrees\n", 
 		        ( angleOfView * 180.0 / M_PI)
 		    );
 		    printf( "\tFPS: %u\n", currFPS);
+		    printf( 
+			"\tLatency: %u ms (average %u ms, worst %u ms)\n",
+			frameTiming.lastLatency,
+			( ( frameTiming.numInputs > 0U) ?
+			    ( frameTiming.totalLatency / frameTiming.numInputs) :
+			    0U),
+			frameTiming.maxLatency
+		    );
 		    break;
 
-                default:
-		    break;
-
-		} /* End switch */
-
-	    } /* End else-if */
-
-
-            if( triedToMove == GL_TRUE)
-	    {
-		if( hasCollision( 
-			currColDetModel, srcPt, destPt, &movableDist
-		    ) == GL_TRUE
-		)
-		{
-		    /* Nothing to do */
-
-		} /* End if */
-		else
-		{
-		    /* No collision */
-		    if( ( insideTaj == GL_TRUE) && 
-		        ( ( destPt[0] < TAJ_INT_MIN_X) ||
-			  ( destPt[0] > TAJ_INT_MAX_X) ||
-			  ( destPt[2] < TAJ_INT_MIN_Z)
-			)
-		    )
+		case SDLK_F2:
+		    if( IsCapturingFrames( ) == GL_TRUE)
 		    {
-		        /* Quirks of the model */
+			StopFrameCapture( );
 
 		    } /* End if */
-		    else 
+		    else
 		    {
-			vPos[0] = destPt[0];
-			vPos[1] = destPt[1];
-			vPos[2] = destPt[2];
-
-			changedPosn = GL_TRUE;
-
-		    } /* End else */
-
-		} /* End else */
-
-		/* Is he now inside the Taj? */
-		if( ( vPos[0] > TAJ_INT_MIN_X) && 
-		    ( vPos[0] < TAJ_INT_MAX_X) &&
-		    ( vPos[2] > TAJ_INT_MIN_Z) &&
-		    ( vPos[2] < TAJ_INT_MAX_Z)
-		)
-		{
-		    /* We are now inside the Taj */
-		    if( insideTaj == GL_FALSE)
-		    {
-		        /* We have just moved in */
-			insideTaj = GL_TRUE;
-
-			/* Adjust the viewer's position */
-			/* (This is due to the quirks in the models) */
-
-			vPos[1] = -15.0F;
-			vPos[2] = TAJ_INT_MAX_Z - 20.0F;
-
-                        /* Make other adjustments */
-			if( useBSP == GL_TRUE)
-			{
-			    currBspModel = intBspModel;
-
-			} /* End if */
-			else
-			{
-			    currGldModel = intGldModel;
-
-			} /* End else */
-
-			currTextures = intTextures;
-			currColDetModel = intColDetModel;
-			currNumVerts = intNumVerts;
-			currVertIndices = intVertIndices;
-
-			glVertexPointer( 
-			    3, GL_FLOAT, 0, 
-			    ( ( useBSP == GL_TRUE) ? 
-				intBspModel->vertCoords : 
-				intGldModel->vertCoords
-			    )
-			);
-			CHECK_GL_ERROR;
-			glTexCoordPointer( 
-			    2, GL_FLOAT, 0, 
-			    ( ( useBSP == GL_TRUE) ? 
-				intBspModel->texCoords : 
-				intGldModel->texCoords
-			    )
-			);
-			CHECK_GL_ERROR;
-
-			glPrioritizeTextures( 
-			    numIntMaps, intTextures, intTexPriorities
+			StartFrameCapture( 
+			    vtOpts->scrWidth, vtOpts->scrHeight,
+			    vtOpts->captureName
 			);
-			CHECK_GL_ERROR;
-
-			glEnable( GL_ALPHA_TEST);
-			CHECK_GL_ERROR;
 
-		    } /* End if */
-
-		} /* End if */
-		else
-		{
-		    /* We are outside the Taj */
-		    if( insideTaj == GL_TRUE)
-		    {
-		        /* We were inside the Taj earlier */
-			insideTaj = GL_FALSE;
-
-			if( useBSP == GL_TRUE)
-			{
-			    currBspModel = extBspModel;
-
-			} /* End if */
-			else
-			{
-			    currGldModel = extGldModel;
-
-			} /* End else */
-
-			currTextures = extTextures;
-			currColDetModel = extColDetModel;
-			currNumVerts = extNumVerts;
-			currVertIndices = extVertIndices;
-
-			glVertexPointer( 
-			    3, GL_FLOAT, 0, 
-			    ( ( useBSP == GL_TRUE) ? 
-				extBspModel->vertCoords : 
-				extGldModel->vertCoords
-			    )
-			);
-			CHECK_GL_ERROR;
-			glTexCoordPointer( 
-			    2, GL_FLOAT, 0, 
-			    ( ( useBSP == GL_TRUE) ? 
-				extBspModel->texCoords : 
-				extGldModel->texCoords
-			    )
-			);
-			CHECK_GL_ERROR;
+		    } /* End else */
+		    break;
 
-			glPrioritizeTextures( 
-			    numExtMaps, extTextures, extTexPriorities
-			);
-			CHECK_GL_ERROR;
+		case SDLK_F3:
+		    pickMode = ( pickMode == GL_TRUE) ? GL_FALSE : GL_TRUE;
+		    SDL_ShowCursor(
+			( pickMode == GL_TRUE) ? SDL_ENABLE : SDL_DISABLE
+		    );
+		    printf(
+			"\nSurface picking %s\n",
+			( pickMode == GL_TRUE) ? "enabled" : "disabled"
+		    );
+		    break;
 
-			glDisable( GL_ALPHA_TEST);
-			CHECK_GL_ERROR;
+		case SDLK_F4:
+		    ShowEngineMinimap( 
+			vtEngine,
+			( vtEngine->showMinimap == GL_TRUE) ?
+			    GL_FALSE : GL_TRUE
+		    );
+		    break;
 
-                    } /* End if */
+                default:
+		    break;
 
-		} /* End else */
+		} /* End switch */
 
-	    } /* End if */
-	    else if( turnedAround == GL_TRUE)
+	    } /* End else-if */
+	    else if( ( event.type == SDL_MOUSEBUTTONDOWN) &&
+		( event.button.button == SDL_BUTTON_LEFT) &&
+		( pickMode == GL_TRUE)
+	    )
 	    {
-	        /* Update view normal */
-		vNorm[0] = cos( angleOfView);
-		vNorm[2] = sin( angleOfView);
-		
+		IdentifyEngineSurface( 
+		    vtEngine, event.button.x, event.button.y
+		);
+
 	    } /* End else-if */
 
 
-	    /* Update the ModelView matrix if necessary */
-	    if( ( changedPosn == GL_TRUE) || ( turnedAround == GL_TRUE))
+            if( ( triedToMove == GL_TRUE) && ( aTour == NULL))
 	    {
-		glMatrixMode( GL_MODELVIEW);
-		glLoadIdentity( );
-
-		gluLookAt( 
-		    vPos[0], vPos[1], vPos[2], 
-		    vPos[0] + ( 1.0F * cos( angleOfView)), 
-		    vPos[1], 
-		    vPos[2] + ( 1.0F * sin( angleOfView)), 
-		    0.0F, 1.0F, 0.0F
-		);
-		CHECK_GL_ERROR;
+		MoveEngineViewer( vtEngine, destPt);
 
 	    } /* End if */
 
         } /* End while */
 
+	/* All the input seen has now been handled */
+	frameTiming.inputSeen = GL_FALSE;
+
     } /* End while */
 
+#ifdef VTAJ_DEBUG
+    printf( 
+	"LATENCY: %u inputs shown, %u ms on average, %u ms at worst\n",
+	frameTiming.numInputs,
+	( ( frameTiming.numInputs > 0U) ?
+	    ( frameTiming.totalLatency / frameTiming.numInputs) : 0U),
+	frameTiming.maxLatency
+    );
+    fflush( stdout);
+#endif
+
 } /* End function HandleEvents */
 
 
 /**
- * Render a frame according to the viewer position and orientation.
+ * Puts the viewer where the tour, started at 'startTime', has got to,
+ * and has the textures needed further along it streamed in ahead of
+ * time, so that the frame rate does not dip when the view changes
+ * suddenly (as on entering the Taj).
  */
-void RenderFrame( void)
+void FollowTour( VTEngine *vtEngine, const TourData *aTour, Uint32 startTime)
 {
-    register Uint32 i;
-    Uint16 currNMaps;
-    Uint32 startTime, endTime;
-
-    startTime = SDL_GetTicks( );
-
-    glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    GLfloat tourTime = (GLfloat )( SDL_GetTicks( ) - startTime) / 1000.0F;
+    GLfloat vPos[3];
+    GLfloat angleOfView;
+    int i;
 
+    GetTourPose( aTour, tourTime, vPos, &angleOfView);
+    PlaceEngineViewer( vtEngine, vPos, angleOfView);
 
-    if( useBSP == GL_TRUE)
-    {
-        currNMaps = currBspModel->nMaps;
-
-	/* Clear display queue */
-	memset( currNumVerts, 0, ( currNMaps * sizeof( Uint32)));
-
-	/* Figure out which triangles to draw */
-	DrawBSPTree( currBspModel->bspTree);
-
-    } /* End if */
-    else
+    for( i = 1; i <= TOUR_PREFETCH_STEPS; i++)
     {
-        currNMaps = currGldModel->nMaps;
+	GetTourPose( 
+	    aTour, 
+	    ( tourTime + ( ( TOUR_LOOKAHEAD * i) / TOUR_PREFETCH_STEPS)),
+	    vPos, &angleOfView
+	);
+	PrefetchEngineView( vtEngine, vPos, angleOfView);
 
-    } /* End else */
+    } /* End for */
 
+} /* End function FollowTour */
 
-    /* Now draw all the queued triangles */
-    for( i = 0U; i < currNMaps; i++)
-    {
-        if( currNumVerts[i] > 0U)
-	{
-	    glBindTexture( GL_TEXTURE_2D, currTextures[i]);
 
-	    glDrawElements( 
-	        GL_TRIANGLES, 
-		currNumVerts[i], 
-		GL_UNSIGNED_SHORT, 
-		currVertIndices[i]
-	    );
+/**
+ * Render a frame according to the viewer position and orientation,
+ * and show it.
+ */
+void RenderFrame( 
+    VTEngine *vtEngine, Uint32 *currFPS, FrameTiming *frameTiming
+)
+{
+    Uint32 startTime, finishTime, swapTime, endTime;
 
-	} /* End if */
+    startTime = SDL_GetTicks( );
 
-    } /* End for */
+    RenderEngineFrame( vtEngine);
+    PeekInput( frameTiming);
 
     glFinish( );
     CHECK_GL_ERROR;
 
+    finishTime = SDL_GetTicks( );
+    PeekInput( frameTiming);
+
+    /* Queue a read back of this frame if we are recording */
+    CaptureFrame( );
+
     /* Swap buffers to display, since we're double buffered */
     SDL_GL_SwapBuffers();
 
+    swapTime = SDL_GetTicks( );
+    NoteFrameShown( frameTiming, startTime, finishTime, swapTime);
+    PeekInput( frameTiming);
+
+    /* Stream in the texture levels this frame needed */
+    UpdateEngineTextures( vtEngine);
+
+    /* Swap in the files of the scene reloaded since the last frame */
+    SwapEngineReloads( vtEngine);
+
+    /* Report any OpenGL problems with this frame */
+    DrainGLDebugMessages( );
+
     /* Calculate FPS */
     endTime = SDL_GetTicks( );
 
     if( endTime > startTime)
     {
-	currFPS = ( 1000U / ( endTime - startTime));
+	*currFPS = ( 1000U / ( endTime - startTime));
 
     } /* End if */
 
@@ -1206,265 +947,174 @@ void RenderFrame( void)
 
 
 /**
- * Initialises texture objects used by the models.
+ * Notes when input is first seen waiting to be handled, since SDL
+ * events do not carry the time they came in at. This is looked for at
+ * a few points in each frame, so that input coming in while a frame
+ * is rendered is not taken to have come in only once it is handled.
  */
-void InitTextures( void)
+void PeekInput( FrameTiming *frameTiming)
 {
-    char texFileName[256];
-    Uint32 loadedSoFar, totalTextures;
-    Uint16 i;
-
-    /* Load texture for the progress bar window */
-    glGenTextures( 1, &progBarTexture);
+    SDL_Event anEvent;
 
-    strcpy( texFileName, IMGS_FOLDER_PFX);
-    strcat( texFileName, PROG_BAR_IMG);
-    LoadJPGTexture( texFileName, progBarTexture);
-
-
-    ShowProgressBar( 0U);
-    
-    loadedSoFar = 0U;
-    totalTextures = (Uint32 )numExtMaps + (Uint32 )numIntMaps;
-
-
-    /* Load textures for the Taj exterior */
-
-    if( numExtMaps > 0U)
+    if( frameTiming->inputSeen == GL_TRUE)
     {
-	extTextures = 
-	    (GLuint *)( malloc( sizeof( GLuint) * numExtMaps));
-        extTexPriorities = 
-	    (GLfloat *)( malloc( sizeof( GLfloat) * numExtMaps));
-	if( ( extTextures == NULL) || ( extTexPriorities == NULL))
-	{
-	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
-	    exit( EXIT_FAILURE);
-
-	} /* End if */
-
-	glGenTextures( numExtMaps, extTextures);
-	CHECK_GL_ERROR;
-
-	for( i = 0U; i < numExtMaps; i++)
-	{
-	    /* Load the texture image */
-	    strcpy( texFileName, IMGS_FOLDER_PFX);
-	    strcat( texFileName, 
-	        ( ( useBSP == GL_TRUE) ? 
-		    extBspModel->mapNames[i] :
-		    extGldModel->mapNames[i]
-		)
-	    );
-
-	    LoadJPGTexture( texFileName, extTextures[i]);
-
-            loadedSoFar++;
-            if( ( loadedSoFar % 10U) == 0U)
-	    {
-		ShowProgressBar( ( loadedSoFar * 100U) / totalTextures);
-
-	    } /* End if */
-
-
-            /* Calculate the texture's relative abundance */
-	    if( useBSP == GL_TRUE)
-	    {
-		extTexPriorities[i] = ( 
-		    (GLfloat )( extBspModel->mapTriNums[i]) / 
-		    (GLfloat )( extBspModel->numTri)
-		);
-
-	    } /* End if */
-	    else
-	    {
-		extTexPriorities[i] = ( 
-		    (GLfloat )( extGldModel->mapTriNums[i]) / 
-		    (GLfloat )( extGldModel->numTri)
-		);
-
-	    } /* End else */
-
-	} /* End for */
+	return;
 
     } /* End if */
 
+    SDL_PumpEvents( );
 
-    /* Load textures for the Taj interior */
-
-    if( numIntMaps > 0U)
+    if( SDL_PeepEvents( 
+	    &anEvent, 1, SDL_PEEKEVENT, 
+	    ( SDL_KEYDOWNMASK | SDL_MOUSEBUTTONDOWNMASK)
+	) > 0
+    )
     {
-	intTextures = 
-	    (GLuint *)( malloc( sizeof( GLuint) * numIntMaps));
-        intTexPriorities = 
-	    (GLfloat *)( malloc( sizeof( GLfloat) * numIntMaps));
-	if( ( intTextures == NULL) || ( intTexPriorities == NULL))
-	{
-	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
-	    exit( EXIT_FAILURE);
-
-	} /* End if */
-
-	glGenTextures( numIntMaps, intTextures);
-	CHECK_GL_ERROR;
-
-	for( i = 0U; i < numIntMaps; i++)
-	{
-	    /* Load the texture image */
-	    strcpy( texFileName, IMGS_FOLDER_PFX);
-	    strcat( texFileName, 
-	        ( ( useBSP == GL_TRUE) ? 
-		    intBspModel->mapNames[i] :
-		    intGldModel->mapNames[i]
-		)
-	    );
-
-	    LoadJPGTexture( texFileName, intTextures[i]);
-
-            loadedSoFar++;
-            if( ( loadedSoFar % 10U) == 0U)
-	    {
-		ShowProgressBar( ( loadedSoFar * 100U) / totalTextures);
-
-	    } /* End if */
+	frameTiming->inputSeen = GL_TRUE;
+	frameTiming->seenTime = SDL_GetTicks( );
 
+    } /* End if */
 
-            /* Calculate the texture's relative abundance */
-	    if( useBSP == GL_TRUE)
-	    {
-		intTexPriorities[i] = ( 
-		    (GLfloat )( intBspModel->mapTriNums[i]) / 
-		    (GLfloat )( intBspModel->numTri)
-		);
+} /* End function PeekInput */
 
-	    } /* End if */
-	    else
-	    {
-		intTexPriorities[i] = ( 
-		    (GLfloat )( intGldModel->mapTriNums[i]) / 
-		    (GLfloat )( intGldModel->numTri)
-		);
 
-            } /* End else */
-
-	} /* End for */
+/**
+ * Notes that input has been handled, to be shown in the next frame.
+ */
+void NoteInputHandled( FrameTiming *frameTiming)
+{
+    if( frameTiming->inputHandled == GL_FALSE)
+    {
+	frameTiming->inputHandled = GL_TRUE;
+	frameTiming->handledTime = ( frameTiming->inputSeen == GL_TRUE) ?
+	    frameTiming->seenTime : SDL_GetTicks( );
 
     } /* End if */
 
-    ShowProgressBar( 100U);
-
-    /* We no longer need the progress bar texture */
-    glDeleteTextures( 1, &progBarTexture);
-
-} /* End function InitTextures */
+} /* End function NoteInputHandled */
 
 
 /**
- * Recursively draw a BSP Tree. Instead of actually drawing
- * the triangles of the tree, collects vertex indices of visible
- * triangles. Performs backface and view cone based culling.
+ * Notes the timing of a frame just shown - started at 'startTime',
+ * finished by OpenGL at 'finishTime' and swapped to the screen at
+ * 'swapTime' - and the latency of the input it shows, if any. The
+ * period of a frame held back by WaitToLatch( ) includes the wait, so
+ * only those of the other frames are kept.
  */
-void DrawBSPTree( BSPTree *aTree)
+void NoteFrameShown( 
+    FrameTiming *frameTiming, 
+    Uint32 startTime, Uint32 finishTime, Uint32 swapTime
+)
 {
-    register Uint16 i;
+    Uint32 slotNum = ( frameTiming->numFrames % LATCH_HISTORY);
+
+    frameTiming->renderTimes[slotNum] = finishTime - startTime;
 
-    if( aTree != NULL)
+    if( ( frameTiming->numFrames > 0U) && ( frameTiming->latchWait == 0U))
     {
-        PointType vpRel = ClassifyPoint( vPos, &( aTree->partPlane));
-	GLdouble vpDotProd;
+	slotNum = ( frameTiming->numPeriods % LATCH_HISTORY);
+	frameTiming->framePeriods[slotNum] = 
+	    swapTime - frameTiming->lastSwapTime;
+	frameTiming->numPeriods++;
 
-        vpDotProd = 
-	    vNorm[0]*aTree->partPlane.A + vNorm[2]*aTree->partPlane.C;
+    } /* End if */
 
-        /* 'vNorm[1]' is always zero */
+    frameTiming->lastSwapTime = swapTime;
+    frameTiming->latchWait = 0U;
+    frameTiming->numFrames++;
 
-	if( 0 && ( vpRel == BELOW_PLANE) && ( vpDotProd < -minVisCos))
-	{
-	    /* The front sub-tree can not be seen */
+    if( frameTiming->inputHandled == GL_TRUE)
+    {
+	Uint32 latency = swapTime - frameTiming->handledTime;
 
-	} /* End if */
-	else if( aTree->front != NULL)
-	{
-	    DrawBSPTree( aTree->front);
+	frameTiming->lastLatency = latency;
+	frameTiming->maxLatency = ( latency > frameTiming->maxLatency) ?
+	    latency : frameTiming->maxLatency;
+	frameTiming->totalLatency += latency;
+	frameTiming->numInputs++;
 
-	} /* End else-if */
+	frameTiming->inputHandled = GL_FALSE;
 
+    } /* End if */
 
-	for( i = 0U; i < aTree->numTri; i++)
-	{
-	    register Uint32 tIndex;
-	    register BSPTriFace *aTri;
-	    GLfloat res[3], dotProd;
-	    
-	    aTri = ( aTree->triDefs + i);
+} /* End function NoteFrameShown */
 
-	    if( insideTaj == GL_FALSE)
-	    {
-		/* Backface culling can be done only for the
-		 * Taj exterior model.
-		 */
-		res[0] = 
-		    currBspModel->vertCoords[3*aTri->vIndices[0] + 0];
-		res[1] = 
-		    currBspModel->vertCoords[3*aTri->vIndices[0] + 1];
-		res[2] = 
-		    currBspModel->vertCoords[3*aTri->vIndices[0] + 2];
-
-		res[0] -= vPos[0];
-		res[1] -= vPos[1];
-		res[2] -= vPos[2];
-
-		res[0] *= aTree->partPlane.A;
-		res[1] *= aTree->partPlane.B;
-		res[2] *= aTree->partPlane.C;
-
-		dotProd = res[0] + res[1] + res[2];
-
-		if( dotProd >= 0.0F)
-		{
-		    continue;
 
-		} /* End if */
+/**
+ * Waits until just before the next frame must be rendered, so that
+ * the input it shows is handled as late as possible. No frame has been
+ * shown sooner than the shortest recent frame period after the one
+ * before it (as when the swap of buffers waits for the vertical
+ * retrace), so the next one is due that long after the last swap, and
+ * must be started before that by the longest recent render time.
+ *
+ * The frame periods leave out frames held back by this wait (whose
+ * periods would otherwise include it, and lengthen every later wait),
+ * and the wait is limited to LATCH_MAX_WAIT_MS.
+ */
+void WaitToLatch( FrameTiming *frameTiming)
+{
+    Uint32 minPeriod = frameTiming->framePeriods[0];
+    Uint32 maxRender = frameTiming->renderTimes[0];
+    Uint32 waitTime, startTime, nowTime, waitStart;
+    int i;
+
+    /* Wait to know enough about recent frames */
+    if( ( frameTiming->numFrames < LATCH_HISTORY) ||
+	( frameTiming->numPeriods < LATCH_HISTORY)
+    )
+    {
+	return;
 
-	    } /* End if */
+    } /* End if */
 
-	    tIndex = currNumVerts[aTri->texIndex];
+    for( i = 1; i < LATCH_HISTORY; i++)
+    {
+	minPeriod = ( frameTiming->framePeriods[i] < minPeriod) ?
+	    frameTiming->framePeriods[i] : minPeriod;
+	maxRender = ( frameTiming->renderTimes[i] > maxRender) ?
+	    frameTiming->renderTimes[i] : maxRender;
 
-	    currVertIndices[aTri->texIndex][tIndex++] = 
-		aTri->vIndices[0];
+    } /* End for */
 
-	    currVertIndices[aTri->texIndex][tIndex++] = 
-		aTri->vIndices[1];
+    if( minPeriod <= ( maxRender + LATCH_MARGIN_MS))
+    {
+	/* No time to spare */
+	return;
 
-	    currVertIndices[aTri->texIndex][tIndex++] = 
-		aTri->vIndices[2];
+    } /* End if */
 
-	    currNumVerts[aTri->texIndex] = tIndex;
+    waitTime = minPeriod - maxRender - LATCH_MARGIN_MS;
+    waitTime = ( waitTime > LATCH_MAX_WAIT_MS) ? 
+	LATCH_MAX_WAIT_MS : waitTime;
 
-	} /* End for */
+    startTime = frameTiming->lastSwapTime + waitTime;
 
+    /* (The difference of the times, taken as signed, is correct even
+     * across a wrap-around of the ticks.)
+     */
+    waitStart = SDL_GetTicks( );
+    nowTime = waitStart;
+    while( (Sint32 )( startTime - nowTime) > 0)
+    {
+	PeekInput( frameTiming);
+	SDL_Delay( 1U);
 
-	if( ( vpRel == ABOVE_PLANE) && ( vpDotProd > minVisCos))
-	{
-	    /* The back sub-tree can not be seen */
-
-	} /* End if */
-	else if( aTree->back != NULL)
-	{
-	    DrawBSPTree( aTree->back);
+	nowTime = SDL_GetTicks( );
 
-	} /* End if */
+    } /* End while */
 
-    } /* End if */
+    frameTiming->latchWait = nowTime - waitStart;
 
-} /* End function DrawBSPTree */
+} /* End function WaitToLatch */
 
 
 /**
  * A simple function to show a progress bar to the user while
- * the textures are being loaded.
+ * the textures are being loaded. 'cbData' points to the texture of
+ * the progress bar window.
  */
-void ShowProgressBar( unsigned int percentComplete)
+void ShowProgressBar( void *cbData, unsigned int percentComplete)
 {
     /* Assume Ortho-2D projection, with coordinate system matching
      * screen resolution has been set up.
@@ -1472,13 +1122,17 @@ void ShowProgressBar( unsigned int percentComplete)
      * The progress window is 256x128, and is to be centred.
      */
 
-    int startX = ( scrWidth - 256) / 2;
-    int startY = ( scrHeight - 128) / 2;
+    GLint viewPort[4];
+    int startX, startY;
+
+    glGetIntegerv( GL_VIEWPORT, viewPort);
+    startX = ( viewPort[2] - 256) / 2;
+    startY = ( viewPort[3] - 128) / 2;
 
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     CHECK_GL_ERROR;
 
-    glBindTexture( GL_TEXTURE_2D, progBarTexture);
+    glBindTexture( GL_TEXTURE_2D, *( (GLuint *)cbData));
     CHECK_GL_ERROR;
 
     glBegin( GL_QUADS);
@@ -1515,222 +1169,20 @@ void ShowProgressBar( unsigned int percentComplete)
 } /* End function ShowProgressBar */
 
 
-/**
- * Loads a JPEG texture, creating an alpha channel - "sufficiently
- * black" pixels are considered transparent. This is used to
- * show the grills in the Taj interiors.
- */
-int LoadJPGTexture( const char *fileName, GLuint texObjId)
-{
-    int retVal;
-    Uint32 rmask, gmask, bmask, amask;
-    SDL_Surface *image = NULL;
-    SDL_Surface *bbImage = NULL;
-  
-    /* RGBA masks will have to depend on the endianness of the
-     * the machine. (A fraud, since the rest of the code heavily
-     * depends on it being a 32-bit, i386 compatible machine.)
-     */
-#if SDL_BYTEORDER == SDL_BIG_ENDIAN
-    rmask = 0xFF000000;
-    gmask = 0x00FF0000;
-    bmask = 0x0000FF00;
-    amask = 0x000000FF;
-#else
-    rmask = 0x000000FF;
-    gmask = 0x0000FF00;
-    bmask = 0x00FF0000;
-    amask = 0xFF000000;
-#endif
-
-    image = IMG_Load( fileName);
-
-    if( image != NULL)
-    {
-        bbImage = SDL_CreateRGBSurface( 
-	    SDL_SWSURFACE, image->w, image->h, 32, 
-	    rmask, gmask, bmask, amask
-        );
-
-	if( bbImage == NULL)
-	{
-	    fprintf( stderr, "ERROR: Could not create billboard image! (%s)\n",
-	        SDL_GetError( )
-	    );
-	    fflush( stderr);
-
-	} /* End if */
-	else
-	{
-	    int i, totalPixels = ( image->w * image->h);
-	    Uint8 *bbPixels = (Uint8 *)( bbImage->pixels);
-
-	    for( i = 0; i < totalPixels; i++)
-	    {
-	        /* For the moment, assume 24-bit RGB in 
-		 * little-endian form.
-		 */
-                
-		bbPixels[4*i + 0] = ((Uint8 *)( image->pixels))[3*i + 0];
-		bbPixels[4*i + 1] = ((Uint8 *)( image->pixels))[3*i + 1];
-		bbPixels[4*i + 2] = ((Uint8 *)( image->pixels))[3*i + 2];
-
-		if( ( bbPixels[4*i + 0] <= 5) &&
-		    ( bbPixels[4*i + 1] <= 5) &&
-		    ( bbPixels[4*i + 2] <= 5)
-                )
-		{
-		    bbPixels[4*i + 3] = 0x00;
-
-		} /* End if */
-		else
-		{
-		    bbPixels[4*i + 3] = 0xff;
-
-		} /* End else */
-
-	    } /* End for */
-	    
-	} /* End else */
-
-	SDL_FreeSurface( image);
-
-	glBindTexture( GL_TEXTURE_2D, texObjId);
-	CHECK_GL_ERROR;
-
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	CHECK_GL_ERROR;
-
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	CHECK_GL_ERROR;
-
-	glTexParameteri( 
-	    GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR
-	);
-	CHECK_GL_ERROR;
-
-	glTexParameteri( 
-	    GL_TEXTURE_2D, 
-	    GL_TEXTURE_MIN_FILTER, 
-	    GL_LINEAR_MIPMAP_NEAREST
-	);
-	CHECK_GL_ERROR;
-
-	gluBuild2DMipmaps(
-	    GL_TEXTURE_2D,
-	    GL_RGBA,
-	    bbImage->w, bbImage->h,
-	    GL_RGBA, GL_UNSIGNED_BYTE,
-	    bbImage->pixels
-	);
-	CHECK_GL_ERROR;
-
-        retVal = 0;
-
-	SDL_FreeSurface( bbImage);
-
-    } /* End if */
-    else
-    {
-	fprintf( 
-	    stderr,
-	    "\nERROR: Could not load image \"%s\" (%s)\n",
-	    fileName, SDL_GetError( )
-	);
-	fflush( stderr);
-
-        retVal = -1;
-
-    } /* End else */
-
-    return retVal;
-
-} /* End function LoadJPGTexture */
-
-
 /** 
  * Frees up the resources at the end of the program.
  */
-void FreeResources( void)
+void FreeResources( VTEngine *vtEngine, TourData *aTour)
 {
-    Uint32 i;
-
-    /* Free the external model and associated resources */
-    for( i = 0U; i < numExtMaps; i++)
-    {
-        extNumVerts[i] = 0U;
-	free( extVertIndices[i]);
-	extVertIndices[i] = NULL;
+    /* Save any frames still being captured */
+    StopFrameCapture( );
 
-    } /* End for */
-
-    free( extNumVerts);
-    extNumVerts = NULL;
-    free( extVertIndices);
-    extVertIndices = NULL;
+    /* Report OpenGL problems as they happen from here on */
+    StopGLDebug( );
 
-    glDeleteTextures( numExtMaps, extTextures);
-    CHECK_GL_ERROR;
-
-    free( extTextures);
-    extTextures = NULL;
-    free( extTexPriorities);
-    extTexPriorities = NULL;
-
-    if( useBSP == GL_TRUE)
-    {
-	FreeBSPTreeData( extBspModel);
-	extBspModel = NULL;
-
-    } /* End if */
-    else
-    {
-        FreeGLData( extGldModel);
-	extGldModel = NULL;
-
-    } /* End else */
-    
-    FreeGLData( extColDetModel);
-    extColDetModel = NULL;
-
-
-    /* Ditto for the internal model and associated resources */
-    for( i = 0U; i < numIntMaps; i++)
-    {
-        intNumVerts[i] = 0U;
-	free( intVertIndices[i]);
-	intVertIndices[i] = NULL;
-
-    } /* End for */
-
-    free( intNumVerts);
-    intNumVerts = NULL;
-    free( intVertIndices);
-    intVertIndices = NULL;
-
-    glDeleteTextures( numIntMaps, intTextures);
-    CHECK_GL_ERROR;
-
-    free( intTextures);
-    intTextures = NULL;
-    free( intTexPriorities);
-    intTexPriorities = NULL;
-
-    if( useBSP == GL_TRUE)
-    {
-	FreeBSPTreeData( intBspModel);
-	intBspModel = NULL;
-
-    } /* End if */
-    else
-    {
-	FreeGLData( intGldModel);
-	intGldModel = NULL;
-
-    } /* End else */
+    FreeEngine( vtEngine);
 
-    FreeGLData( intColDetModel);
-    intColDetModel = NULL;
+    FreeTour( aTour);
 
 } /* End function FreeResources */
 
@@ -0,0 +1,36 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * VTAJ.H: Constants describing the Taj models and how they are viewed,
+ * shared by the demo and the tools that render views of it.
+ */
+
+#ifndef _VTAJ_H
+#define _VTAJ_H
+
+#ifndef M_PI
+    # define M_PI		3.14159265358979323846F
+#endif
+
+
+/* Viewing parameters */
+
+#define FIELD_OF_VIEW 30.0F
+#define NEAR_Z_CLIP 1.0F
+#define FAR_Z_CLIP 6000.F
+
+
+/* Where the models and their textures are */
+
+#define IMGS_FOLDER_PFX "textures/"
+#define TEX_CACHE_FOLDER_PFX "texcache/"
+#define PROG_BAR_IMG "initwindow.jpg"
+
+#define SCENE_FILE "models/taj.scn"
+
+#endif    /* _VTAJ_H */
+
+
@@ -0,0 +1,921 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * VTRACE.C: Renders reference images of views of the Virtual Taj
+ * Mahal by casting rays on the CPU ("vtaj-trace").
+ *
+ * The images do not depend on an OpenGL driver, so they can serve as
+ * the "ground truth" against which changes to the OpenGL renderer are
+ * checked. They follow what the demo does for GLData models as closely
+ * as possible - the same projection, back face culling, texture
+ * wrapping and filtering (bilinear, with the nearest mipmap), and
+ * the same colour key - and alpha test, for the models that ask for
+ * it. Each view shows
+ * the models of the scene that the demo would show a viewer at that
+ * position.
+ *
+ * The views are read from a views file (see "views.h" for its
+ * format) and the n-th view (counting from zero) is saved as the
+ * binary PPM image "<prefix>nnnnn.ppm".
+ *
+ * Command line options:
+ *   -size <w>x<h>: size of the images (default 320x240)
+ *   -j <n>: cast rays using <n> threads (default: one per processor)
+ *   -o <prefix>: prefix for the names of the images (default "trace")
+ *   -scene <file>: show the models listed in <file> (see "scene.h")
+ *
+ * Rays are cast against a Bounding Volume Hierarchy (see "bvh.h") over
+ * each model. Each image is split into tiles that the threads take
+ * up one at a time, so that threads that get cheap tiles (sky, say)
+ * simply do more of them.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <unistd.h>
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+#include "SDL_thread.h"
+
+#include "gld.h"
+#include "bvh.h"
+#include "texload.h"
+#include "scene.h"
+#include "views.h"
+#include "vtaj.h"
+
+
+/* Literal constants */
+
+#define DEFAULT_IMG_WIDTH 320
+#define DEFAULT_IMG_HEIGHT 240
+
+#define DEFAULT_OUT_PREFIX "trace"
+
+#define MAX_THREADS 64
+
+/* Size of the square tiles handed out to the threads */
+#define TILE_SIZE 16
+
+/* Maximum number of mipmap levels of a texture */
+#define MAX_MIP_LEVELS 16
+
+/* The colour the demo clears the screen with */
+#define CLEAR_RED 0
+#define CLEAR_GREEN 102
+#define CLEAR_BLUE 153
+
+
+/* Data types used locally */
+
+/* A texture image with all its mipmap levels */
+typedef struct _tex_mipmap
+{
+    int numLevels;          /* Zero if the image could not be loaded */
+    int widths[MAX_MIP_LEVELS];
+    int heights[MAX_MIP_LEVELS];
+    Uint8 *levels[MAX_MIP_LEVELS];
+
+} TexMipmap;
+
+
+/* A model along with what it takes to cast rays against it */
+typedef struct _trace_model
+{
+    const SceneModel *sceneModel;
+    GLData *glData;
+    BVHData *bvhData;
+    TexMipmap *texMaps;
+
+} TraceModel;
+
+
+/* The eye and the basis of a view in the coordinates of a model. A
+ * ray parameter of 't' in these is 't * scale' in world coordinates.
+ */
+typedef struct _model_view
+{
+    const TraceModel *aModel;
+
+    GLfloat eyePos[3];
+    GLfloat fwdDir[3];
+    GLfloat sideDir[3];
+    GLfloat upDir[3];
+
+} ModelView;
+
+
+/* The view being traced */
+typedef struct _trace_view
+{
+    Uint32 numActive;
+    ModelView *activeModels;    /* The models the viewer sees */
+
+    GLfloat tanHalfFOV;     /* Vertical */
+    GLfloat aspectRatio;
+    GLfloat pixelSize;      /* Size of a pixel at unit depth */
+
+    Uint8 *pixels;          /* Top row first, RGBA */
+
+} TraceView;
+
+
+/* The state of a ray while its candidate hits are shaded */
+typedef struct _ray_shade
+{
+    const TraceView *aView;
+    const TraceModel *aModel;
+    const GLfloat *rayDir;
+    GLfloat rgba[4];        /* Colour of the last accepted hit */
+
+} RayShade;
+
+
+/* Global data */
+
+static int imgWidth = DEFAULT_IMG_WIDTH;
+static int imgHeight = DEFAULT_IMG_HEIGHT;
+static int numThreads = 0;
+static const char *outPrefix = DEFAULT_OUT_PREFIX;
+static const char *viewFileName = NULL;
+static const char *sceneFileName = SCENE_FILE;
+
+static SceneData *theScene = NULL;
+static TraceModel *traceModels = NULL;
+
+/* Work shared by the threads */
+static TraceView currView;
+static Uint32 numTiles, nextTile;
+static SDL_mutex *tileLock = NULL;
+
+
+/* Local function prototypes */
+
+static void ParseCmdLine( int argc, char *argv[]);
+static void LoadTraceModel(
+    const SceneModel *sceneModel, TraceModel *aModel
+);
+static void BuildMipmaps( TexMipmap *texMap, Uint8 *pixels, int w, int h);
+static void SetupView( const ViewPose *aView);
+static int TraceTiles( void *unused);
+static void TraceTile( Uint32 tileNum);
+static GLboolean ShadeHit( const BVHHit *aHit, void *filterData);
+static void SampleTexture(
+    const TexMipmap *texMap, int level, GLfloat s, GLfloat t,
+    GLfloat rgba[4]
+);
+
+
+/**
+ * The entry point to the program
+ */
+int main( int argc, char *argv[])
+{
+    SDL_Thread *threads[MAX_THREADS];
+    ViewPose *views;
+    Uint32 numViews, numFailed = 0U;
+    Uint32 startTime, endTime;
+    Uint32 i;
+    int j;
+
+    ParseCmdLine( argc, argv);
+
+    /* We only need SDL for its timer and threads */
+    if( SDL_Init( SDL_INIT_TIMER) < 0) 
+    {
+	fprintf( stderr, "Unable to initialise SDL: %s\n", SDL_GetError( ));
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    atexit( SDL_Quit);
+
+    if( ( views = LoadViewPoses( viewFileName, &numViews)) == NULL)
+    {
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    if( numThreads <= 0)
+    {
+#ifdef _SC_NPROCESSORS_ONLN
+	long numCPUs = sysconf( _SC_NPROCESSORS_ONLN);
+
+	numThreads = ( numCPUs > 0L) ? (int )numCPUs : 1;
+#else
+	numThreads = 1;
+#endif
+
+    } /* End if */
+
+    numThreads = ( numThreads > MAX_THREADS) ? MAX_THREADS : numThreads;
+
+
+    /* Load the models and textures, and build the hierarchies */
+    startTime = SDL_GetTicks( );
+
+    if( ( theScene = LoadScene( sceneFileName)) == NULL)
+    {
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    traceModels = (TraceModel *)(
+	malloc( theScene->numModels * sizeof( TraceModel))
+    );
+    currView.activeModels = (ModelView *)(
+	malloc( theScene->numModels * sizeof( ModelView))
+    );
+    if( ( traceModels == NULL) || ( currView.activeModels == NULL))
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( i = 0U; i < theScene->numModels; i++)
+    {
+	LoadTraceModel( theScene->models + i, traceModels + i);
+
+    } /* End for */
+
+    endTime = SDL_GetTicks( );
+
+    printf(
+	"VTAJ-TRACE: Scene ready in %u ms, tracing %u views at %dx%d "
+	"using %d thread(s)\n",
+	( endTime - startTime), numViews, imgWidth, imgHeight, numThreads
+    );
+    fflush( stdout);
+
+
+    /* Trace the views, one at a time */
+    currView.pixels = (Uint8 *)(
+	malloc( 4 * imgWidth * imgHeight * sizeof( Uint8))
+    );
+    tileLock = SDL_CreateMutex( );
+
+    if( ( currView.pixels == NULL) || ( tileLock == NULL))
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    numTiles = ( ( imgWidth + TILE_SIZE - 1) / TILE_SIZE) *
+	( ( imgHeight + TILE_SIZE - 1) / TILE_SIZE);
+
+    startTime = SDL_GetTicks( );
+
+    for( i = 0U; i < numViews; i++)
+    {
+	SetupView( views + i);
+	nextTile = 0U;
+
+	/* The main thread traces tiles too */
+	for( j = 1; j < numThreads; j++)
+	{
+	    threads[j] = SDL_CreateThread( TraceTiles, NULL);
+
+	} /* End for */
+
+	TraceTiles( NULL);
+
+	for( j = 1; j < numThreads; j++)
+	{
+	    if( threads[j] != NULL)
+	    {
+		SDL_WaitThread( threads[j], NULL);
+
+	    } /* End if */
+
+	} /* End for */
+
+	if( SaveViewImage(
+		outPrefix, i, imgWidth, imgHeight, currView.pixels, GL_FALSE
+	    ) != 0
+	)
+	{
+	    numFailed++;
+
+	} /* End if */
+
+    } /* End for */
+
+    endTime = SDL_GetTicks( );
+
+    printf(
+	"VTAJ-TRACE: Done in %u ms (%.2f Mrays/second)\n",
+	( endTime - startTime),
+	( ( endTime > startTime) ?
+	    ( ( (double )numViews * imgWidth * imgHeight) /
+		( 1000.0 * ( endTime - startTime))) :
+	    0.0
+	)
+    );
+    fflush( stdout);
+
+    SDL_DestroyMutex( tileLock);
+    free( currView.pixels);
+    free( views);
+
+    return ( numFailed == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} /* End function main */
+
+
+/**
+ * Parse the command line and set appropriate flags and variables.
+ */
+void ParseCmdLine( int argc, char *argv[])
+{
+    GLboolean parseError = GL_FALSE;
+    int i;
+
+    for( i = 1; i < argc; i++)
+    {
+	if( ( strcmp( "-size", argv[i]) == 0) && ( ( i + 1) < argc))
+	{
+	    if( ( sscanf( argv[++i], "%dx%d", &imgWidth, &imgHeight) != 2) ||
+		( imgWidth <= 0) || ( imgHeight <= 0)
+	    )
+	    {
+		parseError = GL_TRUE;
+		break;
+
+	    } /* End if */
+
+	} /* End if */
+	else if( ( strcmp( "-j", argv[i]) == 0) && ( ( i + 1) < argc))
+	{
+	    numThreads = atoi( argv[++i]);
+	    if( numThreads <= 0)
+	    {
+		parseError = GL_TRUE;
+		break;
+
+	    } /* End if */
+
+	} /* End else-if */
+	else if( ( strcmp( "-o", argv[i]) == 0) && ( ( i + 1) < argc))
+	{
+	    outPrefix = argv[++i];
+
+	} /* End else-if */
+	else if( ( strcmp( "-scene", argv[i]) == 0) && ( ( i + 1) < argc))
+	{
+	    sceneFileName = argv[++i];
+
+	} /* End else-if */
+	else if( ( argv[i][0] != '-') && ( viewFileName == NULL))
+	{
+	    viewFileName = argv[i];
+
+	} /* End else-if */
+	else
+	{
+	    parseError = GL_TRUE;
+	    break;
+
+	} /* End else */
+
+    } /* End for */
+
+
+    if( ( parseError == GL_TRUE) || ( viewFileName == NULL))
+    {
+	fprintf(
+	    stderr,
+	    "VTAJ-TRACE: Ray trace reference images of the Virtual Taj\n"
+	);
+	fprintf(
+	    stderr,
+	    "Usage: %s [-size <w>x<h>] [-j <n>] [-o <prefix>] "
+	    "[-scene <file>] <viewfile>\n",
+	    argv[0]
+	);
+	fprintf(
+	    stderr,
+	    "\t-size: size of the images (default %dx%d)\n",
+	    DEFAULT_IMG_WIDTH, DEFAULT_IMG_HEIGHT
+	);
+	fprintf(
+	    stderr,
+	    "\t   -j: number of threads (default one per CPU)\n"
+	);
+	fprintf(
+	    stderr,
+	    "\t   -o: prefix for the image names (default \"%s\")\n",
+	    DEFAULT_OUT_PREFIX
+	);
+	fprintf(
+	    stderr,
+	    "\t-scene: show the models listed in <file> (default \"%s\")\n",
+	    SCENE_FILE
+	);
+	fprintf(
+	    stderr,
+	    "Each line of <viewfile> is \"x y z angle\" (angle in degrees)\n"
+	);
+
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+} /* End function ParseCmdLine */
+
+
+/**
+ * Loads the GLData version of a model of the scene and its textures,
+ * and builds its BVH. Exits if the model can not be loaded. Textures
+ * that can not be loaded are left empty.
+ */
+void LoadTraceModel( const SceneModel *sceneModel, TraceModel *aModel)
+{
+    const char *fileName = sceneModel->gldFileName;
+    char texFileName[256];
+    FILE *mdlFile;
+    Uint16 i;
+
+    aModel->sceneModel = sceneModel;
+
+    if( ( mdlFile = fopen( fileName, "rb")) == NULL)
+    {
+	fprintf(
+	    stderr,
+	    "\nERROR: Could not read VirtualTaj GLD model \"%s\"\n", fileName
+	);
+	perror( "Details");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    aModel->glData = LoadGLData( mdlFile);
+    fclose( mdlFile);
+
+    if( aModel->glData == NULL)
+    {
+	fprintf(
+	    stderr,
+	    "\nERROR: Invalid VirtualTaj GLD model \"%s\"\n", fileName
+	);
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    aModel->bvhData = GenBVHData( aModel->glData);
+
+    aModel->texMaps = (TexMipmap *)(
+	calloc( aModel->glData->nMaps + 1U, sizeof( TexMipmap))
+    );
+    if( aModel->texMaps == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( i = 0U; i < aModel->glData->nMaps; i++)
+    {
+	Uint8 *pixels;
+	int width, height;
+
+	strcpy( texFileName, IMGS_FOLDER_PFX);
+	strcat( texFileName, aModel->glData->mapNames[i]);
+
+	pixels = LoadJPGImage( texFileName, 1, &width, &height);
+	if( pixels != NULL)
+	{
+	    BuildMipmaps( aModel->texMaps + i, pixels, width, height);
+
+	} /* End if */
+
+    } /* End for */
+
+} /* End function LoadTraceModel */
+
+
+/**
+ * Builds the mipmap levels of a texture image the way
+ * 'gluBuild2DMipmaps' does for images with power-of-two sizes - each
+ * level averages 2x2 blocks of the level above it. The texture takes
+ * over the given pixels as its first level.
+ */
+void BuildMipmaps( TexMipmap *texMap, Uint8 *pixels, int w, int h)
+{
+    int n = 0;
+
+    texMap->levels[0] = pixels;
+    texMap->widths[0] = w;
+    texMap->heights[0] = h;
+
+    while( ( ( w > 1) || ( h > 1)) && ( ( n + 1) < MAX_MIP_LEVELS))
+    {
+	const Uint8 *srcPixels = texMap->levels[n];
+	int srcW = w, srcH = h;
+	Uint8 *dstPixels;
+	int x, y, c;
+
+	w = ( w > 1) ? ( w / 2) : 1;
+	h = ( h > 1) ? ( h / 2) : 1;
+
+	dstPixels = (Uint8 *)( malloc( 4 * w * h * sizeof( Uint8)));
+	if( dstPixels == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	for( y = 0; y < h; y++)
+	{
+	    int y0 = ( srcH > 1) ? ( 2 * y) : y;
+	    int y1 = ( srcH > 1) ? ( 2 * y + 1) : y;
+
+	    for( x = 0; x < w; x++)
+	    {
+		int x0 = ( srcW > 1) ? ( 2 * x) : x;
+		int x1 = ( srcW > 1) ? ( 2 * x + 1) : x;
+
+		for( c = 0; c < 4; c++)
+		{
+		    dstPixels[4*( y*w + x) + c] = (Uint8 )( (
+			srcPixels[4*( y0*srcW + x0) + c] +
+			srcPixels[4*( y0*srcW + x1) + c] +
+			srcPixels[4*( y1*srcW + x0) + c] +
+			srcPixels[4*( y1*srcW + x1) + c] + 2) / 4
+		    );
+
+		} /* End for */
+
+	    } /* End for */
+
+	} /* End for */
+
+	n++;
+	texMap->levels[n] = dstPixels;
+	texMap->widths[n] = w;
+	texMap->heights[n] = h;
+
+    } /* End while */
+
+    texMap->numLevels = n + 1;
+
+} /* End function BuildMipmaps */
+
+
+/**
+ * Sets up 'currView' for tracing the given view, the way the demo
+ * would show it.
+ */
+void SetupView( const ViewPose *aView)
+{
+    GLdouble fwdDir[3], sideDir[3], upDir[3];
+    GLdouble modelDir[3];
+    Uint32 i;
+    int m;
+
+    /* The basis 'gluLookAt' sets up for a viewer looking horizontally */
+    fwdDir[0] = cos( aView->angleOfView);
+    fwdDir[1] = 0.0;
+    fwdDir[2] = sin( aView->angleOfView);
+
+    sideDir[0] = -fwdDir[2];
+    sideDir[1] = 0.0;
+    sideDir[2] = fwdDir[0];
+
+    upDir[0] = 0.0;
+    upDir[1] = 1.0;
+    upDir[2] = 0.0;
+
+    currView.numActive = 0U;
+
+    for( i = 0U; i < theScene->numModels; i++)
+    {
+	const SceneModel *sceneModel = theScene->models + i;
+	ModelView *modelView;
+
+	if( IsSceneModelActive( sceneModel, aView->vPos) == GL_FALSE)
+	{
+	    continue;
+
+	} /* End if */
+
+	modelView = currView.activeModels + currView.numActive++;
+	modelView->aModel = traceModels + i;
+
+	WorldToModelPoint( sceneModel, aView->vPos, modelView->eyePos);
+
+	WorldToModelDir( sceneModel, fwdDir, modelDir);
+	for( m = 0; m < 3; m++)
+	{
+	    modelView->fwdDir[m] = (GLfloat )modelDir[m];
+
+	} /* End for */
+
+	WorldToModelDir( sceneModel, sideDir, modelDir);
+	for( m = 0; m < 3; m++)
+	{
+	    modelView->sideDir[m] = (GLfloat )modelDir[m];
+
+	} /* End for */
+
+	WorldToModelDir( sceneModel, upDir, modelDir);
+	for( m = 0; m < 3; m++)
+	{
+	    modelView->upDir[m] = (GLfloat )modelDir[m];
+
+	} /* End for */
+
+    } /* End for */
+
+    currView.tanHalfFOV = (GLfloat )tan( ( FIELD_OF_VIEW / 2.0) * M_PI / 180.0);
+    currView.aspectRatio = (GLfloat )imgWidth / (GLfloat )imgHeight;
+    currView.pixelSize = ( 2.0F * currView.tanHalfFOV) / (GLfloat )imgHeight;
+
+} /* End function SetupView */
+
+
+/**
+ * Traces tiles of the current view until none are left.
+ */
+int TraceTiles( void *unused)
+{
+    (void )unused;
+
+    for( ; ; )
+    {
+	Uint32 tileNum;
+
+	SDL_LockMutex( tileLock);
+	tileNum = nextTile++;
+	SDL_UnlockMutex( tileLock);
+
+	if( tileNum >= numTiles)
+	{
+	    break;
+
+	} /* End if */
+
+	TraceTile( tileNum);
+
+    } /* End for */
+
+    return 0;
+
+} /* End function TraceTiles */
+
+
+/**
+ * Casts a ray through the centre of each pixel of the given tile of
+ * the current view.
+ */
+void TraceTile( Uint32 tileNum)
+{
+    int tilesPerRow = ( imgWidth + TILE_SIZE - 1) / TILE_SIZE;
+    int startX = ( tileNum % tilesPerRow) * TILE_SIZE;
+    int startY = ( tileNum / tilesPerRow) * TILE_SIZE;
+    int endX = ( ( startX + TILE_SIZE) < imgWidth) ?
+	( startX + TILE_SIZE) : imgWidth;
+    int endY = ( ( startY + TILE_SIZE) < imgHeight) ?
+	( startY + TILE_SIZE) : imgHeight;
+    int x, y;
+
+    for( y = startY; y < endY; y++)
+    {
+	/* Image rows go downwards, OpenGL window rows upwards */
+	GLfloat camY = currView.tanHalfFOV *
+	    ( 1.0F - ( 2.0F * ( y + 0.5F)) / (GLfloat )imgHeight);
+
+	for( x = startX; x < endX; x++)
+	{
+	    GLfloat camX = currView.tanHalfFOV * currView.aspectRatio *
+		( ( ( 2.0F * ( x + 0.5F)) / (GLfloat )imgWidth) - 1.0F);
+	    Uint8 *aPixel = currView.pixels + 4 * ( y * imgWidth + x);
+	    GLfloat nearestT = FAR_Z_CLIP;
+	    GLboolean isHit = GL_FALSE;
+	    Uint32 k;
+
+	    /* The models are traced one by one, each only up to the
+	     * nearest hit found so far (in world coordinates).
+	     */
+	    for( k = 0U; k < currView.numActive; k++)
+	    {
+		const ModelView *modelView = currView.activeModels + k;
+		GLfloat scale = modelView->aModel->sceneModel->scale;
+		GLfloat rayDir[3];
+		RayShade rayShade;
+		BVHHit aHit;
+		int m;
+
+		/* With a unit forward component, the ray parameter is
+		 * the depth of a point (times the scale of the model),
+		 * which is what the clip planes limit.
+		 */
+		for( m = 0; m < 3; m++)
+		{
+		    rayDir[m] = modelView->fwdDir[m] +
+			camX * modelView->sideDir[m] +
+			camY * modelView->upDir[m];
+
+		} /* End for */
+
+		rayShade.aView = &currView;
+		rayShade.aModel = modelView->aModel;
+		rayShade.rayDir = rayDir;
+
+		if( IntersectBVH(
+			modelView->aModel->bvhData, modelView->eyePos, rayDir,
+			NEAR_Z_CLIP / scale, nearestT / scale, GL_TRUE,
+			ShadeHit, &rayShade, &aHit
+		    ) == GL_TRUE
+		)
+		{
+		    nearestT = aHit.t * scale;
+		    isHit = GL_TRUE;
+
+		    aPixel[0] = (Uint8 )( rayShade.rgba[0] + 0.5F);
+		    aPixel[1] = (Uint8 )( rayShade.rgba[1] + 0.5F);
+		    aPixel[2] = (Uint8 )( rayShade.rgba[2] + 0.5F);
+
+		} /* End if */
+
+	    } /* End for */
+
+	    if( isHit == GL_FALSE)
+	    {
+		aPixel[0] = CLEAR_RED;
+		aPixel[1] = CLEAR_GREEN;
+		aPixel[2] = CLEAR_BLUE;
+
+	    } /* End if */
+
+	    aPixel[3] = 0xff;
+
+	} /* End for */
+
+    } /* End for */
+
+} /* End function TraceTile */
+
+
+/**
+ * Finds the colour of a candidate hit, rejecting it if it fails the
+ * alpha test. The mipmap level is chosen from the size of the pixel's
+ * footprint on the triangle, measured in texels.
+ */
+GLboolean ShadeHit( const BVHHit *aHit, void *filterData)
+{
+    RayShade *rayShade = (RayShade *)filterData;
+    const TraceView *aView = rayShade->aView;
+    const BVHTri *aTri = aHit->aTri;
+    const TraceModel *aModel = rayShade->aModel;
+    const TexMipmap *texMap = aModel->texMaps + aTri->texIndex;
+    const GLData *glData = aModel->glData;
+    GLboolean alphaTest = aModel->sceneModel->alphaTest;
+    const GLfloat *uv0 = GLD_TEX_COORDS( glData, aTri->vIndices[0]);
+    const GLfloat *uv1 = GLD_TEX_COORDS( glData, aTri->vIndices[1]);
+    const GLfloat *uv2 = GLD_TEX_COORDS( glData, aTri->vIndices[2]);
+    GLfloat w0 = 1.0F - aHit->u - aHit->v;
+    GLfloat s, t;
+    GLfloat rgba[4];
+    int level = 0;
+
+    if( texMap->numLevels == 0)
+    {
+	/* OpenGL ignores incomplete textures and uses the current
+	 * colour, whose alpha is zero.
+	 */
+	if( alphaTest == GL_TRUE)
+	{
+	    return GL_FALSE;
+
+	} /* End if */
+
+	rayShade->rgba[0] = rayShade->rgba[1] = rayShade->rgba[2] = 255.0F;
+	rayShade->rgba[3] = 0.0F;
+
+	return GL_TRUE;
+
+    } /* End if */
+
+    s = w0*uv0[0] + aHit->u*uv1[0] + aHit->v*uv2[0];
+    t = w0*uv0[1] + aHit->u*uv1[1] + aHit->v*uv2[1];
+
+    if( texMap->numLevels > 1)
+    {
+	const GLfloat *dir = rayShade->rayDir;
+	GLfloat normal[3];
+	GLfloat worldArea, texArea, rayLen, cosTheta, footprint, lambda;
+
+	normal[0] = aTri->e1[1]*aTri->e2[2] - aTri->e1[2]*aTri->e2[1];
+	normal[1] = aTri->e1[2]*aTri->e2[0] - aTri->e1[0]*aTri->e2[2];
+	normal[2] = aTri->e1[0]*aTri->e2[1] - aTri->e1[1]*aTri->e2[0];
+
+	worldArea = (GLfloat )sqrt(
+	    normal[0]*normal[0] + normal[1]*normal[1] + normal[2]*normal[2]
+	);
+	texArea = (GLfloat )fabs(
+	    ( uv1[0] - uv0[0]) * ( uv2[1] - uv0[1]) -
+	    ( uv2[0] - uv0[0]) * ( uv1[1] - uv0[1])
+	) * texMap->widths[0] * texMap->heights[0];
+	rayLen = (GLfloat )sqrt( dir[0]*dir[0] + dir[1]*dir[1] + dir[2]*dir[2]);
+
+	if( ( worldArea > 0.0F) && ( texArea > 0.0F))
+	{
+	    cosTheta = (GLfloat )fabs(
+		dir[0]*normal[0] + dir[1]*normal[1] + dir[2]*normal[2]
+	    ) / ( worldArea * rayLen);
+	    cosTheta = ( cosTheta < 0.01F) ? 0.01F : cosTheta;
+
+	    footprint = ( aHit->t * aView->pixelSize) / cosTheta;
+	    lambda = (GLfloat )( log(
+		footprint * sqrt( texArea / worldArea)
+	    ) / log( 2.0));
+
+	    /* GL_LINEAR_MIPMAP_NEAREST picks the nearest level */
+	    if( lambda > 0.5F)
+	    {
+		level = (int )ceil( lambda + 0.5F) - 1;
+		level = ( level >= texMap->numLevels) ?
+		    ( texMap->numLevels - 1) : level;
+
+	    } /* End if */
+
+	} /* End if */
+
+    } /* End if */
+
+    SampleTexture( texMap, level, s, t, rgba);
+
+    if( ( alphaTest == GL_TRUE) && ( rgba[3] <= 127.5F))
+    {
+	return GL_FALSE;
+
+    } /* End if */
+
+    /* Only the colour of an accepted hit may replace the last one */
+    rayShade->rgba[0] = rgba[0];
+    rayShade->rgba[1] = rgba[1];
+    rayShade->rgba[2] = rgba[2];
+    rayShade->rgba[3] = rgba[3];
+
+    return GL_TRUE;
+
+} /* End function ShadeHit */
+
+
+/**
+ * Samples a level of a texture with bilinear filtering, wrapping
+ * texture coordinates around (GL_REPEAT). The first row of a texture
+ * image is at t = 0. The components are returned in [0, 255].
+ */
+void SampleTexture(
+    const TexMipmap *texMap, int level, GLfloat s, GLfloat t,
+    GLfloat rgba[4]
+)
+{
+    int w = texMap->widths[level];
+    int h = texMap->heights[level];
+    const Uint8 *pixels = texMap->levels[level];
+    GLfloat texX = s * w - 0.5F;
+    GLfloat texY = t * h - 0.5F;
+    GLfloat floorX = (GLfloat )floor( texX);
+    GLfloat floorY = (GLfloat )floor( texY);
+    GLfloat fracX = texX - floorX;
+    GLfloat fracY = texY - floorY;
+    int x0, x1, y0, y1, c;
+
+    x0 = (int )fmod( floorX, (double )w);
+    x0 = ( x0 < 0) ? ( x0 + w) : x0;
+    x1 = ( x0 + 1) % w;
+
+    y0 = (int )fmod( floorY, (double )h);
+    y0 = ( y0 < 0) ? ( y0 + h) : y0;
+    y1 = ( y0 + 1) % h;
+
+    for( c = 0; c < 4; c++)
+    {
+	GLfloat top = pixels[4*( y0*w + x0) + c] * ( 1.0F - fracX) +
+	    pixels[4*( y0*w + x1) + c] * fracX;
+	GLfloat bottom = pixels[4*( y1*w + x0) + c] * ( 1.0F - fracX) +
+	    pixels[4*( y1*w + x1) + c] * fracX;
+
+	rgba[c] = top * ( 1.0F - fracY) + bottom * fracY;
+
+    } /* End for */
+
+} /* End function SampleTexture */
+
+
@@ -0,0 +1,702 @@
+/* Copyright (c) 2001 Ranjit Mathew. All rights reserved.
+ * Use of this source code is governed by the terms of the BSD licence
+ * that can be found in the LICENCE file.
+ */
+
+/*
+ * VTRENDER.C: Renders a set of views of the Virtual Taj Mahal to
+ * image files, without needing a display ("vtaj-render").
+ *
+ * The views are read from a views file (see "views.h" for its
+ * format) and the n-th view (counting from zero) is saved as the
+ * binary PPM image "<prefix>nnnnn.ppm".
+ *
+ * Command line options:
+ *   -size <w>x<h>: size of the images (default 320x240)
+ *   -j <n>: render using <n> worker processes (default: one per
+ *      processor)
+ *   -o <prefix>: prefix for the names of the images (default "view")
+ *   -scene <file>: show the models listed in <file> (see "scene.h")
+ *
+ * Each view shows the models of the scene that the demo would show a
+ * viewer at that position. The GLData models are loaded and the textures decoded only once,
+ * before the worker processes are forked off, so that all the workers
+ * share them. Each worker renders every n-th view into its own
+ * off-screen OSMesa context. Since we already use a process per
+ * processor, the workers ask Mesa's "llvmpipe" rasteriser not to
+ * start threads of its own, unless LP_NUM_THREADS says otherwise.
+ *
+ * Requires Mesa with OSMesa, SDL_image and a POSIX system.
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/time.h>
+
+/* We do not want SDL to automatically include "glext.h" */
+#define NO_SDL_GLEXT
+
+#include "SDL.h"
+#include "SDL_opengl.h"
+
+#include <GL/osmesa.h>
+
+#include "gld.h"
+#include "glutil.h"
+#include "texload.h"
+#include "scene.h"
+#include "views.h"
+#include "vtaj.h"
+
+
+/* Literal constants */
+
+#define DEFAULT_IMG_WIDTH 320
+#define DEFAULT_IMG_HEIGHT 240
+
+#define DEFAULT_OUT_PREFIX "view"
+
+
+/* Data types used locally */
+
+/* A decoded texture image */
+typedef struct _tex_image
+{
+    int width;
+    int height;
+    Uint8 *pixels;
+
+} TexImage;
+
+
+/* Global data */
+
+static int imgWidth = DEFAULT_IMG_WIDTH;
+static int imgHeight = DEFAULT_IMG_HEIGHT;
+static int numWorkers = 0;
+static const char *outPrefix = DEFAULT_OUT_PREFIX;
+static const char *viewFileName = NULL;
+static const char *sceneFileName = SCENE_FILE;
+
+static ViewPose *views = NULL;
+static Uint32 numViews = 0U;
+
+/* The scene shared by all the workers, with the GLData model and the
+ * texture images of each of its models
+ */
+static SceneData *theScene = NULL;
+static GLData **gldModels = NULL;
+static TexImage **texImages = NULL;
+
+
+/* Local function prototypes */
+
+static void ParseCmdLine( int argc, char *argv[]);
+static GLData *LoadModel( const char *fileName);
+static TexImage *LoadImages( GLData *aModel);
+static GLuint *UploadImages( GLData *aModel, TexImage *texImages);
+static void InitContext( void);
+static Uint32 RenderViews( int workerNum);
+static double GetSeconds( void);
+
+
+/**
+ * The entry point to the program
+ */
+int main( int argc, char *argv[])
+{
+    int i;
+    Uint32 k;
+    Uint32 numFailed = 0U;
+    double startTime, endTime;
+
+    ParseCmdLine( argc, argv);
+
+    if( ( views = LoadViewPoses( viewFileName, &numViews)) == NULL)
+    {
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    if( numWorkers <= 0)
+    {
+	long numCPUs = sysconf( _SC_NPROCESSORS_ONLN);
+
+	numWorkers = ( numCPUs > 0L) ? (int )numCPUs : 1;
+
+    } /* End if */
+
+    if( (Uint32 )numWorkers > numViews)
+    {
+	numWorkers = ( numViews > 0U) ? (int )numViews : 1;
+
+    } /* End if */
+
+
+    /* Load the scene once for all the workers */
+    if( ( theScene = LoadScene( sceneFileName)) == NULL)
+    {
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    gldModels = (GLData **)(
+	malloc( theScene->numModels * sizeof( GLData *))
+    );
+    texImages = (TexImage **)(
+	malloc( theScene->numModels * sizeof( TexImage *))
+    );
+    if( ( gldModels == NULL) || ( texImages == NULL))
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( k = 0U; k < theScene->numModels; k++)
+    {
+	gldModels[k] = LoadModel( theScene->models[k].gldFileName);
+	texImages[k] = LoadImages( gldModels[k]);
+
+    } /* End for */
+
+    printf(
+	"VTAJ-RENDER: Rendering %u views at %dx%d using %d worker(s)\n",
+	numViews, imgWidth, imgHeight, numWorkers
+    );
+    fflush( stdout);
+
+    startTime = GetSeconds( );
+
+    if( numWorkers == 1)
+    {
+	numFailed = RenderViews( 0);
+
+    } /* End if */
+    else
+    {
+	pid_t *workerPids = (pid_t *)( malloc( numWorkers * sizeof( pid_t)));
+
+	if( workerPids == NULL)
+	{
+	    fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	    exit( EXIT_FAILURE);
+
+	} /* End if */
+
+	/* One process per processor is all the parallelism we need */
+	setenv( "LP_NUM_THREADS", "0", 0);
+
+	for( i = 0; i < numWorkers; i++)
+	{
+	    workerPids[i] = fork( );
+
+	    if( workerPids[i] == 0)
+	    {
+		/* In the worker */
+		_exit(
+		    ( RenderViews( i) == 0U) ? EXIT_SUCCESS : EXIT_FAILURE
+		);
+
+	    } /* End if */
+	    else if( workerPids[i] < 0)
+	    {
+		perror( "VTAJ-RENDER: Could not start worker");
+		numFailed++;
+
+	    } /* End else-if */
+
+	} /* End for */
+
+	/* A worker can not report how many views it failed to save
+	 * through its exit status, so count failed workers instead.
+	 */
+	for( i = 0; i < numWorkers; i++)
+	{
+	    int workerStatus;
+
+	    if( workerPids[i] > 0)
+	    {
+		if( ( waitpid( workerPids[i], &workerStatus, 0) < 0) ||
+		    !WIFEXITED( workerStatus) ||
+		    ( WEXITSTATUS( workerStatus) != EXIT_SUCCESS)
+		)
+		{
+		    fprintf(
+			stderr, "\nERROR: Worker %d failed!\n", i
+		    );
+		    numFailed++;
+
+		} /* End if */
+
+	    } /* End if */
+
+	} /* End for */
+
+	free( workerPids);
+
+    } /* End else */
+
+    endTime = GetSeconds( );
+
+    printf(
+	"VTAJ-RENDER: Done in %.2f seconds (%.1f views/second)\n",
+	( endTime - startTime),
+	( ( endTime > startTime) ?
+	    ( numViews / ( endTime - startTime)) : 0.0
+	)
+    );
+    fflush( stdout);
+
+    return ( numFailed == 0U) ? EXIT_SUCCESS : EXIT_FAILURE;
+
+} /* End function main */
+
+
+/**
+ * Parse the command line and set appropriate flags and variables.
+ */
+void ParseCmdLine( int argc, char *argv[])
+{
+    GLboolean parseError = GL_FALSE;
+    int i;
+
+    for( i = 1; i < argc; i++)
+    {
+	if( ( strcmp( "-size", argv[i]) == 0) && ( ( i + 1) < argc))
+	{
+	    if( ( sscanf( argv[++i], "%dx%d", &imgWidth, &imgHeight) != 2) ||
+		( imgWidth <= 0) || ( imgHeight <= 0)
+	    )
+	    {
+		parseError = GL_TRUE;
+		break;
+
+	    } /* End if */
+
+	} /* End if */
+	else if( ( strcmp( "-j", argv[i]) == 0) && ( ( i + 1) < argc))
+	{
+	    numWorkers = atoi( argv[++i]);
+	    if( numWorkers <= 0)
+	    {
+		parseError = GL_TRUE;
+		break;
+
+	    } /* End if */
+
+	} /* End else-if */
+	else if( ( strcmp( "-o", argv[i]) == 0) && ( ( i + 1) < argc))
+	{
+	    outPrefix = argv[++i];
+
+	} /* End else-if */
+	else if( ( strcmp( "-scene", argv[i]) == 0) && ( ( i + 1) < argc))
+	{
+	    sceneFileName = argv[++i];
+
+	} /* End else-if */
+	else if( ( argv[i][0] != '-') && ( viewFileName == NULL))
+	{
+	    viewFileName = argv[i];
+
+	} /* End else-if */
+	else
+	{
+	    parseError = GL_TRUE;
+	    break;
+
+	} /* End else */
+
+    } /* End for */
+
+
+    if( ( parseError == GL_TRUE) || ( viewFileName == NULL))
+    {
+	fprintf(
+	    stderr,
+	    "VTAJ-RENDER: Render views of the Virtual Taj to PPM images\n"
+	);
+	fprintf(
+	    stderr,
+	    "Usage: %s [-size <w>x<h>] [-j <n>] [-o <prefix>] "
+	    "[-scene <file>] <viewfile>\n",
+	    argv[0]
+	);
+	fprintf(
+	    stderr,
+	    "\t-size: size of the images (default %dx%d)\n",
+	    DEFAULT_IMG_WIDTH, DEFAULT_IMG_HEIGHT
+	);
+	fprintf(
+	    stderr,
+	    "\t   -j: number of worker processes (default one per CPU)\n"
+	);
+	fprintf(
+	    stderr,
+	    "\t   -o: prefix for the image names (default \"%s\")\n",
+	    DEFAULT_OUT_PREFIX
+	);
+	fprintf(
+	    stderr,
+	    "\t-scene: show the models listed in <file> (default \"%s\")\n",
+	    SCENE_FILE
+	);
+	fprintf(
+	    stderr,
+	    "Each line of <viewfile> is \"x y z angle\" (angle in degrees)\n"
+	);
+
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+} /* End function ParseCmdLine */
+
+
+/**
+ * Loads a GLData model, exiting on errors.
+ */
+GLData *LoadModel( const char *fileName)
+{
+    FILE *mdlFile;
+    GLData *retVal;
+
+    if( ( mdlFile = fopen( fileName, "rb")) == NULL)
+    {
+	fprintf(
+	    stderr,
+	    "\nERROR: Could not read VirtualTaj GLD model \"%s\"\n", fileName
+	);
+	perror( "Details");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    retVal = LoadGLData( mdlFile);
+    fclose( mdlFile);
+
+    if( retVal == NULL)
+    {
+	fprintf(
+	    stderr,
+	    "\nERROR: Invalid VirtualTaj GLD model \"%s\"\n", fileName
+	);
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    return retVal;
+
+} /* End function LoadModel */
+
+
+/**
+ * Decodes the texture images used by a model. Images that could not
+ * be loaded are left empty - the triangles using them are then drawn
+ * untextured.
+ */
+TexImage *LoadImages( GLData *aModel)
+{
+    char texFileName[256];
+    TexImage *retVal;
+    Uint16 i;
+
+    retVal = (TexImage *)( calloc( aModel->nMaps + 1U, sizeof( TexImage)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    for( i = 0U; i < aModel->nMaps; i++)
+    {
+	strcpy( texFileName, IMGS_FOLDER_PFX);
+	strcat( texFileName, aModel->mapNames[i]);
+
+	retVal[i].pixels = LoadJPGImage(
+	    texFileName, 1, &( retVal[i].width), &( retVal[i].height)
+	);
+
+    } /* End for */
+
+    return retVal;
+
+} /* End function LoadImages */
+
+
+/**
+ * Creates texture objects in the current context for the decoded
+ * texture images of a model.
+ */
+GLuint *UploadImages( GLData *aModel, TexImage *texImages)
+{
+    GLuint *retVal;
+    Uint16 i;
+
+    retVal = (GLuint *)( malloc( ( aModel->nMaps + 1U) * sizeof( GLuint)));
+    if( retVal == NULL)
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    glGenTextures( aModel->nMaps, retVal);
+    CHECK_GL_ERROR;
+
+    for( i = 0U; i < aModel->nMaps; i++)
+    {
+	if( texImages[i].pixels != NULL)
+	{
+	    UploadTexture(
+		retVal[i], texImages[i].width, texImages[i].height,
+		texImages[i].pixels
+	    );
+
+	} /* End if */
+
+    } /* End for */
+
+    return retVal;
+
+} /* End function UploadImages */
+
+
+/**
+ * Sets up the OpenGL state of a worker's context the way the demo
+ * sets up its own for GLData models.
+ */
+void InitContext( void)
+{
+    glViewport( 0, 0, (GLsizei )imgWidth, (GLsizei )imgHeight); 
+    CHECK_GL_ERROR;
+
+    glClearColor( 0.0F, 0.4F, 0.6F, 0.0F); 
+    glEnable( GL_DEPTH_TEST);
+    glClearDepth( +1.0F);
+    glDepthFunc( GL_LEQUAL);
+
+    glFrontFace( GL_CCW);
+    glCullFace( GL_BACK);
+    glEnable( GL_CULL_FACE);
+
+    glEnable( GL_TEXTURE_2D);
+    glTexEnvf( GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+    glAlphaFunc( GL_GREATER, 0.5F);
+    glShadeModel( GL_FLAT);
+    glHint( GL_PERSPECTIVE_CORRECTION_HINT, GL_FASTEST);
+    glColor4f( 1.0F, 1.0F, 1.0F, 0.0F);
+    CHECK_GL_ERROR;
+
+    glEnableClientState( GL_VERTEX_ARRAY);
+    glEnableClientState( GL_TEXTURE_COORD_ARRAY);
+    CHECK_GL_ERROR;
+
+    glMatrixMode( GL_PROJECTION);
+    glLoadIdentity( );
+
+    gluPerspective( 
+	FIELD_OF_VIEW, (GLfloat )imgWidth/(GLfloat )imgHeight,
+	NEAR_Z_CLIP, FAR_Z_CLIP
+    );
+    CHECK_GL_ERROR;
+
+    glMatrixMode( GL_MODELVIEW);
+    glLoadIdentity( );
+
+} /* End function InitContext */
+
+
+/**
+ * Renders and saves the views handled by the given worker, that is
+ * every 'numWorkers'-th view starting with view number 'workerNum'.
+ * Returns the number of views that could not be saved.
+ */
+Uint32 RenderViews( int workerNum)
+{
+    OSMesaContext osCtx;
+    Uint8 *frameBuf;
+    GLuint **textures;
+    GLData *currGldModel = NULL;
+    Uint32 numFailed = 0U;
+    Uint32 i, j, k;
+
+    frameBuf = (Uint8 *)( malloc( 4 * imgWidth * imgHeight * sizeof( Uint8)));
+    textures = (GLuint **)(
+	malloc( theScene->numModels * sizeof( GLuint *))
+    );
+    if( ( frameBuf == NULL) || ( textures == NULL))
+    {
+	fprintf( stderr, "\nFATAL ERROR: Out of Memory!\n");
+	exit( EXIT_FAILURE);
+
+    } /* End if */
+
+    osCtx = OSMesaCreateContextExt( OSMESA_RGBA, 24, 0, 0, NULL);
+    if( ( osCtx == NULL) ||
+	( OSMesaMakeCurrent(
+	    osCtx, frameBuf, GL_UNSIGNED_BYTE, imgWidth, imgHeight
+	  ) == GL_FALSE
+	)
+    )
+    {
+	fprintf(
+	    stderr,
+	    "\nERROR: Worker %d could not create an OSMesa context!\n",
+	    workerNum
+	);
+	return numViews;
+
+    } /* End if */
+
+    InitContext( );
+
+    for( k = 0U; k < theScene->numModels; k++)
+    {
+	textures[k] = UploadImages( gldModels[k], texImages[k]);
+
+    } /* End for */
+
+
+    for( i = (Uint32 )workerNum; i < numViews; i += (Uint32 )numWorkers)
+    {
+	ViewPose *aView = views + i;
+
+	glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glLoadIdentity( );
+	gluLookAt( 
+	    aView->vPos[0], aView->vPos[1], aView->vPos[2], 
+	    aView->vPos[0] + ( 1.0F * cos( aView->angleOfView)), 
+	    aView->vPos[1], 
+	    aView->vPos[2] + ( 1.0F * sin( aView->angleOfView)), 
+	    0.0F, 1.0F, 0.0F
+	);
+
+	for( k = 0U; k < theScene->numModels; k++)
+	{
+	    const SceneModel *sceneModel = theScene->models + k;
+	    GLData *aGldModel = gldModels[k];
+
+	    if( IsSceneModelActive( sceneModel, aView->vPos) == GL_FALSE)
+	    {
+		continue;
+
+	    } /* End if */
+
+	    /* Switch models only when we must */
+	    if( aGldModel != currGldModel)
+	    {
+		currGldModel = aGldModel;
+
+		glVertexPointer( 
+		    3, GL_FLOAT, 
+		    (GLsizei )( currGldModel->vertStride * sizeof( GLfloat)),
+		    currGldModel->vertCoords
+		);
+		glTexCoordPointer( 
+		    2, GL_FLOAT, 
+		    (GLsizei )( currGldModel->texStride * sizeof( GLfloat)),
+		    currGldModel->texCoords
+		);
+		CHECK_GL_ERROR;
+
+		if( sceneModel->alphaTest == GL_TRUE)
+		{
+		    glEnable( GL_ALPHA_TEST);
+
+		} /* End if */
+		else
+		{
+		    glDisable( GL_ALPHA_TEST);
+
+		} /* End else */
+
+	    } /* End if */
+
+	    glPushMatrix( );
+
+	    if( sceneModel->isTransformed == GL_TRUE)
+	    {
+		glMultMatrixf( sceneModel->toWorld);
+
+	    } /* End if */
+
+	    for( j = 0U; j < currGldModel->nMaps; j++)
+	    {
+		if( currGldModel->mapTriNums[j] > 0U)
+		{
+		    glBindTexture( GL_TEXTURE_2D, textures[k][j]);
+
+		    glDrawElements( 
+			GL_TRIANGLES, 
+			3U * currGldModel->mapTriNums[j], 
+			GL_UNSIGNED_SHORT, 
+			currGldModel->triFaces[j]
+		    );
+
+		} /* End if */
+
+	    } /* End for */
+
+	    glPopMatrix( );
+
+	} /* End for */
+
+	glFinish( );
+	CHECK_GL_ERROR;
+
+	/* OSMesa stores the bottom row first */
+	if( SaveViewImage(
+		outPrefix, i, imgWidth, imgHeight, frameBuf, GL_TRUE
+	    ) != 0
+	)
+	{
+	    numFailed++;
+
+	} /* End if */
+
+    } /* End for */
+
+
+    for( k = 0U; k < theScene->numModels; k++)
+    {
+	glDeleteTextures( gldModels[k]->nMaps, textures[k]);
+	free( textures[k]);
+
+    } /* End for */
+
+    free( textures);
+
+    OSMesaDestroyContext( osCtx);
+    free( frameBuf);
+
+    return numFailed;
+
+} /* End function RenderViews */
+
+
+/**
+ * Returns the current time in seconds, with microsecond resolution
+ * where available.
+ */
+double GetSeconds( void)
+{
+    struct timeval tv;
+
+    gettimeofday( &tv, NULL);
+
+    return tv.tv_sec + ( tv.tv_usec / 1000000.0);
+
+} /* End function GetSeconds */
+
+